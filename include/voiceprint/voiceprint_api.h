@@ -56,6 +56,28 @@ VP_API void vp_release();
  */
 VP_API int vp_enroll(const char* speaker_id, const float* pcm_data, int sample_count);
 
+/**
+ * Enroll a batch of utterances. Embeddings are extracted in model batches
+ * grouped by length, one inference per group instead of per utterance.
+ * Models with a relative-length input pad utterances up to 1.5x apart into
+ * one group and mask the padding (results within float rounding of single
+ * extraction); other models group only utterances of the same length in
+ * frames or the same length bucket (see vp_set_length_buckets), with
+ * results bit-identical to single extraction. They are merged in input
+ * order, so repeating a speaker_id is the same as calling vp_enroll() for
+ * each utterance in turn.
+ * @param speaker_ids Array of count speaker IDs (may repeat)
+ * @param pcm_data Array of count pointers to Float32 PCM samples (16kHz)
+ * @param sample_counts Array of count sample counts
+ * @param count Number of utterances (>= 1)
+ * @param out_results Optional caller-allocated array of count entries;
+ *                    receives each utterance's error code (VP_OK if enrolled)
+ * @return VP_OK if every utterance was enrolled, otherwise the error of the
+ *         last failed one
+ */
+VP_API int vp_enroll_batch(const char* const* speaker_ids, const float* const* pcm_data,
+                           const int* sample_counts, int count, int* out_results);
+
 /**
  * Enroll a speaker from a WAV file.
  * @param speaker_id Unique identifier for the speaker
@@ -71,6 +93,20 @@ VP_API int vp_enroll_file(const char* speaker_id, const char* wav_path);
  */
 VP_API int vp_remove_speaker(const char* speaker_id);
 
+/**
+ * Publish this process's enrolls and removes to the gallery snapshot
+ * ("<db_path>.gallery", VP_SEARCH_FLAT only). Writes only update memory:
+ * the first one after init or a publish moves the mapped gallery into
+ * private memory, later ones cost O(1) in gallery size. Publishing writes
+ * the whole file (O(N)) and maps it again, so other processes switch to it
+ * within about 0.5 s and this one shares the page cache again. Call it after
+ * a batch of changes; vp_release publishes too. Processes that never see a
+ * published snapshot rebuild it from the database after about 10 s.
+ * @return VP_OK on success (also when there is nothing to publish),
+ *         VP_ERROR_DB_ERROR if the file could not be written
+ */
+VP_API int vp_publish_snapshot();
+
 /**
  * Identify a speaker from PCM audio (1:N search).
  * @param pcm_data Float32 PCM samples
@@ -83,6 +119,45 @@ VP_API int vp_remove_speaker(const char* speaker_id);
 VP_API int vp_identify(const float* pcm_data, int sample_count,
                        char* out_speaker_id, int id_buf_size, float* out_score);
 
+/**
+ * Identify the K best-matching speakers from PCM audio in one gallery pass.
+ * Candidates are returned best first and are NOT filtered by the threshold,
+ * so callers can inspect runner-up margins.
+ * @param pcm_data Float32 PCM samples
+ * @param sample_count Number of samples
+ * @param k Number of candidates requested (>= 1)
+ * @param out_matches Caller-allocated array of at least k entries
+ * @param out_count Receives the number of entries written (<= k)
+ * @return VP_OK on success, VP_ERROR_NO_MATCH if no speakers are enrolled
+ */
+VP_API int vp_identify_topk(const float* pcm_data, int sample_count, int k,
+                            VpSpeakerMatch* out_matches, int* out_count);
+
+/**
+ * Identify the K best-matching speakers for a batch of PCM queries.
+ * Queries are extracted in model batches grouped by length (as in
+ * vp_enroll_batch), then
+ * all of them are scored against the gallery together as one cache-blocked
+ * matrix product, so the gallery is read once per block of queries instead
+ * of once per query (VP_SEARCH_FLAT; index-backed backends answer the
+ * queries one by one).
+ * Candidates are best first and NOT filtered by the threshold.
+ * @param pcm_data Array of query_count pointers to Float32 PCM samples
+ * @param sample_counts Array of query_count sample counts
+ * @param query_count Number of queries (>= 1)
+ * @param k Number of candidates per query (>= 1)
+ * @param out_matches Caller-allocated array of query_count * k entries;
+ *                    candidates of query i start at out_matches[i * k]
+ * @param out_counts Caller-allocated array of query_count entries; receives
+ *                   the number of candidates written per query (0 when that
+ *                   query's audio could not be processed)
+ * @return VP_OK if at least one query was scored, VP_ERROR_NO_MATCH if no
+ *         speakers are enrolled, otherwise the error of the last failed query
+ */
+VP_API int vp_identify_batch(const float* const* pcm_data, const int* sample_counts,
+                             int query_count, int k,
+                             VpSpeakerMatch* out_matches, int* out_counts);
+
 /**
  * Verify if audio belongs to a specific speaker (1:1).
  * @param speaker_id Speaker to verify against
@@ -101,6 +176,205 @@ VP_API int vp_verify(const char* speaker_id,
  */
 VP_API int vp_set_threshold(float threshold);
 
+/**
+ * Select the in-memory representation used for 1:N search.
+ * VP_SEARCH_INT8 keeps only per-vector-scaled int8 codes in memory (~4x less
+ * than float32), scans them with integer SIMD kernels and re-scores the
+ * shortlist exactly against the float embeddings in the database, so
+ * decisions match VP_SEARCH_FLAT whenever the top-2 margin exceeds the
+ * rerank epsilon.
+ * VP_SEARCH_HNSW searches an HNSW graph in sub-linear time (recall < 1,
+ * tuned with vp_set_ef_search). The graph is maintained on every enroll and
+ * remove, saved to "<db_path>.hnsw" on release, and rebuilt automatically
+ * if that file is missing or stale.
+ * VP_SEARCH_IVFPQ keeps 8-16 byte product-quantization codes per speaker in
+ * inverted lists ("<db_path>.ivfpq", created by vp_train_ivfpq), probes
+ * vp_set_nprobe lists per query and re-scores the shortlist exactly from the
+ * database. Intended for galleries of millions of speakers.
+ * Rebuilds the gallery from the database.
+ * @param backend VP_SEARCH_FLAT, VP_SEARCH_INT8, VP_SEARCH_HNSW or VP_SEARCH_IVFPQ
+ * @return VP_OK on success, VP_ERROR_INVALID_PARAM for an unknown backend,
+ *         VP_ERROR_MODEL_NOT_AVAILABLE for VP_SEARCH_IVFPQ before training
+ *         (the previous backend stays active)
+ */
+VP_API int vp_set_search_backend(int backend);
+
+/**
+ * Set the approximate-score window used by VP_SEARCH_INT8: every candidate
+ * scoring within epsilon of the K-th best approximate score is re-scored
+ * exactly.
+ * @param epsilon Value between 0.0 and 1.0 (default: 0.01)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_rerank_epsilon(float epsilon);
+
+/**
+ * Set the HNSW candidate list size used by VP_SEARCH_HNSW queries.
+ * Larger values raise recall at the cost of latency.
+ * @param ef_search Value >= 1 (default: 64; values below K act as K)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_ef_search(int ef_search);
+
+/**
+ * Train the IVF-PQ index offline over the enrolled speakers: k-means coarse
+ * centroids and per-sub-space PQ codebooks are learned from a sample of the
+ * speakers table, then every speaker is encoded and the index is saved to
+ * "<db_path>.ivfpq". Later enrolls and removes update it incrementally;
+ * retrain when the gallery has grown substantially.
+ * Searches keep running on the current backend while training.
+ * @param nlist Number of inverted lists (0 = about 4 * sqrt(speaker count))
+ * @param code_bytes Bytes per PQ code, must divide the embedding dim
+ *                   (0 = 16; 8 halves memory at some recall cost)
+ * @return VP_OK on success, error code on failure
+ */
+VP_API int vp_train_ivfpq(int nlist, int code_bytes);
+
+/**
+ * Set the number of inverted lists probed by VP_SEARCH_IVFPQ queries.
+ * Larger values raise recall at the cost of latency.
+ * @param nprobe Value >= 1 (default: 16)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_nprobe(int nprobe);
+
+/**
+ * Enable micro-batching of concurrent embedding extractions (opt-in).
+ * Calls from many threads (vp_enroll / vp_identify / vp_verify ...) whose
+ * speech falls in the same length bucket queue their features and a
+ * scheduler runs them as one batched model inference, which raises
+ * throughput at high concurrency. Batching only happens within one length
+ * bucket, so it takes effect only while vp_set_length_buckets is on;
+ * without buckets, and for a call with no other call of its bucket to pair
+ * with, extraction runs on the calling thread as if batching were off.
+ * A batch is held open only while other calls are still in feature
+ * extraction, and never longer than max_wait_us, so a lone call is not
+ * delayed.
+ * @param max_batch Largest batch (capped by the model); <= 1 disables (default)
+ * @param max_wait_us Longest a queued call waits for others, in microseconds
+ *                    (e.g. 2000)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_batching(int max_batch, int max_wait_us);
+
+/**
+ * Enable long-input mode for speaker embeddings (opt-in).
+ * Speech longer than 4 windows (after VAD) is split into windows of
+ * window_sec seconds overlapping by overlap_sec, the windows run through the
+ * model in batches and their L2-normalized embeddings are averaged. Model
+ * memory and per-window latency then stay fixed however long the recording
+ * is (e.g. enrolling from a 20-minute call); shorter input is unaffected.
+ * @param window_sec Window length in seconds (e.g. 3.0); <= 0 disables (default)
+ * @param overlap_sec Overlap between consecutive windows, in [0, window_sec)
+ *                    (e.g. 1.5)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_long_input(float window_sec, float overlap_sec);
+
+/**
+ * Enable a bounded LRU cache of results keyed by audio content (opt-in).
+ * Re-submitted identical PCM (retries, replayed prompts) returns the cached
+ * embedding (vp_enroll / vp_identify / vp_verify / vp_extract_embedding,
+ * diarization segments) or VpAnalysisResult (vp_analyze and the per-feature
+ * calls) without running VAD, FBank or model inference. Keys are an xxHash64
+ * of the samples plus the model files, sample rate and feature flags; one
+ * cache is shared by speaker recognition, analysis and diarization.
+ * Calling again resizes the cache and keeps its entries.
+ * @param max_bytes Memory cap in bytes (e.g. 64 MB); 0 disables the cache
+ *                  and frees it (default)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_result_cache(uint64_t max_bytes);
+
+/** vp_set_length_buckets() count selecting the built-in bucket set */
+#define VP_LENGTH_BUCKETS_DEFAULT (-1)
+
+/**
+ * Run variable-length models at a small set of input lengths (opt-in).
+ * ONNX Runtime caches one memory plan per input shape; with exact lengths
+ * every utterance is a new shape and the arena fragments over time. With
+ * buckets, the speaker model pads inputs up to the next bucket and masks the
+ * padding when the model takes relative lengths, otherwise crops to the
+ * bucket below; the gender/age and emotion models crop. Lengths beyond
+ * the largest bucket snap to whole seconds. While warm-up is on
+ * (vp_set_warmup), every bucket is warmed up right away.
+ * @param seconds Bucket lengths in seconds of speech, each in (0, 60]
+ * @param count   Number of lengths; 0 disables bucketing (default);
+ *                VP_LENGTH_BUCKETS_DEFAULT uses 1.5 s .. 30 s, 12.5% apart
+ * @return VP_OK on success
+ */
+VP_API int vp_set_length_buckets(const float* seconds, int count);
+
+/**
+ * Get result cache counters (all zero while the cache is off).
+ * @param out Receives hit / miss / eviction counts and memory use
+ * @return VP_OK on success
+ */
+VP_API int vp_get_result_cache_stats(VpCacheStats* out);
+
+/**
+ * Warm the models up during vp_init (speaker model, VAD) and
+ * vp_init_analyzer (analysis and diarization models) at these speech
+ * lengths (opt-in). ONNX Runtime allocates memory and plans kernels on the
+ * first inference of each input length; warming up at representative
+ * lengths moves that cost from the first requests into initialization,
+ * which takes two model runs per length and model longer (vp_get_warmup_stats).
+ * The memory plans are per session, so one warm run serves every thread.
+ * May be called before vp_init; applies to later vp_init /
+ * vp_init_analyzer calls and survives vp_release.
+ * @param seconds Lengths in seconds, each in (0, 60] (e.g. 2, 5, 10)
+ * @param count   Number of lengths; 0 disables warm-up (default)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_warmup(const float* seconds, int count);
+
+/**
+ * Get the warm-up timings of the current initialization (all zero before
+ * vp_init or with warm-up disabled). May be called before vp_init.
+ * @param out Receives run count, per-model-family times and the slowest
+ *            first call next to its repeat
+ * @return VP_OK on success
+ */
+VP_API int vp_get_warmup_stats(VpWarmupStats* out);
+
+/**
+ * Set the ONNX Runtime threading of one model family: threads per operator
+ * and across graph nodes, whether idle workers spin-wait, and optional core
+ * pinning of the intra-op threads. For throughput with one SDK instance per
+ * core, use 1 intra-op thread and no spinning; for latency in one large
+ * instance, more threads with spinning (or vp_set_global_thread_pool).
+ * May be called before vp_init; applies to sessions created later (the
+ * next vp_init / vp_init_analyzer) and survives vp_release.
+ * @param model  VP_MODEL_SPEAKER, VP_MODEL_VAD or VP_MODEL_ANALYZER
+ * @param config Settings; NULL restores the default (2 intra-op threads,
+ *               1 for the VAD; 1 inter-op thread; spinning)
+ * @return VP_OK on success, VP_ERROR_INVALID_PARAM for negative counts or
+ *         an affinity without one group per intra-op thread after the first
+ */
+VP_API int vp_set_threading(int model, const VpThreadingConfig* config);
+
+/**
+ * Run all sessions on one shared intra-op and inter-op thread pool instead
+ * of a pool per session, so the SDK uses a fixed set of threads however
+ * many models are loaded. Per-model settings (vp_set_threading) are then
+ * ignored. May be called before vp_init; takes effect at the next vp_init
+ * and survives vp_release.
+ * @param config Pool settings; NULL returns to per-session pools (default)
+ * @return VP_OK on success
+ */
+VP_API int vp_set_global_thread_pool(const VpThreadingConfig* config);
+
+/**
+ * Select the FBank front-end of the speaker and analysis models. The native
+ * engine is faster and matches kaldi-native-fbank up to float rounding, but
+ * embeddings still shift slightly, so keep a gallery on the engine it was
+ * enrolled with (re-enroll before switching). May be called before vp_init;
+ * applies to later vp_init / vp_init_analyzer calls and survives vp_release.
+ * @param engine VP_FBANK_KALDI (default) or VP_FBANK_NATIVE
+ * @return VP_OK on success, VP_ERROR_INVALID_PARAM for an unknown engine
+ */
+VP_API int vp_set_fbank_engine(int engine);
+
 /**
  * Get the number of registered speakers.
  * @return Number of speakers, or negative error code
@@ -113,6 +387,116 @@ VP_API int vp_get_speaker_count();
  */
 VP_API const char* vp_get_last_error();
 
+/**
+ * Get the SIMD level the similarity and search kernels run with.
+ * Chosen once from CPUID at first use; may be called before vp_init.
+ * @return VP_SIMD_* constant
+ */
+VP_API int vp_get_simd_level();
+
+// ============================================================
+// Embedding-level API
+// Embeddings extracted once can be cached by the caller and enrolled,
+// identified or verified later without re-running VAD / FBank / model
+// inference. Embeddings are float32 vectors of vp_get_embedding_dim()
+// values; inputs are L2-normalized by the SDK.
+// ============================================================
+
+/**
+ * Get the speaker embedding dimension of the loaded model.
+ * @return Dimension (e.g. 192), or negative error code
+ */
+VP_API int vp_get_embedding_dim();
+
+/**
+ * Extract an L2-normalized speaker embedding from PCM audio.
+ * The speaker database is not touched.
+ * @param pcm_data Float32 PCM samples (16kHz, mono)
+ * @param sample_count Number of samples
+ * @param out_embedding Caller buffer of embedding_dim floats
+ * @param embedding_dim Must equal vp_get_embedding_dim()
+ * @return VP_OK on success, error code on failure
+ */
+VP_API int vp_extract_embedding(const float* pcm_data, int sample_count,
+                                float* out_embedding, int embedding_dim);
+
+/**
+ * Enroll (or incrementally update) a speaker from an embedding.
+ * @param speaker_id Unique speaker identifier
+ * @param embedding Embedding of embedding_dim floats
+ * @param embedding_dim Must equal vp_get_embedding_dim()
+ * @return VP_OK on success, error code on failure
+ */
+VP_API int vp_enroll_embedding(const char* speaker_id,
+                               const float* embedding, int embedding_dim);
+
+/**
+ * Identify a speaker from an embedding (1:N search, same semantics as vp_identify).
+ * @return VP_OK on match, VP_ERROR_NO_MATCH if no match above threshold
+ */
+VP_API int vp_identify_embedding(const float* embedding, int embedding_dim,
+                                 char* out_speaker_id, int id_buf_size, float* out_score);
+
+/**
+ * Verify an embedding against a specific speaker (1:1).
+ * @return VP_OK on success, error code on failure
+ */
+VP_API int vp_verify_embedding(const char* speaker_id,
+                               const float* embedding, int embedding_dim, float* out_score);
+
+// ============================================================
+// Streaming API
+// Live audio is pushed in chunks as it arrives; VAD, FBank and window
+// embeddings run incrementally on the new samples only, so a score can be
+// requested after any chunk without reprocessing earlier audio. Calls on
+// one stream are serialized; different streams run in parallel.
+// ============================================================
+
+/**
+ * Open a streaming session.
+ * @param out_stream Receives the stream handle (> 0)
+ * @return VP_OK on success, error code on failure
+ */
+VP_API int vp_stream_open(int* out_stream);
+
+/**
+ * Append PCM to a stream.
+ * @param stream Handle from vp_stream_open
+ * @param pcm_data Float32 PCM samples (16kHz, mono), any chunk size
+ * @param sample_count Number of samples
+ * @return VP_OK on success, VP_ERROR_INVALID_PARAM for an unknown stream,
+ *         VP_ERROR_INFERENCE if a model failed (the chunk's speech is lost;
+ *         the stream stays usable)
+ */
+VP_API int vp_stream_push(int stream, const float* pcm_data, int sample_count);
+
+/**
+ * Verify all speech pushed so far against a speaker (1:1). May be called
+ * repeatedly as audio arrives.
+ * @param stream Handle from vp_stream_open
+ * @param speaker_id Speaker to verify against
+ * @param out_score Cosine similarity score
+ * @return VP_OK on success, VP_ERROR_AUDIO_TOO_SHORT while the stream
+ *         holds less than 1.5 s of speech
+ */
+VP_API int vp_stream_score(int stream, const char* speaker_id, float* out_score);
+
+/**
+ * Enroll (or incrementally update) a speaker from all speech pushed since
+ * the stream was opened or last enrolled from. On success that speech is
+ * consumed: the stream starts over empty, so enrolling again after more
+ * audio adds only the new speech (as a second vp_enroll would).
+ * @return VP_OK on success, error code on failure (the stream is then kept)
+ */
+VP_API int vp_stream_enroll(int stream, const char* speaker_id);
+
+/**
+ * Close a stream and free its state. Streams still open at vp_release()
+ * are closed with it.
+ * @return VP_OK on success, VP_ERROR_INVALID_PARAM for an unknown stream
+ */
+VP_API int vp_stream_close(int stream);
+
 // ============================================================
 // Voice Analysis API
 // ============================================================
@@ -65,6 +65,36 @@ extern "C" {
 #define VP_STRESS_MEDIUM     1
 #define VP_STRESS_HIGH       2
 
+// ============================================================
+// Speaker search backends for vp_set_search_backend()
+// ============================================================
+#define VP_SEARCH_FLAT    0   // exact float32 scan (default)
+#define VP_SEARCH_INT8    1   // int8 scan + exact float re-scoring of the shortlist
+#define VP_SEARCH_HNSW    2   // HNSW graph index (approximate, <db_path>.hnsw)
+#define VP_SEARCH_IVFPQ   3   // IVF-PQ codes + exact re-scoring (<db_path>.ivfpq, needs vp_train_ivfpq)
+
+// ============================================================
+// SIMD kernel levels reported by vp_get_simd_level()
+// ============================================================
+#define VP_SIMD_SCALAR    0   // portable C++
+#define VP_SIMD_SSE41     1   // SSE4.1
+#define VP_SIMD_AVX2      2   // AVX2 + FMA
+#define VP_SIMD_AVX512    3   // AVX-512 F/BW/VL + VNNI
+
+// ============================================================
+// Model families for vp_set_threading()
+// ============================================================
+#define VP_MODEL_SPEAKER  0   // ecapa_tdnn.onnx (speaker manager and diarizer)
+#define VP_MODEL_VAD      1   // silero_vad.onnx
+#define VP_MODEL_ANALYZER 2   // gender/age, emotion, anti-spoof, DNSMOS, language
+#define VP_MODEL_COUNT    3
+
+// ============================================================
+// FBank front-ends for vp_set_fbank_engine()
+// ============================================================
+#define VP_FBANK_KALDI    0   // kaldi-native-fbank (default)
+#define VP_FBANK_NATIVE   1   // in-tree SIMD kernels, equal to kaldi up to float rounding
+
 // ============================================================
 // Result structures (all POD / C-compatible)
 // ============================================================
@@ -167,6 +197,45 @@ typedef struct VpDiarizeSegment {
     int   reserved[2];
 } VpDiarizeSegment;
 
+/** One candidate from vp_identify_topk() */
+typedef struct VpSpeakerMatch {
+    char  speaker_id[128];  /**< Registered speaker ID */
+    float score;            /**< Cosine similarity [-1,1] */
+    int   reserved[2];
+} VpSpeakerMatch;
+
+/** Counters of the result cache, from vp_get_result_cache_stats() */
+typedef struct VpCacheStats {
+    uint64_t hits;          /**< Lookups served from the cache */
+    uint64_t misses;        /**< Lookups that ran the full pipeline */
+    uint64_t evictions;     /**< Entries dropped to stay under the memory cap */
+    uint64_t entries;       /**< Embeddings + analysis results held */
+    uint64_t bytes;         /**< Memory held, including per-entry overhead */
+    uint64_t capacity;      /**< Memory cap in bytes (0 = cache off) */
+} VpCacheStats;
+
+/** Timings of the init-time model warm-up, from vp_get_warmup_stats() */
+typedef struct VpWarmupStats {
+    int   runs;             /**< Synthetic model calls made */
+    float total_ms;         /**< Wall time of all warm-up stages so far */
+    float speaker_ms;       /**< FBank + speaker model (incl. diarizer), all lengths */
+    float vad_ms;           /**< Silero VAD */
+    float analyzer_ms;      /**< Voice analysis models */
+    float first_run_ms;     /**< Slowest first call of any model / length */
+    float second_run_ms;    /**< Slowest repeat of that same call (steady state) */
+} VpWarmupStats;
+
+/** ONNX Runtime threading of a model family or of the global pool, for
+ *  vp_set_threading() / vp_set_global_thread_pool() */
+typedef struct VpThreadingConfig {
+    int intra_op_threads;   /**< Threads per operator, incl. the caller (0 = ORT default: one per core) */
+    int inter_op_threads;   /**< Threads across independent graph nodes (0 = ORT default) */
+    int spin;               /**< 1 = idle workers spin-wait (lower latency), 0 = block (less CPU) */
+    const char* affinity;   /**< Logical cores per extra intra-op thread, e.g. "2;3;4" or "1,2;3,4"
+                                 (1-based, one ';'-group per thread after the caller's);
+                                 NULL or "" = not pinned */
+} VpThreadingConfig;
+
 /** Aggregated analysis result from vp_analyze() */
 typedef struct VpAnalysisResult {
     unsigned int     features_computed; /**< Bitmask of VP_FEATURE_* flags actually computed */
@@ -3,19 +3,57 @@
 #include "manager/diarizer.h"
 #include "core/voice_analyzer.h"
 #include "core/audio_processor.h"
+#include "core/fbank_extractor.h"
+#include "core/result_cache.h"
+#include "core/length_buckets.h"
+#include "core/ort_threading.h"
+#include "core/simd_dispatch.h"
 #include "utils/error_codes.h"
 #include "utils/logger.h"
 #include <memory>
 #include <mutex>
 #include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 // Global manager instance
 static std::unique_ptr<vp::SpeakerManager> g_manager;
 static std::unique_ptr<vp::VoiceAnalyzer>  g_analyzer;
 static std::unique_ptr<vp::Diarizer>       g_diarizer;
+static std::shared_ptr<vp::ResultCache> g_result_cache;   // null while off; g_init_mutex
+static std::shared_ptr<const vp::LengthBuckets> g_length_buckets;   // null while off; g_init_mutex
 static std::mutex g_init_mutex;
 static std::string g_model_dir;  // stored on vp_init for re-use by analyzer/diarizer
 
+// Init-time warm-up lengths in seconds (empty: off, the default) and the
+// timings of the current init; both g_init_mutex
+static std::vector<float> g_warmup_seconds;
+static VpWarmupStats g_warmup_stats = {};
+
+// Lengths to warm up at: every bucket while length bucketing is on (one
+// memory plan each), otherwise the configured ones (g_init_mutex held)
+static std::vector<float> warmup_lengths() {
+    return g_length_buckets ? g_length_buckets->seconds() : g_warmup_seconds;
+}
+
+// Run one warm-up stage and add its wall time to g_warmup_stats
+// (g_init_mutex held). Failures are logged and do not fail the init.
+template <typename Fn>
+static void run_warmup(const char* stage, Fn&& warm_up) {
+    if (g_warmup_seconds.empty()) return;
+    auto start = std::chrono::steady_clock::now();
+    if (!warm_up(warmup_lengths(), g_warmup_stats)) {
+        VP_LOG_WARN("Warm-up of {} incomplete", stage);
+    }
+    const float ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    g_warmup_stats.total_ms += ms;
+    VP_LOG_INFO("Warm-up of {} took {:.1f} ms ({} runs so far)", stage, ms, g_warmup_stats.runs);
+}
+
 VP_API int vp_init(const char* model_dir, const char* db_path) {
     std::lock_guard<std::mutex> lock(g_init_mutex);
 
@@ -41,6 +79,12 @@ VP_API int vp_init(const char* model_dir, const char* db_path) {
             return VP_ERROR_MODEL_LOAD;
         }
 
+        g_warmup_stats = {};
+        run_warmup("speaker recognition", [](const std::vector<float>& seconds,
+                                             VpWarmupStats& stats) {
+            return g_manager->warm_up(seconds, stats);
+        });
+
         VP_LOG_INFO("VoicePrint SDK initialized successfully");
         return VP_OK;
     } catch (const std::exception& e) {
@@ -59,6 +103,8 @@ VP_API void vp_release() {
 
     if (g_diarizer) g_diarizer.reset();
     if (g_analyzer)  g_analyzer.reset();
+    g_result_cache.reset();
+    g_length_buckets.reset();
 
     if (g_manager) {
         try {
@@ -98,6 +144,33 @@ VP_API int vp_enroll(const char* speaker_id, const float* pcm_data, int sample_c
     }
 }
 
+VP_API int vp_enroll_batch(const char* const* speaker_ids, const float* const* pcm_data,
+                           const int* sample_counts, int count, int* out_results) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!speaker_ids || !pcm_data || !sample_counts || count <= 0) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        int result = g_manager->enroll_batch(speaker_ids, pcm_data, sample_counts, count,
+                                             out_results);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
 VP_API int vp_enroll_file(const char* speaker_id, const char* wav_path) {
     if (!g_manager) {
         vp::set_last_error(vp::ErrorCode::NOT_INIT);
@@ -148,6 +221,27 @@ VP_API int vp_remove_speaker(const char* speaker_id) {
     }
 }
 
+VP_API int vp_publish_snapshot() {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    try {
+        int result = g_manager->publish_snapshot();
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
 VP_API int vp_identify(const float* pcm_data, int sample_count,
                        char* out_speaker_id, int id_buf_size, float* out_score) {
     if (!g_manager) {
@@ -160,7 +254,8 @@ VP_API int vp_identify(const float* pcm_data, int sample_count,
     }
 
     try {
-        std::string speaker_id;
+        // Per-thread, so repeated calls reuse the string
+        thread_local std::string speaker_id;
         float score = 0.0f;
         int result = g_manager->identify(pcm_data, sample_count, speaker_id, score);
 
@@ -187,6 +282,93 @@ VP_API int vp_identify(const float* pcm_data, int sample_count,
     }
 }
 
+// ============================================================
+// Helper: copy ranked results into a caller-provided VpSpeakerMatch array
+// ============================================================
+static int copy_matches(const std::vector<vp::IdentifyResult>& results, VpSpeakerMatch* out_matches) {
+    for (size_t i = 0; i < results.size(); ++i) {
+        VpSpeakerMatch& m = out_matches[i];
+        std::memset(&m, 0, sizeof(m));
+        if (results[i].speaker_id.size() >= sizeof(m.speaker_id)) {
+            vp::set_last_error(vp::ErrorCode::BUFFER_TOO_SMALL);
+            return VP_ERROR_BUFFER_TOO_SMALL;
+        }
+        std::strncpy(m.speaker_id, results[i].speaker_id.c_str(), sizeof(m.speaker_id) - 1);
+        m.score = results[i].score;
+    }
+    return VP_OK;
+}
+
+VP_API int vp_identify_topk(const float* pcm_data, int sample_count, int k,
+                            VpSpeakerMatch* out_matches, int* out_count) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!pcm_data || sample_count <= 0 || k <= 0 || !out_matches || !out_count) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        *out_count = 0;
+        thread_local std::vector<vp::IdentifyResult> results;   // reused, as in vp_identify
+        int result = g_manager->identify_topk(pcm_data, sample_count, k, results);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+            return result;
+        }
+
+        result = copy_matches(results, out_matches);
+        if (result != VP_OK) return result;
+        *out_count = static_cast<int>(results.size());
+        return VP_OK;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_identify_batch(const float* const* pcm_data, const int* sample_counts,
+                             int query_count, int k,
+                             VpSpeakerMatch* out_matches, int* out_counts) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!pcm_data || !sample_counts || query_count <= 0 || k <= 0 ||
+        !out_matches || !out_counts) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        std::fill(out_counts, out_counts + query_count, 0);
+        std::vector<std::vector<vp::IdentifyResult>> results;
+        int result = g_manager->identify_batch(pcm_data, sample_counts, query_count, k, results);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+            return result;
+        }
+
+        for (int q = 0; q < query_count; ++q) {
+            int rc = copy_matches(results[q], out_matches + static_cast<size_t>(q) * k);
+            if (rc != VP_OK) return rc;
+            out_counts[q] = static_cast<int>(results[q].size());
+        }
+        return VP_OK;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
 VP_API int vp_verify(const char* speaker_id,
                      const float* pcm_data, int sample_count, float* out_score) {
     if (!g_manager) {
@@ -230,81 +412,676 @@ VP_API int vp_set_threshold(float threshold) {
     return VP_OK;
 }
 
-VP_API int vp_get_speaker_count() {
+VP_API int vp_set_search_backend(int backend) {
     if (!g_manager) {
         vp::set_last_error(vp::ErrorCode::NOT_INIT);
         return VP_ERROR_NOT_INIT;
     }
 
-    return g_manager->get_speaker_count();
+    if (backend != VP_SEARCH_FLAT && backend != VP_SEARCH_INT8 &&
+        backend != VP_SEARCH_HNSW && backend != VP_SEARCH_IVFPQ) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "Unknown search backend");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        int result = g_manager->set_search_backend(static_cast<vp::SearchBackend>(backend));
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
 }
 
-VP_API const char* vp_get_last_error() {
-    return vp::get_last_error();
+VP_API int vp_set_rerank_epsilon(float epsilon) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    if (epsilon < 0.0f || epsilon > 1.0f) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "Rerank epsilon must be between 0.0 and 1.0");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    g_manager->set_rerank_epsilon(epsilon);
+    return VP_OK;
 }
 
-// ============================================================
-// Helper: load PCM from file, resampled to 16kHz
-// ============================================================
-static int load_pcm_from_file(const char* wav_path,
-                               std::vector<float>& pcm) {
-    vp::AudioProcessor ap;
-    int sr = 0;
-    if (!ap.read_wav(wav_path, pcm, sr)) {
-        vp::set_last_error(vp::ErrorCode::FILE_NOT_FOUND, ap.last_error());
-        return VP_ERROR_FILE_NOT_FOUND;
+VP_API int vp_set_ef_search(int ef_search) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
     }
-    pcm = ap.normalize(pcm, sr);
+
+    if (ef_search <= 0) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "ef_search must be positive");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    g_manager->set_ef_search(ef_search);
     return VP_OK;
 }
 
-// ============================================================
-// Helper: ensure VoiceAnalyzer is initialized with given flags
-// ============================================================
-static int ensure_analyzer(unsigned int flags) {
+VP_API int vp_train_ivfpq(int nlist, int code_bytes) {
     if (!g_manager) {
-        vp::set_last_error(vp::ErrorCode::NOT_INIT,
-                           "vp_init() must be called before voice analysis");
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
         return VP_ERROR_NOT_INIT;
     }
-    if (!g_analyzer) {
-        vp::set_last_error(vp::ErrorCode::NOT_INIT,
-                           "vp_init_analyzer() not called");
+
+    if (nlist < 0 || code_bytes < 0) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "nlist and code_bytes must not be negative");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        int result = g_manager->train_ivfpq(nlist, code_bytes);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_set_nprobe(int nprobe) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
         return VP_ERROR_NOT_INIT;
     }
+
+    if (nprobe <= 0) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "nprobe must be positive");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    g_manager->set_nprobe(nprobe);
     return VP_OK;
 }
 
-// ============================================================
-// vp_init_analyzer
-// ============================================================
-VP_API int vp_init_analyzer(unsigned int feature_flags) {
+VP_API int vp_set_batching(int max_batch, int max_wait_us) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    if (max_wait_us < 0) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "max_wait_us must not be negative");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    g_manager->set_batching(max_batch, max_wait_us);
+    return VP_OK;
+}
+
+VP_API int vp_set_long_input(float window_sec, float overlap_sec) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    if (window_sec > 0.0f && (overlap_sec < 0.0f || overlap_sec >= window_sec)) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM,
+                           "overlap_sec must be in [0, window_sec)");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    g_manager->set_long_input(window_sec, overlap_sec);
+    return VP_OK;
+}
+
+VP_API int vp_set_result_cache(uint64_t max_bytes) {
     std::lock_guard<std::mutex> lock(g_init_mutex);
     if (!g_manager) {
         vp::set_last_error(vp::ErrorCode::NOT_INIT);
         return VP_ERROR_NOT_INIT;
     }
-    try {
-        void* ort_env = vp::SpeakerManager::get_ort_env();
 
-        // Initialize VoiceAnalyzer
-        if (!g_analyzer)
-            g_analyzer = std::make_unique<vp::VoiceAnalyzer>();
-        if (!g_analyzer->init(g_model_dir, feature_flags, ort_env)) {
-            vp::set_last_error(vp::ErrorCode::MODEL_LOAD, g_analyzer->last_error());
-            g_analyzer.reset();
-            return VP_ERROR_MODEL_LOAD;
+    const size_t cap = static_cast<size_t>(
+        std::min<uint64_t>(max_bytes, std::numeric_limits<size_t>::max()));
+    if (cap > 0 && g_result_cache) {
+        g_result_cache->set_capacity(cap);
+        return VP_OK;
+    }
+    g_result_cache = cap > 0 ? std::make_shared<vp::ResultCache>(cap) : nullptr;
+
+    // Calls already holding the old cache finish with it
+    g_manager->set_result_cache(g_result_cache);
+    if (g_analyzer) g_analyzer->set_result_cache(g_result_cache);
+    if (g_diarizer) g_diarizer->set_result_cache(g_result_cache);
+    VP_LOG_INFO("Result cache: {} bytes", cap);
+    return VP_OK;
+}
+
+VP_API int vp_set_length_buckets(const float* seconds, int count) {
+    std::lock_guard<std::mutex> lock(g_init_mutex);
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (count < VP_LENGTH_BUCKETS_DEFAULT || (count > 0 && !seconds)) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        std::shared_ptr<const vp::LengthBuckets> buckets;
+        if (count == VP_LENGTH_BUCKETS_DEFAULT) {
+            buckets = std::make_shared<const vp::LengthBuckets>(vp::LengthBuckets::defaults());
+        } else if (count > 0) {
+            std::vector<int> frames;
+            for (int i = 0; i < count; ++i) {
+                if (!(seconds[i] > 0.0f && seconds[i] <= 60.0f)) {
+                    vp::set_last_error(vp::ErrorCode::INVALID_PARAM,
+                                       "bucket lengths must be in (0, 60] seconds");
+                    return VP_ERROR_INVALID_PARAM;
+                }
+                frames.push_back(static_cast<int>(std::lround(
+                    seconds[i] * vp::LengthBuckets::FRAMES_PER_SECOND)));
+            }
+            buckets = std::make_shared<const vp::LengthBuckets>(std::move(frames));
         }
+        g_length_buckets = buckets;
 
-        // Initialize Diarizer (reuses same models)
-        if (!g_diarizer)
-            g_diarizer = std::make_unique<vp::Diarizer>();
-        if (!g_diarizer->init(g_model_dir, ort_env, g_manager.get())) {
-            // Non-fatal: diarizer may fail if models missing, analyzer still usable
-            VP_LOG_WARN("Diarizer init failed (feature disabled): {}",
-                        g_diarizer->last_error());
-            g_diarizer.reset();
+        // Calls already running keep the lengths they started with
+        g_manager->set_length_buckets(buckets);
+        if (g_analyzer) g_analyzer->set_length_buckets(buckets);
+        if (g_diarizer) g_diarizer->set_length_buckets(buckets);
+        VP_LOG_INFO("Length bucketing: {} buckets", buckets ? buckets->frames().size() : 0);
+
+        // Plan every bucket now rather than on the first request that hits it
+        if (buckets) {
+            run_warmup("length buckets", [](const std::vector<float>& lengths,
+                                            VpWarmupStats& stats) {
+                bool ok = g_manager->warm_up(lengths, stats);
+                if (g_analyzer) ok &= g_analyzer->warm_up(lengths, stats);
+                if (g_diarizer) ok &= g_diarizer->warm_up(lengths, stats);
+                return ok;
+            });
         }
+        return VP_OK;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_get_result_cache_stats(VpCacheStats* out) {
+    if (!out) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(g_init_mutex);
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    std::memset(out, 0, sizeof(*out));
+    if (g_result_cache) {
+        const vp::ResultCache::Stats stats = g_result_cache->stats();
+        out->hits = stats.hits;
+        out->misses = stats.misses;
+        out->evictions = stats.evictions;
+        out->entries = stats.entries;
+        out->bytes = stats.bytes;
+        out->capacity = stats.capacity;
+    }
+    return VP_OK;
+}
+
+VP_API int vp_set_warmup(const float* seconds, int count) {
+    if (count < 0 || (count > 0 && !seconds)) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (!(seconds[i] > 0.0f && seconds[i] <= 60.0f)) {
+            vp::set_last_error(vp::ErrorCode::INVALID_PARAM,
+                               "warm-up lengths must be in (0, 60] seconds");
+            return VP_ERROR_INVALID_PARAM;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(g_init_mutex);
+    g_warmup_seconds.assign(seconds, seconds + count);
+    return VP_OK;
+}
+
+VP_API int vp_get_warmup_stats(VpWarmupStats* out) {
+    if (!out) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(g_init_mutex);
+    *out = g_warmup_stats;
+    return VP_OK;
+}
+
+// Validated copy of a C threading config; false with the last error set
+static bool to_threading(const VpThreadingConfig& in, vp::ThreadingConfig& out) {
+    if (in.spin != 0 && in.spin != 1) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "spin must be 0 or 1");
+        return false;
+    }
+    out.intra_op_threads = in.intra_op_threads;
+    out.inter_op_threads = in.inter_op_threads;
+    out.spin = in.spin != 0;
+    out.affinity = in.affinity ? in.affinity : "";
+    const std::string problem = vp::validate_threading(out);
+    if (!problem.empty()) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, problem);
+        return false;
+    }
+    return true;
+}
+
+VP_API int vp_set_threading(int model, const VpThreadingConfig* config) {
+    if (model < 0 || model >= VP_MODEL_COUNT) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+    const auto kind = static_cast<vp::ModelKind>(model);
+    vp::ThreadingConfig threading = vp::default_threading(kind);
+    if (config && !to_threading(*config, threading)) return VP_ERROR_INVALID_PARAM;
+
+    vp::set_threading(kind, threading);
+    return VP_OK;
+}
+
+VP_API int vp_set_global_thread_pool(const VpThreadingConfig* config) {
+    vp::ThreadingConfig pool;
+    if (config && !to_threading(*config, pool)) return VP_ERROR_INVALID_PARAM;
+
+    vp::set_global_thread_pool(config ? &pool : nullptr);
+    return VP_OK;
+}
+
+VP_API int vp_set_fbank_engine(int engine) {
+    if (engine != VP_FBANK_KALDI && engine != VP_FBANK_NATIVE) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "engine must be VP_FBANK_KALDI or VP_FBANK_NATIVE");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    vp::set_fbank_engine(engine == VP_FBANK_NATIVE ? vp::FbankEngine::NATIVE : vp::FbankEngine::KALDI);
+    return VP_OK;
+}
+
+VP_API int vp_get_speaker_count() {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    return g_manager->get_speaker_count();
+}
+
+VP_API const char* vp_get_last_error() {
+    return vp::get_last_error();
+}
+
+VP_API int vp_get_simd_level() {
+    return static_cast<int>(vp::simd_kernels().level);
+}
+
+// ============================================================
+// Embedding-level API
+// ============================================================
+
+VP_API int vp_get_embedding_dim() {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    return g_manager->embedding_dim();
+}
+
+VP_API int vp_extract_embedding(const float* pcm_data, int sample_count,
+                                float* out_embedding, int embedding_dim) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!pcm_data || sample_count <= 0 || !out_embedding) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+    if (embedding_dim != g_manager->embedding_dim()) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM, "embedding_dim must equal vp_get_embedding_dim()");
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        std::vector<float> embedding;
+        int result = g_manager->extract_embedding(pcm_data, sample_count, embedding);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+            return result;
+        }
+        std::copy(embedding.begin(), embedding.end(), out_embedding);
+        return VP_OK;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_enroll_embedding(const char* speaker_id,
+                               const float* embedding, int embedding_dim) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!speaker_id || !embedding || embedding_dim <= 0) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        int result = g_manager->enroll_embedding(speaker_id, embedding, embedding_dim);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_identify_embedding(const float* embedding, int embedding_dim,
+                                 char* out_speaker_id, int id_buf_size, float* out_score) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!embedding || embedding_dim <= 0 || !out_speaker_id || id_buf_size <= 0 || !out_score) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        std::string speaker_id;
+        float score = 0.0f;
+        int result = g_manager->identify_embedding(embedding, embedding_dim, speaker_id, score);
+
+        *out_score = score;
+
+        if (result == VP_OK) {
+            if (static_cast<int>(speaker_id.size()) >= id_buf_size) {
+                vp::set_last_error(vp::ErrorCode::BUFFER_TOO_SMALL);
+                return VP_ERROR_BUFFER_TOO_SMALL;
+            }
+            std::strncpy(out_speaker_id, speaker_id.c_str(), id_buf_size - 1);
+            out_speaker_id[id_buf_size - 1] = '\0';
+        } else {
+            out_speaker_id[0] = '\0';
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_verify_embedding(const char* speaker_id,
+                               const float* embedding, int embedding_dim, float* out_score) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!speaker_id || !embedding || embedding_dim <= 0 || !out_score) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        float score = 0.0f;
+        int result = g_manager->verify_embedding(speaker_id, embedding, embedding_dim, score);
+        *out_score = score;
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+// ============================================================
+// Streaming API
+// ============================================================
+
+VP_API int vp_stream_open(int* out_stream) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!out_stream) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        int stream = 0;
+        int result = g_manager->stream_open(stream);
+        *out_stream = stream;
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_stream_push(int stream, const float* pcm_data, int sample_count) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!pcm_data || sample_count <= 0) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        int result = g_manager->stream_push(stream, pcm_data, sample_count);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_stream_score(int stream, const char* speaker_id, float* out_score) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!speaker_id || !out_score) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        float score = 0.0f;
+        int result = g_manager->stream_score(stream, speaker_id, score);
+        *out_score = score;
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_stream_enroll(int stream, const char* speaker_id) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!speaker_id) {
+        vp::set_last_error(vp::ErrorCode::INVALID_PARAM);
+        return VP_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        int result = g_manager->stream_enroll(stream, speaker_id);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+VP_API int vp_stream_close(int stream) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+
+    try {
+        int result = g_manager->stream_close(stream);
+        if (result != VP_OK) {
+            vp::set_last_error(g_manager->last_error());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN, e.what());
+        return VP_ERROR_UNKNOWN;
+    } catch (...) {
+        vp::set_last_error(vp::ErrorCode::UNKNOWN);
+        return VP_ERROR_UNKNOWN;
+    }
+}
+
+// ============================================================
+// Helper: load PCM from file, resampled to 16kHz
+// ============================================================
+static int load_pcm_from_file(const char* wav_path,
+                               std::vector<float>& pcm) {
+    vp::AudioProcessor ap;
+    int sr = 0;
+    if (!ap.read_wav(wav_path, pcm, sr)) {
+        vp::set_last_error(vp::ErrorCode::FILE_NOT_FOUND, ap.last_error());
+        return VP_ERROR_FILE_NOT_FOUND;
+    }
+    pcm = ap.normalize(pcm, sr);
+    return VP_OK;
+}
+
+// ============================================================
+// Helper: ensure VoiceAnalyzer is initialized with given flags
+// ============================================================
+static int ensure_analyzer(unsigned int flags) {
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT,
+                           "vp_init() must be called before voice analysis");
+        return VP_ERROR_NOT_INIT;
+    }
+    if (!g_analyzer) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT,
+                           "vp_init_analyzer() not called");
+        return VP_ERROR_NOT_INIT;
+    }
+    return VP_OK;
+}
+
+// ============================================================
+// vp_init_analyzer
+// ============================================================
+VP_API int vp_init_analyzer(unsigned int feature_flags) {
+    std::lock_guard<std::mutex> lock(g_init_mutex);
+    if (!g_manager) {
+        vp::set_last_error(vp::ErrorCode::NOT_INIT);
+        return VP_ERROR_NOT_INIT;
+    }
+    try {
+        void* ort_env = vp::SpeakerManager::get_ort_env();
+
+        // Initialize VoiceAnalyzer
+        if (!g_analyzer)
+            g_analyzer = std::make_unique<vp::VoiceAnalyzer>();
+        if (!g_analyzer->init(g_model_dir, feature_flags, ort_env)) {
+            vp::set_last_error(vp::ErrorCode::MODEL_LOAD, g_analyzer->last_error());
+            g_analyzer.reset();
+            return VP_ERROR_MODEL_LOAD;
+        }
+        g_analyzer->set_result_cache(g_result_cache);
+        g_analyzer->set_length_buckets(g_length_buckets);
+
+        // Initialize Diarizer (reuses same models)
+        if (!g_diarizer)
+            g_diarizer = std::make_unique<vp::Diarizer>();
+        if (!g_diarizer->init(g_model_dir, ort_env, g_manager.get())) {
+            // Non-fatal: diarizer may fail if models missing, analyzer still usable
+            VP_LOG_WARN("Diarizer init failed (feature disabled): {}",
+                        g_diarizer->last_error());
+            g_diarizer.reset();
+        } else {
+            g_diarizer->set_result_cache(g_result_cache);
+            g_diarizer->set_length_buckets(g_length_buckets);
+        }
+
+        run_warmup("voice analysis", [](const std::vector<float>& seconds,
+                                        VpWarmupStats& stats) {
+            bool ok = g_analyzer->warm_up(seconds, stats);
+            if (g_diarizer) ok &= g_diarizer->warm_up(seconds, stats);
+            return ok;
+        });
 
         VP_LOG_INFO("VoiceAnalyzer initialized, features=0x{:03x}", feature_flags);
         return VP_OK;
@@ -146,15 +146,44 @@ std::vector<float> AudioProcessor::int16_to_float(const int16_t* data, size_t co
     return result;
 }
 
+std::vector<float> AudioProcessor::synthetic_speech(size_t samples) {
+    std::vector<float> audio(samples);
+    uint32_t seed = 0x12345678u;
+    for (size_t i = 0; i < samples; ++i) {
+        const float t = static_cast<float>(i) / 16000.0f;
+        const float pitch = 140.0f + 20.0f * std::sin(2.0f * 3.14159265f * 0.7f * t);
+        const float envelope = 0.6f + 0.4f * std::sin(2.0f * 3.14159265f * 4.0f * t);
+        float v = 0.0f;
+        for (int h = 1; h <= 4; ++h) {
+            v += std::sin(2.0f * 3.14159265f * pitch * h * t) / static_cast<float>(h);
+        }
+        seed = seed * 1664525u + 1013904223u;   // LCG noise
+        const float noise = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+        audio[i] = 0.2f * envelope * v + 0.02f * noise;
+    }
+    return audio;
+}
+
 std::vector<float> AudioProcessor::resample(const std::vector<float>& input,
                                              int src_rate, int dst_rate) {
     if (src_rate == dst_rate) {
         return input;
     }
+    std::vector<float> output;
+    resample(Span<const float>(input), src_rate, dst_rate, output);
+    return output;
+}
+
+void AudioProcessor::resample(Span<const float> input, int src_rate, int dst_rate,
+                              std::vector<float>& output) {
+    if (src_rate == dst_rate) {
+        output.assign(input.begin(), input.end());
+        return;
+    }
 
     double ratio = static_cast<double>(dst_rate) / static_cast<double>(src_rate);
     size_t output_size = static_cast<size_t>(std::ceil(input.size() * ratio));
-    std::vector<float> output(output_size);
+    output.resize(output_size);
 
     for (size_t i = 0; i < output_size; ++i) {
         double src_pos = static_cast<double>(i) / ratio;
@@ -170,8 +199,6 @@ std::vector<float> AudioProcessor::resample(const std::vector<float>& input,
             output[i] = 0.0f;
         }
     }
-
-    return output;
 }
 
 std::vector<float> AudioProcessor::normalize(const std::vector<float>& input, int sample_rate) {
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include "utils/span.h"
 
 namespace vp {
 
@@ -37,6 +38,14 @@ public:
     static std::vector<float> resample(const std::vector<float>& input,
                                         int src_rate, int dst_rate);
 
+    // Resample into `output`, reusing its capacity
+    static void resample(Span<const float> input, int src_rate, int dst_rate,
+                         std::vector<float>& output);
+
+    // Deterministic speech-like signal at 16kHz (voiced harmonics with a
+    // syllable-rate envelope plus noise), for model warm-up
+    static std::vector<float> synthetic_speech(size_t samples);
+
     // Ensure audio is 16kHz mono
     std::vector<float> normalize(const std::vector<float>& input, int sample_rate);
 
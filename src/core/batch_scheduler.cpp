@@ -0,0 +1,155 @@
+#include "core/batch_scheduler.h"
+#include <algorithm>
+
+namespace vp {
+
+BatchScheduler::BatchScheduler(RunBatch run, int max_batch, int max_wait_us)
+    : run_(std::move(run)),
+      max_batch_(std::max(1, max_batch)),
+      max_wait_(std::max(0, max_wait_us)) {
+    worker_ = std::thread([this] { worker_loop(); });
+}
+
+BatchScheduler::~BatchScheduler() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+void BatchScheduler::begin() {
+    std::lock_guard lock(mutex_);
+    ++announced_;
+}
+
+void BatchScheduler::abandon() {
+    {
+        std::lock_guard lock(mutex_);
+        --announced_;
+    }
+    cv_.notify_all();
+}
+
+bool BatchScheduler::submit(const std::vector<float>& input, int key, bool announced,
+                            std::vector<float>& output, std::string& error) {
+    Request request{&input, key, &output, &error, std::chrono::steady_clock::now(), false, {}};
+    auto result = request.done.get_future();
+    bool alone = false;
+    {
+        std::lock_guard lock(mutex_);
+        if (announced) --announced_;
+        if (stop_) {
+            error = "Batch scheduler stopped";
+            return false;
+        }
+        // Nothing queued to pair with and nobody on the way: skip the
+        // worker hand-off
+        alone = announced_ == 0 && queued(key) == 0;
+        if (!alone) queue_.push_back(&request);
+    }
+    if (alone) return run_alone(input, output, error);
+
+    cv_.notify_all();
+    const bool ok = result.get();
+    if (request.alone) return run_alone(input, output, error);
+    return ok;
+}
+
+int BatchScheduler::queued(int key) const {
+    int count = 0;
+    for (const Request* r : queue_) {
+        if (r->key == key && ++count == max_batch_) break;
+    }
+    return count;
+}
+
+bool BatchScheduler::run_alone(const std::vector<float>& input, std::vector<float>& output,
+                               std::string& error) {
+    std::vector<const std::vector<float>*> inputs(1, &input);
+    std::vector<std::vector<float>> outputs(1);
+    std::vector<std::string> errors(1);
+    try {
+        run_(inputs, outputs, errors);
+    } catch (const std::exception& e) {
+        outputs[0].clear();
+        errors[0] = e.what();
+    }
+    if (outputs[0].empty()) {
+        error = std::move(errors[0]);
+        return false;
+    }
+    output = std::move(outputs[0]);
+    return true;
+}
+
+void BatchScheduler::worker_loop() {
+    std::vector<Request*> batch;
+    std::vector<const std::vector<float>*> inputs;
+    std::vector<std::vector<float>> outputs;
+    std::vector<std::string> errors;
+
+    std::unique_lock lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_) break;
+
+        // Hold the batch open only for requests already on their way
+        const int key = queue_.front()->key;
+        const auto deadline = queue_.front()->arrival + max_wait_;
+        while (!stop_ && queued(key) < max_batch_ && announced_ > 0) {
+            if (cv_.wait_until(lock, deadline) == std::cv_status::timeout) break;
+        }
+        if (stop_) break;
+
+        // The oldest request and the next ones of its key, in arrival order
+        batch.clear();
+        for (auto it = queue_.begin();
+             it != queue_.end() && static_cast<int>(batch.size()) < max_batch_;) {
+            if ((*it)->key == key) {
+                batch.push_back(*it);
+                it = queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (batch.size() == 1) {
+            // No partner: its caller runs it, leaving the worker to batches
+            batch[0]->alone = true;
+            batch[0]->done.set_value(true);
+            continue;
+        }
+        const int count = static_cast<int>(batch.size());
+        lock.unlock();
+
+        inputs.clear();
+        for (Request* r : batch) inputs.push_back(r->input);
+        outputs.assign(count, {});
+        errors.assign(count, {});
+        try {
+            run_(inputs, outputs, errors);
+        } catch (const std::exception& e) {
+            outputs.assign(count, {});
+            errors.assign(count, e.what());
+        }
+
+        for (int i = 0; i < count; ++i) {
+            Request* r = batch[i];
+            const bool ok = !outputs[i].empty();
+            *r->output = std::move(outputs[i]);
+            if (!ok) *r->error = std::move(errors[i]);
+            r->done.set_value(ok);
+        }
+        lock.lock();
+    }
+
+    // Fail whatever is still queued
+    for (Request* r : queue_) {
+        *r->error = "Batch scheduler stopped";
+        r->done.set_value(false);
+    }
+    queue_.clear();
+}
+
+} // namespace vp
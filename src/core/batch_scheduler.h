@@ -0,0 +1,92 @@
+#ifndef VP_BATCH_SCHEDULER_H
+#define VP_BATCH_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vp {
+
+/**
+ * Micro-batching in front of a batched model call.
+ *
+ * Concurrent callers submit one input each, tagged with a key (the model
+ * length it runs at), and block; a worker thread drains the queue into
+ * batches of up to max_batch requests of one key and scatters the outputs
+ * back. The worker only holds a batch open while more requests are known
+ * to be on their way (announced with begin() but not yet submitted), and
+ * never longer than max_wait past the oldest queued request. A request
+ * with no partner of its key is handed back and runs on its caller's
+ * thread, so the worker never serializes work that does not batch: a lone
+ * caller at low load runs immediately, while at high load requests that
+ * arrive during a model run form the next batch.
+ */
+class BatchScheduler {
+public:
+    // Run `inputs` as one batch, filling outputs[i] (empty on failure, with
+    // errors[i] set). Called on the worker thread for batches and on a
+    // caller's thread for a request that runs alone, so it must be safe to
+    // call concurrently.
+    using RunBatch = std::function<void(const std::vector<const std::vector<float>*>& inputs,
+                                        std::vector<std::vector<float>>& outputs,
+                                        std::vector<std::string>& errors)>;
+
+    BatchScheduler(RunBatch run, int max_batch, int max_wait_us);
+    ~BatchScheduler();   // fails queued requests, joins the worker
+
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+
+    // Announce a request that will be submitted (or abandoned) shortly,
+    // e.g. before its feature extraction, so the worker waits for it
+    void begin();
+    void abandon();
+
+    // Queue `input` and wait for its result; only requests of equal `key`
+    // share a batch. Consumes a begin() if the caller made one. Returns
+    // false with `error` set on failure.
+    bool submit(const std::vector<float>& input, int key, bool announced,
+                std::vector<float>& output, std::string& error);
+
+    int max_batch() const { return max_batch_; }
+    int max_wait_us() const { return static_cast<int>(max_wait_.count()); }
+
+private:
+    struct Request {
+        const std::vector<float>* input;
+        int key;
+        std::vector<float>* output;
+        std::string* error;
+        std::chrono::steady_clock::time_point arrival;
+        bool alone;          // handed back to run on the caller's thread
+        std::promise<bool> done;
+    };
+
+    void worker_loop();
+    // Queued requests of `key`, counted up to max_batch_ (mutex_ held)
+    int queued(int key) const;
+    // Run one request on the calling thread
+    bool run_alone(const std::vector<float>& input, std::vector<float>& output,
+                   std::string& error);
+
+    RunBatch run_;
+    const int max_batch_;
+    const std::chrono::microseconds max_wait_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request*> queue_;
+    int announced_ = 0;   // begun but not yet submitted or abandoned
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+} // namespace vp
+
+#endif // VP_BATCH_SCHEDULER_H
@@ -0,0 +1,108 @@
+#include "core/cmvn.h"
+#include "core/simd_dispatch.h"
+#include "utils/scratch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace vp {
+
+namespace {
+
+// Mean and 1 / stddev from sums of (x - shift) over count frames
+void finalize(const float* shift, const float* sum, const float* sumsq, int count,
+              int num_bins, float* mean, float* scale) {
+    const float inv_n = 1.0f / static_cast<float>(count);
+    for (int j = 0; j < num_bins; ++j) {
+        const float m = sum[j] * inv_n;
+        const float var = std::max(sumsq[j] * inv_n - m * m, 0.0f);
+        mean[j] = shift[j] + m;
+        scale[j] = 1.0f / std::sqrt(var + 1e-10f);
+    }
+}
+
+} // anonymous namespace
+
+void apply_utterance_cmvn(float* features, int num_frames, int num_bins) {
+    if (num_frames <= 0) return;
+    const SimdKernels& k = simd_kernels();
+
+    // Shifting by the first frame keeps sum-of-squares well conditioned for
+    // log-mel values far from zero
+    struct CmvnScratch;
+    float* shift = thread_scratch<CmvnScratch>(4 * static_cast<size_t>(num_bins));
+    float* sum = shift + num_bins;
+    float* sumsq = sum + num_bins;
+    float* scale = sumsq + num_bins;
+    std::memcpy(shift, features, num_bins * sizeof(float));
+    std::fill(sum, sum + 2 * num_bins, 0.0f);
+
+    k.cmvn_stats(features, num_frames, num_bins, shift, 1.0f, sum, sumsq);
+    finalize(shift, sum, sumsq, num_frames, num_bins, sum, scale);
+    k.cmvn_apply(features, num_frames, num_bins, sum, scale);
+}
+
+SlidingCmvn::SlidingCmvn(int num_bins, int window) {
+    reset(num_bins, window);
+}
+
+void SlidingCmvn::reset(int num_bins, int window) {
+    num_bins_ = std::max(num_bins, 1);
+    window_ = std::max(window, 1);
+    ring_.assign(static_cast<size_t>(window_) * num_bins_, 0.0f);
+    shift_.assign(num_bins_, 0.0f);
+    sum_.assign(num_bins_, 0.0f);
+    sumsq_.assign(num_bins_, 0.0f);
+    mean_.assign(num_bins_, 0.0f);
+    scale_.assign(num_bins_, 1.0f);
+    count_ = 0;
+    head_ = 0;
+}
+
+void SlidingCmvn::reset() {
+    std::fill(sum_.begin(), sum_.end(), 0.0f);
+    std::fill(sumsq_.begin(), sumsq_.end(), 0.0f);
+    count_ = 0;
+    head_ = 0;
+}
+
+void SlidingCmvn::process(float* features, int num_frames) {
+    for (int i = 0; i < num_frames; ++i) {
+        push(features + static_cast<size_t>(i) * num_bins_);
+    }
+}
+
+void SlidingCmvn::push(float* row) {
+    const SimdKernels& k = simd_kernels();
+    const int bins = num_bins_;
+    float* slot = ring_.data() + static_cast<size_t>(head_) * bins;
+
+    if (count_ == 0) {
+        std::memcpy(shift_.data(), row, bins * sizeof(float));
+    }
+    if (count_ == window_) {
+        // Oldest frame leaves the window
+        k.cmvn_stats(slot, 1, bins, shift_.data(), -1.0f, sum_.data(), sumsq_.data());
+    } else {
+        ++count_;
+    }
+    std::memcpy(slot, row, bins * sizeof(float));
+
+    if (++head_ == window_) {
+        // Rebuild the sums from the full ring once per wrap, re-centred on
+        // the recent mean, so add/remove rounding does not accumulate over
+        // a long stream
+        head_ = 0;
+        if (count_ > 1) shift_ = mean_;
+        std::fill(sum_.begin(), sum_.end(), 0.0f);
+        std::fill(sumsq_.begin(), sumsq_.end(), 0.0f);
+        k.cmvn_stats(ring_.data(), count_, bins, shift_.data(), 1.0f, sum_.data(), sumsq_.data());
+    } else {
+        k.cmvn_stats(slot, 1, bins, shift_.data(), 1.0f, sum_.data(), sumsq_.data());
+    }
+
+    finalize(shift_.data(), sum_.data(), sumsq_.data(), count_, bins, mean_.data(), scale_.data());
+    k.cmvn_apply(row, 1, bins, mean_.data(), scale_.data());
+}
+
+} // namespace vp
@@ -0,0 +1,58 @@
+#ifndef VP_CMVN_H
+#define VP_CMVN_H
+
+#include <vector>
+
+namespace vp {
+
+// Per-utterance CMVN over [num_frames x num_bins] row-major, in place:
+// x = (x - mean) / sqrt(var + 1e-10). One fused statistics pass and one
+// normalize pass through SimdKernels::cmvn_stats / cmvn_apply.
+void apply_utterance_cmvn(float* features, int num_frames, int num_bins);
+
+/**
+ * Sliding-window CMVN for streaming front-ends.
+ *
+ * Causal: each frame is normalized with the statistics of itself and up to
+ * window - 1 preceding frames, so feeding an utterance in chunks gives the
+ * same output as feeding it at once. Statistics are kept as running sums
+ * (shifted by a reference frame for precision); the oldest frame is
+ * subtracted as it leaves the window and the sums are rebuilt from the
+ * window once per wrap to bound float drift.
+ *
+ * Buffers are sized by reset(); process() does not allocate. Not
+ * thread-safe: one instance per stream.
+ */
+class SlidingCmvn {
+public:
+    explicit SlidingCmvn(int num_bins = 80, int window = 300);
+
+    // Clear the history, optionally with a new geometry (window >= 1)
+    void reset();
+    void reset(int num_bins, int window);
+
+    // Normalize the next num_frames frames [num_frames x num_bins] in place
+    void process(float* features, int num_frames);
+
+    int num_bins() const { return num_bins_; }
+    int window() const { return window_; }
+    int frames_in_window() const { return count_; }
+
+private:
+    void push(float* row);
+
+    int num_bins_ = 0;
+    int window_ = 0;
+    int count_ = 0;                 // frames in the ring
+    int head_ = 0;                  // next ring slot to write
+    std::vector<float> ring_;       // [window x num_bins] raw frames
+    std::vector<float> shift_;      // reference frame the sums are taken against
+    std::vector<float> sum_;        // sums of (x - shift) over the ring
+    std::vector<float> sumsq_;
+    std::vector<float> mean_;
+    std::vector<float> scale_;
+};
+
+} // namespace vp
+
+#endif // VP_CMVN_H
@@ -1,20 +1,58 @@
 #include "core/embedding_extractor.h"
 #include "core/fbank_extractor.h"
 #include "core/onnx_model.h"
+#include "core/model_registry.h"
 #include "core/vad.h"
 #include "core/audio_processor.h"
+#include "core/similarity.h"
+#include "core/batch_scheduler.h"
+#include "core/result_cache.h"
+#include "core/length_buckets.h"
+#include "core/warmup.h"
+#include "utils/hash.h"
 #include "utils/logger.h"
 #include <onnxruntime_cxx_api.h>
 #include <cmath>
+#include <algorithm>
 #include <numeric>
 #include <chrono>
 
 namespace vp {
 
+// Per-request scratch buffers; a pooled context is used by one call at a
+// time and keeps its capacity for the next one, up to MAX_RETAINED_FLOATS
+// per buffer
+struct EmbeddingExtractor::Context {
+    std::vector<float> audio_16k;   // resampled input (other sample rates only)
+    std::vector<float> speech;      // VAD-filtered audio
+    std::vector<SpeechSegment> segments;
+    std::vector<float> features;    // FBank of a single extract()
+    std::vector<float> batch;       // padded [B, T_max, bins] model input
+    std::vector<float> lengths;     // relative lengths, if the model takes them
+    std::vector<float> output;      // raw model output
+    std::unique_ptr<OnnxModel::Binding> binding;   // speaker model, bound on first use
+    std::vector<const float*> inputs;
+    std::vector<std::vector<int64_t>> shapes;
+    std::vector<int> starts;        // long-input window offsets, in frames
+    std::vector<const std::vector<float>*> group;   // run_group input for one item
+    std::vector<std::vector<float>> embeddings;     // run_group output for one item
+
+    // On return to the pool: free any audio, feature or model buffer an
+    // unusually long request grew past the cap, so one outlier does not
+    // pin its memory in every context it passed through
+    void trim() {
+        for (std::vector<float>* buffer : {&audio_16k, &speech, &features, &batch, &output}) {
+            if (buffer->capacity() > MAX_RETAINED_FLOATS) std::vector<float>().swap(*buffer);
+        }
+    }
+};
+
+thread_local std::string EmbeddingExtractor::last_error_;
+
 EmbeddingExtractor::EmbeddingExtractor()
     : fbank_(std::make_unique<FbankExtractor>()),
-      speaker_model_(std::make_unique<OnnxModel>()),
-      vad_(std::make_unique<VoiceActivityDetector>()) {}
+      vad_(std::make_unique<VoiceActivityDetector>()),
+      contexts_([] { return std::make_unique<Context>(); }, [](Context& ctx) { ctx.trim(); }) {}
 
 EmbeddingExtractor::~EmbeddingExtractor() = default;
 
@@ -23,7 +61,7 @@ bool EmbeddingExtractor::init(const std::string& model_dir, void* ort_env) {
     Ort::Env* env = static_cast<Ort::Env*>(ort_env);
 
     // Initialize FBank
-    fbank_->init(80, 16000, 25.0f, 10.0f);
+    fbank_->init(80, 16000, 25.0f, 10.0f, fbank_engine());
 
     // Load VAD model
     std::string vad_path = model_dir + "/silero_vad.onnx";
@@ -35,8 +73,9 @@ bool EmbeddingExtractor::init(const std::string& model_dir, void* ort_env) {
 
     // Load speaker embedding model
     std::string model_path = model_dir + "/ecapa_tdnn.onnx";
-    if (!speaker_model_->load(model_path, *env)) {
-        last_error_ = "Failed to load speaker model: " + speaker_model_->last_error();
+    speaker_model_ = acquire_model(model_path, *env, ModelKind::SPEAKER);
+    if (!speaker_model_) {
+        last_error_ = "Failed to load speaker model: " + OnnxModel::last_error();
         VP_LOG_ERROR(last_error_);
         return false;
     }
@@ -52,74 +91,463 @@ bool EmbeddingExtractor::init(const std::string& model_dir, void* ort_env) {
         embedding_dim_ = 192;
     }
 
-    VP_LOG_INFO("Embedding extractor initialized: dim={}", embedding_dim_);
+    // Batching needs a dynamic batch dimension. A second rank-1 input is
+    // taken as per-utterance relative lengths (SpeechBrain-style export),
+    // which lets the model mask padded frames.
+    auto input_shape = speaker_model_->get_input_shape(0);
+    max_batch_ = (!input_shape.empty() && input_shape[0] < 0) ? MAX_BATCH : 1;
+    length_input_ = speaker_model_->get_input_count() >= 2 &&
+                    speaker_model_->get_input_shape(1).size() == 1;
+
+    VP_LOG_INFO("Embedding extractor initialized: dim={}, max_batch={}, length_input={}",
+                embedding_dim_, max_batch_, length_input_);
     initialized_ = true;
     return true;
 }
 
-std::vector<float> EmbeddingExtractor::extract(const std::vector<float>& audio, int sample_rate) {
-    if (!initialized_) {
-        last_error_ = "Embedding extractor not initialized";
-        return {};
-    }
-
-    auto start_time = std::chrono::high_resolution_clock::now();
-
-    // Resample to 16kHz if needed
-    std::vector<float> audio_16k;
+bool EmbeddingExtractor::compute_features(Context& ctx, Span<const float> audio,
+                                          int sample_rate, std::vector<float>& features,
+                                          float& speech_duration) {
+    // Resample to 16kHz if needed; 16kHz input is read in place
+    Span<const float> audio_16k = audio;
     if (sample_rate != 16000) {
-        audio_16k = AudioProcessor::resample(audio, sample_rate, 16000);
-    } else {
-        audio_16k = audio;
+        AudioProcessor::resample(audio, sample_rate, 16000, ctx.audio_16k);
+        audio_16k = ctx.audio_16k;
     }
 
-    // VAD: filter silence (best-effort; fall back to full audio if no speech detected)
-    auto speech_audio = vad_->filter_silence(audio_16k, 16000);
-    if (speech_audio.empty()) {
+    // VAD: filter silence; fall back to full audio if no speech was detected,
+    // but not if the VAD itself failed
+    if (!vad_->filter_silence(audio_16k, 16000, ctx.speech, ctx.segments)) {
+        last_error_ = vad_->last_error();
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    if (ctx.speech.empty()) {
         VP_LOG_WARN("VAD detected no speech, using full audio as fallback");
-        speech_audio = audio_16k;
     }
+    Span<const float> speech_audio = ctx.speech.empty() ? audio_16k : Span<const float>(ctx.speech);
 
     // Check minimum speech duration
-    float speech_duration = static_cast<float>(speech_audio.size()) / 16000.0f;
+    speech_duration = static_cast<float>(speech_audio.size()) / 16000.0f;
     if (speech_duration < MIN_SPEECH_DURATION) {
         last_error_ = "Speech too short: " + std::to_string(speech_duration) +
                       "s (minimum " + std::to_string(MIN_SPEECH_DURATION) + "s)";
         VP_LOG_WARN(last_error_);
-        return {};
+        return false;
     }
 
     // Extract FBank features
-    auto fbank_features = fbank_->extract(speech_audio);
-    if (fbank_features.empty()) {
+    if (fbank_->extract(speech_audio, features) == 0) {
         last_error_ = "FBank feature extraction failed";
         VP_LOG_ERROR(last_error_);
-        return {};
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddingExtractor::run_group(Context& ctx,
+                                   const std::vector<const std::vector<float>*>& features,
+                                   const int* indices, int count, int target,
+                                   std::vector<std::vector<float>>& out) {
+    const int bins = fbank_->num_bins();
+
+    // Input tensor: [count, target, bins]. Rows are zero-padded up to
+    // target when the model masks by length, with the true length in the
+    // mask; otherwise every utterance of a group has the same bucketed
+    // length and is cropped to its first target frames (repeat-padded only
+    // below the smallest bucket), exactly what a lone call would feed. A
+    // single utterance at its own length is fed straight from its buffer.
+    const size_t row = static_cast<size_t>(target) * bins;
+    std::vector<float>& lengths = ctx.lengths;
+    lengths.resize(count);
+    const float* batch = features[indices[0]]->data();
+    if (count > 1 || target != static_cast<int>(features[indices[0]]->size()) / bins) {
+        ctx.batch.resize(row * count);
+        for (int b = 0; b < count; ++b) {
+            const std::vector<float>& f = *features[indices[b]];
+            fit_frames(f.data(), static_cast<int>(f.size()) / bins, bins, target, length_input_,
+                       ctx.batch.data() + row * b);
+        }
+        batch = ctx.batch.data();
     }
+    for (int b = 0; b < count; ++b) {
+        const int frames = static_cast<int>(features[indices[b]]->size()) / bins;
+        lengths[b] = static_cast<float>(std::min(frames, target)) / target;
+    }
+    if (!run_model(ctx, batch, count, target)) return false;
 
-    int num_frames = static_cast<int>(fbank_features.size()) / fbank_->num_bins();
+    const std::vector<float>& output = ctx.output;
+    for (int b = 0; b < count; ++b) {
+        auto& embedding = out[indices[b]];
+        embedding.assign(output.begin() + static_cast<size_t>(b) * embedding_dim_,
+                         output.begin() + static_cast<size_t>(b + 1) * embedding_dim_);
+        SimilarityCalculator::l2_normalize(embedding.data(), embedding_dim_);
+    }
+    return true;
+}
 
-    // Prepare input tensor: [1, num_frames, 80]
-    std::vector<int64_t> input_shape = {1, num_frames, fbank_->num_bins()};
+bool EmbeddingExtractor::run_model(Context& ctx, const float* batch, int count, int frames) {
+    const int bins = fbank_->num_bins();
+    ctx.inputs.assign(1, batch);
+    ctx.shapes.resize(length_input_ ? 2 : 1);
+    ctx.shapes[0].assign({count, frames, bins});
+    if (length_input_) {
+        ctx.inputs.push_back(ctx.lengths.data());
+        ctx.shapes[1].assign(1, count);
+    }
 
-    // Run speaker model inference
-    auto embedding = speaker_model_->run(fbank_features, input_shape);
-    if (embedding.empty()) {
+    // Output straight into ctx.output through the context's binding: once
+    // the shapes repeat, a call neither creates tensors nor allocates
+    if (!ctx.binding) ctx.binding = speaker_model_->create_binding();
+    ctx.output.resize(static_cast<size_t>(count) * embedding_dim_);
+    if (!ctx.binding ||
+        !speaker_model_->run_into(*ctx.binding, ctx.inputs, ctx.shapes, ctx.output)) {
         last_error_ = "Speaker model inference failed: " + speaker_model_->last_error();
         VP_LOG_ERROR(last_error_);
-        return {};
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddingExtractor::run_windows(Context& ctx, const std::vector<float>& features,
+                                     const LongInput& mode, std::vector<float>& embedding) {
+    const int bins = fbank_->num_bins();
+    const int frames = static_cast<int>(features.size()) / bins;
+    const int window = mode.window_frames;
+
+    // Windows start every hop frames, plus one flush with the end for the
+    // tail; all have the same length, so they batch without padding
+    std::vector<int>& starts = ctx.starts;
+    starts.clear();
+    for (int s = 0; s + window <= frames; s += mode.hop_frames) starts.push_back(s);
+    if (starts.back() + window < frames) starts.push_back(frames - window);
+
+    // Mean of the L2-normalized window embeddings, re-normalized
+    const size_t row = static_cast<size_t>(window) * bins;
+    const int windows = static_cast<int>(starts.size());
+    embedding.assign(embedding_dim_, 0.0f);
+    for (int first = 0; first < windows; first += max_batch_) {
+        const int count = std::min(max_batch_, windows - first);
+        const float* batch = features.data() + static_cast<size_t>(starts[first]) * bins;
+        if (count > 1) {
+            ctx.batch.resize(row * count);
+            for (int b = 0; b < count; ++b) {
+                std::copy_n(features.data() + static_cast<size_t>(starts[first + b]) * bins, row,
+                            ctx.batch.data() + row * b);
+            }
+            batch = ctx.batch.data();
+        }
+        ctx.lengths.assign(count, 1.0f);
+        if (!run_model(ctx, batch, count, window)) return false;
+
+        for (int b = 0; b < count; ++b) {
+            float* e = ctx.output.data() + static_cast<size_t>(b) * embedding_dim_;
+            SimilarityCalculator::l2_normalize(e, embedding_dim_);
+            for (int d = 0; d < embedding_dim_; ++d) embedding[d] += e[d];
+        }
+    }
+    SimilarityCalculator::l2_normalize(embedding.data(), embedding_dim_);
+    VP_LOG_DEBUG("Long input: {} frames as {} windows of {}", frames, windows, window);
+    return true;
+}
+
+int EmbeddingExtractor::run_grouped(Context& ctx,
+                                    const std::vector<const std::vector<float>*>& features,
+                                    std::vector<int> order,
+                                    std::vector<std::vector<float>>& out,
+                                    std::vector<std::string>* errors,
+                                    float max_pad_ratio) {
+    const int bins = fbank_->num_bins();
+    auto frames = [&](int i) { return static_cast<int>(features[i]->size()) / bins; };
+
+    // A masked model ignores zero padding, so utterances of close lengths
+    // share a call padded to the longest (the result moves only by the
+    // padded frames' numerics). Without a mask, padding would reach the
+    // pooled statistics: only equal model lengths share a call, which with
+    // length buckets means every utterance cropped to the same bucket.
+    auto buckets = std::atomic_load(&buckets_);
+    std::vector<int> targets(features.size());
+    for (int i : order) targets[i] = bucket_frames(buckets.get(), frames(i));
+    const auto groups = plan_batches(targets, order, max_batch_,
+                                     length_input_ && max_pad_ratio > 0.0f, max_pad_ratio);
+
+    for (const BatchGroup& group : groups) {
+        const int* indices = &order[group.begin];
+        if (!run_group(ctx, features, indices, group.count, group.target, out) && errors) {
+            for (int b = 0; b < group.count; ++b) (*errors)[indices[b]] = last_error_;
+        }
+    }
+    return static_cast<int>(groups.size());
+}
+
+bool EmbeddingExtractor::run_single(Context& ctx, const float* features, int frames) {
+    auto buckets = std::atomic_load(&buckets_);
+    const int target = bucket_frames(buckets.get(), frames);
+    if (target != frames) {
+        const int bins = fbank_->num_bins();
+        ctx.batch.resize(static_cast<size_t>(target) * bins);
+        fit_frames(features, frames, bins, target, length_input_, ctx.batch.data());
+        features = ctx.batch.data();
     }
+    ctx.lengths.assign(1, static_cast<float>(std::min(frames, target)) / target);
+    return run_model(ctx, features, 1, target);
+}
+
+int EmbeddingExtractor::bucket_frames(const LengthBuckets* buckets, int frames) const {
+    if (!buckets) return frames;
+    return length_input_ ? buckets->pad_to(frames) : buckets->crop_to(frames);
+}
+
+bool EmbeddingExtractor::embed_frames(const float* features, int frames,
+                                      std::vector<float>& embedding) {
+    auto ctx = contexts_.acquire();
+    if (!run_single(*ctx, features, frames)) return false;
+    embedding.assign(ctx->output.begin(), ctx->output.end());
+    SimilarityCalculator::l2_normalize(embedding.data(), embedding_dim_);
+    return true;
+}
 
-    // L2 normalize
-    l2_normalize(embedding);
+std::vector<float> EmbeddingExtractor::extract(Span<const float> audio, int sample_rate) {
+    std::vector<float> embedding;
+    extract(audio, sample_rate, embedding);
+    return embedding;
+}
+
+bool EmbeddingExtractor::extract(Span<const float> audio, int sample_rate,
+                                 std::vector<float>& embedding) {
+    embedding.clear();
+    if (!initialized_) {
+        last_error_ = "Embedding extractor not initialized";
+        return false;
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // Identical audio seen before: no VAD, FBank or inference
+    auto cache = std::atomic_load(&result_cache_);
+    ResultKey key;
+    if (cache) {
+        key = ResultCache::make_key(audio, cache_context(sample_rate));
+        if (cache->get_embedding(key, embedding)) {
+            VP_LOG_DEBUG("Embedding served from cache: {} samples", audio.size());
+            return true;
+        }
+    }
+
+    auto ctx = contexts_.acquire();
+
+    // Requests batch only within one length bucket, the one length many of
+    // them share; without buckets every request runs on its own thread.
+    // Announce the request before feature extraction, so a batch that is
+    // being collected waits for it.
+    auto buckets = std::atomic_load(&buckets_);
+    auto scheduler = buckets ? std::atomic_load(&scheduler_) : nullptr;
+    if (scheduler) scheduler->begin();
+
+    float speech_duration = 0.0f;
+    if (!compute_features(*ctx, audio, sample_rate, ctx->features, speech_duration)) {
+        if (scheduler) scheduler->abandon();
+        return false;
+    }
+
+    // Long input: fixed-size windows, independent of the micro-batcher
+    const LongInput long_input = long_input_.load();
+    if (is_long(ctx->features, long_input)) {
+        if (scheduler) scheduler->abandon();
+        if (!run_windows(*ctx, ctx->features, long_input, embedding)) return false;
+    } else {
+        const int frames = static_cast<int>(ctx->features.size()) / fbank_->num_bins();
+        const int target = bucket_frames(buckets.get(), frames);
+        if (scheduler) {
+            if (!scheduler->submit(ctx->features, target, true, embedding, last_error_)) {
+                return false;
+            }
+        } else {
+            // Run through the context's one-item group; swapping the result
+            // out hands the caller's old buffer to the context for the next
+            // call
+            ctx->group.assign(1, &ctx->features);
+            ctx->embeddings.resize(1);
+            const int index = 0;
+            if (!run_group(*ctx, ctx->group, &index, 1, target, ctx->embeddings)) return false;
+            embedding.swap(ctx->embeddings[0]);
+        }
+    }
+    if (cache) cache->put_embedding(key, embedding);
 
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         end_time - start_time).count();
     VP_LOG_INFO("Embedding extracted: dim={}, time={}ms, speech_dur={:.2f}s",
                 embedding.size(), duration_ms, speech_duration);
+    return true;
+}
 
-    return embedding;
+std::vector<std::vector<float>> EmbeddingExtractor::extract_batch(
+        const std::vector<Span<const float>>& audios, int sample_rate,
+        std::vector<std::string>* errors) {
+    const int n = static_cast<int>(audios.size());
+    std::vector<std::vector<float>> embeddings(n);
+    if (errors) errors->assign(n, std::string());
+    if (!initialized_) {
+        last_error_ = "Embedding extractor not initialized";
+        if (errors) errors->assign(n, last_error_);
+        return embeddings;
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto ctx = contexts_.acquire();
+
+    const LongInput long_input = long_input_.load();
+    auto cache = std::atomic_load(&result_cache_);
+    const uint64_t context = cache ? cache_context(sample_rate) : 0;
+    std::vector<ResultKey> keys(cache ? n : 0);
+    int cached = 0;
+
+    std::vector<std::vector<float>> features(n);
+    std::vector<const std::vector<float>*> inputs(n);
+    std::vector<int> order;
+    order.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        inputs[i] = &features[i];
+        if (cache) {
+            keys[i] = ResultCache::make_key(audios[i], context);
+            if (cache->get_embedding(keys[i], embeddings[i])) {
+                ++cached;
+                continue;
+            }
+        }
+        float speech_duration = 0.0f;
+        if (!compute_features(*ctx, audios[i], sample_rate, features[i], speech_duration)) {
+            if (errors) (*errors)[i] = last_error_;
+            continue;
+        }
+        if (is_long(features[i], long_input)) {
+            if (!run_windows(*ctx, features[i], long_input, embeddings[i])) {
+                embeddings[i].clear();
+                if (errors) (*errors)[i] = last_error_;
+            } else if (cache) {
+                cache->put_embedding(keys[i], embeddings[i]);
+            }
+            std::vector<float>().swap(features[i]);
+            continue;
+        }
+        order.push_back(i);
+    }
+
+    const size_t extracted = order.size();
+    int groups = run_grouped(*ctx, inputs, order, embeddings, errors, MAX_PAD_RATIO);
+    if (cache) {
+        for (int i : order) {
+            if (!embeddings[i].empty()) cache->put_embedding(keys[i], embeddings[i]);
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        end_time - start_time).count();
+    VP_LOG_INFO("Batch embeddings extracted: {} of {} utterances in {} model calls "
+                "({} cached), time={}ms", extracted, n, groups, cached, duration_ms);
+    return embeddings;
+}
+
+void EmbeddingExtractor::set_batching(int max_batch, int max_wait_us) {
+    max_batch = std::min(max_batch, max_batch_);
+    std::shared_ptr<BatchScheduler> scheduler;
+    if (initialized_ && max_batch > 1) {
+        scheduler = std::make_shared<BatchScheduler>(
+            [this](const std::vector<const std::vector<float>*>& inputs,
+                   std::vector<std::vector<float>>& outputs,
+                   std::vector<std::string>& errors) {
+                std::vector<int> order(inputs.size());
+                std::iota(order.begin(), order.end(), 0);
+                // Requests of one batch share a bucket; no padding across
+                // lengths, so an embedding never depends on its batch-mates
+                auto ctx = contexts_.acquire();
+                run_grouped(*ctx, inputs, std::move(order), outputs, &errors, 0.0f);
+            },
+            max_batch, max_wait_us);
+    }
+
+    // Calls already holding the old scheduler finish on it; it stops once
+    // the last of them lets go
+    std::atomic_store(&scheduler_, scheduler);
+    VP_LOG_INFO("Request batching: max_batch={}, max_wait={}us",
+                scheduler ? max_batch : 1, scheduler ? max_wait_us : 0);
+    if (scheduler && !std::atomic_load(&buckets_)) {
+        VP_LOG_INFO("Request batching applies only while length buckets are set");
+    }
+}
+
+void EmbeddingExtractor::set_result_cache(std::shared_ptr<ResultCache> cache) {
+    std::atomic_store(&result_cache_, std::move(cache));
+}
+
+void EmbeddingExtractor::set_length_buckets(std::shared_ptr<const LengthBuckets> buckets) {
+    if (buckets && buckets->empty()) buckets.reset();
+    std::atomic_store(&buckets_, std::move(buckets));
+}
+
+void EmbeddingExtractor::set_long_input(float window_sec, float overlap_sec) {
+    LongInput mode;
+    if (window_sec > 0.0f) {
+        mode.window_frames = std::max(1, static_cast<int>(window_sec * FRAMES_PER_SECOND));
+        const int overlap = static_cast<int>(std::max(overlap_sec, 0.0f) * FRAMES_PER_SECOND);
+        mode.hop_frames = std::max(1, mode.window_frames - overlap);
+    }
+    long_input_.store(mode);
+    VP_LOG_INFO("Long input mode: window={} frames, hop={} frames",
+                mode.window_frames, mode.hop_frames);
+}
+
+bool EmbeddingExtractor::is_long(const std::vector<float>& features, const LongInput& mode) const {
+    if (mode.window_frames <= 0) return false;
+    const size_t frames = features.size() / fbank_->num_bins();
+    return frames > static_cast<size_t>(mode.window_frames) * LONG_INPUT_MIN_WINDOWS;
+}
+
+uint64_t EmbeddingExtractor::cache_context(int sample_rate) const {
+    // Windowed and single-pass embeddings of the same audio differ, as do
+    // embeddings of padded or cropped inputs and of other FBank front-ends
+    const LongInput mode = long_input_.load();
+    const int front_end[2] = {static_cast<int>(fbank_->engine()), fbank_->cmvn_window()};
+    uint64_t context = speaker_model_ ? speaker_model_->fingerprint() : 0;
+    context = xxhash64(&sample_rate, sizeof(sample_rate), context);
+    context = xxhash64(&mode, sizeof(mode), context);
+    context = xxhash64(front_end, sizeof(front_end), context);
+    if (auto buckets = std::atomic_load(&buckets_)) {
+        const std::vector<int>& frames = buckets->frames();
+        context = xxhash64(frames.data(), frames.size() * sizeof(int), context);
+    }
+    return context;
+}
+
+bool EmbeddingExtractor::warm_up(const std::vector<float>& seconds, VpWarmupStats& stats) {
+    if (!initialized_) return false;
+    vad_->warm_up(stats);
+
+    // Model exported without a dynamic time axis: only its own length runs
+    auto input_shape = speaker_model_->get_input_shape(0);
+    const int fixed_frames =
+        input_shape.size() >= 2 && input_shape[1] > 0 ? static_cast<int>(input_shape[1]) : 0;
+
+    bool ok = true;
+    auto ctx = contexts_.acquire();
+    for (float sec : seconds) {
+        const int samples = fixed_frames > 0
+            ? (fixed_frames - 1) * fbank_->frame_shift_samples() + fbank_->frame_length_samples()
+            : static_cast<int>(std::lround(sec * 16000.0f));
+        const int frames = fbank_->get_num_frames(samples);
+        if (frames <= 0) continue;
+        const std::vector<float> audio = AudioProcessor::synthetic_speech(samples);
+
+        ok &= warm_up_call("speaker model (" + std::to_string(frames) + " frames)", [&] {
+            if (fbank_->extract(Span<const float>(audio), ctx->features) != frames) return false;
+            return run_single(*ctx, ctx->features.data(), frames);
+        }, stats, stats.speaker_ms);
+        if (fixed_frames > 0) break;
+    }
+    return ok;
 }
 
 std::vector<float> EmbeddingExtractor::extract_from_file(const std::string& wav_path) {
@@ -135,17 +563,4 @@ std::vector<float> EmbeddingExtractor::extract_from_file(const std::string& wav_
     return extract(samples, sample_rate);
 }
 
-void EmbeddingExtractor::l2_normalize(std::vector<float>& vec) {
-    float norm = 0.0f;
-    for (float v : vec) {
-        norm += v * v;
-    }
-    norm = std::sqrt(norm);
-    if (norm > 1e-10f) {
-        for (float& v : vec) {
-            v /= norm;
-        }
-    }
-}
-
 } // namespace vp
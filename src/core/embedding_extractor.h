@@ -1,10 +1,16 @@
 #ifndef VP_EMBEDDING_EXTRACTOR_H
 #define VP_EMBEDDING_EXTRACTOR_H
 
+#include "utils/object_pool.h"
+#include "utils/span.h"
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
 
+struct VpWarmupStats;
+
 namespace Ort {
     struct Env;
 }
@@ -14,7 +20,13 @@ namespace vp {
 class FbankExtractor;
 class OnnxModel;
 class VoiceActivityDetector;
+class BatchScheduler;
+class ResultCache;
+class EmbeddingStream;
+class LengthBuckets;
 
+// Thread-safe after init(): the ORT sessions are shared read-only and every
+// call draws its mutable state from a pool of per-request contexts.
 class EmbeddingExtractor {
 public:
     EmbeddingExtractor();
@@ -25,7 +37,59 @@ public:
 
     // Extract embedding from audio (16kHz, float32, mono)
     // Returns L2-normalized embedding vector
-    std::vector<float> extract(const std::vector<float>& audio, int sample_rate = 16000);
+    std::vector<float> extract(Span<const float> audio, int sample_rate = 16000);
+
+    // Same, into `embedding` (capacity reused). With a warm context and a
+    // reused output buffer the 16kHz path makes no heap allocations of its
+    // own (ONNX Runtime and the FBank library may still allocate).
+    bool extract(Span<const float> audio, int sample_rate, std::vector<float>& embedding);
+
+    // Extract embeddings for several utterances, grouped by length into
+    // [B, T, 80] model calls. A model with a relative-length input takes
+    // utterances up to 1.5x apart in one call, zero-padded to the longest
+    // and masked, so results match extract() to within padding numerics.
+    // Other models share a call only at the same model length (equal frame
+    // counts, or the same bucket with set_length_buckets), where each result
+    // equals what extract() returns for that utterance. result[i] is empty
+    // for an utterance that could not be processed; its error goes to
+    // (*errors)[i].
+    // Utterances found in the cache (set_result_cache) are not re-extracted.
+    std::vector<std::vector<float>> extract_batch(const std::vector<Span<const float>>& audios,
+                                                  int sample_rate = 16000,
+                                                  std::vector<std::string>* errors = nullptr);
+
+    // Route extract() calls through a micro-batching scheduler: concurrent
+    // calls in the same length bucket are run as one model batch of up to
+    // max_batch (capped by the model), held open at most max_wait_us for
+    // calls still in feature extraction. Calls without a partner in their
+    // bucket, and every call while set_length_buckets is off, run on their
+    // own thread. Results match unbatched calls. max_batch <= 1 turns it
+    // off (default).
+    void set_batching(int max_batch, int max_wait_us);
+
+    // Long-input mode: speech longer than 4 windows is embedded as windows of
+    // window_sec seconds (overlapping by overlap_sec), run through the model
+    // in batches; the L2-normalized window embeddings are averaged. Model
+    // memory and latency per window stay fixed however long the input is.
+    // window_sec <= 0 turns it off (default: one pass over the whole input).
+    void set_long_input(float window_sec, float overlap_sec);
+
+    // Run the speaker model at bucketed frame counts (core/length_buckets.h):
+    // padded up with a length mask if the model takes relative lengths,
+    // cropped down otherwise. Null: exact lengths (default).
+    void set_length_buckets(std::shared_ptr<const LengthBuckets> buckets);
+
+    // Serve repeated audio from `cache` (keyed by PCM content, sample rate
+    // and model file); null turns it off (default). May be shared with
+    // other extractors of the same model.
+    void set_result_cache(std::shared_ptr<ResultCache> cache);
+
+    // Run VAD, FBank and the speaker model on synthetic speech of each
+    // length (seconds, bucketed like requests; a model with a fixed time
+    // axis takes its own length once), so ORT arenas and per-shape plans
+    // exist before the first request. Timings are added to `stats`.
+    // Returns false if a call failed.
+    bool warm_up(const std::vector<float>& seconds, VpWarmupStats& stats);
 
     // Extract embedding from WAV file
     std::vector<float> extract_from_file(const std::string& wav_path);
@@ -33,22 +97,89 @@ public:
     // Get embedding dimension
     int embedding_dim() const { return embedding_dim_; }
 
+    // Error of the calling thread's last failed call
     const std::string& last_error() const { return last_error_; }
 
 private:
-    // L2 normalize a vector in-place
-    static void l2_normalize(std::vector<float>& vec);
+    friend class EmbeddingStream;
+    struct Context;
+
+    struct LongInput {
+        int window_frames = 0;     // 0: off
+        int hop_frames = 0;
+    };
+
+    // Resample, VAD-filter and FBank one utterance into [frames x bins].
+    // Returns false (last_error_ set) on failure.
+    bool compute_features(Context& ctx, Span<const float> audio, int sample_rate,
+                          std::vector<float>& features, float& speech_duration);
+
+    // Run features[indices[0..count)] as one batch at `target` frames (at
+    // least each one's bucketed length), writing the normalized embeddings
+    // to out[indices[b]]. Returns false on failure.
+    bool run_group(Context& ctx, const std::vector<const std::vector<float>*>& features,
+                   const int* indices, int count, int target,
+                   std::vector<std::vector<float>>& out);
+
+    // Run `count` utterances of `frames` frames each, [count x frames x bins]
+    // row-major at batch (relative lengths in ctx.lengths), into ctx.output.
+    // Returns false (last_error_ set) on failure.
+    bool run_model(Context& ctx, const float* batch, int count, int frames);
+
+    // Long-input embedding of one utterance's features, see set_long_input()
+    bool run_windows(Context& ctx, const std::vector<float>& features,
+                     const LongInput& mode, std::vector<float>& embedding);
+    bool is_long(const std::vector<float>& features, const LongInput& mode) const;
+
+    // L2-normalized embedding of one normalized [frames x bins] matrix
+    // (EmbeddingStream windows). Returns false (last_error_ set) on failure.
+    bool embed_frames(const float* features, int frames, std::vector<float>& embedding);
+
+    // Run one [frames x bins] matrix at its bucketed length into ctx.output
+    bool run_single(Context& ctx, const float* features, int frames);
+
+    // Frame count an input of `frames` runs at under `buckets` (null: as is)
+    int bucket_frames(const LengthBuckets* buckets, int frames) const;
+
+    // Sort features[order] by bucketed length and run them in batches (see
+    // plan_batches()); max_pad_ratio > 0 lets a masked model pad shorter
+    // utterances up to a longer one. Failed items get last_error_ in
+    // (*errors)[i]. Returns the number of model calls.
+    int run_grouped(Context& ctx, const std::vector<const std::vector<float>*>& features,
+                    std::vector<int> order, std::vector<std::vector<float>>& out,
+                    std::vector<std::string>* errors, float max_pad_ratio);
 
     std::unique_ptr<FbankExtractor> fbank_;
-    std::unique_ptr<OnnxModel> speaker_model_;
+    std::shared_ptr<OnnxModel> speaker_model_;      // core/model_registry.h
     std::unique_ptr<VoiceActivityDetector> vad_;
+    ObjectPool<Context> contexts_;
+    std::shared_ptr<BatchScheduler> scheduler_;   // atomic_load/store; null when off
+    std::shared_ptr<ResultCache> result_cache_;   // atomic_load/store; null when off
+    std::shared_ptr<const LengthBuckets> buckets_;   // atomic_load/store; null when off
+    std::atomic<LongInput> long_input_{LongInput{}};
 
     void* ort_env_ = nullptr;
     int embedding_dim_ = 0;
+    int max_batch_ = 1;            // 1 if the model's batch dimension is fixed
+    bool length_input_ = false;    // model takes relative lengths as input 1
     bool initialized_ = false;
-    std::string last_error_;
+    static thread_local std::string last_error_;
+
+    // Cache key context for one sample rate (model fingerprint + rate +
+    // long-input mode + length buckets)
+    uint64_t cache_context(int sample_rate) const;
 
     static constexpr float MIN_SPEECH_DURATION = 1.5f; // seconds
+    static constexpr int MAX_BATCH = 16;
+    // extract_batch(): longest / shortest utterance of one padded model call
+    // (masked models only)
+    static constexpr float MAX_PAD_RATIO = 0.5f;
+    static constexpr int FRAMES_PER_SECOND = 100;        // FBank frame shift 10 ms
+    static constexpr int LONG_INPUT_MIN_WINDOWS = 4;     // shorter inputs take one pass
+    // Largest buffer a pooled context keeps between calls (4 MB: 60 s of
+    // 16kHz audio, or a full batch of 5 s FBank matrices); larger ones are
+    // freed when the context returns to the pool
+    static constexpr size_t MAX_RETAINED_FLOATS = size_t(1) << 20;
 };
 
 } // namespace vp
@@ -0,0 +1,121 @@
+#include "core/embedding_stream.h"
+#include "core/embedding_extractor.h"
+#include "core/fbank_extractor.h"
+#include "core/similarity.h"
+#include "utils/logger.h"
+#include <algorithm>
+
+namespace vp {
+
+EmbeddingStream::EmbeddingStream(EmbeddingExtractor& extractor)
+    : extractor_(extractor),
+      cmvn_(extractor.fbank_->num_bins(), CMVN_FRAMES) {}
+
+bool EmbeddingStream::push(Span<const float> audio) {
+    if (!extractor_.initialized_) {
+        EmbeddingExtractor::last_error_ = "Embedding extractor not initialized";
+        return false;
+    }
+
+    chunk_speech_.clear();
+    if (!extractor_.vad_->push(vad_, audio, chunk_speech_)) {
+        EmbeddingExtractor::last_error_ = extractor_.vad_->last_error();
+        VP_LOG_ERROR(EmbeddingExtractor::last_error_);
+        return false;
+    }
+    if (chunk_speech_.empty()) return true;
+    speech_.insert(speech_.end(), chunk_speech_.begin(), chunk_speech_.end());
+
+    // Frame what is complete; the samples of the partial frame stay for
+    // the next push
+    const FbankExtractor& fbank = *extractor_.fbank_;
+    const int count = fbank.get_num_frames(static_cast<int>(speech_.size()));
+    if (count <= 0) return true;
+    const int bins = fbank.num_bins();
+    const size_t old_size = features_.size();
+    features_.resize(old_size + static_cast<size_t>(count) * bins);
+    float* rows = features_.data() + old_size;
+    fbank.compute_frames(speech_.data(), count, rows);
+    cmvn_.process(rows, count);
+    speech_.erase(speech_.begin(),
+                  speech_.begin() + static_cast<size_t>(count) * fbank.frame_shift_samples());
+    frames_ += count;
+
+    return commit_windows();
+}
+
+bool EmbeddingStream::commit_windows() {
+    const int bins = extractor_.fbank_->num_bins();
+    const int dim = extractor_.embedding_dim();
+    while (frames_ - next_window_ >= WINDOW_FRAMES) {
+        const float* window =
+            features_.data() + static_cast<size_t>(next_window_ - first_frame_) * bins;
+        if (!extractor_.embed_frames(window, WINDOW_FRAMES, window_embedding_)) return false;
+        sum_.resize(dim, 0.0f);
+        for (int d = 0; d < dim; ++d) sum_[d] += window_embedding_[d];
+        ++windows_;
+        next_window_ += HOP_FRAMES;
+    }
+
+    // Later windows start after frames_ - WINDOW_FRAMES and the tail pass
+    // reads the last WINDOW_FRAMES frames; anything before is done with
+    const int64_t keep_from = std::max(first_frame_, frames_ - WINDOW_FRAMES);
+    if (keep_from > first_frame_) {
+        features_.erase(features_.begin(),
+                        features_.begin() + static_cast<size_t>(keep_from - first_frame_) * bins);
+        first_frame_ = keep_from;
+    }
+    return true;
+}
+
+bool EmbeddingStream::embedding(std::vector<float>& out) {
+    out.clear();
+    if (frames_ < MIN_FRAMES) {
+        EmbeddingExtractor::last_error_ =
+            "Speech too short: " + std::to_string(speech_duration()) + "s (minimum " +
+            std::to_string(EmbeddingExtractor::MIN_SPEECH_DURATION) + "s)";
+        return false;
+    }
+
+    const int bins = extractor_.fbank_->num_bins();
+    const int dim = extractor_.embedding_dim();
+    out.assign(dim, 0.0f);
+    if (!sum_.empty()) std::copy(sum_.begin(), sum_.end(), out.begin());
+
+    // Frames past the last committed window: one pass over the latest
+    // window's worth, reused until more speech arrives
+    const int64_t covered = windows_ > 0 ? next_window_ - HOP_FRAMES + WINDOW_FRAMES : 0;
+    if (frames_ > covered) {
+        if (tail_frames_ != frames_) {
+            const int count = static_cast<int>(std::min<int64_t>(frames_, WINDOW_FRAMES));
+            const float* rows = features_.data() +
+                                static_cast<size_t>(frames_ - count - first_frame_) * bins;
+            if (!extractor_.embed_frames(rows, count, tail_)) return false;
+            tail_frames_ = frames_;
+        }
+        for (int d = 0; d < dim; ++d) out[d] += tail_[d];
+    }
+    SimilarityCalculator::l2_normalize(out.data(), dim);
+
+    VP_LOG_DEBUG("Stream embedding: {} frames, {} windows", frames_, windows_);
+    return true;
+}
+
+float EmbeddingStream::speech_duration() const {
+    return static_cast<float>(frames_) / EmbeddingExtractor::FRAMES_PER_SECOND;
+}
+
+void EmbeddingStream::reset() {
+    vad_ = VoiceActivityDetector::Stream{};
+    cmvn_.reset();
+    speech_.clear();
+    features_.clear();
+    first_frame_ = 0;
+    frames_ = 0;
+    next_window_ = 0;
+    windows_ = 0;
+    sum_.clear();
+    tail_frames_ = -1;
+}
+
+} // namespace vp
@@ -0,0 +1,81 @@
+#ifndef VP_EMBEDDING_STREAM_H
+#define VP_EMBEDDING_STREAM_H
+
+#include "core/cmvn.h"
+#include "core/vad.h"
+#include "utils/span.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vp {
+
+class EmbeddingExtractor;
+
+/**
+ * Incremental speaker embedding of a live 16kHz stream.
+ *
+ * PCM arrives in chunks of any size. Every stage keeps its state between
+ * push() calls, so no sample is processed twice: the VAD carries its
+ * recurrent state and open segment, FBank frames the speech as it is
+ * confirmed (the partial frame waits for the next chunk), and CMVN is the
+ * causal sliding window of core/cmvn.h. Normalized frames are embedded in
+ * fixed windows as soon as each window is complete; the running sum of
+ * those window embeddings is the stream's statistic. embedding() adds one
+ * pass over the frames not yet covered by a window (cached until more
+ * speech arrives), so a score can be taken after every chunk.
+ *
+ * The result depends only on the audio, not on how it was chunked. Not
+ * thread-safe: one caller per stream at a time. The extractor must outlive
+ * the stream.
+ */
+class EmbeddingStream {
+public:
+    explicit EmbeddingStream(EmbeddingExtractor& extractor);
+
+    // Feed the next chunk (16kHz mono). Returns false (extractor's
+    // last_error() set) if a model call failed; with a VAD failure the
+    // chunk's speech is lost, the stream stays usable.
+    bool push(Span<const float> audio);
+
+    // L2-normalized embedding of all speech so far. Returns false if there
+    // is less than the minimum speech duration yet ("Speech too short") or
+    // inference failed.
+    bool embedding(std::vector<float>& out);
+
+    // Seconds of speech framed so far
+    float speech_duration() const;
+
+    // Forget all audio pushed so far, as if newly opened
+    void reset();
+
+private:
+    // Embed whole windows that are complete, then drop frames no later
+    // window or tail pass will read
+    bool commit_windows();
+
+    EmbeddingExtractor& extractor_;
+    VoiceActivityDetector::Stream vad_;
+    SlidingCmvn cmvn_;
+
+    std::vector<float> chunk_speech_;    // VAD output of the current push
+    std::vector<float> speech_;          // confirmed speech not yet framed
+    std::vector<float> features_;        // normalized frames [first_frame_, frames_)
+    int64_t first_frame_ = 0;
+    int64_t frames_ = 0;                 // frames framed so far
+    int64_t next_window_ = 0;            // first frame of the next window
+    int windows_ = 0;                    // windows in sum_
+    std::vector<float> sum_;             // sum of window embeddings
+    std::vector<float> tail_;            // embedding of the uncovered tail...
+    int64_t tail_frames_ = -1;           // ...as of this many frames
+    std::vector<float> window_embedding_;
+
+    static constexpr int WINDOW_FRAMES = 300;     // 3 s model windows
+    static constexpr int HOP_FRAMES = 150;        // 50% overlap
+    static constexpr int CMVN_FRAMES = 300;
+    static constexpr int MIN_FRAMES = 150;        // 1.5 s, as EmbeddingExtractor
+};
+
+} // namespace vp
+
+#endif // VP_EMBEDDING_STREAM_H
@@ -1,6 +1,11 @@
 #include "core/fbank_extractor.h"
+#include "core/cmvn.h"
+#include "core/fbank_native.h"
 #include "utils/logger.h"
-#include "kaldi-native-fbank/csrc/online-feature.h"
+#include "utils/scratch.h"
+#include "kaldi-native-fbank/csrc/feature-fbank.h"
+#include "kaldi-native-fbank/csrc/feature-window.h"
+#include <atomic>
 #include <cmath>
 #include <cstring>
 #include <numeric>
@@ -8,34 +13,60 @@
 
 namespace vp {
 
-FbankExtractor::FbankExtractor() = default;
+namespace {
+std::atomic<FbankEngine> g_engine{FbankEngine::KALDI};
+} // anonymous namespace
+
+void set_fbank_engine(FbankEngine engine) {
+    g_engine.store(engine);
+}
+
+FbankEngine fbank_engine() {
+    return g_engine.load();
+}
+
+struct FbankExtractor::Tables {
+    knf::FbankOptions opts;
+    knf::FeatureWindowFunction window;
+    bool need_raw_log_energy = false;
+
+    explicit Tables(const knf::FbankOptions& o)
+        : opts(o), window(o.frame_opts) {}
+};
+
+// FbankComputer::Compute is not const (and not documented thread-safe), so
+// each concurrent caller leases its own computer
+struct FbankExtractor::Frontend {
+    knf::FbankComputer computer;
+    std::vector<float> frame;   // padded window, transformed in place
+
+    explicit Frontend(const knf::FbankOptions& opts)
+        : computer(opts),
+          frame(static_cast<size_t>(opts.frame_opts.PaddedWindowSize())) {}
+};
+
+FbankExtractor::FbankExtractor() {
+    build_tables();
+}
+
 FbankExtractor::~FbankExtractor() = default;
 
 void FbankExtractor::init(int num_bins, int sample_rate,
-                           float frame_length_ms, float frame_shift_ms) {
+                           float frame_length_ms, float frame_shift_ms,
+                           FbankEngine engine) {
     num_bins_ = num_bins;
     sample_rate_ = sample_rate;
     frame_length_ms_ = frame_length_ms;
     frame_shift_ms_ = frame_shift_ms;
-    frame_length_samples_ = static_cast<int>(frame_length_ms * sample_rate / 1000.0f);
-    frame_shift_samples_ = static_cast<int>(frame_shift_ms * sample_rate / 1000.0f);
-    initialized_ = true;
+    engine_ = engine;
+    build_tables();
 
-    VP_LOG_INFO("FBank initialized: bins={}, rate={}, frame_len={}ms, frame_shift={}ms",
-                num_bins_, sample_rate_, frame_length_ms_, frame_shift_ms_);
-}
-
-int FbankExtractor::get_num_frames(int num_samples) const {
-    if (num_samples < frame_length_samples_) return 0;
-    return 1 + (num_samples - frame_length_samples_) / frame_shift_samples_;
+    VP_LOG_INFO("FBank initialized: bins={}, rate={}, frame_len={}ms, frame_shift={}ms, engine={}",
+                num_bins_, sample_rate_, frame_length_ms_, frame_shift_ms_,
+                engine_ == FbankEngine::NATIVE ? "native" : "kaldi");
 }
 
-std::vector<float> FbankExtractor::extract(const std::vector<float>& audio) {
-    if (!initialized_) {
-        init();
-    }
-
-    // Configure kaldi-native-fbank
+void FbankExtractor::build_tables() {
     knf::FbankOptions opts;
     opts.frame_opts.samp_freq = static_cast<float>(sample_rate_);
     opts.frame_opts.frame_length_ms = frame_length_ms_;
@@ -47,65 +78,107 @@ std::vector<float> FbankExtractor::extract(const std::vector<float>& audio) {
     opts.mel_opts.low_freq = 20.0f;
     opts.mel_opts.high_freq = 0.0f; // Nyquist
 
-    knf::OnlineFbank fbank(opts);
+    // Use knf's own rounding so get_num_frames() agrees with the frame loop
+    frame_length_samples_ = opts.frame_opts.WindowSize();
+    frame_shift_samples_ = opts.frame_opts.WindowShift();
+
+    tables_ = std::make_unique<Tables>(opts);
+    frontends_.reset();
+    native_.reset();
+
+    if (engine_ == FbankEngine::NATIVE) {
+        NativeFbank::Options native;
+        native.sample_rate = opts.frame_opts.samp_freq;
+        native.frame_length = frame_length_samples_;
+        native.frame_shift = frame_shift_samples_;
+        native.fft_size = opts.frame_opts.PaddedWindowSize();
+        native.preemph = opts.frame_opts.preemph_coeff;
+        native.num_bins = opts.mel_opts.num_bins;
+        native.low_freq = opts.mel_opts.low_freq;
+        native.high_freq = opts.mel_opts.high_freq;
+        native_ = std::make_unique<NativeFbank>(native);
+        return;
+    }
+
+    const Tables* tables = tables_.get();
+    frontends_ = std::make_unique<ObjectPool<Frontend>>([tables] {
+        return std::make_unique<Frontend>(tables->opts);
+    });
+    tables_->need_raw_log_energy = frontends_->acquire()->computer.NeedRawLogEnergy();
+}
+
+int FbankExtractor::get_num_frames(int num_samples) const {
+    if (num_samples < frame_length_samples_) return 0;
+    return 1 + (num_samples - frame_length_samples_) / frame_shift_samples_;
+}
+
+std::vector<float> FbankExtractor::extract(const std::vector<float>& audio) const {
+    std::vector<float> features;
+    extract(Span<const float>(audio), features);
+    return features;
+}
 
-    // Accept waveform
-    fbank.AcceptWaveform(sample_rate_, audio.data(), static_cast<int32_t>(audio.size()));
-    fbank.InputFinished();
+int FbankExtractor::extract(Span<const float> audio, std::vector<float>& features) const {
+    features.clear();
 
-    int num_frames = fbank.NumFramesReady();
+    // snip_edges framing, as knf::OnlineFbank does after InputFinished()
+    const int num_frames = get_num_frames(static_cast<int>(audio.size()));
     if (num_frames <= 0) {
         VP_LOG_WARN("FBank: no frames extracted from {} samples", audio.size());
-        return {};
-    }
-
-    // Extract features
-    std::vector<float> features(num_frames * num_bins_);
-    for (int i = 0; i < num_frames; ++i) {
-        const float* frame = fbank.GetFrame(i);
-        std::memcpy(features.data() + i * num_bins_, frame, num_bins_ * sizeof(float));
+        return 0;
     }
+    features.resize(static_cast<size_t>(num_frames) * num_bins_);
+    compute_frames(audio.data(), num_frames, features.data());
 
     // Apply CMVN
-    apply_cmvn(features, num_frames, num_bins_);
+    if (cmvn_window_ > 0) {
+        // Per-thread state, reset per utterance (no steady-state allocation)
+        thread_local SlidingCmvn sliding;
+        if (sliding.num_bins() != num_bins_ || sliding.window() != cmvn_window_) {
+            sliding.reset(num_bins_, cmvn_window_);
+        } else {
+            sliding.reset();
+        }
+        sliding.process(features.data(), num_frames);
+    } else {
+        apply_cmvn(features.data(), num_frames, num_bins_);
+    }
 
     VP_LOG_DEBUG("FBank: extracted {} frames x {} bins from {} samples",
                  num_frames, num_bins_, audio.size());
-    return features;
+    return num_frames;
 }
 
-void FbankExtractor::apply_cmvn(std::vector<float>& features, int num_frames, int num_bins) {
-    if (num_frames <= 0) return;
+void FbankExtractor::compute_frames(const float* audio, int num_frames, float* out) const {
+    if (native_) {
+        native_->compute(audio, num_frames, out);
+        return;
+    }
 
-    // Compute mean and variance per bin
-    std::vector<float> mean(num_bins, 0.0f);
-    std::vector<float> var(num_bins, 0.0f);
+    const Tables& tables = *tables_;
+    auto frontend = frontends_->acquire();
+    std::vector<float>& frame = frontend->frame;
+    float* padding = frame.data() + frame_length_samples_;
 
     for (int i = 0; i < num_frames; ++i) {
-        for (int j = 0; j < num_bins; ++j) {
-            mean[j] += features[i * num_bins + j];
-        }
-    }
-    for (int j = 0; j < num_bins; ++j) {
-        mean[j] /= num_frames;
+        const float* src = audio + static_cast<size_t>(i) * frame_shift_samples_;
+        std::memcpy(frame.data(), src, frame_length_samples_ * sizeof(float));
+        std::fill(padding, frame.data() + frame.size(), 0.0f);
+
+        float raw_log_energy = 0.0f;
+        knf::ProcessWindow(tables.opts.frame_opts, tables.window, frame.data(),
+                           tables.need_raw_log_energy ? &raw_log_energy : nullptr);
+        frontend->computer.Compute(raw_log_energy, 1.0f, &frame,
+                                   out + static_cast<size_t>(i) * num_bins_);
     }
+}
 
-    for (int i = 0; i < num_frames; ++i) {
-        for (int j = 0; j < num_bins; ++j) {
-            float diff = features[i * num_bins + j] - mean[j];
-            var[j] += diff * diff;
-        }
-    }
-    for (int j = 0; j < num_bins; ++j) {
-        var[j] = std::sqrt(var[j] / num_frames + 1e-10f);
-    }
+void FbankExtractor::set_cmvn_window(int frames) {
+    cmvn_window_ = std::max(frames, 0);
+}
 
-    // Normalize: (x - mean) / std
-    for (int i = 0; i < num_frames; ++i) {
-        for (int j = 0; j < num_bins; ++j) {
-            features[i * num_bins + j] = (features[i * num_bins + j] - mean[j]) / var[j];
-        }
-    }
+void FbankExtractor::apply_cmvn(float* features, int num_frames, int num_bins) {
+    apply_utterance_cmvn(features, num_frames, num_bins);
 }
 
 } // namespace vp
@@ -1,43 +1,103 @@
 #ifndef VP_FBANK_EXTRACTOR_H
 #define VP_FBANK_EXTRACTOR_H
 
+#include <memory>
 #include <vector>
 #include <string>
+#include "utils/object_pool.h"
+#include "utils/span.h"
 
 namespace vp {
 
+class NativeFbank;
+
+// Filterbank implementation behind FbankExtractor
+enum class FbankEngine {
+    KALDI,    // kaldi-native-fbank, one frame at a time
+    NATIVE,   // in-tree SIMD kernels (fbank_native.h), blocks of frames
+};
+
+/**
+ * 80-dim log-mel FBank + per-utterance or sliding CMVN (kaldi-compatible).
+ *
+ * The frame options and window function are built once per init(). With
+ * the KALDI engine the FFT and mel filterbank tables live in pooled
+ * kaldi-native-fbank front-ends that are built on first use and reused;
+ * the NATIVE engine builds its tables once and computes several frames per
+ * SIMD register. Either way extract() does no per-call setup and writes
+ * frames straight into the output buffer; the engines agree to float
+ * rounding.
+ */
 class FbankExtractor {
 public:
     FbankExtractor();
     ~FbankExtractor();
 
-    // Initialize with parameters
+    // Initialize with parameters (not concurrently with extract). The SDK's
+    // extractors pass fbank_engine().
     void init(int num_bins = 80, int sample_rate = 16000,
-              float frame_length_ms = 25.0f, float frame_shift_ms = 10.0f);
+              float frame_length_ms = 25.0f, float frame_shift_ms = 10.0f,
+              FbankEngine engine = FbankEngine::KALDI);
 
     // Extract FBank features from audio
     // Input: float32 PCM, 16kHz
-    // Output: [num_frames, num_bins] row-major
-    std::vector<float> extract(const std::vector<float>& audio);
+    // Output: [num_frames, num_bins] row-major. Thread-safe (no shared state)
+    std::vector<float> extract(const std::vector<float>& audio) const;
+
+    // Same, into `features` (capacity reused). Returns the frame count,
+    // 0 if the audio is shorter than one frame.
+    int extract(Span<const float> audio, std::vector<float>& features) const;
 
     // Get number of frames for given input
     int get_num_frames(int num_samples) const;
 
+    // Raw log-mel rows (no CMVN) of the first num_frames frames of `audio`,
+    // which must hold get_num_frames() >= num_frames worth of samples.
+    // Frame i starts at sample i * frame_shift_samples(), so a stream can
+    // be framed incrementally by dropping num_frames * shift consumed samples
+    void compute_frames(const float* audio, int num_frames, float* out) const;
+
+    int frame_length_samples() const { return frame_length_samples_; }
+    int frame_shift_samples() const { return frame_shift_samples_; }
+
     int num_bins() const { return num_bins_; }
+    FbankEngine engine() const { return engine_; }
+
+    // CMVN mode for extract(): 0 (default) normalizes over the whole
+    // utterance; > 0 uses a causal sliding window of that many frames, as
+    // streaming front-ends see it (core/cmvn.h). Not concurrently with extract
+    void set_cmvn_window(int frames);
+    int cmvn_window() const { return cmvn_window_; }
+
+    // Per-utterance CMVN over [num_frames x num_bins], in place
+    static void apply_cmvn(float* features, int num_frames, int num_bins);
 
 private:
+    struct Tables;
+    struct Frontend;
+
+    void build_tables();
+
     int num_bins_ = 80;
     int sample_rate_ = 16000;
     float frame_length_ms_ = 25.0f;
     float frame_shift_ms_ = 10.0f;
     int frame_length_samples_ = 400;
     int frame_shift_samples_ = 160;
-    bool initialized_ = false;
+    FbankEngine engine_ = FbankEngine::KALDI;
+    int cmvn_window_ = 0;
 
-    // Apply CMVN normalization
-    void apply_cmvn(std::vector<float>& features, int num_frames, int num_bins);
+    std::unique_ptr<Tables> tables_;                     // options + window, per configuration
+    std::unique_ptr<ObjectPool<Frontend>> frontends_;    // KALDI: FFT / mel tables + frame buffer
+    std::unique_ptr<NativeFbank> native_;                // NATIVE engine
 };
 
+// Process-wide engine of the SDK's extractors (vp_set_fbank_engine), read
+// when one is initialized. KALDI by default: galleries enrolled with one
+// engine should be queried with the same one.
+void set_fbank_engine(FbankEngine engine);
+FbankEngine fbank_engine();
+
 } // namespace vp
 
 #endif // VP_FBANK_EXTRACTOR_H
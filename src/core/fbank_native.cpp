@@ -0,0 +1,100 @@
+#include "core/fbank_native.h"
+#include "utils/scratch.h"
+#include <cmath>
+
+namespace vp {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Kaldi mel scale, in float like kaldi-native-fbank
+float mel_scale(float freq) {
+    return 1127.0f * std::log(1.0f + freq / 700.0f);
+}
+
+} // anonymous namespace
+
+NativeFbank::NativeFbank(const Options& opts) {
+    const int n = opts.frame_length;
+    const int half = opts.fft_size / 2;
+
+    // Hamming window, computed in double and stored as float as kaldi does
+    window_.resize(n);
+    const double a = 2.0 * kPi / (n - 1);
+    for (int i = 0; i < n; ++i) {
+        window_[i] = static_cast<float>(0.54 - 0.46 * std::cos(a * i));
+    }
+
+    // Half-size complex FFT: bit reversal and twiddles
+    int bits = 0;
+    while ((1 << bits) < half) ++bits;
+    bitrev_.resize(half);
+    for (int m = 0; m < half; ++m) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) r |= ((m >> b) & 1) << (bits - 1 - b);
+        bitrev_[m] = r;
+    }
+    twiddle_.resize(half);   // half / 2 complex values
+    for (int m = 0; m < half / 2; ++m) {
+        twiddle_[2 * m] = static_cast<float>(std::cos(2.0 * kPi * m / half));
+        twiddle_[2 * m + 1] = static_cast<float>(-std::sin(2.0 * kPi * m / half));
+    }
+    split_.resize(2 * (half / 2 + 1));
+    for (int k = 0; k <= half / 2; ++k) {
+        split_[2 * k] = static_cast<float>(std::cos(2.0 * kPi * k / opts.fft_size));
+        split_[2 * k + 1] = static_cast<float>(-std::sin(2.0 * kPi * k / opts.fft_size));
+    }
+
+    // Triangular mel filters over FFT bins [0, fft_size / 2), same float
+    // arithmetic as knf::MelBanks so bin edges land identically
+    const float nyquist = 0.5f * opts.sample_rate;
+    const float high_freq = opts.high_freq > 0.0f ? opts.high_freq : nyquist + opts.high_freq;
+    const float fft_bin_width = opts.sample_rate / opts.fft_size;
+    const float mel_low = mel_scale(opts.low_freq);
+    const float mel_high = mel_scale(high_freq);
+    const float mel_delta = (mel_high - mel_low) / (opts.num_bins + 1);
+
+    mel_first_.assign(opts.num_bins, 0);
+    mel_offset_.assign(opts.num_bins + 1, 0);
+    for (int bin = 0; bin < opts.num_bins; ++bin) {
+        const float left = mel_low + bin * mel_delta;
+        const float center = mel_low + (bin + 1) * mel_delta;
+        const float right = mel_low + (bin + 2) * mel_delta;
+        // mel_scale is monotonic, so each filter covers one contiguous run
+        int first = -1;
+        for (int i = 0; i < half; ++i) {
+            const float mel = mel_scale(fft_bin_width * i);
+            if (mel > left && mel < right) {
+                if (first < 0) first = i;
+                mel_weights_.push_back(mel <= center ? (mel - left) / (center - left)
+                                                     : (right - mel) / (right - center));
+            }
+        }
+        mel_first_[bin] = first < 0 ? 0 : first;
+        mel_offset_[bin + 1] = static_cast<int>(mel_weights_.size());
+    }
+
+    tables_.frame_length = n;
+    tables_.frame_shift = opts.frame_shift;
+    tables_.fft_size = opts.fft_size;
+    tables_.preemph = opts.preemph;
+    tables_.window = window_.data();
+    tables_.bitrev = bitrev_.data();
+    tables_.twiddle = twiddle_.data();
+    tables_.split = split_.data();
+    tables_.num_bins = opts.num_bins;
+    tables_.mel_first = mel_first_.data();
+    tables_.mel_offset = mel_offset_.data();
+    tables_.mel_weights = mel_weights_.data();
+}
+
+void NativeFbank::compute(const float* samples, int num_frames, float* out) const {
+    if (num_frames <= 0) return;
+    struct FbankBlockScratch;
+    float* scratch = thread_scratch<FbankBlockScratch>(
+        static_cast<size_t>(tables_.fft_size) * SIMD_FBANK_MAX_LANES);
+    simd_kernels().fbank_frames(tables_, samples, num_frames, out, scratch);
+}
+
+} // namespace vp
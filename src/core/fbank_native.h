@@ -0,0 +1,56 @@
+#ifndef VP_FBANK_NATIVE_H
+#define VP_FBANK_NATIVE_H
+
+#include <vector>
+#include "core/simd_dispatch.h"
+
+namespace vp {
+
+/**
+ * In-tree log-mel filterbank, numerically compatible with the
+ * kaldi-native-fbank configuration FbankExtractor uses (snip-edges framing,
+ * DC removal, pre-emphasis, Hamming window, zero-padded power spectrum,
+ * kaldi mel filters, log floored at FLT_EPSILON; no dither, no energy).
+ *
+ * The window, FFT twiddles and sparse mel matrix are built once here; the
+ * per-frame work runs in SimdKernels::fbank_frames, several frames per SIMD
+ * register. compute() is const and thread-safe.
+ */
+class NativeFbank {
+public:
+    struct Options {
+        float sample_rate = 16000.0f;
+        int frame_length = 400;      // samples
+        int frame_shift = 160;       // samples
+        int fft_size = 512;          // padded frame length, power of two
+        float preemph = 0.97f;
+        int num_bins = 80;
+        float low_freq = 20.0f;
+        float high_freq = 0.0f;      // <= 0: offset from Nyquist
+    };
+
+    explicit NativeFbank(const Options& opts);
+
+    NativeFbank(const NativeFbank&) = delete;
+    NativeFbank& operator=(const NativeFbank&) = delete;
+
+    // Log-mel energies of the first num_frames frames of samples (which must
+    // hold them all), [num_frames x num_bins] row-major, no CMVN
+    void compute(const float* samples, int num_frames, float* out) const;
+
+    int num_bins() const { return tables_.num_bins; }
+
+private:
+    std::vector<float> window_;
+    std::vector<int> bitrev_;
+    std::vector<float> twiddle_;
+    std::vector<float> split_;
+    std::vector<int> mel_first_;
+    std::vector<int> mel_offset_;
+    std::vector<float> mel_weights_;
+    FbankKernelTables tables_{};
+};
+
+} // namespace vp
+
+#endif // VP_FBANK_NATIVE_H
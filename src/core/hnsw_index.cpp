@@ -0,0 +1,511 @@
+#include "core/hnsw_index.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <queue>
+
+namespace vp {
+
+namespace {
+
+constexpr uint32_t HNSW_MAGIC   = 0x4E485056;   // "VPHN"
+constexpr uint32_t HNSW_VERSION = 1;
+constexpr int FLOATS_PER_LINE = static_cast<int>(HnswIndex::ALIGNMENT / sizeof(float));
+
+// Per-thread visited marks, reset in O(1) by bumping the epoch
+struct VisitedList {
+    std::vector<uint32_t> tags;
+    uint32_t epoch = 0;
+
+    void begin(int n) {
+        if (static_cast<int>(tags.size()) < n) tags.resize(n, 0);
+        if (++epoch == 0) {
+            std::fill(tags.begin(), tags.end(), 0);
+            epoch = 1;
+        }
+    }
+    bool visit(int node) {
+        if (tags[node] == epoch) return false;
+        tags[node] = epoch;
+        return true;
+    }
+};
+
+VisitedList& visited_list() {
+    thread_local VisitedList list;
+    return list;
+}
+
+template <typename T>
+void write_pod(std::ofstream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::ifstream& in, T& v) {
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    return static_cast<bool>(in);
+}
+
+} // anonymous namespace
+
+HnswIndex::HnswIndex() = default;
+
+HnswIndex::~HnswIndex() {
+    if (data_) ::operator delete(data_, std::align_val_t(ALIGNMENT));
+}
+
+HnswIndex::HnswIndex(const HnswIndex& other) {
+    *this = other;
+}
+
+HnswIndex& HnswIndex::operator=(const HnswIndex& other) {
+    if (this == &other) return *this;
+    reset(other.dim_, other.M_, other.ef_construction_);
+    if (other.capacity_ > 0) {
+        data_ = static_cast<float*>(::operator new(
+            static_cast<size_t>(other.capacity_) * stride_ * sizeof(float), std::align_val_t(ALIGNMENT)));
+        std::memcpy(data_, other.data_, static_cast<size_t>(other.nodes_) * stride_ * sizeof(float));
+    }
+    nodes_ = other.nodes_;
+    live_ = other.live_;
+    capacity_ = other.capacity_;
+    entry_ = other.entry_;
+    max_level_ = other.max_level_;
+    links0_ = other.links0_;
+    levels_ = other.levels_;
+    upper_links_ = other.upper_links_;
+    deleted_ = other.deleted_;
+    ids_ = other.ids_;
+    enroll_counts_ = other.enroll_counts_;
+    index_ = other.index_;
+    rng_ = other.rng_;
+    return *this;
+}
+
+void HnswIndex::reset(int dim, int M, int ef_construction) {
+    if (data_) ::operator delete(data_, std::align_val_t(ALIGNMENT));
+    data_ = nullptr;
+    dim_ = std::max(0, dim);
+    stride_ = (dim_ + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE;
+    M_ = std::max(2, M);
+    max_links0_ = 2 * M_;
+    ef_construction_ = std::max(M_, ef_construction);
+    level_mult_ = 1.0 / std::log(static_cast<double>(M_));
+
+    nodes_ = 0;
+    live_ = 0;
+    capacity_ = 0;
+    entry_ = -1;
+    max_level_ = -1;
+    links0_.clear();
+    levels_.clear();
+    upper_links_.clear();
+    deleted_.clear();
+    ids_.clear();
+    enroll_counts_.clear();
+    index_.clear();
+    rng_.seed(42);
+}
+
+void HnswIndex::grow(int min_nodes) {
+    int new_capacity = std::max({min_nodes, capacity_ * 2, 64});
+    float* new_data = static_cast<float*>(::operator new(
+        static_cast<size_t>(new_capacity) * stride_ * sizeof(float), std::align_val_t(ALIGNMENT)));
+    if (data_) {
+        std::memcpy(new_data, data_, static_cast<size_t>(nodes_) * stride_ * sizeof(float));
+        ::operator delete(data_, std::align_val_t(ALIGNMENT));
+    }
+    data_ = new_data;
+    capacity_ = new_capacity;
+
+    links0_.resize(static_cast<size_t>(new_capacity) * (max_links0_ + 1), 0);
+    levels_.reserve(new_capacity);
+    upper_links_.reserve(new_capacity);
+    deleted_.reserve(new_capacity);
+    ids_.reserve(new_capacity);
+    enroll_counts_.reserve(new_capacity);
+}
+
+int HnswIndex::random_level() {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    double r = std::max(dist(rng_), std::numeric_limits<double>::min());
+    return static_cast<int>(-std::log(r) * level_mult_);
+}
+
+float HnswIndex::similarity(const float* q, int node) const {
+    return SimilarityCalculator::cosine_similarity(q, vector_at(node), dim_);
+}
+
+int* HnswIndex::links(int node, int level) {
+    if (level == 0) return links0(node);
+    return upper_links_[node].data() + static_cast<size_t>(level - 1) * (M_ + 1);
+}
+
+const int* HnswIndex::links(int node, int level) const {
+    if (level == 0) return links0(node);
+    return upper_links_[node].data() + static_cast<size_t>(level - 1) * (M_ + 1);
+}
+
+int HnswIndex::find(const std::string& speaker_id) const {
+    auto it = index_.find(speaker_id);
+    return it == index_.end() ? -1 : it->second;
+}
+
+int HnswIndex::greedy_descend(const float* q, int entry, int from_level, int to_level) const {
+    int cur = entry;
+    float best = similarity(q, cur);
+    for (int level = from_level; level >= to_level; --level) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            const int* nb = links(cur, level);
+            for (int i = 1; i <= nb[0]; ++i) {
+                float s = similarity(q, nb[i]);
+                if (s > best) {
+                    best = s;
+                    cur = nb[i];
+                    changed = true;
+                }
+            }
+        }
+    }
+    return cur;
+}
+
+void HnswIndex::search_layer(const float* q, int entry, int ef, int level, bool skip_deleted,
+                             std::vector<Candidate>& out) const {
+    auto closer = [](const Candidate& a, const Candidate& b) { return a.score < b.score; };
+    auto farther = [](const Candidate& a, const Candidate& b) { return a.score > b.score; };
+    // candidates: best on top; results: worst on top
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(closer)> candidates(closer);
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(farther)> results(farther);
+
+    VisitedList& visited = visited_list();
+    visited.begin(nodes_);
+
+    float s = similarity(q, entry);
+    visited.visit(entry);
+    candidates.push({s, entry});
+    if (!skip_deleted || !deleted_[entry]) results.push({s, entry});
+    float lower_bound = results.empty() ? -std::numeric_limits<float>::infinity()
+                                        : results.top().score;
+
+    while (!candidates.empty()) {
+        Candidate c = candidates.top();
+        if (c.score < lower_bound && static_cast<int>(results.size()) >= ef) break;
+        candidates.pop();
+
+        const int* nb = links(c.node, level);
+        for (int i = 1; i <= nb[0]; ++i) {
+            int n = nb[i];
+            if (!visited.visit(n)) continue;
+            float sn = similarity(q, n);
+            if (static_cast<int>(results.size()) < ef || sn > lower_bound) {
+                candidates.push({sn, n});
+                if (!skip_deleted || !deleted_[n]) {
+                    results.push({sn, n});
+                    if (static_cast<int>(results.size()) > ef) results.pop();
+                }
+                if (!results.empty()) lower_bound = results.top().score;
+            }
+        }
+    }
+
+    out.resize(results.size());
+    for (int i = static_cast<int>(results.size()) - 1; i >= 0; --i) {
+        out[i] = results.top();
+        results.pop();
+    }
+}
+
+void HnswIndex::select_neighbors(std::vector<Candidate>& candidates, int m) const {
+    // Candidate scores are relative to the base point, sorted descending
+    if (static_cast<int>(candidates.size()) <= m) return;
+
+    // Heuristic selection: keep a candidate only if it is closer to the base
+    // point than to every neighbour already kept, which preserves links
+    // towards distinct clusters instead of m near-duplicates.
+    std::vector<Candidate> selected;
+    selected.reserve(m);
+    for (const auto& c : candidates) {
+        bool keep = true;
+        for (const auto& s : selected) {
+            if (SimilarityCalculator::cosine_similarity(vector_at(c.node), vector_at(s.node), dim_)
+                > c.score) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            selected.push_back(c);
+            if (static_cast<int>(selected.size()) == m) break;
+        }
+    }
+    candidates.swap(selected);
+}
+
+void HnswIndex::connect(int node, int level, const std::vector<Candidate>& neighbors) {
+    const int max_links = (level == 0) ? max_links0_ : M_;
+
+    int* own = links(node, level);
+    own[0] = static_cast<int>(neighbors.size());
+    for (size_t i = 0; i < neighbors.size(); ++i) own[i + 1] = neighbors[i].node;
+
+    std::vector<Candidate> pool;
+    for (const auto& nb : neighbors) {
+        int* l = links(nb.node, level);
+        if (l[0] < max_links) {
+            l[++l[0]] = node;
+            continue;
+        }
+
+        // Neighbour is full: re-select its links including the new node
+        const float* base = vector_at(nb.node);
+        pool.clear();
+        pool.push_back({nb.score, node});
+        for (int i = 1; i <= l[0]; ++i) {
+            pool.push_back({SimilarityCalculator::cosine_similarity(base, vector_at(l[i]), dim_), l[i]});
+        }
+        std::sort(pool.begin(), pool.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+        select_neighbors(pool, max_links);
+        l[0] = static_cast<int>(pool.size());
+        for (size_t i = 0; i < pool.size(); ++i) l[i + 1] = pool[i].node;
+    }
+}
+
+void HnswIndex::insert(int node, int level) {
+    if (entry_ < 0) {
+        entry_ = node;
+        max_level_ = level;
+        return;
+    }
+
+    const float* q = vector_at(node);
+    int cur = greedy_descend(q, entry_, max_level_, level + 1);
+
+    std::vector<Candidate> candidates;
+    for (int l = std::min(level, max_level_); l >= 0; --l) {
+        search_layer(q, cur, ef_construction_, l, false, candidates);
+        if (candidates.empty()) continue;
+        cur = candidates[0].node;
+        select_neighbors(candidates, M_);
+        connect(node, l, candidates);
+    }
+
+    if (level > max_level_) {
+        entry_ = node;
+        max_level_ = level;
+    }
+}
+
+void HnswIndex::add(const std::string& speaker_id, const float* embedding, int enroll_count) {
+    if (!embedding || dim_ == 0) return;
+
+    auto it = index_.find(speaker_id);
+    if (it != index_.end()) {
+        deleted_[it->second] = 1;
+        --live_;
+        index_.erase(it);
+    }
+
+    if (nodes_ == capacity_) grow(nodes_ + 1);
+    int node = nodes_++;
+    float* dst = data_ + static_cast<size_t>(node) * stride_;
+    std::memcpy(dst, embedding, static_cast<size_t>(dim_) * sizeof(float));
+    std::fill(dst + dim_, dst + stride_, 0.0f);
+
+    int level = random_level();
+    levels_.push_back(level);
+    upper_links_.emplace_back(static_cast<size_t>(level) * (M_ + 1), 0);
+    links0(node)[0] = 0;
+    deleted_.push_back(0);
+    ids_.push_back(speaker_id);
+    enroll_counts_.push_back(enroll_count);
+    index_[speaker_id] = node;
+    ++live_;
+
+    insert(node, level);
+}
+
+bool HnswIndex::remove(const std::string& speaker_id) {
+    auto it = index_.find(speaker_id);
+    if (it == index_.end()) return false;
+    deleted_[it->second] = 1;
+    --live_;
+    index_.erase(it);
+    return true;
+}
+
+void HnswIndex::compact() {
+    if (deleted_count() == 0) return;
+
+    std::vector<int> live_nodes;
+    live_nodes.reserve(live_);
+    for (int n = 0; n < nodes_; ++n) {
+        if (!deleted_[n]) live_nodes.push_back(n);
+    }
+
+    std::vector<float> vectors(live_nodes.size() * static_cast<size_t>(dim_));
+    std::vector<std::string> ids;
+    std::vector<int> counts;
+    for (size_t i = 0; i < live_nodes.size(); ++i) {
+        int n = live_nodes[i];
+        std::memcpy(vectors.data() + i * dim_, vector_at(n), static_cast<size_t>(dim_) * sizeof(float));
+        ids.push_back(std::move(ids_[n]));
+        counts.push_back(enroll_counts_[n]);
+    }
+
+    reset(dim_, M_, ef_construction_);
+    grow(static_cast<int>(ids.size()));
+    for (size_t i = 0; i < ids.size(); ++i) {
+        add(ids[i], vectors.data() + i * dim_, counts[i]);
+    }
+}
+
+int HnswIndex::search(const float* query, int k, int ef, ScoredIndex* out) const {
+    if (live_ == 0 || k <= 0) return 0;
+
+    int cur = greedy_descend(query, entry_, max_level_, 1);
+    std::vector<Candidate> candidates;
+    search_layer(query, cur, std::max(ef, k), 0, true, candidates);
+
+    int n = std::min(k, static_cast<int>(candidates.size()));
+    for (int i = 0; i < n; ++i) out[i] = {candidates[i].node, candidates[i].score};
+    return n;
+}
+
+bool HnswIndex::save(const std::string& path) const {
+    namespace fs = std::filesystem;
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        write_pod(out, HNSW_MAGIC);
+        write_pod(out, HNSW_VERSION);
+        write_pod(out, static_cast<int32_t>(dim_));
+        write_pod(out, static_cast<int32_t>(M_));
+        write_pod(out, static_cast<int32_t>(ef_construction_));
+        write_pod(out, static_cast<int32_t>(nodes_));
+        write_pod(out, static_cast<int32_t>(entry_));
+        write_pod(out, static_cast<int32_t>(max_level_));
+
+        for (int n = 0; n < nodes_; ++n) {
+            write_pod(out, static_cast<uint32_t>(ids_[n].size()));
+            out.write(ids_[n].data(), static_cast<std::streamsize>(ids_[n].size()));
+            write_pod(out, static_cast<int32_t>(enroll_counts_[n]));
+            write_pod(out, deleted_[n]);
+            write_pod(out, static_cast<int32_t>(levels_[n]));
+            out.write(reinterpret_cast<const char*>(vector_at(n)),
+                      static_cast<std::streamsize>(dim_ * sizeof(float)));
+            for (int l = 0; l <= levels_[n]; ++l) {
+                const int* nb = links(n, l);
+                out.write(reinterpret_cast<const char*>(nb),
+                          static_cast<std::streamsize>((nb[0] + 1) * sizeof(int)));
+            }
+        }
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool HnswIndex::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    uint32_t magic = 0, version = 0;
+    int32_t dim = 0, M = 0, ef_c = 0, nodes = 0, entry = -1, max_level = -1;
+    if (!read_pod(in, magic) || magic != HNSW_MAGIC) return false;
+    if (!read_pod(in, version) || version != HNSW_VERSION) return false;
+    if (!read_pod(in, dim) || !read_pod(in, M) || !read_pod(in, ef_c) ||
+        !read_pod(in, nodes) || !read_pod(in, entry) || !read_pod(in, max_level)) {
+        return false;
+    }
+    if (dim <= 0 || M < 2 || nodes < 0 || entry >= nodes || (nodes > 0 && entry < 0)) return false;
+
+    reset(dim, M, ef_c);
+    if (nodes > 0) grow(nodes);
+
+    auto fail = [&]() { reset(dim, M, ef_c); return false; };
+
+    for (int n = 0; n < nodes; ++n) {
+        uint32_t id_len = 0;
+        int32_t count = 0, level = 0;
+        uint8_t deleted = 0;
+        if (!read_pod(in, id_len) || id_len > 4096) return fail();
+        std::string id(id_len, '\0');
+        in.read(&id[0], id_len);
+        if (!read_pod(in, count) || !read_pod(in, deleted) || !read_pod(in, level) ||
+            level < 0 || level > max_level) {
+            return fail();
+        }
+
+        float* dst = data_ + static_cast<size_t>(n) * stride_;
+        in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(dim_ * sizeof(float)));
+        std::fill(dst + dim_, dst + stride_, 0.0f);
+
+        levels_.push_back(level);
+        upper_links_.emplace_back(static_cast<size_t>(level) * (M_ + 1), 0);
+        for (int l = 0; l <= level; ++l) {
+            int* nb = (l == 0) ? links0(n) : upper_links_[n].data() + static_cast<size_t>(l - 1) * (M_ + 1);
+            int max_links = (l == 0) ? max_links0_ : M_;
+            if (!read_pod(in, nb[0]) || nb[0] < 0 || nb[0] > max_links) return fail();
+            in.read(reinterpret_cast<char*>(nb + 1), static_cast<std::streamsize>(nb[0] * sizeof(int)));
+            for (int i = 1; i <= nb[0]; ++i) {
+                if (nb[i] < 0 || nb[i] >= nodes) return fail();
+            }
+        }
+        if (!in) return fail();
+
+        deleted_.push_back(deleted ? 1 : 0);
+        ids_.push_back(id);
+        enroll_counts_.push_back(count);
+        if (!deleted) {
+            index_[id] = n;
+            ++live_;
+        }
+        ++nodes_;
+    }
+
+    // Searches descend from the entry's top level and follow each upper
+    // link at its own level, so both levels must exist on the nodes named
+    if (nodes > 0 && levels_[entry] != max_level) return fail();
+    for (int n = 0; n < nodes; ++n) {
+        for (int l = 1; l <= levels_[n]; ++l) {
+            const int* nb = upper_links_[n].data() + static_cast<size_t>(l - 1) * (M_ + 1);
+            for (int i = 1; i <= nb[0]; ++i) {
+                if (levels_[nb[i]] < l) return fail();
+            }
+        }
+    }
+
+    entry_ = entry;
+    max_level_ = max_level;
+    return true;
+}
+
+size_t HnswIndex::memory_bytes() const {
+    size_t bytes = static_cast<size_t>(capacity_) * stride_ * sizeof(float);
+    bytes += links0_.capacity() * sizeof(int);
+    for (const auto& l : upper_links_) bytes += sizeof(l) + l.capacity() * sizeof(int);
+    for (const auto& id : ids_) bytes += sizeof(std::string) + id.capacity();
+    bytes += levels_.capacity() * sizeof(int) + enroll_counts_.capacity() * sizeof(int);
+    bytes += deleted_.capacity();
+    bytes += index_.size() * (sizeof(std::string) + sizeof(int) + 2 * sizeof(void*));
+    return bytes;
+}
+
+} // namespace vp
@@ -0,0 +1,127 @@
+#ifndef VP_HNSW_INDEX_H
+#define VP_HNSW_INDEX_H
+
+#include "core/similarity.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+
+namespace vp {
+
+/**
+ * Hierarchical Navigable Small World graph over L2-normalized embeddings
+ * (Malkov & Yashunin), scored by cosine similarity.
+ *
+ * Nodes own a copy of their vector in one 64-byte-aligned matrix, so scores
+ * returned by search() are exact for the nodes visited. Level-0 links live
+ * in a flat [capacity x 2M] table; the few upper-level links are stored per
+ * node.
+ *
+ * Updates are incremental: add() of an existing ID tombstones the old node
+ * and inserts a new one; remove() tombstones. Tombstoned nodes are still
+ * traversed but never returned. Call compact() to rebuild without them once
+ * deleted_count() grows large.
+ *
+ * Not thread-safe for writers: search() may run concurrently with other
+ * searches, add/remove/compact need exclusive access.
+ */
+class HnswIndex {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    HnswIndex();
+    ~HnswIndex();
+
+    HnswIndex(const HnswIndex& other);
+    HnswIndex& operator=(const HnswIndex& other);
+
+    // Drop all nodes and set the graph parameters
+    void reset(int dim, int M = 16, int ef_construction = 200);
+
+    // Insert or replace the vector for an ID
+    void add(const std::string& speaker_id, const float* embedding, int enroll_count);
+
+    // Tombstone an ID. Returns false if unknown.
+    bool remove(const std::string& speaker_id);
+
+    // Rebuild the graph from live nodes only
+    void compact();
+
+    // K nearest live nodes (exact scores, descending). ef >= k is the size of
+    // the dynamic candidate list; larger ef trades latency for recall.
+    int search(const float* query, int k, int ef, ScoredIndex* out) const;
+
+    const std::string& id_at(int node) const { return ids_[node]; }
+    int enroll_count_at(int node) const      { return enroll_counts_[node]; }
+    const float* vector_at(int node) const   { return data_ + static_cast<size_t>(node) * stride_; }
+
+    // Live node for an ID, or -1
+    int find(const std::string& speaker_id) const;
+
+    int size() const          { return live_; }
+    int deleted_count() const { return nodes_ - live_; }
+    int dim() const           { return dim_; }
+    bool empty() const        { return live_ == 0; }
+
+    // Binary persistence. load() replaces the current contents and returns
+    // false (leaving the index empty) on any format mismatch.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    size_t memory_bytes() const;
+
+private:
+    struct Candidate {
+        float score;
+        int node;
+    };
+
+    void grow(int min_nodes);
+    int  random_level();
+    float similarity(const float* q, int node) const;
+
+    int*       links0(int node)       { return links0_.data() + static_cast<size_t>(node) * (max_links0_ + 1); }
+    const int* links0(int node) const { return links0_.data() + static_cast<size_t>(node) * (max_links0_ + 1); }
+
+    // Neighbour list of a node at a level: [count, n0, n1, ...]
+    int*       links(int node, int level);
+    const int* links(int node, int level) const;
+
+    int  greedy_descend(const float* q, int entry, int from_level, int to_level) const;
+    void search_layer(const float* q, int entry, int ef, int level, bool skip_deleted,
+                      std::vector<Candidate>& out) const;
+    void select_neighbors(std::vector<Candidate>& candidates, int m) const;
+    void connect(int node, int level, const std::vector<Candidate>& neighbors);
+    void insert(int node, int level);
+
+    float* data_ = nullptr;       // capacity_ x stride_
+    int dim_ = 0;
+    int stride_ = 0;
+    int M_ = 16;
+    int max_links0_ = 32;
+    int ef_construction_ = 200;
+    double level_mult_ = 0.0;
+
+    int nodes_ = 0;
+    int live_ = 0;
+    int capacity_ = 0;
+    int entry_ = -1;
+    int max_level_ = -1;
+
+    std::vector<int> links0_;                      // capacity_ x (1 + max_links0_)
+    std::vector<int> levels_;
+    std::vector<std::vector<int>> upper_links_;    // per node: levels x (1 + M_)
+    std::vector<uint8_t> deleted_;
+    std::vector<std::string> ids_;
+    std::vector<int> enroll_counts_;
+    std::unordered_map<std::string, int> index_;   // live nodes only
+
+    std::mt19937 rng_{42};
+};
+
+} // namespace vp
+
+#endif // VP_HNSW_INDEX_H
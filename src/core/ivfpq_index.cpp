@@ -0,0 +1,438 @@
+#include "core/ivfpq_index.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace vp {
+
+namespace {
+
+constexpr uint32_t IVFPQ_MAGIC   = 0x51495056;   // "VPIQ"
+constexpr uint32_t IVFPQ_VERSION = 1;
+constexpr int COARSE_ITERS = 20;
+constexpr int PQ_ITERS     = 25;
+
+// Lloyd's k-means (L2) on n row-major d-dim points, k <= n.
+// Empty clusters are re-seeded by splitting the largest one.
+void kmeans(const float* x, int n, int d, int k, int iters, std::mt19937& rng,
+            std::vector<float>& centroids) {
+    centroids.assign(static_cast<size_t>(k) * d, 0.0f);
+
+    std::vector<int> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    for (int j = 0; j < k; ++j) {
+        std::uniform_int_distribution<int> pick(j, n - 1);
+        std::swap(perm[j], perm[pick(rng)]);
+        std::memcpy(&centroids[static_cast<size_t>(j) * d], x + static_cast<size_t>(perm[j]) * d,
+                    d * sizeof(float));
+    }
+
+    std::vector<float> norms(k);
+    std::vector<double> sums(static_cast<size_t>(k) * d);
+    std::vector<int> counts(k);
+
+    for (int it = 0; it < iters; ++it) {
+        for (int j = 0; j < k; ++j) {
+            const float* c = &centroids[static_cast<size_t>(j) * d];
+            norms[j] = SimilarityCalculator::dot(c, c, d);
+        }
+
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int i = 0; i < n; ++i) {
+            const float* xi = x + static_cast<size_t>(i) * d;
+            int best = 0;
+            float best_dist = std::numeric_limits<float>::max();
+            for (int j = 0; j < k; ++j) {
+                float dist = norms[j] - 2.0f * SimilarityCalculator::dot(
+                    xi, &centroids[static_cast<size_t>(j) * d], d);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = j;
+                }
+            }
+            ++counts[best];
+            double* s = &sums[static_cast<size_t>(best) * d];
+            for (int t = 0; t < d; ++t) s[t] += xi[t];
+        }
+
+        for (int j = 0; j < k; ++j) {
+            if (counts[j] == 0) continue;
+            float* c = &centroids[static_cast<size_t>(j) * d];
+            const double* s = &sums[static_cast<size_t>(j) * d];
+            for (int t = 0; t < d; ++t) c[t] = static_cast<float>(s[t] / counts[j]);
+        }
+
+        for (int j = 0; j < k; ++j) {
+            if (counts[j] > 0) continue;
+            int big = static_cast<int>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+            float* c = &centroids[static_cast<size_t>(j) * d];
+            float* cb = &centroids[static_cast<size_t>(big) * d];
+            for (int t = 0; t < d; ++t) {
+                float eps = (t % 2 == 0) ? 1e-4f : -1e-4f;
+                c[t] = cb[t] * (1.0f + eps);
+                cb[t] = cb[t] * (1.0f - eps);
+            }
+            counts[j] = counts[big] / 2;
+            counts[big] -= counts[j];
+        }
+    }
+}
+
+template <typename T>
+void write_pod(std::ofstream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::ifstream& in, T& v) {
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    return static_cast<bool>(in);
+}
+
+} // anonymous namespace
+
+IvfPqIndex::IvfPqIndex() = default;
+
+bool IvfPqIndex::train(const float* data, int n, int dim, int nlist, int m, uint32_t seed) {
+    if (!data || n <= 0 || dim <= 0) {
+        last_error_ = "No training vectors";
+        return false;
+    }
+    if (m <= 0 || dim % m != 0) {
+        last_error_ = "Embedding dim " + std::to_string(dim) +
+                      " is not divisible by code size " + std::to_string(m);
+        return false;
+    }
+
+    dim_ = dim;
+    m_ = m;
+    dsub_ = dim / m;
+    nlist_ = std::max(1, std::min(nlist, n));
+    std::mt19937 rng(seed);
+
+    // Coarse quantizer
+    kmeans(data, n, dim_, nlist_, COARSE_ITERS, rng, centroids_);
+    centroid_norms_.resize(nlist_);
+    for (int l = 0; l < nlist_; ++l) {
+        const float* c = &centroids_[static_cast<size_t>(l) * dim_];
+        centroid_norms_[l] = SimilarityCalculator::dot(c, c, dim_);
+    }
+
+    // Residuals of every training vector against its list centroid
+    std::vector<float> residuals(static_cast<size_t>(n) * dim_);
+    for (int i = 0; i < n; ++i) {
+        const float* x = data + static_cast<size_t>(i) * dim_;
+        const float* c = &centroids_[static_cast<size_t>(assign_list(x)) * dim_];
+        float* r = &residuals[static_cast<size_t>(i) * dim_];
+        for (int t = 0; t < dim_; ++t) r[t] = x[t] - c[t];
+    }
+
+    // One codebook per sub-space; with fewer than KSUB points the learned
+    // codewords are repeated so every byte value stays decodable
+    codebooks_.assign(static_cast<size_t>(m_) * KSUB * dsub_, 0.0f);
+    const int ksub = std::min(KSUB, n);
+    std::vector<float> sub(static_cast<size_t>(n) * dsub_);
+    std::vector<float> cb;
+    for (int s = 0; s < m_; ++s) {
+        for (int i = 0; i < n; ++i) {
+            std::memcpy(&sub[static_cast<size_t>(i) * dsub_],
+                        &residuals[static_cast<size_t>(i) * dim_ + static_cast<size_t>(s) * dsub_],
+                        dsub_ * sizeof(float));
+        }
+        kmeans(sub.data(), n, dsub_, ksub, PQ_ITERS, rng, cb);
+        float* dst = &codebooks_[static_cast<size_t>(s) * KSUB * dsub_];
+        for (int k = 0; k < KSUB; ++k) {
+            std::memcpy(dst + static_cast<size_t>(k) * dsub_,
+                        &cb[static_cast<size_t>(k % ksub) * dsub_], dsub_ * sizeof(float));
+        }
+    }
+
+    codeword_norms_.resize(static_cast<size_t>(m_) * KSUB);
+    for (int i = 0; i < m_ * KSUB; ++i) {
+        const float* w = &codebooks_[static_cast<size_t>(i) * dsub_];
+        codeword_norms_[i] = SimilarityCalculator::dot(w, w, dsub_);
+    }
+
+    clear_entries();
+    return true;
+}
+
+void IvfPqIndex::clear_entries() {
+    lists_.assign(nlist_, InvList{});
+    list_of_.clear();
+    pos_in_list_.clear();
+    size_ = 0;
+}
+
+int IvfPqIndex::assign_list(const float* x) const {
+    int best = 0;
+    float best_dist = std::numeric_limits<float>::max();
+    for (int l = 0; l < nlist_; ++l) {
+        float dist = centroid_norms_[l] - 2.0f * SimilarityCalculator::dot(
+            x, &centroids_[static_cast<size_t>(l) * dim_], dim_);
+        if (dist < best_dist) {
+            best_dist = dist;
+            best = l;
+        }
+    }
+    return best;
+}
+
+int IvfPqIndex::encode(const float* x, uint8_t* code) const {
+    const int list = assign_list(x);
+    const float* c = &centroids_[static_cast<size_t>(list) * dim_];
+    std::vector<float> r(dsub_);
+    for (int s = 0; s < m_; ++s) {
+        for (int t = 0; t < dsub_; ++t) r[t] = x[s * dsub_ + t] - c[s * dsub_ + t];
+
+        const float* book = &codebooks_[static_cast<size_t>(s) * KSUB * dsub_];
+        const float* norms = &codeword_norms_[static_cast<size_t>(s) * KSUB];
+        int best = 0;
+        float best_dist = std::numeric_limits<float>::max();
+        for (int k = 0; k < KSUB; ++k) {
+            float dist = norms[k] - 2.0f * SimilarityCalculator::dot(
+                r.data(), book + static_cast<size_t>(k) * dsub_, dsub_);
+            if (dist < best_dist) {
+                best_dist = dist;
+                best = k;
+            }
+        }
+        code[s] = static_cast<uint8_t>(best);
+    }
+    return list;
+}
+
+void IvfPqIndex::set(int row, int list, const uint8_t* code) {
+    if (row < 0 || list < 0 || list >= nlist_) return;
+    if (row >= rows()) resize(row + 1);
+    if (list_of_[row] >= 0) drop(row);
+
+    InvList& inv = lists_[list];
+    list_of_[row] = list;
+    pos_in_list_[row] = static_cast<int>(inv.rows.size());
+    inv.rows.push_back(row);
+    inv.codes.insert(inv.codes.end(), code, code + m_);
+    ++size_;
+}
+
+void IvfPqIndex::add(int row, const float* embedding) {
+    if (!trained() || !embedding) return;
+    std::vector<uint8_t> code(m_);
+    int list = encode(embedding, code.data());
+    set(row, list, code.data());
+}
+
+void IvfPqIndex::drop(int row) {
+    // Swap-remove inside the inverted list
+    InvList& inv = lists_[list_of_[row]];
+    int p = pos_in_list_[row];
+    int last_p = static_cast<int>(inv.rows.size()) - 1;
+    if (p != last_p) {
+        int moved = inv.rows[last_p];
+        inv.rows[p] = moved;
+        std::memcpy(&inv.codes[static_cast<size_t>(p) * m_],
+                    &inv.codes[static_cast<size_t>(last_p) * m_], m_);
+        pos_in_list_[moved] = p;
+    }
+    inv.rows.pop_back();
+    inv.codes.resize(static_cast<size_t>(last_p) * m_);
+    list_of_[row] = -1;
+    pos_in_list_[row] = -1;
+    --size_;
+}
+
+void IvfPqIndex::resize(int rows) {
+    rows = std::max(0, rows);
+    for (int r = rows; r < this->rows(); ++r) {
+        if (list_of_[r] >= 0) drop(r);
+    }
+    list_of_.resize(rows, -1);
+    pos_in_list_.resize(rows, -1);
+}
+
+void IvfPqIndex::remove(int row) {
+    if (row < 0 || row >= rows()) return;
+    if (list_of_[row] >= 0) drop(row);
+
+    // The last row takes the freed slot
+    int last = rows() - 1;
+    if (row != last) {
+        list_of_[row] = list_of_[last];
+        pos_in_list_[row] = pos_in_list_[last];
+        if (list_of_[row] >= 0) lists_[list_of_[row]].rows[pos_in_list_[row]] = row;
+    }
+    list_of_.pop_back();
+    pos_in_list_.pop_back();
+}
+
+int IvfPqIndex::search(const float* query, int n, int nprobe, ScoredIndex* out) const {
+    if (!trained() || size_ == 0 || n <= 0) return 0;
+    nprobe = std::max(1, std::min(nprobe, nlist_));
+
+    // Probe the lists whose centroids are nearest in L2, matching how
+    // vectors were assigned: argmin |q - c|^2 = argmax q.c - |c|^2 / 2
+    std::vector<float> coarse(nlist_);
+    TopKSelector probe_sel(nprobe);
+    for (int l = 0; l < nlist_; ++l) {
+        coarse[l] = SimilarityCalculator::dot(query, &centroids_[static_cast<size_t>(l) * dim_], dim_);
+        float key = coarse[l] - 0.5f * centroid_norms_[l];
+        if (key > probe_sel.threshold()) probe_sel.push(l, key);
+    }
+    std::vector<ScoredIndex> probes(nprobe);
+    int np = probe_sel.take_sorted(probes.data());
+
+    // ADC table: q_m . codeword for every sub-space and code
+    std::vector<float> table(static_cast<size_t>(m_) * KSUB);
+    for (int s = 0; s < m_; ++s) {
+        const float* q = query + s * dsub_;
+        const float* book = &codebooks_[static_cast<size_t>(s) * KSUB * dsub_];
+        float* t = &table[static_cast<size_t>(s) * KSUB];
+        for (int k = 0; k < KSUB; ++k) {
+            t[k] = SimilarityCalculator::dot(q, book + static_cast<size_t>(k) * dsub_, dsub_);
+        }
+    }
+
+    TopKSelector selector(n);
+    for (int p = 0; p < np; ++p) {
+        const InvList& inv = lists_[probes[p].index];
+        const float base = coarse[probes[p].index];
+        const uint8_t* code = inv.codes.data();
+        const int count = static_cast<int>(inv.rows.size());
+        for (int j = 0; j < count; ++j, code += m_) {
+            float score = base;
+            const float* t = table.data();
+            for (int s = 0; s < m_; ++s, t += KSUB) score += t[code[s]];
+            if (score > selector.threshold()) selector.push(inv.rows[j], score);
+        }
+    }
+    return selector.take_sorted(out);
+}
+
+bool IvfPqIndex::save(const std::string& path, const RowLabel& label) const {
+    namespace fs = std::filesystem;
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        write_pod(out, IVFPQ_MAGIC);
+        write_pod(out, IVFPQ_VERSION);
+        write_pod(out, static_cast<int32_t>(dim_));
+        write_pod(out, static_cast<int32_t>(nlist_));
+        write_pod(out, static_cast<int32_t>(m_));
+        out.write(reinterpret_cast<const char*>(centroids_.data()),
+                  static_cast<std::streamsize>(centroids_.size() * sizeof(float)));
+        out.write(reinterpret_cast<const char*>(codebooks_.data()),
+                  static_cast<std::streamsize>(codebooks_.size() * sizeof(float)));
+
+        write_pod(out, static_cast<int32_t>(size_));
+        for (int row = 0; row < rows(); ++row) {
+            if (list_of_[row] < 0) continue;
+            const InvList& inv = lists_[list_of_[row]];
+            int enroll_count = 0;
+            std::string_view id = label(row, enroll_count);
+            write_pod(out, static_cast<uint32_t>(id.size()));
+            out.write(id.data(), static_cast<std::streamsize>(id.size()));
+            write_pod(out, static_cast<int32_t>(enroll_count));
+            write_pod(out, static_cast<int32_t>(list_of_[row]));
+            out.write(reinterpret_cast<const char*>(&inv.codes[static_cast<size_t>(pos_in_list_[row]) * m_]), m_);
+        }
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool IvfPqIndex::load(const std::string& path, const RowLookup& lookup) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        last_error_ = "Cannot open index file: " + path;
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0;
+    int32_t dim = 0, nlist = 0, m = 0;
+    if (!read_pod(in, magic) || magic != IVFPQ_MAGIC ||
+        !read_pod(in, version) || version != IVFPQ_VERSION ||
+        !read_pod(in, dim) || !read_pod(in, nlist) || !read_pod(in, m) ||
+        dim <= 0 || nlist <= 0 || m <= 0 || dim % m != 0) {
+        last_error_ = "Invalid index file: " + path;
+        return false;
+    }
+
+    dim_ = dim;
+    nlist_ = nlist;
+    m_ = m;
+    dsub_ = dim / m;
+    centroids_.resize(static_cast<size_t>(nlist_) * dim_);
+    codebooks_.resize(static_cast<size_t>(m_) * KSUB * dsub_);
+    in.read(reinterpret_cast<char*>(centroids_.data()),
+            static_cast<std::streamsize>(centroids_.size() * sizeof(float)));
+    in.read(reinterpret_cast<char*>(codebooks_.data()),
+            static_cast<std::streamsize>(codebooks_.size() * sizeof(float)));
+
+    auto fail = [&]() {
+        centroids_.clear();
+        codebooks_.clear();
+        clear_entries();
+        last_error_ = "Corrupt index file: " + path;
+        return false;
+    };
+
+    int32_t count = 0;
+    if (!read_pod(in, count) || count < 0) return fail();
+
+    centroid_norms_.resize(nlist_);
+    for (int l = 0; l < nlist_; ++l) {
+        const float* c = &centroids_[static_cast<size_t>(l) * dim_];
+        centroid_norms_[l] = SimilarityCalculator::dot(c, c, dim_);
+    }
+    codeword_norms_.resize(static_cast<size_t>(m_) * KSUB);
+    for (int i = 0; i < m_ * KSUB; ++i) {
+        const float* w = &codebooks_[static_cast<size_t>(i) * dsub_];
+        codeword_norms_[i] = SimilarityCalculator::dot(w, w, dsub_);
+    }
+
+    // Entries the owner no longer has (or has at another enroll count) are
+    // dropped here and re-encoded by the caller
+    clear_entries();
+    std::vector<uint8_t> code(m_);
+    for (int e = 0; e < count; ++e) {
+        uint32_t id_len = 0;
+        int32_t enroll_count = 0, list = 0;
+        if (!read_pod(in, id_len) || id_len > 4096) return fail();
+        std::string id(id_len, '\0');
+        in.read(&id[0], id_len);
+        if (!read_pod(in, enroll_count) || !read_pod(in, list) || list < 0 || list >= nlist_) {
+            return fail();
+        }
+        in.read(reinterpret_cast<char*>(code.data()), m_);
+        if (!in) return fail();
+        int row = lookup(id, enroll_count);
+        if (row >= 0) set(row, list, code.data());
+    }
+    return true;
+}
+
+size_t IvfPqIndex::memory_bytes() const {
+    size_t bytes = (centroids_.capacity() + centroid_norms_.capacity() +
+                    codebooks_.capacity() + codeword_norms_.capacity()) * sizeof(float);
+    for (const auto& inv : lists_) {
+        bytes += sizeof(InvList) + inv.rows.capacity() * sizeof(int) + inv.codes.capacity();
+    }
+    bytes += (list_of_.capacity() + pos_in_list_.capacity()) * sizeof(int);
+    return bytes;
+}
+
+} // namespace vp
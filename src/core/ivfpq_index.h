@@ -0,0 +1,121 @@
+#ifndef VP_IVFPQ_INDEX_H
+#define VP_IVFPQ_INDEX_H
+
+#include "core/similarity.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace vp {
+
+/**
+ * Inverted-file index with product quantization (IVF-PQ) for very large
+ * galleries.
+ *
+ * Training runs k-means for `nlist` coarse centroids, then splits the
+ * residuals (x - centroid) into `m` sub-vectors and learns a 256-entry
+ * codebook per sub-space, so every embedding is stored as m bytes.
+ *
+ * A query probes the `nprobe` nearest lists. Because the residual score is
+ * linear, one asymmetric-distance (ADC) table T[m][256] = q_m . codeword is
+ * computed per query and shared by all lists:
+ *   score(x) ~= q . centroid(list) + sum_m T[m][code_m]
+ * Scores are approximate; callers re-rank the shortlist with exact floats.
+ *
+ * Entries are keyed by the owner's row numbers (SpeakerManager uses the
+ * gallery rows), so speaker IDs are held once, by the owner. remove()
+ * mirrors the gallery's swap-remove; search() returns rows. On disk each
+ * entry is labelled with its ID and enroll count, which the owner maps to
+ * and from rows in save() / load().
+ */
+class IvfPqIndex {
+public:
+    static constexpr int KSUB = 256;   // codewords per sub-quantizer (8-bit codes)
+
+    // ID and enroll count of a row, for save()
+    using RowLabel = std::function<std::string_view(int row, int& enroll_count)>;
+    // Row for a saved ID / enroll count, or -1 to drop the entry, for load()
+    using RowLookup = std::function<int(std::string_view speaker_id, int enroll_count)>;
+
+    IvfPqIndex();
+
+    // Learn coarse centroids and PQ codebooks from n row-major vectors.
+    // Drops all entries. dim must be divisible by m.
+    bool train(const float* data, int n, int dim, int nlist, int m, uint32_t seed = 42);
+
+    bool trained() const { return !centroids_.empty(); }
+
+    // Drop entries, keep the trained quantizers
+    void clear_entries();
+
+    // Coarse list of a vector; its m code bytes go to `code`. Requires trained().
+    int encode(const float* embedding, uint8_t* code) const;
+
+    // Insert (or replace) the entry of `row` from encode() output
+    void set(int row, int list, const uint8_t* code);
+
+    // Encode and insert (or replace) the entry of `row`. Requires trained().
+    void add(int row, const float* embedding);
+
+    // Track `rows` rows: new rows have no entry, cut rows lose theirs
+    void resize(int rows);
+
+    // Drop the entry of `row` and move the entry of the last row into its
+    // slot, as SpeakerGallery::remove() does with its rows
+    void remove(int row);
+
+    // Whether `row` has an entry (rows are added out of order while syncing)
+    bool has(int row) const {
+        return row >= 0 && row < rows() && list_of_[row] >= 0;
+    }
+
+    // Best `n` rows by approximate score over the nprobe nearest lists,
+    // in descending order. Returns the count written.
+    int search(const float* query, int n, int nprobe, ScoredIndex* out) const;
+
+    int rows() const       { return static_cast<int>(list_of_.size()); }
+    int size() const       { return size_; }
+    int dim() const        { return dim_; }
+    int nlist() const      { return nlist_; }
+    int code_bytes() const { return m_; }
+
+    // Binary persistence of quantizers and codes
+    bool save(const std::string& path, const RowLabel& label) const;
+    bool load(const std::string& path, const RowLookup& lookup);
+
+    size_t memory_bytes() const;
+
+    const std::string& last_error() const { return last_error_; }
+
+private:
+    struct InvList {
+        std::vector<int> rows;         // owner rows
+        std::vector<uint8_t> codes;    // rows.size() x m_
+    };
+
+    int  assign_list(const float* x) const;
+    void drop(int row);
+
+    int dim_ = 0;
+    int nlist_ = 0;
+    int m_ = 0;
+    int dsub_ = 0;
+    int size_ = 0;
+
+    std::vector<float> centroids_;       // nlist x dim
+    std::vector<float> centroid_norms_;  // squared L2 norm per centroid
+    std::vector<float> codebooks_;       // m x KSUB x dsub
+    std::vector<float> codeword_norms_;  // m x KSUB squared norms
+
+    std::vector<InvList> lists_;
+    std::vector<int> list_of_;           // row -> list, -1 if the row has no entry
+    std::vector<int> pos_in_list_;       // row -> position in its list
+
+    std::string last_error_;
+};
+
+} // namespace vp
+
+#endif // VP_IVFPQ_INDEX_H
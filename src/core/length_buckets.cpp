@@ -0,0 +1,87 @@
+#include "core/length_buckets.h"
+#include <algorithm>
+#include <cmath>
+
+namespace vp {
+
+LengthBuckets::LengthBuckets(std::vector<int> frames) : frames_(std::move(frames)) {
+    frames_.erase(std::remove_if(frames_.begin(), frames_.end(), [](int f) { return f < 1; }),
+                  frames_.end());
+    std::sort(frames_.begin(), frames_.end());
+    frames_.erase(std::unique(frames_.begin(), frames_.end()), frames_.end());
+}
+
+LengthBuckets LengthBuckets::geometric(int min_frames, int max_frames, float ratio) {
+    std::vector<int> frames;
+    for (int f = std::max(min_frames, 1); f < max_frames;) {
+        frames.push_back(f);
+        // Round down to 10 frames, but always advance
+        const int next = static_cast<int>(std::floor(f * ratio / 10.0f)) * 10;
+        f = std::max(next, f + 1);
+    }
+    frames.push_back(max_frames);
+    return LengthBuckets(std::move(frames));
+}
+
+LengthBuckets LengthBuckets::defaults() {
+    return geometric(150, 3000, 1.125f);
+}
+
+int LengthBuckets::pad_to(int frames) const {
+    if (frames_.empty()) return frames;
+    auto it = std::lower_bound(frames_.begin(), frames_.end(), frames);
+    if (it != frames_.end()) return *it;
+    return (frames + FRAMES_PER_SECOND - 1) / FRAMES_PER_SECOND * FRAMES_PER_SECOND;
+}
+
+int LengthBuckets::crop_to(int frames) const {
+    if (frames_.empty()) return frames;
+    if (frames > frames_.back()) {
+        return std::max(frames / FRAMES_PER_SECOND * FRAMES_PER_SECOND, frames_.back());
+    }
+    auto it = std::upper_bound(frames_.begin(), frames_.end(), frames);
+    return it == frames_.begin() ? frames_.front() : *(it - 1);
+}
+
+std::vector<float> LengthBuckets::seconds() const {
+    std::vector<float> out;
+    out.reserve(frames_.size());
+    for (int f : frames_) out.push_back((f - 1) * 0.010f + 0.025f);
+    return out;
+}
+
+void fit_frames(const float* src, int frames, int bins, int target, bool zero_pad, float* dst) {
+    const size_t row = static_cast<size_t>(bins);
+    const int copied = std::min(frames, target);
+    std::copy_n(src, copied * row, dst);
+    for (int t = copied; t < target; ++t) {
+        float* out = dst + t * row;
+        if (zero_pad) {
+            std::fill_n(out, row, 0.0f);
+        } else {
+            std::copy_n(src + (t % frames) * row, row, out);
+        }
+    }
+}
+
+std::vector<BatchGroup> plan_batches(const std::vector<int>& targets, std::vector<int>& order,
+                                     int max_batch, bool zero_pad, float max_pad_ratio) {
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return targets[a] < targets[b]; });
+
+    std::vector<BatchGroup> groups;
+    const int n = static_cast<int>(order.size());
+    for (int g = 0; g < n;) {
+        const int shortest = targets[order[g]];
+        const int longest = zero_pad
+            ? static_cast<int>(std::floor(shortest * (1.0f + max_pad_ratio)))
+            : shortest;
+        int end = g + 1;
+        while (end < n && end - g < max_batch && targets[order[end]] <= longest) ++end;
+        groups.push_back({g, end - g, targets[order[end - 1]]});
+        g = end;
+    }
+    return groups;
+}
+
+} // namespace vp
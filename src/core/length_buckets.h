@@ -0,0 +1,78 @@
+#ifndef VP_LENGTH_BUCKETS_H
+#define VP_LENGTH_BUCKETS_H
+
+#include <vector>
+
+namespace vp {
+
+/**
+ * Bucketing policy for the time axis of variable-length model inputs.
+ *
+ * ONNX Runtime caches a memory plan per input shape; feeding the exact
+ * frame count of every utterance defeats that cache and fragments the
+ * arena over millions of distinct shapes. With a policy set, inputs are
+ * padded or cropped to one of a few bucket lengths, so each bucket reuses
+ * one plan. Which way an input goes is the model's rule: models that mask
+ * padded frames (relative-length input) pad up, the others crop down so no
+ * synthetic frames reach their pooling.
+ *
+ * Lengths past the largest bucket snap to whole seconds (100 frames), which
+ * still bounds the number of shapes. Immutable; shared read-only.
+ */
+class LengthBuckets {
+public:
+    // Bucket lengths in frames (sorted and deduplicated; values < 1 dropped)
+    explicit LengthBuckets(std::vector<int> frames);
+
+    // Geometric series from min_frames to max_frames, each bucket at most
+    // `ratio` times the previous, rounded to 10 frames
+    static LengthBuckets geometric(int min_frames, int max_frames, float ratio);
+
+    // Default set: 1.5 s .. 30 s, 12.5% apart (29 buckets)
+    static LengthBuckets defaults();
+
+    // Smallest bucket >= frames (padding target)
+    int pad_to(int frames) const;
+
+    // Largest bucket <= frames (cropping target); below the smallest bucket
+    // the smallest, which the input is padded up to
+    int crop_to(int frames) const;
+
+    const std::vector<int>& frames() const { return frames_; }
+    bool empty() const { return frames_.empty(); }
+
+    // Audio length (seconds) whose FBank has exactly each bucket's frame
+    // count (25 ms windows, 10 ms shift), e.g. for warming up every bucket
+    std::vector<float> seconds() const;
+
+    static constexpr int FRAMES_PER_SECOND = 100;
+
+private:
+    std::vector<int> frames_;
+};
+
+// Copy [frames x bins] at src into [target x bins] at dst: the first
+// `target` frames if the input is longer, otherwise the input followed by
+// zeros (zero_pad) or by its own frames repeated cyclically
+void fit_frames(const float* src, int frames, int bins, int target, bool zero_pad, float* dst);
+
+// One model call of a batch plan: order[begin, begin + count), run at
+// `target` frames
+struct BatchGroup {
+    int begin;
+    int count;
+    int target;
+};
+
+// Plan the model calls for items order[..] whose model lengths are
+// targets[item]: sorts `order` by target and cuts it into groups of up to
+// max_batch. With zero_pad (models that mask by relative length) a group
+// spans targets up to (1 + max_pad_ratio) times its shortest and runs at
+// its longest; otherwise only equal targets share a call, since padding
+// would reach the pooling.
+std::vector<BatchGroup> plan_batches(const std::vector<int>& targets, std::vector<int>& order,
+                                     int max_batch, bool zero_pad, float max_pad_ratio);
+
+} // namespace vp
+
+#endif // VP_LENGTH_BUCKETS_H
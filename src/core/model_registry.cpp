@@ -0,0 +1,57 @@
+#include "core/model_registry.h"
+#include "core/onnx_model.h"
+#include "utils/logger.h"
+#include <onnxruntime_cxx_api.h>
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+namespace vp {
+
+namespace {
+
+std::mutex g_mutex;
+std::map<std::string, std::weak_ptr<OnnxModel>> g_models;   // path + options -> model
+std::weak_ptr<Ort::PrepackedWeightsContainer> g_prepacked;   // alive while any model is
+
+} // anonymous namespace
+
+std::shared_ptr<OnnxModel> acquire_model(const std::string& path, Ort::Env& env,
+                                         ModelKind kind) {
+    // Same file under different spellings is one entry
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    const std::string key = (ec ? path : canonical.string()) + "\n" + session_key(kind);
+
+    // Loads are serialized; they only happen at init
+    std::lock_guard lock(g_mutex);
+    for (auto it = g_models.begin(); it != g_models.end();) {
+        it = it->second.expired() ? g_models.erase(it) : std::next(it);
+    }
+    auto found = g_models.find(key);
+    if (found != g_models.end()) {
+        if (auto model = found->second.lock()) {
+            VP_LOG_INFO("ONNX model shared: {} ({} holders)", path, model.use_count() - 1);
+            return model;
+        }
+    }
+
+    auto prepacked = g_prepacked.lock();
+    if (!prepacked) {
+        prepacked = std::make_shared<Ort::PrepackedWeightsContainer>();
+        g_prepacked = prepacked;
+    }
+    auto model = std::make_shared<OnnxModel>();
+    if (!model->load(path, env, kind, prepacked)) return nullptr;
+    g_models[key] = model;
+    return model;
+}
+
+size_t loaded_model_count() {
+    std::lock_guard lock(g_mutex);
+    size_t count = 0;
+    for (const auto& entry : g_models) count += entry.second.expired() ? 0 : 1;
+    return count;
+}
+
+} // namespace vp
@@ -0,0 +1,39 @@
+#ifndef VP_MODEL_REGISTRY_H
+#define VP_MODEL_REGISTRY_H
+
+#include "core/ort_threading.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace vp {
+
+class OnnxModel;
+
+/**
+ * Process-wide registry of loaded ONNX models.
+ *
+ * SpeakerManager, VoiceAnalyzer and Diarizer each run the VAD, and the
+ * diarizer runs the speaker model as well. acquire_model() loads a file
+ * once per set of session options (path + core/ort_threading.h settings)
+ * and hands later callers the same OnnxModel, whose run() and bindings are
+ * safe to use concurrently; memory and load time then scale with distinct
+ * models, not with subsystems. Entries are reference-counted: a model is
+ * unloaded when its last holder lets go (vp_release), so a later acquire
+ * loads the file afresh. Sessions loaded while any model is held share one
+ * ORT prepacked-weights container, keeping a single copy of repacked
+ * constant weights across sessions of the same file with different
+ * options. Thread-safe.
+ */
+
+// Model at `path` with the session options of `kind`, loaded on first
+// request. Null if loading failed (OnnxModel::last_error() set).
+std::shared_ptr<OnnxModel> acquire_model(const std::string& path, Ort::Env& env,
+                                         ModelKind kind);
+
+// Models currently loaded (distinct path + options)
+size_t loaded_model_count();
+
+} // namespace vp
+
+#endif // VP_MODEL_REGISTRY_H
@@ -1,26 +1,34 @@
 #include "core/onnx_model.h"
+#include "utils/hash.h"
 #include "utils/logger.h"
 #include <algorithm>
+#include <filesystem>
+#include <type_traits>
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
 namespace vp {
 
+thread_local std::string OnnxModel::last_error_;
+
 OnnxModel::OnnxModel() = default;
 OnnxModel::~OnnxModel() = default;
 
-bool OnnxModel::load(const std::string& model_path, Ort::Env& env, int num_threads) {
+bool OnnxModel::load(const std::string& model_path, Ort::Env& env, ModelKind kind,
+                     std::shared_ptr<Ort::PrepackedWeightsContainer> prepacked) {
     try {
-        session_options_.SetIntraOpNumThreads(num_threads);
-        session_options_.SetInterOpNumThreads(1);
+        configure_session(session_options_, kind);
         session_options_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
 
         // Convert to wide string for Windows (UTF-8 safe)
         int wlen = MultiByteToWideChar(CP_UTF8, 0, model_path.c_str(), -1, nullptr, 0);
         std::wstring wpath(wlen, 0);
         MultiByteToWideChar(CP_UTF8, 0, model_path.c_str(), -1, &wpath[0], wlen);
-        session_ = std::make_unique<Ort::Session>(env, wpath.c_str(), session_options_);
+        prepacked_ = std::move(prepacked);
+        session_ = prepacked_
+            ? std::make_unique<Ort::Session>(env, wpath.c_str(), session_options_, *prepacked_)
+            : std::make_unique<Ort::Session>(env, wpath.c_str(), session_options_);
 
         // Query input names
         size_t num_inputs = session_->GetInputCount();
@@ -29,15 +37,27 @@ bool OnnxModel::load(const std::string& model_path, Ort::Env& env, int num_threa
             auto name = session_->GetInputNameAllocated(i, allocator_);
             input_names_.push_back(name.get());
         }
+        input_name_ptrs_.clear();
+        for (const auto& name : input_names_) input_name_ptrs_.push_back(name.c_str());
 
         // Query output names
         size_t num_outputs = session_->GetOutputCount();
         output_names_.clear();
+        output_shapes_.clear();
         for (size_t i = 0; i < num_outputs; ++i) {
             auto name = session_->GetOutputNameAllocated(i, allocator_);
             output_names_.push_back(name.get());
         }
 
+        namespace fs = std::filesystem;
+        const fs::path path(model_path);
+        std::error_code ec;
+        const uint64_t file_size = fs::file_size(path, ec);
+        const int64_t mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+        fingerprint_ = xxhash64(model_path.data(), model_path.size());
+        fingerprint_ = xxhash64(&file_size, sizeof(file_size), fingerprint_);
+        fingerprint_ = xxhash64(&mtime, sizeof(mtime), fingerprint_);
+
         loaded_ = true;
         VP_LOG_INFO("ONNX model loaded: {} (inputs={}, outputs={})",
                     model_path, num_inputs, num_outputs);
@@ -54,7 +74,8 @@ bool OnnxModel::load(const std::string& model_path, Ort::Env& env, int num_threa
         }
 
         for (size_t i = 0; i < num_outputs; ++i) {
-            auto shape = get_output_shape(static_cast<int>(i));
+            output_shapes_.push_back(get_output_shape(static_cast<int>(i)));
+            const auto& shape = output_shapes_.back();
             std::string shape_str = "[";
             for (size_t j = 0; j < shape.size(); ++j) {
                 if (j > 0) shape_str += ", ";
@@ -109,6 +130,195 @@ std::vector<float> OnnxModel::run(const std::vector<float>& input,
     }
 }
 
+std::vector<float> OnnxModel::run(const std::vector<const float*>& inputs,
+                                  const std::vector<std::vector<int64_t>>& input_shapes) {
+    std::vector<float> output;
+    run(inputs, input_shapes, output);
+    return output;
+}
+
+bool OnnxModel::run(const std::vector<const float*>& inputs,
+                    const std::vector<std::vector<int64_t>>& input_shapes,
+                    std::vector<float>& output) {
+    output.clear();
+    if (!loaded_) {
+        last_error_ = "Model not loaded";
+        return false;
+    }
+    if (inputs.size() != input_shapes.size() || inputs.size() > input_names_.size() ||
+        inputs.size() > MAX_INPUTS) {
+        last_error_ = "Model expects " + std::to_string(input_names_.size()) + " inputs";
+        return false;
+    }
+
+    try {
+        Ort::Value tensors[MAX_INPUTS] = {Ort::Value(nullptr), Ort::Value(nullptr),
+                                          Ort::Value(nullptr), Ort::Value(nullptr)};
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            size_t count = 1;
+            for (auto dim : input_shapes[i]) count *= static_cast<size_t>(dim);
+            tensors[i] = Ort::Value::CreateTensor<float>(
+                memory_info_, const_cast<float*>(inputs[i]), count,
+                input_shapes[i].data(), input_shapes[i].size());
+        }
+        const char* output_name = output_names_[0].c_str();
+
+        auto outputs = session_->Run(Ort::RunOptions{nullptr},
+                                     input_name_ptrs_.data(), tensors, inputs.size(),
+                                     &output_name, 1);
+
+        auto& output_tensor = outputs[0];
+        size_t output_size = output_tensor.GetTensorTypeAndShapeInfo().GetElementCount();
+        const float* output_data = output_tensor.GetTensorData<float>();
+        output.assign(output_data, output_data + output_size);
+        return true;
+    } catch (const Ort::Exception& e) {
+        last_error_ = std::string("ONNX inference error: ") + e.what();
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+}
+
+std::unique_ptr<OnnxModel::Binding> OnnxModel::create_binding() {
+    if (!loaded_) {
+        last_error_ = "Model not loaded";
+        return nullptr;
+    }
+    try {
+        return std::unique_ptr<Binding>(new Binding(*this));
+    } catch (const Ort::Exception& e) {
+        last_error_ = std::string("ONNX binding error: ") + e.what();
+        VP_LOG_ERROR(last_error_);
+        return nullptr;
+    }
+}
+
+bool OnnxModel::run_into(Binding& binding, const std::vector<const float*>& inputs,
+                         const std::vector<std::vector<int64_t>>& input_shapes,
+                         Span<float> output) {
+    if (!loaded_) {
+        last_error_ = "Model not loaded";
+        return false;
+    }
+    if (inputs.size() != input_shapes.size() || inputs.size() > input_names_.size() ||
+        output_shapes_.empty()) {
+        last_error_ = "Model expects " + std::to_string(input_names_.size()) + " inputs";
+        return false;
+    }
+
+    // Declared output shape, its dynamic dimension sized to fit the buffer
+    std::vector<int64_t>& shape = binding.output_shape_;
+    shape = output_shapes_[0];
+    size_t known = 1;
+    int dynamic = -1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] >= 0) {
+            known *= static_cast<size_t>(shape[i]);
+        } else if (dynamic < 0) {
+            dynamic = static_cast<int>(i);
+        } else {
+            last_error_ = "Model output has more than one dynamic dimension";
+            return false;
+        }
+    }
+    if (dynamic >= 0 && known > 0 && output.size() % known == 0) {
+        shape[dynamic] = static_cast<int64_t>(output.size() / known);
+        known = output.size();
+    }
+    if (known != output.size()) {
+        last_error_ = "Output buffer of " + std::to_string(output.size()) +
+                      " floats does not fit the model output";
+        return false;
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!binding.bind_input(i, inputs[i], input_shapes[i].data(), input_shapes[i].size())) {
+            return false;
+        }
+    }
+    return binding.bind_output(0, output.data(), shape.data(), shape.size()) && binding.run();
+}
+
+int OnnxModel::input_index(const std::string& name) const {
+    auto it = std::find(input_names_.begin(), input_names_.end(), name);
+    return it == input_names_.end() ? -1 : static_cast<int>(it - input_names_.begin());
+}
+
+int OnnxModel::output_index(const std::string& name) const {
+    auto it = std::find(output_names_.begin(), output_names_.end(), name);
+    return it == output_names_.end() ? -1 : static_cast<int>(it - output_names_.begin());
+}
+
+OnnxModel::Binding::Binding(OnnxModel& model)
+    : model_(model),
+      binding_(*model.session_),
+      inputs_(model.input_names_.size()),
+      outputs_(model.output_names_.size()) {}
+
+template <typename T>
+bool OnnxModel::Binding::bind(bool input, size_t index, T* data, const int64_t* shape,
+                              size_t rank) {
+    std::vector<Slot>& slots = input ? inputs_ : outputs_;
+    if (index >= slots.size()) {
+        last_error_ = std::string("Model has no ") + (input ? "input " : "output ") +
+                      std::to_string(index);
+        return false;
+    }
+    Slot& slot = slots[index];
+    if (slot.data == data && slot.shape.size() == rank &&
+        std::equal(shape, shape + rank, slot.shape.begin())) {
+        return true;
+    }
+
+    try {
+        using Element = std::remove_const_t<T>;
+        size_t count = 1;
+        for (size_t i = 0; i < rank; ++i) count *= static_cast<size_t>(shape[i]);
+        // The bound tensor views the caller's memory; ORT keeps its own reference
+        Ort::Value value = Ort::Value::CreateTensor<Element>(
+            model_.memory_info_, const_cast<Element*>(data), count, shape, rank);
+        if (input) {
+            binding_.BindInput(model_.input_names_[index].c_str(), value);
+        } else {
+            binding_.BindOutput(model_.output_names_[index].c_str(), value);
+        }
+    } catch (const Ort::Exception& e) {
+        slot.data = nullptr;
+        last_error_ = std::string("ONNX binding error: ") + e.what();
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+    slot.data = data;
+    slot.shape.assign(shape, shape + rank);
+    return true;
+}
+
+bool OnnxModel::Binding::bind_input(size_t index, const float* data, const int64_t* shape,
+                                    size_t rank) {
+    return bind(true, index, data, shape, rank);
+}
+
+bool OnnxModel::Binding::bind_input(size_t index, const int64_t* data, const int64_t* shape,
+                                    size_t rank) {
+    return bind(true, index, data, shape, rank);
+}
+
+bool OnnxModel::Binding::bind_output(size_t index, float* data, const int64_t* shape,
+                                     size_t rank) {
+    return bind(false, index, data, shape, rank);
+}
+
+bool OnnxModel::Binding::run() {
+    try {
+        model_.session_->Run(Ort::RunOptions{nullptr}, binding_);
+        return true;
+    } catch (const Ort::Exception& e) {
+        last_error_ = std::string("ONNX inference error: ") + e.what();
+        VP_LOG_ERROR(last_error_);
+        return false;
+    }
+}
+
 std::string OnnxModel::get_input_name(int index) const {
     if (index < 0 || index >= static_cast<int>(input_names_.size())) return "";
     return input_names_[index];
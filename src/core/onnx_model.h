@@ -1,6 +1,8 @@
 #ifndef VP_ONNX_MODEL_H
 #define VP_ONNX_MODEL_H
 
+#include "core/ort_threading.h"
+#include "utils/span.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -10,15 +12,85 @@ namespace vp {
 
 class OnnxModel {
 public:
+    /**
+     * IoBinding of one model for one caller at a time (a pooled context, a
+     * detector loop). Inputs and outputs are bound over caller memory that
+     * persists across runs (pooled buffers). Binding the same pointer and
+     * shape again is a no-op, so a run in steady state creates no tensors,
+     * allocates no outputs and lets ORT reuse its feed/fetch setup. The
+     * model must outlive the binding.
+     */
+    class Binding {
+    public:
+        // Bind input `index` (model input order) over caller memory.
+        // Returns false (model's last_error() set) on failure.
+        bool bind_input(size_t index, const float* data, const int64_t* shape, size_t rank);
+        bool bind_input(size_t index, const int64_t* data, const int64_t* shape, size_t rank);
+
+        // Bind output `index` into caller memory of this shape; Run writes
+        // there directly
+        bool bind_output(size_t index, float* data, const int64_t* shape, size_t rank);
+
+        // Run with the current bindings. Returns false (model's
+        // last_error() set) on failure.
+        bool run();
+
+    private:
+        friend class OnnxModel;
+        explicit Binding(OnnxModel& model);
+
+        struct Slot {
+            const void* data = nullptr;
+            std::vector<int64_t> shape;
+        };
+        template <typename T>
+        bool bind(bool input, size_t index, T* data, const int64_t* shape, size_t rank);
+
+        OnnxModel& model_;
+        Ort::IoBinding binding_;
+        std::vector<Slot> inputs_;
+        std::vector<Slot> outputs_;
+        std::vector<int64_t> output_shape_;         // run_into() scratch
+    };
+
     OnnxModel();
     ~OnnxModel();
 
-    // Load model from file
-    bool load(const std::string& model_path, Ort::Env& env, int num_threads = 2);
+    // Load model from file, threaded as configured for `kind`
+    // (core/ort_threading.h). Sessions given the same `prepacked` container
+    // share repacked weights; the model keeps it alive. Shared models come
+    // from core/model_registry.h.
+    bool load(const std::string& model_path, Ort::Env& env, ModelKind kind,
+              std::shared_ptr<Ort::PrepackedWeightsContainer> prepacked = nullptr);
 
     // Run inference
     std::vector<float> run(const std::vector<float>& input, const std::vector<int64_t>& input_shape);
 
+    // Run inference on a model with several float inputs, fed in model input
+    // order. Returns the first output flattened.
+    std::vector<float> run(const std::vector<const float*>& inputs,
+                           const std::vector<std::vector<int64_t>>& input_shapes);
+
+    // Same, into `output` (capacity reused). Returns false on failure.
+    bool run(const std::vector<const float*>& inputs,
+             const std::vector<std::vector<int64_t>>& input_shapes,
+             std::vector<float>& output);
+
+    // New binding for one caller; null (last_error() set) if the model is
+    // not loaded or ORT refuses
+    std::unique_ptr<Binding> create_binding();
+
+    // Run through `binding` (inputs in model input order), writing the first
+    // output into `output`. Its shape is the model's declared output shape
+    // with the one dynamic dimension, if any, sized to fit output.size().
+    // Returns false if the output does not fit or inference failed.
+    bool run_into(Binding& binding, const std::vector<const float*>& inputs,
+                  const std::vector<std::vector<int64_t>>& input_shapes, Span<float> output);
+
+    // Index of the input/output with this name, -1 if there is none
+    int input_index(const std::string& name) const;
+    int output_index(const std::string& name) const;
+
     // Get input/output info
     std::string get_input_name(int index = 0) const;
     std::string get_output_name(int index = 0) const;
@@ -28,9 +100,17 @@ public:
     size_t get_output_count() const;
 
     bool is_loaded() const { return loaded_; }
-    const std::string& last_error() const { return last_error_; }
+
+    // Identifies the loaded model file (path, size, modification time), so
+    // cached results are not served across a model update. 0 before load().
+    uint64_t fingerprint() const { return fingerprint_; }
+
+    // Error of the calling thread's last failed call. run() is thread-safe
+    // (ORT sessions support concurrent Run), so errors are kept per thread.
+    static const std::string& last_error() { return last_error_; }
 
 private:
+    std::shared_ptr<Ort::PrepackedWeightsContainer> prepacked_;   // outlives session_
     std::unique_ptr<Ort::Session> session_;
     Ort::SessionOptions session_options_;
     Ort::MemoryInfo memory_info_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
@@ -38,9 +118,14 @@ private:
 
     std::vector<std::string> input_names_;
     std::vector<std::string> output_names_;
+    std::vector<const char*> input_name_ptrs_;   // c_str() of input_names_
+    std::vector<std::vector<int64_t>> output_shapes_;   // declared, -1 for dynamic dims
+
+    static constexpr size_t MAX_INPUTS = 4;
 
+    uint64_t fingerprint_ = 0;
     bool loaded_ = false;
-    std::string last_error_;
+    static thread_local std::string last_error_;
 };
 
 } // namespace vp
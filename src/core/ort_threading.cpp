@@ -0,0 +1,146 @@
+#include "core/ort_threading.h"
+#include "utils/logger.h"
+#include <onnxruntime_cxx_api.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace vp {
+
+namespace {
+
+std::mutex g_mutex;
+ThreadingConfig g_configs[MODEL_KIND_COUNT] = {
+    default_threading(ModelKind::SPEAKER),
+    default_threading(ModelKind::VAD),
+    default_threading(ModelKind::ANALYZER)};
+std::optional<ThreadingConfig> g_pool;       // requested global pool
+std::optional<ThreadingConfig> g_env_pool;   // global pool of the current environment
+std::unique_ptr<Ort::Env> g_env;
+
+// "N" or "N-M" with 1 <= N <= M
+bool valid_core_range(const std::string& item) {
+    const size_t dash = item.find('-');
+    const std::string first = item.substr(0, dash);
+    const std::string last = dash == std::string::npos ? first : item.substr(dash + 1);
+    auto number = [](const std::string& s, int& out) {
+        if (s.empty() || s.size() > 6 || s.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        out = std::stoi(s);
+        return out >= 1;
+    };
+    int lo = 0, hi = 0;
+    return number(first, lo) && number(last, hi) && lo <= hi;
+}
+
+} // anonymous namespace
+
+std::string validate_threading(const ThreadingConfig& config) {
+    if (config.intra_op_threads < 0 || config.inter_op_threads < 0) {
+        return "thread counts must be >= 0";
+    }
+    if (config.affinity.empty()) return {};
+    if (config.intra_op_threads < 2) {
+        return "affinity needs intra_op_threads >= 2 (the caller's thread is not pinned)";
+    }
+
+    int groups = 0;
+    size_t start = 0;
+    while (start <= config.affinity.size()) {
+        size_t end = config.affinity.find(';', start);
+        if (end == std::string::npos) end = config.affinity.size();
+        const std::string group = config.affinity.substr(start, end - start);
+        size_t item_start = 0;
+        while (item_start <= group.size()) {
+            size_t item_end = group.find(',', item_start);
+            if (item_end == std::string::npos) item_end = group.size();
+            if (!valid_core_range(group.substr(item_start, item_end - item_start))) {
+                return "bad affinity group '" + group + "': expected cores like 3, 1-4 or 1,3";
+            }
+            item_start = item_end + 1;
+        }
+        ++groups;
+        start = end + 1;
+    }
+    if (groups != config.intra_op_threads - 1) {
+        return "affinity has " + std::to_string(groups) + " groups, expected " +
+               std::to_string(config.intra_op_threads - 1) + " (intra_op_threads - 1)";
+    }
+    return {};
+}
+
+ThreadingConfig default_threading(ModelKind kind) {
+    ThreadingConfig config;
+    config.intra_op_threads = kind == ModelKind::VAD ? 1 : 2;
+    config.inter_op_threads = 1;
+    return config;
+}
+
+void set_threading(ModelKind kind, const ThreadingConfig& config) {
+    std::lock_guard lock(g_mutex);
+    g_configs[static_cast<int>(kind)] = config;
+}
+
+ThreadingConfig threading(ModelKind kind) {
+    std::lock_guard lock(g_mutex);
+    return g_configs[static_cast<int>(kind)];
+}
+
+void set_global_thread_pool(const ThreadingConfig* config) {
+    std::lock_guard lock(g_mutex);
+    g_pool = config ? std::optional<ThreadingConfig>(*config) : std::nullopt;
+}
+
+Ort::Env& ort_env(bool recreate) {
+    std::lock_guard lock(g_mutex);
+    if (g_env && (!recreate || g_env_pool == g_pool)) return *g_env;
+
+    g_env.reset();
+    if (g_pool) {
+        Ort::ThreadingOptions options;
+        options.SetGlobalIntraOpNumThreads(g_pool->intra_op_threads);
+        options.SetGlobalInterOpNumThreads(g_pool->inter_op_threads);
+        options.SetGlobalSpinControl(g_pool->spin ? 1 : 0);
+        if (!g_pool->affinity.empty()) {
+            Ort::ThrowOnError(Ort::GetApi().SetGlobalIntraOpThreadAffinity(
+                options, g_pool->affinity.c_str()));
+        }
+        g_env = std::make_unique<Ort::Env>(options, ORT_LOGGING_LEVEL_WARNING, "voiceprint");
+        VP_LOG_INFO("ORT environment with global thread pools: intra={}, inter={}, spin={}, "
+                    "affinity='{}'", g_pool->intra_op_threads, g_pool->inter_op_threads,
+                    g_pool->spin, g_pool->affinity);
+    } else {
+        g_env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "voiceprint");
+    }
+    g_env_pool = g_pool;
+    return *g_env;
+}
+
+void configure_session(Ort::SessionOptions& options, ModelKind kind) {
+    std::lock_guard lock(g_mutex);
+    if (g_env_pool) {
+        options.DisablePerSessionThreads();
+        return;
+    }
+    const ThreadingConfig& config = g_configs[static_cast<int>(kind)];
+    const char* spin = config.spin ? "1" : "0";
+    options.SetIntraOpNumThreads(config.intra_op_threads);
+    options.SetInterOpNumThreads(config.inter_op_threads);
+    options.AddConfigEntry("session.intra_op.allow_spinning", spin);
+    options.AddConfigEntry("session.inter_op.allow_spinning", spin);
+    if (!config.affinity.empty()) {
+        options.AddConfigEntry("session.intra_op_thread_affinities", config.affinity.c_str());
+    }
+}
+
+std::string session_key(ModelKind kind) {
+    std::lock_guard lock(g_mutex);
+    if (g_env_pool) return "global";
+    const ThreadingConfig& config = g_configs[static_cast<int>(kind)];
+    return std::to_string(config.intra_op_threads) + "/" +
+           std::to_string(config.inter_op_threads) + "/" + (config.spin ? "spin" : "block") +
+           "/" + config.affinity;
+}
+
+} // namespace vp
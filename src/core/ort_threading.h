@@ -0,0 +1,67 @@
+#ifndef VP_ORT_THREADING_H
+#define VP_ORT_THREADING_H
+
+#include <string>
+
+namespace Ort {
+    struct Env;
+    struct SessionOptions;
+}
+
+namespace vp {
+
+// Model families with their own session threading (VP_MODEL_* order)
+enum class ModelKind { SPEAKER = 0, VAD = 1, ANALYZER = 2 };
+constexpr int MODEL_KIND_COUNT = 3;
+
+// ONNX Runtime threading of one session, or of the global pools
+struct ThreadingConfig {
+    int intra_op_threads = 0;    // incl. the calling thread; 0: ORT default (one per core)
+    int inter_op_threads = 0;    // 0: ORT default
+    bool spin = true;            // idle workers spin-wait (ORT default) or block
+    std::string affinity;        // ORT intra-op affinity string; empty: not pinned
+
+    bool operator==(const ThreadingConfig& other) const {
+        return intra_op_threads == other.intra_op_threads &&
+               inter_op_threads == other.inter_op_threads && spin == other.spin &&
+               affinity == other.affinity;
+    }
+    bool operator!=(const ThreadingConfig& other) const { return !(*this == other); }
+};
+
+// Check a config before it reaches ORT: non-negative counts, and an
+// affinity of 1-based core ids or ranges ("3", "1-4", "1,3") with one
+// ';'-separated group per intra-op thread after the caller's. Returns an
+// empty string, or what is wrong.
+std::string validate_threading(const ThreadingConfig& config);
+
+// Built-in settings: 2 intra-op threads for the speaker and analysis
+// models, 1 for the VAD; 1 inter-op thread; spinning on
+ThreadingConfig default_threading(ModelKind kind);
+
+// Process-wide settings, read when a session is created (OnnxModel::load)
+void set_threading(ModelKind kind, const ThreadingConfig& config);
+ThreadingConfig threading(ModelKind kind);
+
+// One shared intra-op / inter-op pool for all sessions (`config`), or a
+// pool per session (null, default). Takes effect when the environment is
+// next created, see ort_env().
+void set_global_thread_pool(const ThreadingConfig* config);
+
+// The ONNX Runtime environment every session is created in, created on
+// first use. With `recreate`, an environment whose global pool no longer
+// matches set_global_thread_pool() is replaced: only while no session
+// exists (SpeakerManager::init).
+Ort::Env& ort_env(bool recreate = false);
+
+// Thread options of a new session of `kind`: its thread counts, spinning
+// and affinity, or none when the environment provides global pools
+void configure_session(Ort::SessionOptions& options, ModelKind kind);
+
+// Identifies the options configure_session() gives a session of `kind`,
+// so sessions with equal options can be shared (core/model_registry.h)
+std::string session_key(ModelKind kind);
+
+} // namespace vp
+
+#endif // VP_ORT_THREADING_H
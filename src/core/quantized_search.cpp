@@ -0,0 +1,86 @@
+#include "core/quantized_search.h"
+#include "core/simd_dispatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace vp {
+
+namespace {
+
+// Offset that makes the query unsigned for the VNNI (u8 x s8) kernel
+constexpr int QUERY_OFFSET = 128;
+
+} // anonymous namespace
+
+float quantize_int8(const float* x, int dim, int padded_dim,
+                    int8_t* codes, int32_t* out_sum) {
+    float max_abs = 0.0f;
+    for (int i = 0; i < dim; ++i) max_abs = std::max(max_abs, std::fabs(x[i]));
+
+    int32_t sum = 0;
+    float scale = max_abs / 127.0f;
+    if (scale > 0.0f) {
+        float inv = 1.0f / scale;
+        for (int i = 0; i < dim; ++i) {
+            long c = std::lrintf(x[i] * inv);
+            c = std::max(-127L, std::min(127L, c));
+            codes[i] = static_cast<int8_t>(c);
+            sum += static_cast<int32_t>(c);
+        }
+    } else {
+        std::memset(codes, 0, static_cast<size_t>(dim));
+    }
+    if (padded_dim > dim) {
+        std::memset(codes + dim, 0, static_cast<size_t>(padded_dim - dim));
+    }
+    if (out_sum) *out_sum = sum;
+    return scale;
+}
+
+int32_t dot_int8(const int8_t* a, const int8_t* b, int n) {
+    int32_t dot = 0;
+    for (int i = 0; i < n; ++i) dot += static_cast<int32_t>(a[i]) * b[i];
+    return dot;
+}
+
+int int8_find_top_k(const int8_t* query_codes, float query_scale,
+                    const Int8MatrixView& m, int k, ScoredIndex* out) {
+    if (m.rows <= 0 || k <= 0) return 0;
+
+    TopKSelector selector(std::min(k, m.rows));
+    const int stride = m.stride;
+
+    const SimdKernels& kern = simd_kernels();
+    std::vector<uint8_t> query_u8;
+    if (kern.int8_offset_query) {
+        query_u8.resize(stride);
+        for (int i = 0; i < stride; ++i) {
+            query_u8[i] = static_cast<uint8_t>(query_codes[i] + QUERY_OFFSET);
+        }
+    }
+
+    int r = 0;
+    for (; r + 4 <= m.rows; r += 4) {
+        int32_t d[4];
+        const int8_t* block = m.codes + static_cast<size_t>(r) * stride;
+        kern.int8_dot4(query_codes, query_u8.data(), block, stride, d);
+        if (kern.int8_offset_query) {
+            for (int j = 0; j < 4; ++j) d[j] -= QUERY_OFFSET * m.sums[r + j];
+        }
+        for (int j = 0; j < 4; ++j) {
+            float score = query_scale * m.scales[r + j] * static_cast<float>(d[j]);
+            if (score > selector.threshold()) selector.push(r + j, score);
+        }
+    }
+    for (; r < m.rows; ++r) {
+        int32_t d = dot_int8(query_codes, m.codes + static_cast<size_t>(r) * stride, stride);
+        float score = query_scale * m.scales[r] * static_cast<float>(d);
+        if (score > selector.threshold()) selector.push(r, score);
+    }
+
+    return selector.take_sorted(out);
+}
+
+} // namespace vp
@@ -0,0 +1,42 @@
+#ifndef VP_QUANTIZED_SEARCH_H
+#define VP_QUANTIZED_SEARCH_H
+
+#include "core/similarity.h"
+#include <cstdint>
+
+namespace vp {
+
+/**
+ * Int8 scalar quantization for the in-memory gallery.
+ *
+ * Each vector is quantized symmetrically with its own scale:
+ *   x[i] ~= scale * code[i],  code in [-127, 127],  scale = max|x| / 127
+ * so an approximate dot product is scale_a * scale_b * sum(code_a * code_b),
+ * computed entirely in integer arithmetic. Rows also carry the sum of their
+ * codes, which the VNNI kernel (unsigned x signed) needs to undo the +128
+ * offset it applies to the query.
+ */
+struct Int8MatrixView {
+    const int8_t*  codes  = nullptr;   // rows x stride, zero padded
+    const float*   scales = nullptr;   // per-row scale
+    const int32_t* sums   = nullptr;   // per-row sum of codes
+    int rows   = 0;
+    int stride = 0;                    // bytes per row, multiple of 64
+};
+
+// Quantize dim floats into codes[0..padded_dim), zero filling the padding.
+// Returns the scale and writes the code sum to out_sum (may be null).
+float quantize_int8(const float* x, int dim, int padded_dim,
+                    int8_t* codes, int32_t* out_sum);
+
+// Exact integer dot product of two int8 vectors of length n
+int32_t dot_int8(const int8_t* a, const int8_t* b, int n);
+
+// Approximate K best rows for a quantized query (codes padded to m.stride).
+// Writes min(k, rows) entries in descending approximate score order.
+int int8_find_top_k(const int8_t* query_codes, float query_scale,
+                    const Int8MatrixView& m, int k, ScoredIndex* out);
+
+} // namespace vp
+
+#endif // VP_QUANTIZED_SEARCH_H
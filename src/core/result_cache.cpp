@@ -0,0 +1,110 @@
+#include "core/result_cache.h"
+#include "utils/hash.h"
+#include <cstring>
+
+namespace vp {
+
+ResultCache::ResultCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+ResultKey ResultCache::make_key(Span<const float> pcm, uint64_t context) {
+    ResultKey key;
+    key.audio = xxhash64(pcm.data(), pcm.size() * sizeof(float));
+    key.context = context;
+    key.samples = static_cast<uint32_t>(pcm.size());
+    return key;
+}
+
+const std::vector<unsigned char>* ResultCache::find(const ResultKey& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->value;
+}
+
+bool ResultCache::get_embedding(const ResultKey& key, std::vector<float>& embedding) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::vector<unsigned char>* value = find(key);
+    if (!value) return false;
+    embedding.resize(value->size() / sizeof(float));
+    std::memcpy(embedding.data(), value->data(), value->size());
+    return true;
+}
+
+void ResultCache::put_embedding(const ResultKey& key, const std::vector<float>& embedding) {
+    put(key, embedding.data(), embedding.size() * sizeof(float));
+}
+
+bool ResultCache::get_analysis(const ResultKey& key, VpAnalysisResult* result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::vector<unsigned char>* value = find(key);
+    if (!value || value->size() != sizeof(VpAnalysisResult)) return false;
+    std::memcpy(result, value->data(), sizeof(VpAnalysisResult));
+    return true;
+}
+
+void ResultCache::put_analysis(const ResultKey& key, const VpAnalysisResult& result) {
+    put(key, &result, sizeof(result));
+}
+
+void ResultCache::put(const ResultKey& key, const void* data, size_t size) {
+    // Copy outside the lock; a value that alone exceeds the cap is dropped
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::vector<unsigned char> value(bytes, bytes + size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (footprint(size) > max_bytes_) return;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // Concurrent misses on the same audio: keep one copy
+        bytes_ -= footprint(it->second->value.size());
+        it->second->value.swap(value);
+        lru_.splice(lru_.begin(), lru_, it->second);
+    } else {
+        lru_.push_front(Entry{key, std::move(value)});
+        index_.emplace(key, lru_.begin());
+    }
+    bytes_ += footprint(size);
+    evict_to(max_bytes_);
+}
+
+void ResultCache::evict_to(size_t max_bytes) {
+    while (bytes_ > max_bytes && !lru_.empty()) {
+        const Entry& oldest = lru_.back();
+        bytes_ -= footprint(oldest.value.size());
+        index_.erase(oldest.key);
+        lru_.pop_back();
+        ++evictions_;
+    }
+}
+
+void ResultCache::set_capacity(size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_bytes_ = max_bytes;
+    evict_to(max_bytes_);
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s;
+    s.hits = hits_;
+    s.misses = misses_;
+    s.evictions = evictions_;
+    s.entries = index_.size();
+    s.bytes = bytes_;
+    s.capacity = max_bytes_;
+    return s;
+}
+
+} // namespace vp
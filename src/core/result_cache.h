@@ -0,0 +1,104 @@
+#ifndef VP_RESULT_CACHE_H
+#define VP_RESULT_CACHE_H
+
+#include <voiceprint/voiceprint_types.h>
+#include "utils/span.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vp {
+
+// Identifies one computation: the input PCM plus everything else the result
+// depends on (model files, sample rate, feature flags), folded into context
+struct ResultKey {
+    uint64_t audio = 0;     // xxhash64 of the PCM bytes
+    uint64_t context = 0;
+    uint32_t samples = 0;
+
+    bool operator==(const ResultKey& o) const {
+        return audio == o.audio && context == o.context && samples == o.samples;
+    }
+};
+
+/**
+ * Bounded LRU cache of embeddings and analysis results, keyed by a hash of
+ * the audio content. Re-submitted audio (retries, replayed prompts) skips
+ * VAD, FBank and model inference entirely.
+ *
+ * One instance is shared by the extractors of SpeakerManager and Diarizer
+ * and by VoiceAnalyzer; the context part of the key keeps their entries
+ * apart. Memory is capped by max_bytes (values plus per-entry overhead);
+ * the least recently used entries are evicted first. Failed computations
+ * are not cached. Thread-safe.
+ */
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t capacity = 0;
+    };
+
+    explicit ResultCache(size_t max_bytes);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    static ResultKey make_key(Span<const float> pcm, uint64_t context);
+
+    bool get_embedding(const ResultKey& key, std::vector<float>& embedding);
+    void put_embedding(const ResultKey& key, const std::vector<float>& embedding);
+
+    bool get_analysis(const ResultKey& key, VpAnalysisResult* result);
+    void put_analysis(const ResultKey& key, const VpAnalysisResult& result);
+
+    // Shrinking evicts down to the new cap right away
+    void set_capacity(size_t max_bytes);
+    void clear();
+    Stats stats() const;
+
+private:
+    struct Entry {
+        ResultKey key;
+        std::vector<unsigned char> value;
+    };
+
+    struct KeyHash {
+        size_t operator()(const ResultKey& k) const {
+            return static_cast<size_t>(k.audio ^ (k.context * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+
+    using List = std::list<Entry>;
+
+    // Value of `key`, moved to the front, or null; counts the hit / miss
+    // (mutex_ held)
+    const std::vector<unsigned char>* find(const ResultKey& key);
+    void put(const ResultKey& key, const void* data, size_t size);
+    void evict_to(size_t max_bytes);   // mutex_ held
+
+    static size_t footprint(size_t value_size) { return value_size + ENTRY_OVERHEAD; }
+
+    mutable std::mutex mutex_;
+    List lru_;                                                   // front = most recent
+    std::unordered_map<ResultKey, List::iterator, KeyHash> index_;
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+
+    // List node + hash node + key, roughly
+    static constexpr size_t ENTRY_OVERHEAD = sizeof(Entry) + 4 * sizeof(void*) + sizeof(ResultKey);
+};
+
+} // namespace vp
+
+#endif // VP_RESULT_CACHE_H
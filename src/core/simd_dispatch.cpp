@@ -0,0 +1,121 @@
+#include "core/simd_dispatch.h"
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define VP_X86_CPUID 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define VP_X86_CPUID 1
+#endif
+
+namespace vp {
+
+namespace {
+
+#ifdef VP_X86_CPUID
+void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<uint32_t>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// XCR0: register state the OS saves on context switches
+uint64_t xgetbv0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+SimdLevel probe_cpu() {
+    uint32_t r[4];
+    cpuid(0, 0, r);
+    const uint32_t max_leaf = r[0];
+    if (max_leaf < 1) return SimdLevel::SCALAR;
+
+    cpuid(1, 0, r);
+    const bool sse41   = (r[2] >> 19) & 1;
+    const bool fma     = (r[2] >> 12) & 1;
+    const bool osxsave = (r[2] >> 27) & 1;
+    const bool avx     = (r[2] >> 28) & 1;
+    if (!sse41) return SimdLevel::SCALAR;
+    if (!osxsave || !avx || !fma || max_leaf < 7) return SimdLevel::SSE41;
+
+    const uint64_t xcr0 = xgetbv0();
+    if ((xcr0 & 0x6) != 0x6) return SimdLevel::SSE41;   // XMM + YMM state
+
+    cpuid(7, 0, r);
+    const bool avx2      = (r[1] >> 5) & 1;
+    const bool avx512f   = (r[1] >> 16) & 1;
+    const bool avx512bw  = (r[1] >> 30) & 1;
+    const bool avx512vl  = (r[1] >> 31) & 1;
+    const bool avx512vnni = (r[2] >> 11) & 1;
+    if (!avx2) return SimdLevel::SSE41;
+
+    // Opmask + upper ZMM state
+    const bool os_avx512 = (xcr0 & 0xE0) == 0xE0;
+    if (os_avx512 && avx512f && avx512bw && avx512vl && avx512vnni) return SimdLevel::AVX512;
+    return SimdLevel::AVX2;
+}
+#endif
+
+const SimdKernels* kernels_for(SimdLevel level) {
+    // Fall back past levels whose TU was built without its ISA flags
+    const SimdKernels* k = nullptr;
+    switch (level) {
+    case SimdLevel::AVX512: k = simd_kernels_avx512(); if (k) return k; [[fallthrough]];
+    case SimdLevel::AVX2:   k = simd_kernels_avx2();   if (k) return k; [[fallthrough]];
+    case SimdLevel::SSE41:  k = simd_kernels_sse41();  if (k) return k; [[fallthrough]];
+    default:                return simd_kernels_scalar();
+    }
+}
+
+std::atomic<const SimdKernels*> g_active{nullptr};
+
+} // anonymous namespace
+
+SimdLevel detect_simd_level() {
+#ifdef VP_X86_CPUID
+    static const SimdLevel level = probe_cpu();
+    return level;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+const SimdKernels& simd_kernels() {
+    const SimdKernels* k = g_active.load(std::memory_order_acquire);
+    if (!k) {
+        // Racing first calls select the same table
+        k = kernels_for(detect_simd_level());
+        g_active.store(k, std::memory_order_release);
+    }
+    return *k;
+}
+
+SimdLevel set_simd_level(SimdLevel level) {
+    const SimdLevel best = detect_simd_level();
+    if (static_cast<int>(level) > static_cast<int>(best)) level = best;
+    const SimdKernels* k = kernels_for(level);
+    g_active.store(k, std::memory_order_release);
+    return k->level;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SSE41:  return "sse4.1";
+    case SimdLevel::AVX2:   return "avx2";
+    case SimdLevel::AVX512: return "avx512";
+    default:                return "scalar";
+    }
+}
+
+} // namespace vp
@@ -0,0 +1,114 @@
+#ifndef VP_SIMD_DISPATCH_H
+#define VP_SIMD_DISPATCH_H
+
+#include <cstdint>
+
+namespace vp {
+
+/**
+ * Runtime ISA dispatch for the similarity / quantized-search and FBank
+ * kernels.
+ *
+ * Each ISA level lives in its own translation unit (simd_kernels_*.cpp)
+ * compiled with that ISA's flags; the rest of the library is built for the
+ * baseline target. The best level the CPU and OS support is picked once,
+ * on first use, so one binary runs the fastest path on every host.
+ *
+ * The kernel TUs must stay free of inline functions shared with other TUs
+ * (STL containers, <algorithm>, ...): the linker may keep any one copy of
+ * such a function, and an AVX-512 copy would then run on every host.
+ */
+
+// Values mirror VP_SIMD_*
+enum class SimdLevel {
+    SCALAR = 0,
+    SSE41  = 1,   // SSE4.1
+    AVX2   = 2,   // AVX2 + FMA
+    AVX512 = 3,   // AVX-512 F/BW/VL + VNNI
+};
+
+// Largest number of queries a gemm_tile call scores at once
+constexpr int SIMD_GEMM_MAX_MR = 12;
+// Rows per packed panel read by gemm_tile
+constexpr int SIMD_GEMM_NR = 16;
+
+// Lanes (frames per block) of the widest fbank_frames kernel
+constexpr int SIMD_FBANK_MAX_LANES = 16;
+
+// Read-only tables for fbank_frames, built by NativeFbank (fbank_native.h)
+struct FbankKernelTables {
+    int frame_length;           // samples per frame
+    int frame_shift;            // samples between frame starts
+    int fft_size;               // zero-padded frame length, a power of two >= 4
+    float preemph;              // pre-emphasis coefficient
+    const float* window;        // [frame_length]
+    const int* bitrev;          // [fft_size / 2] bit reversal for the half-size complex FFT
+    const float* twiddle;       // [fft_size / 4] complex exp(-2 pi i m / (fft_size / 2))
+    const float* split;         // [fft_size / 4 + 1] complex exp(-2 pi i k / fft_size)
+    int num_bins;
+    const int* mel_first;       // [num_bins] first FFT bin of each triangular filter
+    const int* mel_offset;      // [num_bins + 1] filter b's weights are
+    const float* mel_weights;   //   mel_weights[mel_offset[b] .. mel_offset[b + 1])
+};
+
+struct SimdKernels {
+    SimdLevel level;
+
+    // Unclamped dot product
+    float (*dot)(const float* a, const float* b, int dim);
+
+    // Dot products of one query against 4 rows `stride` floats apart
+    void (*dot4)(const float* q, const float* r, int dim, int stride, float out[4]);
+
+    // c[gemm_mr x NR] = q[gemm_mr x dim] . panel[dim x NR], where panel is
+    // packed column-major (element (i, t) at panel[i * NR + t])
+    int gemm_mr;
+    void (*gemm_tile)(const float* const* q, const float* panel, int dim, float* c);
+
+    // In-place L2 normalization; vectors with norm <= 1e-10 are left as is
+    void (*l2_normalize)(float* v, int dim);
+
+    // Int8 dot products of one query against 4 rows of `stride` bytes
+    // (stride a multiple of 64). With int8_offset_query set the kernel reads
+    // q_u8 (query + 128) and the caller subtracts 128 * row code sum;
+    // otherwise it reads the signed q and the result is exact.
+    bool int8_offset_query;
+    void (*int8_dot4)(const int8_t* q, const uint8_t* q_u8, const int8_t* r, int stride,
+                      int32_t out[4]);
+
+    // Log-mel energies of num_frames snip-edges frames starting at samples,
+    // [num_frames x num_bins] row-major. Frames are processed in blocks, one
+    // frame per SIMD lane; scratch holds fft_size * SIMD_FBANK_MAX_LANES floats.
+    void (*fbank_frames)(const FbankKernelTables& t, const float* samples, int num_frames,
+                         float* out, float* scratch);
+
+    // CMVN over a row-major [rows x cols] matrix, vectorized along rows (no
+    // gathers). cmvn_stats adds weight * d and weight * d^2, d = x - shift,
+    // into sum / sumsq per column; cmvn_apply sets x = (x - mean) * scale.
+    void (*cmvn_stats)(const float* x, int rows, int cols, const float* shift, float weight,
+                       float* sum, float* sumsq);
+    void (*cmvn_apply)(float* x, int rows, int cols, const float* mean, const float* scale);
+};
+
+// Best level supported by this CPU / OS (detected once)
+SimdLevel detect_simd_level();
+
+// Kernels currently in use
+const SimdKernels& simd_kernels();
+
+// Force a level (tests, benchmarks); clamped to detect_simd_level().
+// Returns the level actually selected.
+SimdLevel set_simd_level(SimdLevel level);
+
+// "scalar", "sse4.1", "avx2", "avx512"
+const char* simd_level_name(SimdLevel level);
+
+// Per-ISA kernel tables; null when that TU was built without its ISA flags
+const SimdKernels* simd_kernels_scalar();
+const SimdKernels* simd_kernels_sse41();
+const SimdKernels* simd_kernels_avx2();
+const SimdKernels* simd_kernels_avx512();
+
+} // namespace vp
+
+#endif // VP_SIMD_DISPATCH_H
@@ -0,0 +1,259 @@
+#ifndef VP_SIMD_FBANK_IMPL_H
+#define VP_SIMD_FBANK_IMPL_H
+
+// Log-mel FBank and CMVN kernel bodies shared by the simd_kernels_*.cpp
+// translation units (internal linkage, so every TU gets its own ISA's
+// copy). Each TU defines an FbankOps for its ISA and instantiates them:
+//
+//   V, W                          vector type and its float lane count
+//   load, store, set1, zero       unaligned memory access, broadcasts
+//   add, sub, mul, div, max       lane-wise arithmetic
+//   fmadd(a, b, c)                a * b + c
+//   log(x)                        natural log of positive finite lanes
+//
+// In fbank_frames_impl frames map to lanes, so every step is the scalar kaldi algorithm
+// run W frames at a time: no shuffles, and per-frame sums keep kaldi's
+// summation order. The scalar TU (W = 1) is the reference implementation.
+// Like the rest of these TUs this must not pull in STL headers.
+
+#include "core/simd_dispatch.h"
+#include <cstddef>
+
+namespace vp {
+
+namespace {
+
+// Cephes logf on pre-split input
+template <typename Ops>
+typename Ops::V fbank_log_cephes(typename Ops::V x, typename Ops::V e, typename Ops::V m_small) {
+    // x is the mantissa in [0.5, 1), e the exponent, m_small 1 where x < sqrt(1/2)
+    using V = typename Ops::V;
+    const V one = Ops::set1(1.0f);
+    e = Ops::sub(e, m_small);
+    x = Ops::sub(Ops::fmadd(x, m_small, x), one);   // 2x - 1 or x - 1
+    const V z = Ops::mul(x, x);
+    V y = Ops::set1(7.0376836292E-2f);
+    y = Ops::fmadd(y, x, Ops::set1(-1.1514610310E-1f));
+    y = Ops::fmadd(y, x, Ops::set1(1.1676998740E-1f));
+    y = Ops::fmadd(y, x, Ops::set1(-1.2420140846E-1f));
+    y = Ops::fmadd(y, x, Ops::set1(1.4249322787E-1f));
+    y = Ops::fmadd(y, x, Ops::set1(-1.6668057665E-1f));
+    y = Ops::fmadd(y, x, Ops::set1(2.0000714765E-1f));
+    y = Ops::fmadd(y, x, Ops::set1(-2.4999993993E-1f));
+    y = Ops::fmadd(y, x, Ops::set1(3.3333331174E-1f));
+    y = Ops::mul(Ops::mul(y, x), z);
+    y = Ops::fmadd(e, Ops::set1(-2.12194440e-4f), y);
+    y = Ops::fmadd(z, Ops::set1(-0.5f), y);
+    return Ops::fmadd(e, Ops::set1(0.693359375f), Ops::add(x, y));
+}
+
+template <typename Ops>
+void fbank_frames_impl(const FbankKernelTables& t, const float* samples, int num_frames,
+                       float* out, float* scratch) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    const int n_len = t.frame_length;
+    const int half = t.fft_size / 2;       // complex points of the half-size FFT
+    const V zero = Ops::zero();
+    const V preemph = Ops::set1(t.preemph);
+    const V inv_two = Ops::set1(0.5f);
+    // Element i of the block (a sample, later a complex point) is W floats at scratch + i * W
+    auto at = [scratch](int i) { return scratch + static_cast<size_t>(i) * W; };
+
+    for (int f0 = 0; f0 < num_frames; f0 += W) {
+        const int lanes = num_frames - f0 < W ? num_frames - f0 : W;
+
+        // Transpose the block in; unused lanes repeat the last frame
+        for (int l = 0; l < W; ++l) {
+            const int f = f0 + (l < lanes ? l : lanes - 1);
+            const float* src = samples + static_cast<size_t>(f) * t.frame_shift;
+            float* dst = scratch + l;
+            for (int n = 0; n < n_len; ++n) dst[static_cast<size_t>(n) * W] = src[n];
+        }
+
+        // DC removal, pre-emphasis and window in one backward pass, so
+        // x[n - 1] is still unmodified when x[n] needs it
+        V sum = zero;
+        for (int n = 0; n < n_len; ++n) sum = Ops::add(sum, Ops::load(at(n)));
+        const V mean = Ops::div(sum, Ops::set1(static_cast<float>(n_len)));
+        V next = Ops::sub(Ops::load(at(n_len - 1)), mean);
+        for (int n = n_len - 1; n > 0; --n) {
+            const V prev = Ops::sub(Ops::load(at(n - 1)), mean);
+            Ops::store(at(n), Ops::mul(Ops::sub(next, Ops::mul(preemph, prev)),
+                                       Ops::set1(t.window[n])));
+            next = prev;
+        }
+        Ops::store(at(0), Ops::mul(Ops::sub(next, Ops::mul(preemph, next)),
+                                   Ops::set1(t.window[0])));
+        for (int n = n_len; n < t.fft_size; ++n) Ops::store(at(n), zero);
+
+        // The real signal read as half complex points z[m] = x[2m] + i x[2m+1]
+        // is already in (re lanes, im lanes) layout: bit-reverse, then radix-2
+        for (int m = 0; m < half; ++m) {
+            const int r = t.bitrev[m];
+            if (r <= m) continue;
+            float* a = at(2 * m);
+            float* b = at(2 * r);
+            for (int i = 0; i < 2 * W; ++i) {
+                const float tmp = a[i];
+                a[i] = b[i];
+                b[i] = tmp;
+            }
+        }
+        for (int len = 2; len <= half; len <<= 1) {
+            const int h = len / 2;
+            const int step = half / len;
+            for (int k = 0; k < h; ++k) {
+                const V wr = Ops::set1(t.twiddle[2 * k * step]);
+                const V wi = Ops::set1(t.twiddle[2 * k * step + 1]);
+                for (int j = k; j < half; j += len) {
+                    float* pa = at(2 * j);
+                    float* pb = at(2 * (j + h));
+                    const V ar = Ops::load(pa), ai = Ops::load(pa + W);
+                    const V br = Ops::load(pb), bi = Ops::load(pb + W);
+                    const V tr = Ops::sub(Ops::mul(br, wr), Ops::mul(bi, wi));
+                    const V ti = Ops::fmadd(br, wi, Ops::mul(bi, wr));
+                    Ops::store(pa, Ops::add(ar, tr));
+                    Ops::store(pa + W, Ops::add(ai, ti));
+                    Ops::store(pb, Ops::sub(ar, tr));
+                    Ops::store(pb + W, Ops::sub(ai, ti));
+                }
+            }
+        }
+
+        // Split into the real FFT and take the power spectrum. Bins k and
+        // half - k come from the same two points; power k overwrites the real
+        // part of point k. The Nyquist bin is not used by the filterbank.
+        for (int k = 0; k <= half / 2; ++k) {
+            float* pa = at(2 * k);
+            float* pb = at(2 * ((half - k) % half));
+            const V ar = Ops::load(pa), ai = Ops::load(pa + W);
+            const V br = Ops::load(pb), bi = Ops::load(pb + W);
+            const V sr = Ops::mul(Ops::add(ar, br), inv_two);
+            const V dr = Ops::mul(Ops::sub(ar, br), inv_two);
+            const V si = Ops::mul(Ops::add(ai, bi), inv_two);
+            const V di = Ops::mul(Ops::sub(ai, bi), inv_two);
+            const V cr = Ops::set1(t.split[2 * k]);
+            const V ci = Ops::set1(t.split[2 * k + 1]);
+            const V u = Ops::fmadd(cr, si, Ops::mul(ci, dr));
+            const V v = Ops::sub(Ops::mul(ci, si), Ops::mul(cr, dr));
+            const V xr = Ops::add(sr, u), xi = Ops::add(di, v);
+            if (k != 0 && k != half / 2) {
+                const V yr = Ops::sub(sr, u), yi = Ops::sub(v, di);
+                Ops::store(pb, Ops::fmadd(yr, yr, Ops::mul(yi, yi)));
+            }
+            Ops::store(pa, Ops::fmadd(xr, xr, Ops::mul(xi, xi)));
+        }
+
+        // Sparse mel projection, floor at FLT_EPSILON, log; transpose out
+        const V floor = Ops::set1(1.19209290e-07f);
+        float lane_out[W];
+        for (int b = 0; b < t.num_bins; ++b) {
+            const int begin = t.mel_offset[b];
+            const int end = t.mel_offset[b + 1];
+            const int first = t.mel_first[b];
+            V energy = zero;
+            for (int j = begin; j < end; ++j) {
+                energy = Ops::fmadd(Ops::set1(t.mel_weights[j]),
+                                    Ops::load(at(2 * (first + j - begin))), energy);
+            }
+            Ops::store(lane_out, Ops::log(Ops::max(energy, floor)));
+            float* dst = out + static_cast<size_t>(f0) * t.num_bins + b;
+            for (int l = 0; l < lanes; ++l) dst[static_cast<size_t>(l) * t.num_bins] = lane_out[l];
+        }
+    }
+}
+
+// CMVN kernels work on column chunks of up to CMVN_UNROLL vectors, whose
+// accumulators / parameters stay in registers while the rows stream by
+constexpr int CMVN_UNROLL = 4;
+
+template <typename Ops, int U>
+void cmvn_stats_chunk(const float* x, int rows, int cols, const float* shift, float weight,
+                      float* sum, float* sumsq) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    const V w = Ops::set1(weight);
+    V k[U], s[U], q[U];
+    for (int u = 0; u < U; ++u) {
+        k[u] = Ops::load(shift + u * W);
+        s[u] = Ops::zero();
+        q[u] = Ops::zero();
+    }
+    for (int r = 0; r < rows; ++r) {
+        const float* row = x + static_cast<size_t>(r) * cols;
+        for (int u = 0; u < U; ++u) {
+            const V d = Ops::sub(Ops::load(row + u * W), k[u]);
+            s[u] = Ops::add(s[u], d);
+            q[u] = Ops::fmadd(d, d, q[u]);
+        }
+    }
+    for (int u = 0; u < U; ++u) {
+        Ops::store(sum + u * W, Ops::fmadd(w, s[u], Ops::load(sum + u * W)));
+        Ops::store(sumsq + u * W, Ops::fmadd(w, q[u], Ops::load(sumsq + u * W)));
+    }
+}
+
+template <typename Ops>
+void cmvn_stats_impl(const float* x, int rows, int cols, const float* shift, float weight,
+                     float* sum, float* sumsq) {
+    constexpr int W = Ops::W;
+    int j = 0;
+    for (; j + CMVN_UNROLL * W <= cols; j += CMVN_UNROLL * W) {
+        cmvn_stats_chunk<Ops, CMVN_UNROLL>(x + j, rows, cols, shift + j, weight, sum + j, sumsq + j);
+    }
+    for (; j + W <= cols; j += W) {
+        cmvn_stats_chunk<Ops, 1>(x + j, rows, cols, shift + j, weight, sum + j, sumsq + j);
+    }
+    for (; j < cols; ++j) {
+        float s = 0.0f, q = 0.0f;
+        for (int r = 0; r < rows; ++r) {
+            const float d = x[static_cast<size_t>(r) * cols + j] - shift[j];
+            s += d;
+            q += d * d;
+        }
+        sum[j] += weight * s;
+        sumsq[j] += weight * q;
+    }
+}
+
+template <typename Ops, int U>
+void cmvn_apply_chunk(float* x, int rows, int cols, const float* mean, const float* scale) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    V m[U], c[U];
+    for (int u = 0; u < U; ++u) {
+        m[u] = Ops::load(mean + u * W);
+        c[u] = Ops::load(scale + u * W);
+    }
+    for (int r = 0; r < rows; ++r) {
+        float* row = x + static_cast<size_t>(r) * cols;
+        for (int u = 0; u < U; ++u) {
+            Ops::store(row + u * W, Ops::mul(Ops::sub(Ops::load(row + u * W), m[u]), c[u]));
+        }
+    }
+}
+
+template <typename Ops>
+void cmvn_apply_impl(float* x, int rows, int cols, const float* mean, const float* scale) {
+    constexpr int W = Ops::W;
+    int j = 0;
+    for (; j + CMVN_UNROLL * W <= cols; j += CMVN_UNROLL * W) {
+        cmvn_apply_chunk<Ops, CMVN_UNROLL>(x + j, rows, cols, mean + j, scale + j);
+    }
+    for (; j + W <= cols; j += W) {
+        cmvn_apply_chunk<Ops, 1>(x + j, rows, cols, mean + j, scale + j);
+    }
+    for (; j < cols; ++j) {
+        for (int r = 0; r < rows; ++r) {
+            float& v = x[static_cast<size_t>(r) * cols + j];
+            v = (v - mean[j]) * scale[j];
+        }
+    }
+}
+
+} // anonymous namespace
+
+} // namespace vp
+
+#endif // VP_SIMD_FBANK_IMPL_H
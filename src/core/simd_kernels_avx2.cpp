@@ -0,0 +1,218 @@
+#include "core/simd_dispatch.h"
+#include <cstddef>
+
+// AVX2 + FMA kernels (built with -mavx2 -mfma, or /arch:AVX2 on MSVC)
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#include "core/simd_fbank_impl.h"
+
+namespace vp {
+
+namespace {
+
+// Register tile: 6 queries x 16 rows = 12 AVX2 accumulators
+constexpr int MR = 6;
+
+inline float hsum256(__m256 v) {
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 sum128 = _mm_add_ps(lo, hi);
+    sum128 = _mm_hadd_ps(sum128, sum128);
+    sum128 = _mm_hadd_ps(sum128, sum128);
+    return _mm_cvtss_f32(sum128);
+}
+
+inline int32_t hsum256_epi32(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+float dot(const float* a, const float* b, int dim) {
+    int i = 0;
+    __m256 sum = _mm256_setzero_ps();
+    for (; i + 8 <= dim; i += 8) {
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum);
+    }
+    float result = hsum256(sum);
+    for (; i < dim; ++i) result += a[i] * b[i];
+    return result;
+}
+
+// The query is loaded once per 8 lanes and reused for all four rows, so the
+// loop is bound by the row stream rather than by query reloads
+void dot4(const float* q, const float* r, int dim, int stride, float out[4]) {
+    const float* r0 = r;
+    const float* r1 = r + stride;
+    const float* r2 = r + 2 * static_cast<size_t>(stride);
+    const float* r3 = r + 3 * static_cast<size_t>(stride);
+    int i = 0;
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    __m256 s2 = _mm256_setzero_ps();
+    __m256 s3 = _mm256_setzero_ps();
+    for (; i + 8 <= dim; i += 8) {
+        __m256 vq = _mm256_loadu_ps(q + i);
+        s0 = _mm256_fmadd_ps(vq, _mm256_loadu_ps(r0 + i), s0);
+        s1 = _mm256_fmadd_ps(vq, _mm256_loadu_ps(r1 + i), s1);
+        s2 = _mm256_fmadd_ps(vq, _mm256_loadu_ps(r2 + i), s2);
+        s3 = _mm256_fmadd_ps(vq, _mm256_loadu_ps(r3 + i), s3);
+    }
+    float d0 = hsum256(s0), d1 = hsum256(s1), d2 = hsum256(s2), d3 = hsum256(s3);
+    for (; i < dim; ++i) {
+        d0 += q[i] * r0[i];
+        d1 += q[i] * r1[i];
+        d2 += q[i] * r2[i];
+        d3 += q[i] * r3[i];
+    }
+    out[0] = d0; out[1] = d1; out[2] = d2; out[3] = d3;
+}
+
+// One broadcast query scalar times two 8-lane row vectors per step, no
+// horizontal reductions. The twelve accumulators are spelled out so they
+// stay in registers.
+void gemm_tile(const float* const* q, const float* panel, int dim, float* c) {
+    constexpr int NR = SIMD_GEMM_NR;
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    const float* q0 = q[0];
+    const float* q1 = q[1];
+    const float* q2 = q[2];
+    const float* q3 = q[3];
+    const float* q4 = q[4];
+    const float* q5 = q[5];
+    for (int i = 0; i < dim; ++i) {
+        const float* col = panel + static_cast<size_t>(i) * NR;
+        __m256 lo = _mm256_loadu_ps(col);
+        __m256 hi = _mm256_loadu_ps(col + 8);
+        __m256 v = _mm256_broadcast_ss(q0 + i);
+        c00 = _mm256_fmadd_ps(v, lo, c00);
+        c01 = _mm256_fmadd_ps(v, hi, c01);
+        v = _mm256_broadcast_ss(q1 + i);
+        c10 = _mm256_fmadd_ps(v, lo, c10);
+        c11 = _mm256_fmadd_ps(v, hi, c11);
+        v = _mm256_broadcast_ss(q2 + i);
+        c20 = _mm256_fmadd_ps(v, lo, c20);
+        c21 = _mm256_fmadd_ps(v, hi, c21);
+        v = _mm256_broadcast_ss(q3 + i);
+        c30 = _mm256_fmadd_ps(v, lo, c30);
+        c31 = _mm256_fmadd_ps(v, hi, c31);
+        v = _mm256_broadcast_ss(q4 + i);
+        c40 = _mm256_fmadd_ps(v, lo, c40);
+        c41 = _mm256_fmadd_ps(v, hi, c41);
+        v = _mm256_broadcast_ss(q5 + i);
+        c50 = _mm256_fmadd_ps(v, lo, c50);
+        c51 = _mm256_fmadd_ps(v, hi, c51);
+    }
+    _mm256_storeu_ps(c + 0 * NR, c00); _mm256_storeu_ps(c + 0 * NR + 8, c01);
+    _mm256_storeu_ps(c + 1 * NR, c10); _mm256_storeu_ps(c + 1 * NR + 8, c11);
+    _mm256_storeu_ps(c + 2 * NR, c20); _mm256_storeu_ps(c + 2 * NR + 8, c21);
+    _mm256_storeu_ps(c + 3 * NR, c30); _mm256_storeu_ps(c + 3 * NR + 8, c31);
+    _mm256_storeu_ps(c + 4 * NR, c40); _mm256_storeu_ps(c + 4 * NR + 8, c41);
+    _mm256_storeu_ps(c + 5 * NR, c50); _mm256_storeu_ps(c + 5 * NR + 8, c51);
+}
+
+void l2_normalize(float* v, int dim) {
+    float norm = _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(dot(v, v, dim))));
+    if (norm <= 1e-10f) return;
+    const __m256 vn = _mm256_set1_ps(norm);
+    int i = 0;
+    for (; i + 8 <= dim; i += 8) _mm256_storeu_ps(v + i, _mm256_div_ps(_mm256_loadu_ps(v + i), vn));
+    for (; i < dim; ++i) v[i] /= norm;
+}
+
+// maddubs on |q| and sign(r, q); pair sums stay below 2 * 127 * 127 so the
+// int16 intermediate cannot saturate
+void int8_dot4(const int8_t* q, const uint8_t*, const int8_t* r, int stride, int32_t out[4]) {
+    const int8_t* r0 = r;
+    const int8_t* r1 = r + stride;
+    const int8_t* r2 = r + 2 * static_cast<size_t>(stride);
+    const int8_t* r3 = r + 3 * static_cast<size_t>(stride);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i s0 = _mm256_setzero_si256();
+    __m256i s1 = _mm256_setzero_si256();
+    __m256i s2 = _mm256_setzero_si256();
+    __m256i s3 = _mm256_setzero_si256();
+    for (int i = 0; i < stride; i += 32) {
+        __m256i vq = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + i));
+        __m256i aq = _mm256_abs_epi8(vq);
+        auto madd = [&](const int8_t* row) {
+            __m256i vr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            return _mm256_madd_epi16(_mm256_maddubs_epi16(aq, _mm256_sign_epi8(vr, vq)), ones);
+        };
+        s0 = _mm256_add_epi32(s0, madd(r0));
+        s1 = _mm256_add_epi32(s1, madd(r1));
+        s2 = _mm256_add_epi32(s2, madd(r2));
+        s3 = _mm256_add_epi32(s3, madd(r3));
+    }
+    out[0] = hsum256_epi32(s0);
+    out[1] = hsum256_epi32(s1);
+    out[2] = hsum256_epi32(s2);
+    out[3] = hsum256_epi32(s3);
+}
+
+struct FbankOps {
+    using V = __m256;
+    static constexpr int W = 8;
+    static V load(const float* p)          { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v)       { _mm256_storeu_ps(p, v); }
+    static V set1(float x)                 { return _mm256_set1_ps(x); }
+    static V zero()                        { return _mm256_setzero_ps(); }
+    static V add(V a, V b)                 { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b)                 { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b)                 { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b)                 { return _mm256_div_ps(a, b); }
+    static V max(V a, V b)                 { return _mm256_max_ps(a, b); }
+    static V fmadd(V a, V b, V c)          { return _mm256_fmadd_ps(a, b, c); }
+
+    // Exponent / mantissa split for positive normal x
+    static V log(V x) {
+        const __m256i bits = _mm256_castps_si256(x);
+        const V e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23),
+                                                        _mm256_set1_epi32(126)));
+        const V m = _mm256_castsi256_ps(_mm256_or_si256(
+            _mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F000000)));
+        const V small = _mm256_and_ps(_mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f),
+                                                    _CMP_LT_OQ),
+                                      _mm256_set1_ps(1.0f));
+        return fbank_log_cephes<FbankOps>(m, e, small);
+    }
+};
+
+void fbank_frames(const FbankKernelTables& t, const float* samples, int num_frames,
+                  float* out, float* scratch) {
+    fbank_frames_impl<FbankOps>(t, samples, num_frames, out, scratch);
+}
+
+void cmvn_stats(const float* x, int rows, int cols, const float* shift, float weight,
+                float* sum, float* sumsq) {
+    cmvn_stats_impl<FbankOps>(x, rows, cols, shift, weight, sum, sumsq);
+}
+
+void cmvn_apply(float* x, int rows, int cols, const float* mean, const float* scale) {
+    cmvn_apply_impl<FbankOps>(x, rows, cols, mean, scale);
+}
+
+const SimdKernels kKernels = {
+    SimdLevel::AVX2, dot, dot4, MR, gemm_tile, l2_normalize, false, int8_dot4,
+    fbank_frames, cmvn_stats, cmvn_apply,
+};
+
+} // anonymous namespace
+
+const SimdKernels* simd_kernels_avx2() { return &kKernels; }
+
+} // namespace vp
+
+#else
+
+namespace vp {
+const SimdKernels* simd_kernels_avx2() { return nullptr; }
+} // namespace vp
+
+#endif
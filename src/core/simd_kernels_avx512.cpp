@@ -0,0 +1,198 @@
+#include "core/simd_dispatch.h"
+#include <cstddef>
+
+// AVX-512 kernels (built with -mavx512f -mavx512bw -mavx512vl -mavx512vnni,
+// or /arch:AVX512 on MSVC). VNNI is part of the level so the int8 scan can
+// use vpdpbusd; AVX-512 parts without it run the AVX2 kernels.
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VL__) && \
+    (defined(__AVX512VNNI__) || defined(_MSC_VER))
+#include <immintrin.h>
+#include "core/simd_fbank_impl.h"
+
+namespace vp {
+
+namespace {
+
+// Register tile: 12 queries x 16 rows = 12 ZMM accumulators
+constexpr int MR = 12;
+
+// Lanes [0, n) of a 16-lane tail
+inline __mmask16 tail_mask(int n) {
+    return static_cast<__mmask16>((1u << n) - 1u);
+}
+
+float dot(const float* a, const float* b, int dim) {
+    int i = 0;
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+    for (; i + 32 <= dim; i += 32) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), s1);
+    }
+    for (; i < dim; i += 16) {
+        const __mmask16 m = dim - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tail_mask(dim - i);
+        s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i), s0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+void dot4(const float* q, const float* r, int dim, int stride, float out[4]) {
+    const float* r0 = r;
+    const float* r1 = r + stride;
+    const float* r2 = r + 2 * static_cast<size_t>(stride);
+    const float* r3 = r + 3 * static_cast<size_t>(stride);
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+    __m512 s2 = _mm512_setzero_ps();
+    __m512 s3 = _mm512_setzero_ps();
+    for (int i = 0; i < dim; i += 16) {
+        const __mmask16 m = dim - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tail_mask(dim - i);
+        __m512 vq = _mm512_maskz_loadu_ps(m, q + i);
+        s0 = _mm512_fmadd_ps(vq, _mm512_maskz_loadu_ps(m, r0 + i), s0);
+        s1 = _mm512_fmadd_ps(vq, _mm512_maskz_loadu_ps(m, r1 + i), s1);
+        s2 = _mm512_fmadd_ps(vq, _mm512_maskz_loadu_ps(m, r2 + i), s2);
+        s3 = _mm512_fmadd_ps(vq, _mm512_maskz_loadu_ps(m, r3 + i), s3);
+    }
+    out[0] = _mm512_reduce_add_ps(s0);
+    out[1] = _mm512_reduce_add_ps(s1);
+    out[2] = _mm512_reduce_add_ps(s2);
+    out[3] = _mm512_reduce_add_ps(s3);
+}
+
+// One panel column is a single ZMM; each query scalar is broadcast straight
+// from memory into the FMA
+void gemm_tile(const float* const* q, const float* panel, int dim, float* c) {
+    constexpr int NR = SIMD_GEMM_NR;
+    __m512 c0 = _mm512_setzero_ps(), c1 = _mm512_setzero_ps(), c2 = _mm512_setzero_ps();
+    __m512 c3 = _mm512_setzero_ps(), c4 = _mm512_setzero_ps(), c5 = _mm512_setzero_ps();
+    __m512 c6 = _mm512_setzero_ps(), c7 = _mm512_setzero_ps(), c8 = _mm512_setzero_ps();
+    __m512 c9 = _mm512_setzero_ps(), c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+    const float* q0 = q[0];
+    const float* q1 = q[1];
+    const float* q2 = q[2];
+    const float* q3 = q[3];
+    const float* q4 = q[4];
+    const float* q5 = q[5];
+    const float* q6 = q[6];
+    const float* q7 = q[7];
+    const float* q8 = q[8];
+    const float* q9 = q[9];
+    const float* q10 = q[10];
+    const float* q11 = q[11];
+    for (int i = 0; i < dim; ++i) {
+        __m512 p = _mm512_loadu_ps(panel + static_cast<size_t>(i) * NR);
+        c0  = _mm512_fmadd_ps(_mm512_set1_ps(q0[i]),  p, c0);
+        c1  = _mm512_fmadd_ps(_mm512_set1_ps(q1[i]),  p, c1);
+        c2  = _mm512_fmadd_ps(_mm512_set1_ps(q2[i]),  p, c2);
+        c3  = _mm512_fmadd_ps(_mm512_set1_ps(q3[i]),  p, c3);
+        c4  = _mm512_fmadd_ps(_mm512_set1_ps(q4[i]),  p, c4);
+        c5  = _mm512_fmadd_ps(_mm512_set1_ps(q5[i]),  p, c5);
+        c6  = _mm512_fmadd_ps(_mm512_set1_ps(q6[i]),  p, c6);
+        c7  = _mm512_fmadd_ps(_mm512_set1_ps(q7[i]),  p, c7);
+        c8  = _mm512_fmadd_ps(_mm512_set1_ps(q8[i]),  p, c8);
+        c9  = _mm512_fmadd_ps(_mm512_set1_ps(q9[i]),  p, c9);
+        c10 = _mm512_fmadd_ps(_mm512_set1_ps(q10[i]), p, c10);
+        c11 = _mm512_fmadd_ps(_mm512_set1_ps(q11[i]), p, c11);
+    }
+    _mm512_storeu_ps(c + 0 * NR, c0);   _mm512_storeu_ps(c + 1 * NR, c1);
+    _mm512_storeu_ps(c + 2 * NR, c2);   _mm512_storeu_ps(c + 3 * NR, c3);
+    _mm512_storeu_ps(c + 4 * NR, c4);   _mm512_storeu_ps(c + 5 * NR, c5);
+    _mm512_storeu_ps(c + 6 * NR, c6);   _mm512_storeu_ps(c + 7 * NR, c7);
+    _mm512_storeu_ps(c + 8 * NR, c8);   _mm512_storeu_ps(c + 9 * NR, c9);
+    _mm512_storeu_ps(c + 10 * NR, c10); _mm512_storeu_ps(c + 11 * NR, c11);
+}
+
+void l2_normalize(float* v, int dim) {
+    float norm = _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(dot(v, v, dim))));
+    if (norm <= 1e-10f) return;
+    const __m512 vn = _mm512_set1_ps(norm);
+    for (int i = 0; i < dim; i += 16) {
+        const __mmask16 m = dim - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tail_mask(dim - i);
+        _mm512_mask_storeu_ps(v + i, m, _mm512_div_ps(_mm512_maskz_loadu_ps(m, v + i), vn));
+    }
+}
+
+// Unsigned x signed byte products, 64 bytes per step; the caller removes
+// the +128 query offset with the per-row code sum
+void int8_dot4(const int8_t*, const uint8_t* q, const int8_t* r, int stride, int32_t out[4]) {
+    const int8_t* r0 = r;
+    const int8_t* r1 = r + stride;
+    const int8_t* r2 = r + 2 * static_cast<size_t>(stride);
+    const int8_t* r3 = r + 3 * static_cast<size_t>(stride);
+    __m512i s0 = _mm512_setzero_si512();
+    __m512i s1 = _mm512_setzero_si512();
+    __m512i s2 = _mm512_setzero_si512();
+    __m512i s3 = _mm512_setzero_si512();
+    for (int i = 0; i < stride; i += 64) {
+        __m512i vq = _mm512_loadu_si512(q + i);
+        s0 = _mm512_dpbusd_epi32(s0, vq, _mm512_loadu_si512(r0 + i));
+        s1 = _mm512_dpbusd_epi32(s1, vq, _mm512_loadu_si512(r1 + i));
+        s2 = _mm512_dpbusd_epi32(s2, vq, _mm512_loadu_si512(r2 + i));
+        s3 = _mm512_dpbusd_epi32(s3, vq, _mm512_loadu_si512(r3 + i));
+    }
+    out[0] = _mm512_reduce_add_epi32(s0);
+    out[1] = _mm512_reduce_add_epi32(s1);
+    out[2] = _mm512_reduce_add_epi32(s2);
+    out[3] = _mm512_reduce_add_epi32(s3);
+}
+
+struct FbankOps {
+    using V = __m512;
+    static constexpr int W = 16;
+    static V load(const float* p)          { return _mm512_loadu_ps(p); }
+    static void store(float* p, V v)       { _mm512_storeu_ps(p, v); }
+    static V set1(float x)                 { return _mm512_set1_ps(x); }
+    static V zero()                        { return _mm512_setzero_ps(); }
+    static V add(V a, V b)                 { return _mm512_add_ps(a, b); }
+    static V sub(V a, V b)                 { return _mm512_sub_ps(a, b); }
+    static V mul(V a, V b)                 { return _mm512_mul_ps(a, b); }
+    static V div(V a, V b)                 { return _mm512_div_ps(a, b); }
+    static V max(V a, V b)                 { return _mm512_max_ps(a, b); }
+    static V fmadd(V a, V b, V c)          { return _mm512_fmadd_ps(a, b, c); }
+
+    // Exponent / mantissa split for positive normal x
+    static V log(V x) {
+        const __m512i bits = _mm512_castps_si512(x);
+        const V e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23),
+                                                        _mm512_set1_epi32(126)));
+        const V m = _mm512_castsi512_ps(_mm512_or_si512(
+            _mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F000000)));
+        const V small = _mm512_maskz_mov_ps(
+            _mm512_cmp_ps_mask(m, _mm512_set1_ps(0.707106781186547524f), _CMP_LT_OQ),
+            _mm512_set1_ps(1.0f));
+        return fbank_log_cephes<FbankOps>(m, e, small);
+    }
+};
+
+void fbank_frames(const FbankKernelTables& t, const float* samples, int num_frames,
+                  float* out, float* scratch) {
+    fbank_frames_impl<FbankOps>(t, samples, num_frames, out, scratch);
+}
+
+void cmvn_stats(const float* x, int rows, int cols, const float* shift, float weight,
+                float* sum, float* sumsq) {
+    cmvn_stats_impl<FbankOps>(x, rows, cols, shift, weight, sum, sumsq);
+}
+
+void cmvn_apply(float* x, int rows, int cols, const float* mean, const float* scale) {
+    cmvn_apply_impl<FbankOps>(x, rows, cols, mean, scale);
+}
+
+const SimdKernels kKernels = {
+    SimdLevel::AVX512, dot, dot4, MR, gemm_tile, l2_normalize, true, int8_dot4,
+    fbank_frames, cmvn_stats, cmvn_apply,
+};
+
+} // anonymous namespace
+
+const SimdKernels* simd_kernels_avx512() { return &kKernels; }
+
+} // namespace vp
+
+#else
+
+namespace vp {
+const SimdKernels* simd_kernels_avx512() { return nullptr; }
+} // namespace vp
+
+#endif
@@ -0,0 +1,113 @@
+#include "core/simd_dispatch.h"
+#include "core/simd_fbank_impl.h"
+#include <cmath>
+#include <cstddef>
+
+// Portable kernels: the fallback on non-x86 hosts and the reference the
+// SIMD levels are tested against.
+
+namespace vp {
+
+namespace {
+
+constexpr int MR = 4;
+
+float dot(const float* a, const float* b, int dim) {
+    float result = 0.0f;
+    for (int i = 0; i < dim; ++i) result += a[i] * b[i];
+    return result;
+}
+
+void dot4(const float* q, const float* r, int dim, int stride, float out[4]) {
+    const float* r0 = r;
+    const float* r1 = r + stride;
+    const float* r2 = r + 2 * static_cast<size_t>(stride);
+    const float* r3 = r + 3 * static_cast<size_t>(stride);
+    float d0 = 0.0f, d1 = 0.0f, d2 = 0.0f, d3 = 0.0f;
+    for (int i = 0; i < dim; ++i) {
+        d0 += q[i] * r0[i];
+        d1 += q[i] * r1[i];
+        d2 += q[i] * r2[i];
+        d3 += q[i] * r3[i];
+    }
+    out[0] = d0; out[1] = d1; out[2] = d2; out[3] = d3;
+}
+
+void gemm_tile(const float* const* q, const float* panel, int dim, float* c) {
+    float acc[MR][SIMD_GEMM_NR] = {};
+    for (int i = 0; i < dim; ++i) {
+        const float* col = panel + static_cast<size_t>(i) * SIMD_GEMM_NR;
+        for (int j = 0; j < MR; ++j) {
+            const float qi = q[j][i];
+            for (int t = 0; t < SIMD_GEMM_NR; ++t) acc[j][t] += qi * col[t];
+        }
+    }
+    for (int j = 0; j < MR; ++j) {
+        for (int t = 0; t < SIMD_GEMM_NR; ++t) c[j * SIMD_GEMM_NR + t] = acc[j][t];
+    }
+}
+
+void l2_normalize(float* v, int dim) {
+    float norm = std::sqrt(dot(v, v, dim));
+    if (norm > 1e-10f) {
+        for (int i = 0; i < dim; ++i) v[i] /= norm;
+    }
+}
+
+void int8_dot4(const int8_t* q, const uint8_t*, const int8_t* r, int stride, int32_t out[4]) {
+    const int8_t* r0 = r;
+    const int8_t* r1 = r + stride;
+    const int8_t* r2 = r + 2 * static_cast<size_t>(stride);
+    const int8_t* r3 = r + 3 * static_cast<size_t>(stride);
+    int32_t d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+    for (int i = 0; i < stride; ++i) {
+        int32_t qi = q[i];
+        d0 += qi * r0[i];
+        d1 += qi * r1[i];
+        d2 += qi * r2[i];
+        d3 += qi * r3[i];
+    }
+    out[0] = d0; out[1] = d1; out[2] = d2; out[3] = d3;
+}
+
+// One frame at a time: the reference for the SIMD levels
+struct FbankOps {
+    using V = float;
+    static constexpr int W = 1;
+    static V load(const float* p)          { return *p; }
+    static void store(float* p, V v)       { *p = v; }
+    static V set1(float x)                 { return x; }
+    static V zero()                        { return 0.0f; }
+    static V add(V a, V b)                 { return a + b; }
+    static V sub(V a, V b)                 { return a - b; }
+    static V mul(V a, V b)                 { return a * b; }
+    static V div(V a, V b)                 { return a / b; }
+    static V max(V a, V b)                 { return a < b ? b : a; }
+    static V fmadd(V a, V b, V c)          { return a * b + c; }
+    static V log(V x)                      { return std::log(x); }
+};
+
+void fbank_frames(const FbankKernelTables& t, const float* samples, int num_frames,
+                  float* out, float* scratch) {
+    fbank_frames_impl<FbankOps>(t, samples, num_frames, out, scratch);
+}
+
+void cmvn_stats(const float* x, int rows, int cols, const float* shift, float weight,
+                float* sum, float* sumsq) {
+    cmvn_stats_impl<FbankOps>(x, rows, cols, shift, weight, sum, sumsq);
+}
+
+void cmvn_apply(float* x, int rows, int cols, const float* mean, const float* scale) {
+    cmvn_apply_impl<FbankOps>(x, rows, cols, mean, scale);
+}
+
+const SimdKernels kKernels = {
+    SimdLevel::SCALAR, dot, dot4, MR, gemm_tile, l2_normalize, false, int8_dot4,
+    fbank_frames, cmvn_stats, cmvn_apply,
+};
+
+} // anonymous namespace
+
+const SimdKernels* simd_kernels_scalar() { return &kKernels; }
+
+} // namespace vp
@@ -0,0 +1,184 @@
+#include "core/simd_dispatch.h"
+#include <cstddef>
+
+// SSE4.1 kernels (built with -msse4.1; MSVC x86 targets accept the
+// intrinsics without flags)
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#include <immintrin.h>
+#include "core/simd_fbank_impl.h"
+
+namespace vp {
+
+namespace {
+
+// Register tile: 2 queries x 16 rows = 8 SSE accumulators
+constexpr int MR = 2;
+
+inline float hsum128(__m128 v) {
+    __m128 sum = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(sum);
+}
+
+inline int32_t hsum128_epi32(__m128i v) {
+    __m128i sum = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+float dot(const float* a, const float* b, int dim) {
+    int i = 0;
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    for (; i + 8 <= dim; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float result = hsum128(_mm_add_ps(s0, s1));
+    for (; i < dim; ++i) result += a[i] * b[i];
+    return result;
+}
+
+void dot4(const float* q, const float* r, int dim, int stride, float out[4]) {
+    const float* r0 = r;
+    const float* r1 = r + stride;
+    const float* r2 = r + 2 * static_cast<size_t>(stride);
+    const float* r3 = r + 3 * static_cast<size_t>(stride);
+    int i = 0;
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    __m128 s2 = _mm_setzero_ps();
+    __m128 s3 = _mm_setzero_ps();
+    for (; i + 4 <= dim; i += 4) {
+        __m128 vq = _mm_loadu_ps(q + i);
+        s0 = _mm_add_ps(s0, _mm_mul_ps(vq, _mm_loadu_ps(r0 + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(vq, _mm_loadu_ps(r1 + i)));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(vq, _mm_loadu_ps(r2 + i)));
+        s3 = _mm_add_ps(s3, _mm_mul_ps(vq, _mm_loadu_ps(r3 + i)));
+    }
+    float d0 = hsum128(s0), d1 = hsum128(s1), d2 = hsum128(s2), d3 = hsum128(s3);
+    for (; i < dim; ++i) {
+        d0 += q[i] * r0[i];
+        d1 += q[i] * r1[i];
+        d2 += q[i] * r2[i];
+        d3 += q[i] * r3[i];
+    }
+    out[0] = d0; out[1] = d1; out[2] = d2; out[3] = d3;
+}
+
+void gemm_tile(const float* const* q, const float* panel, int dim, float* c) {
+    __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+    __m128 c02 = _mm_setzero_ps(), c03 = _mm_setzero_ps();
+    __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+    __m128 c12 = _mm_setzero_ps(), c13 = _mm_setzero_ps();
+    const float* q0 = q[0];
+    const float* q1 = q[1];
+    for (int i = 0; i < dim; ++i) {
+        const float* col = panel + static_cast<size_t>(i) * SIMD_GEMM_NR;
+        __m128 p0 = _mm_loadu_ps(col);
+        __m128 p1 = _mm_loadu_ps(col + 4);
+        __m128 p2 = _mm_loadu_ps(col + 8);
+        __m128 p3 = _mm_loadu_ps(col + 12);
+        __m128 v = _mm_set1_ps(q0[i]);
+        c00 = _mm_add_ps(c00, _mm_mul_ps(v, p0));
+        c01 = _mm_add_ps(c01, _mm_mul_ps(v, p1));
+        c02 = _mm_add_ps(c02, _mm_mul_ps(v, p2));
+        c03 = _mm_add_ps(c03, _mm_mul_ps(v, p3));
+        v = _mm_set1_ps(q1[i]);
+        c10 = _mm_add_ps(c10, _mm_mul_ps(v, p0));
+        c11 = _mm_add_ps(c11, _mm_mul_ps(v, p1));
+        c12 = _mm_add_ps(c12, _mm_mul_ps(v, p2));
+        c13 = _mm_add_ps(c13, _mm_mul_ps(v, p3));
+    }
+    _mm_storeu_ps(c + 0,  c00); _mm_storeu_ps(c + 4,  c01);
+    _mm_storeu_ps(c + 8,  c02); _mm_storeu_ps(c + 12, c03);
+    _mm_storeu_ps(c + SIMD_GEMM_NR + 0,  c10); _mm_storeu_ps(c + SIMD_GEMM_NR + 4,  c11);
+    _mm_storeu_ps(c + SIMD_GEMM_NR + 8,  c12); _mm_storeu_ps(c + SIMD_GEMM_NR + 12, c13);
+}
+
+void l2_normalize(float* v, int dim) {
+    float norm = _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(dot(v, v, dim))));
+    if (norm <= 1e-10f) return;
+    const __m128 vn = _mm_set1_ps(norm);
+    int i = 0;
+    for (; i + 4 <= dim; i += 4) _mm_storeu_ps(v + i, _mm_div_ps(_mm_loadu_ps(v + i), vn));
+    for (; i < dim; ++i) v[i] /= norm;
+}
+
+// maddubs on |q| and sign(r, q); pair sums stay below 2 * 127 * 127 so the
+// int16 intermediate cannot saturate
+void int8_dot4(const int8_t* q, const uint8_t*, const int8_t* r, int stride, int32_t out[4]) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i s[4] = {_mm_setzero_si128(), _mm_setzero_si128(),
+                    _mm_setzero_si128(), _mm_setzero_si128()};
+    for (int i = 0; i < stride; i += 16) {
+        __m128i vq = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i));
+        __m128i aq = _mm_abs_epi8(vq);
+        for (int j = 0; j < 4; ++j) {
+            __m128i vr = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(r + j * static_cast<size_t>(stride) + i));
+            s[j] = _mm_add_epi32(s[j],
+                _mm_madd_epi16(_mm_maddubs_epi16(aq, _mm_sign_epi8(vr, vq)), ones));
+        }
+    }
+    for (int j = 0; j < 4; ++j) out[j] = hsum128_epi32(s[j]);
+}
+
+struct FbankOps {
+    using V = __m128;
+    static constexpr int W = 4;
+    static V load(const float* p)          { return _mm_loadu_ps(p); }
+    static void store(float* p, V v)       { _mm_storeu_ps(p, v); }
+    static V set1(float x)                 { return _mm_set1_ps(x); }
+    static V zero()                        { return _mm_setzero_ps(); }
+    static V add(V a, V b)                 { return _mm_add_ps(a, b); }
+    static V sub(V a, V b)                 { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b)                 { return _mm_mul_ps(a, b); }
+    static V div(V a, V b)                 { return _mm_div_ps(a, b); }
+    static V max(V a, V b)                 { return _mm_max_ps(a, b); }
+    static V fmadd(V a, V b, V c)          { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+    // Exponent / mantissa split for positive normal x
+    static V log(V x) {
+        const __m128i bits = _mm_castps_si128(x);
+        const V e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+        const V m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+                                                  _mm_set1_epi32(0x3F000000)));
+        const V small = _mm_and_ps(_mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f)),
+                                   _mm_set1_ps(1.0f));
+        return fbank_log_cephes<FbankOps>(m, e, small);
+    }
+};
+
+void fbank_frames(const FbankKernelTables& t, const float* samples, int num_frames,
+                  float* out, float* scratch) {
+    fbank_frames_impl<FbankOps>(t, samples, num_frames, out, scratch);
+}
+
+void cmvn_stats(const float* x, int rows, int cols, const float* shift, float weight,
+                float* sum, float* sumsq) {
+    cmvn_stats_impl<FbankOps>(x, rows, cols, shift, weight, sum, sumsq);
+}
+
+void cmvn_apply(float* x, int rows, int cols, const float* mean, const float* scale) {
+    cmvn_apply_impl<FbankOps>(x, rows, cols, mean, scale);
+}
+
+const SimdKernels kKernels = {
+    SimdLevel::SSE41, dot, dot4, MR, gemm_tile, l2_normalize, false, int8_dot4,
+    fbank_frames, cmvn_stats, cmvn_apply,
+};
+
+} // anonymous namespace
+
+const SimdKernels* simd_kernels_sse41() { return &kKernels; }
+
+} // namespace vp
+
+#else
+
+namespace vp {
+const SimdKernels* simd_kernels_sse41() { return nullptr; }
+} // namespace vp
+
+#endif
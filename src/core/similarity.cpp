@@ -1,13 +1,82 @@
 #include "core/similarity.h"
+#include "core/simd_dispatch.h"
 #include <cmath>
 #include <algorithm>
-
-#ifdef __AVX2__
-#include <immintrin.h>
-#endif
+#include <limits>
 
 namespace vp {
 
+namespace {
+
+inline float clamp_score(float dot) {
+    return std::max(-1.0f, std::min(1.0f, dot));
+}
+
+// Blocked [Q x dim] . [dim x N] product for find_top_k_batch.
+// Gallery rows scored per block: 256 x 192 floats = 192 KB, sized to stay
+// resident in L2 while every query of the current query block passes over it
+constexpr int GEMM_ROW_BLOCK   = 256;
+// Queries per block: the gallery is streamed from memory (and packed) once
+// per block; 128 x 192 floats of queries also fit in L2 next to the rows
+constexpr int GEMM_QUERY_BLOCK = 128;
+// Rows per packed panel; the query tile height is per ISA (SimdKernels::gemm_mr)
+constexpr int GEMM_NR = SIMD_GEMM_NR;
+
+// Repack rows [0, rn) of a block into column panels of NR rows so the
+// micro-kernel reads them with unit stride: panel p holds dim x NR floats,
+// element (i, t) = row(p * NR + t)[i]. Missing rows are zero.
+void pack_panels(const float* block, int rn, int dim, int stride, float* packed) {
+    for (int p = 0; p < rn; p += GEMM_NR) {
+        float* dst = packed + static_cast<size_t>(p) * dim;
+        const int valid = std::min(GEMM_NR, rn - p);
+        for (int i = 0; i < dim; ++i) {
+            float* col = dst + static_cast<size_t>(i) * GEMM_NR;
+            int t = 0;
+            for (; t < valid; ++t) col[t] = block[static_cast<size_t>(p + t) * stride + i];
+            for (; t < GEMM_NR; ++t) col[t] = 0.0f;
+        }
+    }
+}
+
+// Min-heap ordering: the root holds the lowest score
+inline bool heap_greater(const ScoredIndex& a, const ScoredIndex& b) {
+    return a.score > b.score;
+}
+
+} // anonymous namespace
+
+void TopKSelector::reset(int k) {
+    k_ = std::max(1, k);
+    heap_.clear();
+    heap_.reserve(k_);
+    threshold_ = -std::numeric_limits<float>::infinity();
+}
+
+void TopKSelector::push(int index, float score) {
+    if (static_cast<int>(heap_.size()) < k_) {
+        heap_.push_back({index, score});
+        std::push_heap(heap_.begin(), heap_.end(), heap_greater);
+        if (static_cast<int>(heap_.size()) == k_) threshold_ = heap_.front().score;
+        return;
+    }
+    if (score <= threshold_) return;
+
+    std::pop_heap(heap_.begin(), heap_.end(), heap_greater);
+    heap_.back() = {index, score};
+    std::push_heap(heap_.begin(), heap_.end(), heap_greater);
+    threshold_ = heap_.front().score;
+}
+
+int TopKSelector::take_sorted(ScoredIndex* out) {
+    // sort_heap with a greater-than comparator yields descending order
+    std::sort_heap(heap_.begin(), heap_.end(), heap_greater);
+    int n = static_cast<int>(heap_.size());
+    for (int i = 0; i < n; ++i) out[i] = heap_[i];
+    heap_.clear();
+    threshold_ = -std::numeric_limits<float>::infinity();
+    return n;
+}
+
 float SimilarityCalculator::cosine_similarity(const std::vector<float>& a,
                                                const std::vector<float>& b) {
     if (a.size() != b.size() || a.empty()) return 0.0f;
@@ -16,39 +85,15 @@ float SimilarityCalculator::cosine_similarity(const std::vector<float>& a,
 
 float SimilarityCalculator::cosine_similarity(const float* a, const float* b, int dim) {
     // For L2-normalized vectors, cosine similarity = dot product
-    float dot = 0.0f;
-
-#ifdef __AVX2__
-    // AVX2 optimized dot product
-    int i = 0;
-    __m256 sum = _mm256_setzero_ps();
-    for (; i + 8 <= dim; i += 8) {
-        __m256 va = _mm256_loadu_ps(a + i);
-        __m256 vb = _mm256_loadu_ps(b + i);
-        sum = _mm256_fmadd_ps(va, vb, sum);
-    }
+    return clamp_score(dot(a, b, dim));
+}
 
-    // Horizontal sum
-    __m128 hi = _mm256_extractf128_ps(sum, 1);
-    __m128 lo = _mm256_castps256_ps128(sum);
-    __m128 sum128 = _mm_add_ps(lo, hi);
-    sum128 = _mm_hadd_ps(sum128, sum128);
-    sum128 = _mm_hadd_ps(sum128, sum128);
-    dot = _mm_cvtss_f32(sum128);
-
-    // Process remaining elements
-    for (; i < dim; ++i) {
-        dot += a[i] * b[i];
-    }
-#else
-    // Scalar fallback
-    for (int i = 0; i < dim; ++i) {
-        dot += a[i] * b[i];
-    }
-#endif
+float SimilarityCalculator::dot(const float* a, const float* b, int dim) {
+    return simd_kernels().dot(a, b, dim);
+}
 
-    // Clamp to [-1, 1]
-    return std::max(-1.0f, std::min(1.0f, dot));
+void SimilarityCalculator::l2_normalize(float* v, int dim) {
+    simd_kernels().l2_normalize(v, dim);
 }
 
 SimilarityCalculator::MatchResult SimilarityCalculator::find_best_match(
@@ -69,4 +114,134 @@ SimilarityCalculator::MatchResult SimilarityCalculator::find_best_match(
     return best;
 }
 
+void SimilarityCalculator::batch_similarity(const float* query, const float* matrix,
+                                            int rows, int dim, int stride,
+                                            float* out_scores) {
+    const SimdKernels& kern = simd_kernels();
+    int r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        float d[4];
+        kern.dot4(query, matrix + static_cast<size_t>(r) * stride, dim, stride, d);
+        for (int k = 0; k < 4; ++k) out_scores[r + k] = clamp_score(d[k]);
+    }
+    for (; r < rows; ++r) {
+        out_scores[r] = cosine_similarity(query, matrix + static_cast<size_t>(r) * stride, dim);
+    }
+}
+
+SimilarityCalculator::MatchResult SimilarityCalculator::find_best_match(
+    const float* query, const float* matrix, int rows, int dim, int stride) {
+
+    MatchResult best{-1, -1.0f, ""};
+    if (rows <= 0) return best;
+    best.score = -std::numeric_limits<float>::infinity();
+
+    const SimdKernels& kern = simd_kernels();
+    int r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        float d[4];
+        kern.dot4(query, matrix + static_cast<size_t>(r) * stride, dim, stride, d);
+        for (int k = 0; k < 4; ++k) {
+            if (d[k] > best.score) {
+                best.score = d[k];
+                best.index = r + k;
+            }
+        }
+    }
+    for (; r < rows; ++r) {
+        float score = cosine_similarity(query, matrix + static_cast<size_t>(r) * stride, dim);
+        if (score > best.score) {
+            best.score = score;
+            best.index = r;
+        }
+    }
+
+    // Only the winner needs clamping
+    best.score = clamp_score(best.score);
+    return best;
+}
+
+void SimilarityCalculator::find_top_k_batch(const float* queries, int num_queries, int query_stride,
+                                            const float* matrix, int rows, int dim, int stride,
+                                            int k, ScoredIndex* out, int* out_counts) {
+    if (num_queries <= 0) return;
+    if (rows <= 0 || k <= 0) {
+        std::fill(out_counts, out_counts + num_queries, 0);
+        return;
+    }
+
+    const int kk = std::min(k, rows);
+    const int panel_rows = (std::min(rows, GEMM_ROW_BLOCK) + GEMM_NR - 1) / GEMM_NR * GEMM_NR;
+    std::vector<float> packed(static_cast<size_t>(panel_rows) * dim);
+    std::vector<TopKSelector> selectors(std::min(num_queries, GEMM_QUERY_BLOCK));
+    const SimdKernels& kern = simd_kernels();
+    const int mr_max = kern.gemm_mr;
+    float tile[SIMD_GEMM_MAX_MR * GEMM_NR];
+    const float* q[SIMD_GEMM_MAX_MR];
+
+    for (int q0 = 0; q0 < num_queries; q0 += GEMM_QUERY_BLOCK) {
+        const int qn = std::min(GEMM_QUERY_BLOCK, num_queries - q0);
+        for (int j = 0; j < qn; ++j) selectors[j].reset(kk);
+
+        for (int r0 = 0; r0 < rows; r0 += GEMM_ROW_BLOCK) {
+            const int rn = std::min(GEMM_ROW_BLOCK, rows - r0);
+            pack_panels(matrix + static_cast<size_t>(r0) * stride, rn, dim, stride, packed.data());
+
+            for (int j0 = 0; j0 < qn; j0 += mr_max) {
+                // A short last tile repeats its first query; extra rows are ignored
+                const int mr = std::min(mr_max, qn - j0);
+                for (int j = 0; j < mr_max; ++j) {
+                    q[j] = queries + static_cast<size_t>(q0 + j0 + (j < mr ? j : 0)) * query_stride;
+                }
+
+                for (int p = 0; p < rn; p += GEMM_NR) {
+                    kern.gemm_tile(q, packed.data() + static_cast<size_t>(p) * dim, dim, tile);
+                    const int valid = std::min(GEMM_NR, rn - p);
+                    for (int j = 0; j < mr; ++j) {
+                        TopKSelector& sel = selectors[j0 + j];
+                        const float* c = tile + j * GEMM_NR;
+                        for (int t = 0; t < valid; ++t) {
+                            if (c[t] > sel.threshold()) sel.push(r0 + p + t, c[t]);
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int j = 0; j < qn; ++j) {
+            ScoredIndex* dst = out + static_cast<size_t>(q0 + j) * k;
+            int n = selectors[j].take_sorted(dst);
+            for (int t = 0; t < n; ++t) dst[t].score = clamp_score(dst[t].score);
+            out_counts[q0 + j] = n;
+        }
+    }
+}
+
+int SimilarityCalculator::find_top_k(const float* query, const float* matrix,
+                                     int rows, int dim, int stride, int k,
+                                     ScoredIndex* out) {
+    if (rows <= 0 || k <= 0) return 0;
+
+    // Per-thread heap, so a steady-state query does not allocate
+    thread_local TopKSelector selector;
+    selector.reset(std::min(k, rows));
+    const SimdKernels& kern = simd_kernels();
+    int r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        float d[4];
+        kern.dot4(query, matrix + static_cast<size_t>(r) * stride, dim, stride, d);
+        for (int j = 0; j < 4; ++j) {
+            if (d[j] > selector.threshold()) selector.push(r + j, d[j]);
+        }
+    }
+    for (; r < rows; ++r) {
+        float score = cosine_similarity(query, matrix + static_cast<size_t>(r) * stride, dim);
+        if (score > selector.threshold()) selector.push(r, score);
+    }
+
+    int n = selector.take_sorted(out);
+    for (int i = 0; i < n; ++i) out[i].score = clamp_score(out[i].score);
+    return n;
+}
+
 } // namespace vp
@@ -7,6 +7,38 @@
 
 namespace vp {
 
+// (row index, score) pair produced by the matrix search kernels
+struct ScoredIndex {
+    int index;
+    float score;
+};
+
+// Bounded top-K selection: a size-k min-heap whose root is the current
+// k-th best score, so most candidates are rejected with one comparison.
+class TopKSelector {
+public:
+    explicit TopKSelector(int k = 1) { reset(k); }
+
+    // Empty the selector and set a new k (k >= 1)
+    void reset(int k);
+
+    // Score a candidate must beat to enter (-inf until k entries are held)
+    float threshold() const { return threshold_; }
+
+    void push(int index, float score);
+
+    // Write held entries in descending score order; returns the count.
+    // The selector is left empty.
+    int take_sorted(ScoredIndex* out);
+
+    int size() const { return static_cast<int>(heap_.size()); }
+
+private:
+    int k_ = 1;
+    float threshold_ = 0.0f;
+    std::vector<ScoredIndex> heap_;
+};
+
 class SimilarityCalculator {
 public:
     // Cosine similarity between two vectors (assumes L2-normalized)
@@ -15,6 +47,12 @@ public:
     // Cosine similarity using raw pointers (for performance)
     static float cosine_similarity(const float* a, const float* b, int dim);
 
+    // Unclamped dot product (vectors need not be normalized)
+    static float dot(const float* a, const float* b, int dim);
+
+    // In-place L2 normalization (vectors with norm <= 1e-10 are left as is)
+    static void l2_normalize(float* v, int dim);
+
     // Find best match from a set of embeddings
     // Returns (index, score) pair, or (-1, 0) if empty
     struct MatchResult {
@@ -26,6 +64,34 @@ public:
     static MatchResult find_best_match(
         const std::vector<float>& query,
         const std::vector<std::pair<std::string, std::vector<float>>>& candidates);
+
+    // Score a query against `rows` rows of a row-major matrix whose rows are
+    // `stride` floats apart. out_scores receives `rows` clamped scores.
+    static void batch_similarity(const float* query, const float* matrix,
+                                 int rows, int dim, int stride, float* out_scores);
+
+    // Best-matching row of a row-major matrix (streaming kernel).
+    // Returns index -1 if rows == 0; speaker_id is left empty.
+    static MatchResult find_best_match(const float* query, const float* matrix,
+                                       int rows, int dim, int stride);
+
+    // K best-matching rows of a row-major matrix in one pass, using bounded
+    // selection instead of sorting all scores. Writes min(k, rows) entries
+    // to out in descending score order and returns that count.
+    static int find_top_k(const float* query, const float* matrix,
+                          int rows, int dim, int stride, int k, ScoredIndex* out);
+
+    // find_top_k for `num_queries` queries at once, computed as a cache-blocked
+    // [Q x dim] . [dim x rows] product: each block of gallery rows is scored
+    // against a whole block of queries while it is resident in L2, so the
+    // matrix is streamed from memory once per query block instead of once
+    // per query. Queries are row-major, `query_stride` floats apart. Results
+    // for query q go to out[q * k] (find_top_k semantics; scores may differ
+    // from it in the last bits because the summation order differs) and
+    // their count to out_counts[q].
+    static void find_top_k_batch(const float* queries, int num_queries, int query_stride,
+                                 const float* matrix, int rows, int dim, int stride,
+                                 int k, ScoredIndex* out, int* out_counts);
 };
 
 } // namespace vp
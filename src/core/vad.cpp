@@ -1,77 +1,123 @@
 #include "core/vad.h"
+#include "core/audio_processor.h"
+#include "core/onnx_model.h"
+#include "core/model_registry.h"
+#include "core/warmup.h"
+#include "utils/object_pool.h"
 #include "utils/logger.h"
 #include <onnxruntime_cxx_api.h>
 #include <cstring>
 #include <algorithm>
 #include <numeric>
-#ifdef _WIN32
-#include <Windows.h>
-#endif
 
 namespace vp {
 
 struct VoiceActivityDetector::Impl {
-    Ort::Session* session = nullptr;
-    Ort::SessionOptions session_options;
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-
-    // Combined hidden state for Silero VAD: [2, 1, 128]
-    std::vector<float> state;
-    int64_t sr_tensor_val = 16000;
-
     static constexpr int STATE_SIZE = 2 * 1 * 128;
 
-    Impl() {
-        state.resize(STATE_SIZE, 0.0f);
-    }
+    // One caller's Silero loop: the model window, the recurrent state
+    // ping-ponging between two buffers (Run writes stateN into the one not
+    // being read) and a binding per direction over these buffers. Bound on
+    // first use and pooled, so a call creates no tensors and binds nothing.
+    struct Runner {
+        float window[WINDOW_SIZE];
+        float state[2][STATE_SIZE];
+        float prob = 0.0f;
+        int64_t sr = 16000;
+        std::unique_ptr<OnnxModel::Binding> bindings[2];
+    };
+
+    std::shared_ptr<OnnxModel> model;   // core/model_registry.h
+    int input_index[3] = {};         // input, state, sr
+    int output_index[2] = {};        // output, stateN
+    ObjectPool<Runner> runners;
+
+    // Bind a runner if it is new. Returns false (model's last_error() set)
+    // on failure.
+    bool bind(Runner& runner);
+};
 
-    ~Impl() {
-        delete session;
+bool VoiceActivityDetector::Impl::bind(Runner& runner) {
+    if (runner.bindings[0]) return true;
+    const int64_t input_shape[] = {1, WINDOW_SIZE};
+    const int64_t state_shape[] = {2, 1, 128};
+    const int64_t sr_shape[] = {1};
+    const int64_t prob_shape[] = {1, 1};
+    std::unique_ptr<OnnxModel::Binding> bindings[2];
+    for (int k = 0; k < 2; ++k) {
+        bindings[k] = model->create_binding();
+        if (!bindings[k] ||
+            !bindings[k]->bind_input(input_index[0], runner.window, input_shape, 2) ||
+            !bindings[k]->bind_input(input_index[1], runner.state[k], state_shape, 3) ||
+            !bindings[k]->bind_input(input_index[2], &runner.sr, sr_shape, 1) ||
+            !bindings[k]->bind_output(output_index[0], &runner.prob, prob_shape, 2) ||
+            !bindings[k]->bind_output(output_index[1], runner.state[1 - k], state_shape, 3)) {
+            return false;
+        }
     }
-};
+    runner.bindings[0] = std::move(bindings[0]);
+    runner.bindings[1] = std::move(bindings[1]);
+    return true;
+}
+
+thread_local std::string VoiceActivityDetector::last_error_;
 
 VoiceActivityDetector::VoiceActivityDetector() : impl_(std::make_unique<Impl>()) {}
 
 VoiceActivityDetector::~VoiceActivityDetector() = default;
 
 bool VoiceActivityDetector::init(const std::string& model_path, void* ort_env) {
-    try {
-        Ort::Env* env = static_cast<Ort::Env*>(ort_env);
-
-        impl_->session_options.SetIntraOpNumThreads(1);
-        impl_->session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-
-        // Convert path to wide string for Windows (UTF-8 safe)
-        int wlen = MultiByteToWideChar(CP_UTF8, 0, model_path.c_str(), -1, nullptr, 0);
-        std::wstring wpath(wlen, 0);
-        MultiByteToWideChar(CP_UTF8, 0, model_path.c_str(), -1, &wpath[0], wlen);
-        impl_->session = new Ort::Session(*env, wpath.c_str(), impl_->session_options);
-
-        reset_states();
-        initialized_ = true;
-        VP_LOG_INFO("VAD model loaded successfully from: {}", model_path);
-        return true;
-    } catch (const Ort::Exception& e) {
-        last_error_ = std::string("Failed to load VAD model: ") + e.what();
+    Ort::Env* env = static_cast<Ort::Env*>(ort_env);
+    impl_->model = acquire_model(model_path, *env, ModelKind::VAD);
+    if (!impl_->model) {
+        last_error_ = "Failed to load VAD model: " + OnnxModel::last_error();
         VP_LOG_ERROR(last_error_);
         return false;
     }
-}
 
-void VoiceActivityDetector::reset_states() {
-    std::fill(impl_->state.begin(), impl_->state.end(), 0.0f);
+    // Silero VAD v5 names
+    const char* inputs[] = {"input", "state", "sr"};
+    const char* outputs[] = {"output", "stateN"};
+    for (int i = 0; i < 3; ++i) impl_->input_index[i] = impl_->model->input_index(inputs[i]);
+    for (int i = 0; i < 2; ++i) impl_->output_index[i] = impl_->model->output_index(outputs[i]);
+    for (int i = 0; i < 3; ++i) {
+        if (impl_->input_index[i] < 0 || (i < 2 && impl_->output_index[i] < 0)) {
+            last_error_ = "VAD model is not Silero VAD v5: no '" +
+                          std::string(impl_->input_index[i] < 0 ? inputs[i] : outputs[i]) + "'";
+            VP_LOG_ERROR(last_error_);
+            return false;
+        }
+    }
+
+    initialized_ = true;
+    VP_LOG_INFO("VAD model loaded successfully from: {}", model_path);
+    return true;
 }
 
 std::vector<SpeechSegment> VoiceActivityDetector::detect(const std::vector<float>& audio,
                                                           int sample_rate) {
+    std::vector<SpeechSegment> segments;
+    detect(Span<const float>(audio), sample_rate, segments);
+    return segments;
+}
+
+bool VoiceActivityDetector::detect(Span<const float> audio, int sample_rate,
+                                   std::vector<SpeechSegment>& segments) {
+    segments.clear();
     if (!initialized_) {
         last_error_ = "VAD not initialized";
-        return {};
+        return false;
     }
 
-    reset_states();
+    auto runner = impl_->runners.acquire();
+    if (!impl_->bind(*runner)) {
+        last_error_ = "VAD binding failed: " + OnnxModel::last_error();
+        return false;
+    }
+    std::fill_n(runner->state[0], Impl::STATE_SIZE, 0.0f);
+    int current = 0;
+    const float& prob = runner->prob;
 
-    std::vector<SpeechSegment> segments;
     const int window_size = WINDOW_SIZE;
     const int min_silence_samples = MIN_SILENCE_DURATION_MS * sample_rate / 1000;
     const int min_speech_samples = MIN_SPEECH_DURATION_MS * sample_rate / 1000;
@@ -82,42 +128,14 @@ std::vector<SpeechSegment> VoiceActivityDetector::detect(const std::vector<float
     float speech_confidence_sum = 0.0f;
     int speech_frame_count = 0;
 
-    // Input/output names (Silero VAD v5 format)
-    const char* input_names[] = {"input", "state", "sr"};
-    const char* output_names[] = {"output", "stateN"};
-
     for (size_t offset = 0; offset + window_size <= audio.size(); offset += window_size) {
-        // Prepare input tensor: [1, window_size]
-        std::vector<float> window(audio.begin() + offset, audio.begin() + offset + window_size);
-        int64_t input_shape[] = {1, window_size};
-        Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-            impl_->memory_info, window.data(), window.size(), input_shape, 2);
-
-        // State tensor: [2, 1, 128]
-        int64_t state_shape[] = {2, 1, 128};
-        Ort::Value state_tensor = Ort::Value::CreateTensor<float>(
-            impl_->memory_info, impl_->state.data(), impl_->state.size(), state_shape, 3);
-
-        // Sample rate tensor: scalar
-        int64_t sr_shape[] = {1};
-        Ort::Value sr_tensor = Ort::Value::CreateTensor<int64_t>(
-            impl_->memory_info, &impl_->sr_tensor_val, 1, sr_shape, 1);
-
-        // Run inference
-        std::vector<Ort::Value> inputs;
-        inputs.push_back(std::move(input_tensor));
-        inputs.push_back(std::move(state_tensor));
-        inputs.push_back(std::move(sr_tensor));
-
-        auto outputs = impl_->session->Run(Ort::RunOptions{nullptr},
-                                           input_names, inputs.data(), inputs.size(),
-                                           output_names, 2);
-
-        float prob = outputs[0].GetTensorData<float>()[0];
-
-        // Update hidden state
-        const float* new_state = outputs[1].GetTensorData<float>();
-        std::memcpy(impl_->state.data(), new_state, impl_->state.size() * sizeof(float));
+        std::memcpy(runner->window, audio.data() + offset, sizeof(runner->window));
+        if (!runner->bindings[current]->run()) {
+            last_error_ = "VAD inference failed: " + OnnxModel::last_error();
+            segments.clear();
+            return false;
+        }
+        current = 1 - current;
 
         int current_sample = static_cast<int>(offset);
 
@@ -164,34 +182,122 @@ std::vector<SpeechSegment> VoiceActivityDetector::detect(const std::vector<float
         }
     }
 
-    // Merge adjacent segments (gap < MIN_SILENCE_DURATION_MS)
+    // Merge adjacent segments (gap < MIN_SILENCE_DURATION_MS), in place
     if (segments.size() > 1) {
-        std::vector<SpeechSegment> merged;
-        merged.push_back(segments[0]);
+        size_t merged = 0;
         for (size_t i = 1; i < segments.size(); ++i) {
-            int gap = segments[i].start_sample - merged.back().end_sample;
+            int gap = segments[i].start_sample - segments[merged].end_sample;
             if (gap < min_silence_samples) {
-                merged.back().end_sample = segments[i].end_sample;
-                merged.back().confidence = (merged.back().confidence + segments[i].confidence) / 2.0f;
+                segments[merged].end_sample = segments[i].end_sample;
+                segments[merged].confidence = (segments[merged].confidence + segments[i].confidence) / 2.0f;
             } else {
-                merged.push_back(segments[i]);
+                segments[++merged] = segments[i];
             }
         }
-        segments = std::move(merged);
+        segments.resize(merged + 1);
     }
 
     VP_LOG_INFO("VAD detected {} speech segments", segments.size());
-    return segments;
+    return true;
+}
+
+bool VoiceActivityDetector::push(Stream& stream, Span<const float> audio,
+                                 std::vector<float>& speech) {
+    if (!initialized_) {
+        last_error_ = "VAD not initialized";
+        return false;
+    }
+
+    // The stream's state goes through a pooled runner and back, so pushes
+    // share the bindings too
+    auto runner = impl_->runners.acquire();
+    if (!impl_->bind(*runner)) {
+        last_error_ = "VAD binding failed: " + OnnxModel::last_error();
+        return false;
+    }
+    std::memcpy(runner->state[0], stream.state, sizeof(stream.state));
+    int current = 0;
+
+    const size_t min_silence_samples = MIN_SILENCE_DURATION_MS * 16000 / 1000;
+    const size_t min_speech_samples = MIN_SPEECH_DURATION_MS * 16000 / 1000;
+    std::vector<float>& held = stream.held;
+
+    bool ok = true;
+    size_t offset = 0;
+    while (offset < audio.size()) {
+        const size_t n = std::min(audio.size() - offset,
+                                  static_cast<size_t>(WINDOW_SIZE - stream.filled));
+        std::memcpy(stream.window + stream.filled, audio.data() + offset, n * sizeof(float));
+        stream.filled += static_cast<int>(n);
+        offset += n;
+        if (stream.filled < WINDOW_SIZE) break;
+        stream.filled = 0;
+
+        std::memcpy(runner->window, stream.window, sizeof(stream.window));
+        if (!runner->bindings[current]->run()) {
+            last_error_ = "VAD inference failed: " + OnnxModel::last_error();
+            ok = false;
+            break;
+        }
+        current = 1 - current;
+
+        if (runner->prob >= THRESHOLD) {
+            if (!stream.in_speech) {
+                stream.in_speech = true;
+                stream.confirmed = false;
+                held.clear();
+            }
+            stream.silence = 0;
+            held.insert(held.end(), stream.window, stream.window + WINDOW_SIZE);
+            if (held.size() >= min_speech_samples) stream.confirmed = true;
+            if (stream.confirmed) {
+                speech.insert(speech.end(), held.begin(), held.end());
+                held.clear();
+            }
+        } else if (stream.in_speech) {
+            stream.silence += WINDOW_SIZE;
+            if (static_cast<size_t>(stream.silence) >= min_silence_samples) {
+                // Segment over; a segment that never reached the minimum
+                // length is dropped
+                stream.in_speech = false;
+                held.clear();
+            } else {
+                held.insert(held.end(), stream.window, stream.window + WINDOW_SIZE);
+            }
+        }
+    }
+    // State as of the last window that ran
+    std::memcpy(stream.state, runner->state[current], sizeof(stream.state));
+    return ok;
+}
+
+void VoiceActivityDetector::warm_up(VpWarmupStats& stats) {
+    if (!initialized_) return;
+    // One window shape: a second of audio covers it
+    const std::vector<float> audio = AudioProcessor::synthetic_speech(16000);
+    std::vector<SpeechSegment> segments;
+    warm_up_call("VAD", [&] {
+        return detect(Span<const float>(audio), 16000, segments);
+    }, stats, stats.vad_ms);
 }
 
 std::vector<float> VoiceActivityDetector::filter_silence(const std::vector<float>& audio,
                                                           int sample_rate) {
-    auto segments = detect(audio, sample_rate);
+    std::vector<float> filtered;
+    std::vector<SpeechSegment> segments;
+    filter_silence(Span<const float>(audio), sample_rate, filtered, segments);
+    return filtered;
+}
+
+bool VoiceActivityDetector::filter_silence(Span<const float> audio, int sample_rate,
+                                           std::vector<float>& filtered,
+                                           std::vector<SpeechSegment>& segments) {
+    filtered.clear();
+    if (!detect(audio, sample_rate, segments)) return false;
     if (segments.empty()) {
-        return {};
+        return true;
     }
 
-    std::vector<float> filtered;
     for (const auto& seg : segments) {
         int start = std::max(0, seg.start_sample);
         int end = std::min(static_cast<int>(audio.size()), seg.end_sample);
@@ -201,7 +307,7 @@ std::vector<float> VoiceActivityDetector::filter_silence(const std::vector<float
     VP_LOG_INFO("VAD: input {} samples -> output {} samples (filtered {}%)",
                 audio.size(), filtered.size(),
                 100 - (filtered.size() * 100 / std::max(audio.size(), size_t(1))));
-    return filtered;
+    return true;
 }
 
 float VoiceActivityDetector::get_speech_duration(const std::vector<SpeechSegment>& segments,
@@ -4,14 +4,9 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include "utils/span.h"
 
-namespace Ort {
-    struct Env;
-    struct Session;
-    struct SessionOptions;
-    struct MemoryInfo;
-    struct Value;
-}
+struct VpWarmupStats;
 
 namespace vp {
 
@@ -29,23 +24,59 @@ public:
     // Initialize with ONNX model path
     bool init(const std::string& model_path, void* ort_env);
 
-    // Detect speech segments in audio (16kHz, float32)
+    // Detect speech segments in audio (16kHz, float32). Thread-safe after
+    // init(): the recurrent state lives on the caller's stack.
     std::vector<SpeechSegment> detect(const std::vector<float>& audio, int sample_rate = 16000);
 
+    // Same, into `segments` (capacity reused); allocation-free once warm.
+    // Returns false (last_error() set, segments empty) if the VAD is not
+    // initialized or the model failed, so a failure is never mistaken for
+    // audio without speech
+    bool detect(Span<const float> audio, int sample_rate, std::vector<SpeechSegment>& segments);
+
     // Filter audio to only include speech segments
     std::vector<float> filter_silence(const std::vector<float>& audio, int sample_rate = 16000);
 
+    // Same, into `filtered`; `segments` is scratch for detect(). Returns
+    // false if detect() failed
+    bool filter_silence(Span<const float> audio, int sample_rate, std::vector<float>& filtered,
+                        std::vector<SpeechSegment>& segments);
+
+    // Incremental detection state for live audio, one per stream: Silero
+    // recurrent state, the partial window and the current segment
+    struct Stream {
+        float state[2 * 1 * 128] = {};
+        float window[512];              // one model window (WINDOW_SIZE)
+        int filled = 0;                 // samples in window
+        bool in_speech = false;
+        bool confirmed = false;         // segment reached the minimum speech length
+        int silence = 0;                // trailing non-speech samples in held
+        std::vector<float> held;        // samples not yet known to be kept
+    };
+
+    // Feed the next chunk of a 16kHz stream (any length). Samples known to
+    // be speech are appended to `speech`: a segment once it reaches the
+    // minimum speech duration, a pause once speech resumes within the
+    // minimum silence. Same rules as filter_silence(), decided up to one
+    // window plus the minimum silence later. Thread-safe across streams.
+    // Returns false (last_error() set) if the model failed; the rest of the
+    // chunk is then dropped and the stream resumes with the next one.
+    bool push(Stream& stream, Span<const float> audio, std::vector<float>& speech);
+
+    // Run the model on synthetic audio so the first real detect() finds its
+    // arena and plan in place; timings go to stats.vad_ms. No-op before init()
+    void warm_up(VpWarmupStats& stats);
+
     // Get total speech duration in seconds
     float get_speech_duration(const std::vector<SpeechSegment>& segments, int sample_rate = 16000);
 
+    // Error of the calling thread's last failed call
     const std::string& last_error() const { return last_error_; }
 
 private:
-    void reset_states();
-
     struct Impl;
     std::unique_ptr<Impl> impl_;
-    std::string last_error_;
+    static thread_local std::string last_error_;
     bool initialized_ = false;
 
     // Model parameters
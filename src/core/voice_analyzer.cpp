@@ -2,9 +2,14 @@
 #include "fbank_extractor.h"
 #include "vad.h"
 #include "onnx_model.h"
+#include "model_registry.h"
 #include "audio_processor.h"
 #include "loudness.h"
 #include "pitch_analyzer.h"
+#include "result_cache.h"
+#include "length_buckets.h"
+#include "warmup.h"
+#include "utils/hash.h"
 #include "utils/logger.h"
 #include "utils/error_codes.h"
 #include <voiceprint/voiceprint_api.h>
@@ -33,22 +38,24 @@ inline float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
 template<typename T>
 inline T clamp(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
 
-// Try loading an ONNX model, log warning if missing
-bool try_load_model(OnnxModel& model, const std::string& model_dir,
-                    const std::string& filename, void* ort_env) {
+// Try loading an ONNX model (shared with other users of the same file),
+// log warning if missing
+std::shared_ptr<OnnxModel> try_load_model(const std::string& model_dir,
+                                          const std::string& filename, void* ort_env) {
     namespace fs = std::filesystem;
     std::string path = (fs::path(model_dir) / filename).string();
     if (!fs::exists(path)) {
         VP_LOG_WARN("Optional model not found (feature disabled): {}", path);
-        return false;
+        return nullptr;
     }
     Ort::Env& env = *static_cast<Ort::Env*>(ort_env);
-    if (!model.load(path, env)) {
-        VP_LOG_WARN("Failed to load model {}: {}", path, model.last_error());
-        return false;
+    auto model = acquire_model(path, env, ModelKind::ANALYZER);
+    if (!model) {
+        VP_LOG_WARN("Failed to load model {}: {}", path, OnnxModel::last_error());
+        return nullptr;
     }
     VP_LOG_INFO("Loaded model: {}", path);
-    return true;
+    return model;
 }
 
 } // anonymous namespace
@@ -65,13 +72,15 @@ VoiceAnalyzer::~VoiceAnalyzer() = default;
 bool VoiceAnalyzer::init(const std::string& model_dir,
                          unsigned int feature_flags, void* ort_env) {
     ort_env_ = ort_env;
-    fbank_->init(80, 16000, 25.0f, 10.0f);
+    fbank_->init(80, 16000, 25.0f, 10.0f, fbank_engine());
 
     // Initialize VAD (required for speech segmentation in all pipelines)
     namespace fs = std::filesystem;
     std::string vad_path = (fs::path(model_dir) / "silero_vad.onnx").string();
+    vad_loaded_ = false;
     if (fs::exists(vad_path)) {
-        if (!vad_->init(vad_path, ort_env)) {
+        vad_loaded_ = vad_->init(vad_path, ort_env);
+        if (!vad_loaded_) {
             VP_LOG_WARN("VAD init failed for voice analyzer, will skip VAD: {}",
                         vad_->last_error());
         }
@@ -79,46 +88,33 @@ bool VoiceAnalyzer::init(const std::string& model_dir,
 
     // Load optional feature models according to requested flags
     if (feature_flags & (VP_FEATURE_GENDER | VP_FEATURE_AGE)) {
-        gender_age_model_ = std::make_unique<OnnxModel>();
-        if (try_load_model(*gender_age_model_, model_dir, "gender_age.onnx", ort_env))
+        gender_age_model_ = try_load_model(model_dir, "gender_age.onnx", ort_env);
+        if (gender_age_model_)
             loaded_features_ |= VP_FEATURE_GENDER | VP_FEATURE_AGE;
-        else
-            gender_age_model_.reset();
     }
 
     if (feature_flags & VP_FEATURE_EMOTION) {
-        emotion_model_ = std::make_unique<OnnxModel>();
-        if (try_load_model(*emotion_model_, model_dir, "emotion.onnx", ort_env))
+        emotion_model_ = try_load_model(model_dir, "emotion.onnx", ort_env);
+        if (emotion_model_)
             loaded_features_ |= VP_FEATURE_EMOTION;
-        else
-            emotion_model_.reset();
     }
 
     if (feature_flags & VP_FEATURE_ANTISPOOF) {
-        antispoof_model_ = std::make_unique<OnnxModel>();
-        if (try_load_model(*antispoof_model_, model_dir, "antispoof.onnx", ort_env))
+        antispoof_model_ = try_load_model(model_dir, "antispoof.onnx", ort_env);
+        if (antispoof_model_)
             loaded_features_ |= VP_FEATURE_ANTISPOOF;
-        else
-            antispoof_model_.reset();
     }
 
     if (feature_flags & VP_FEATURE_QUALITY) {
-        dnsmos_model_ = std::make_unique<OnnxModel>();
-        if (try_load_model(*dnsmos_model_, model_dir, "dnsmos.onnx", ort_env))
-            loaded_features_ |= VP_FEATURE_QUALITY;
-        else {
-            // Quality DSP still works without DNSMOS model (MOS will be estimated)
-            dnsmos_model_.reset();
-            loaded_features_ |= VP_FEATURE_QUALITY;
-        }
+        // Quality DSP still works without DNSMOS model (MOS will be estimated)
+        dnsmos_model_ = try_load_model(model_dir, "dnsmos.onnx", ort_env);
+        loaded_features_ |= VP_FEATURE_QUALITY;
     }
 
     if (feature_flags & VP_FEATURE_LANGUAGE) {
-        language_model_ = std::make_unique<OnnxModel>();
-        if (try_load_model(*language_model_, model_dir, "language.onnx", ort_env))
+        language_model_ = try_load_model(model_dir, "language.onnx", ort_env);
+        if (language_model_)
             loaded_features_ |= VP_FEATURE_LANGUAGE;
-        else
-            language_model_.reset();
     }
 
     // DSP-only features always available
@@ -126,11 +122,74 @@ bool VoiceAnalyzer::init(const std::string& model_dir,
     if (feature_flags & VP_FEATURE_PLEASANTNESS)  loaded_features_ |= VP_FEATURE_PLEASANTNESS;
     if (feature_flags & VP_FEATURE_VOICE_STATE)   loaded_features_ |= VP_FEATURE_VOICE_STATE;
 
+    // Cached results are only valid for the same set of model files and
+    // FBank front-end
+    const int engine = static_cast<int>(fbank_->engine());
+    models_fingerprint_ = xxhash64(&engine, sizeof(engine), 0);
+    for (const auto* model : {&gender_age_model_, &emotion_model_, &antispoof_model_,
+                              &dnsmos_model_, &language_model_}) {
+        const uint64_t fp = *model ? (*model)->fingerprint() : 0;
+        models_fingerprint_ = xxhash64(&fp, sizeof(fp), models_fingerprint_);
+    }
+
     initialized_ = true;
     VP_LOG_INFO("VoiceAnalyzer initialized, loaded_features=0x{:03x}", loaded_features_);
     return true;
 }
 
+// ============================================================
+bool VoiceAnalyzer::warm_up(const std::vector<float>& seconds, VpWarmupStats& stats) {
+    if (!initialized_) return false;
+    vad_->warm_up(stats);
+
+    auto call = [](OnnxModel& model, const std::vector<float>& input,
+                   const std::vector<int64_t>& shape) {
+        return [&model, &input, shape] { return !model.run(input, shape).empty(); };
+    };
+    bool ok = true;
+
+    // Variable-length models take [1, T, 80] FBank
+    for (float sec : seconds) {
+        if (!gender_age_model_ && !emotion_model_) break;
+        const auto audio = AudioProcessor::synthetic_speech(
+            static_cast<size_t>(std::lround(sec * 16000.0f)));
+        const auto fbank = fbank_->extract(audio);
+        int frames = static_cast<int>(fbank.size() / LANG_MEL_BINS);
+        if (frames <= 0) continue;
+        std::vector<float> scratch;
+        const std::vector<float>& input = bucketed(fbank, frames, LANG_MEL_BINS, scratch);
+        const std::vector<int64_t> shape = {1, frames, LANG_MEL_BINS};
+        const std::string at = " (" + std::to_string(frames) + " frames)";
+        if (gender_age_model_) {
+            ok &= warm_up_call("gender/age model" + at, call(*gender_age_model_, input, shape),
+                               stats, stats.analyzer_ms);
+        }
+        if (emotion_model_) {
+            ok &= warm_up_call("emotion model" + at, call(*emotion_model_, input, shape),
+                               stats, stats.analyzer_ms);
+        }
+    }
+
+    // Fixed-shape models: one run each, same input layout as analyze()
+    if (antispoof_model_) {
+        const auto input = AudioProcessor::synthetic_speech(ANTISPOOF_SAMPLES);
+        ok &= warm_up_call("anti-spoof model", call(*antispoof_model_, input, {1, ANTISPOOF_SAMPLES}),
+                           stats, stats.analyzer_ms);
+    }
+    if (dnsmos_model_) {
+        const std::vector<float> input(static_cast<size_t>(LANG_MEL_BINS) * 512, 0.0f);
+        ok &= warm_up_call("DNSMOS model", call(*dnsmos_model_, input, {1, LANG_MEL_BINS, 512}),
+                           stats, stats.analyzer_ms);
+    }
+    if (language_model_) {
+        const std::vector<float> input(static_cast<size_t>(LANG_MEL_BINS) * LANG_MEL_FRAMES, 0.0f);
+        ok &= warm_up_call("language model",
+                           call(*language_model_, input, {1, LANG_MEL_BINS, LANG_MEL_FRAMES}),
+                           stats, stats.analyzer_ms);
+    }
+    return ok;
+}
+
 // ============================================================
 int VoiceAnalyzer::analyze(const float* pcm_in, int sample_count,
                            unsigned int feature_flags, VpAnalysisResult* out) {
@@ -143,17 +202,39 @@ int VoiceAnalyzer::analyze(const float* pcm_in, int sample_count,
         return VP_ERROR_INVALID_PARAM;
     }
 
+    // Identical audio and flags seen before
+    auto cache = std::atomic_load(&result_cache_);
+    ResultKey key;
+    if (cache) {
+        const unsigned int flags[2] = {feature_flags, loaded_features_};
+        uint64_t context = xxhash64(flags, sizeof(flags), models_fingerprint_);
+        if (auto buckets = std::atomic_load(&buckets_)) {
+            const std::vector<int>& frames = buckets->frames();
+            context = xxhash64(frames.data(), frames.size() * sizeof(int), context);
+        }
+        key = ResultCache::make_key(Span<const float>(pcm_in, static_cast<size_t>(sample_count)),
+                                    context);
+        if (cache->get_analysis(key, out)) return VP_OK;
+    }
+
     std::memset(out, 0, sizeof(VpAnalysisResult));
 
     // Build speech-only and noise PCM for quality analysis
     std::vector<float> pcm(pcm_in, pcm_in + sample_count);
-    std::vector<float> speech_pcm = pcm;
+    std::vector<float> speech_pcm;   // full audio unless the VAD finds speech
     std::vector<float> noise_pcm;
 
-    // Run VAD to separate speech and noise
-    auto segments = vad_->detect(pcm);
+    // Run VAD to separate speech and noise. A loaded VAD that fails is an
+    // error, not audio without speech
+    std::vector<SpeechSegment> segments;
+    if (vad_loaded_ &&
+        !vad_->filter_silence(Span<const float>(pcm), 16000, speech_pcm, segments)) {
+        last_error_ = vad_->last_error();
+        VP_LOG_ERROR(last_error_);
+        set_last_error(ErrorCode::INFERENCE, last_error_);
+        return VP_ERROR_INFERENCE;
+    }
     if (!segments.empty()) {
-        speech_pcm = vad_->filter_silence(pcm);
         // Collect noise: samples NOT in any speech segment
         std::vector<bool> is_speech(pcm.size(), false);
         for (auto& seg : segments)
@@ -245,9 +326,32 @@ int VoiceAnalyzer::analyze(const float* pcm_in, int sample_count,
     }
 
     out->features_computed = computed;
+    if (cache) cache->put_analysis(key, *out);
     return VP_OK;
 }
 
+void VoiceAnalyzer::set_result_cache(std::shared_ptr<ResultCache> cache) {
+    std::atomic_store(&result_cache_, std::move(cache));
+}
+
+void VoiceAnalyzer::set_length_buckets(std::shared_ptr<const LengthBuckets> buckets) {
+    if (buckets && buckets->empty()) buckets.reset();
+    std::atomic_store(&buckets_, std::move(buckets));
+}
+
+const std::vector<float>& VoiceAnalyzer::bucketed(const std::vector<float>& fbank,
+                                                  int& num_frames, int num_bins,
+                                                  std::vector<float>& scratch) const {
+    auto buckets = std::atomic_load(&buckets_);
+    if (!buckets) return fbank;
+    const int target = buckets->crop_to(num_frames);
+    if (target == num_frames) return fbank;
+    scratch.resize(static_cast<size_t>(target) * num_bins);
+    fit_frames(fbank.data(), num_frames, num_bins, target, false, scratch.data());
+    num_frames = target;
+    return scratch;
+}
+
 // ============================================================
 // Gender + Age  (gender_age.onnx)
 // Expected I/O: input [1, T, 80] → output [7] (3 gender logits +
@@ -259,9 +363,11 @@ int VoiceAnalyzer::analyze_gender_age(const std::vector<float>& fbank,
                                       VpGenderResult* g, VpAgeResult* a) {
     if (!gender_age_model_ || num_frames <= 0) return VP_ERROR_MODEL_NOT_AVAILABLE;
 
+    std::vector<float> scratch;
+    const std::vector<float>& input = bucketed(fbank, num_frames, num_bins, scratch);
     std::vector<int64_t> shape = {1, num_frames, num_bins};
     try {
-        auto out = gender_age_model_->run(fbank, shape);
+        auto out = gender_age_model_->run(input, shape);
         // Minimum expected outputs: 3 gender logits + 4 age group logits
         if (out.size() < 7) {
             last_error_ = "gender_age model unexpected output size";
@@ -307,9 +413,11 @@ int VoiceAnalyzer::analyze_emotion(const std::vector<float>& fbank,
                                    VpEmotionResult* out) {
     if (!emotion_model_ || num_frames <= 0) return VP_ERROR_MODEL_NOT_AVAILABLE;
 
+    std::vector<float> scratch;
+    const std::vector<float>& input = bucketed(fbank, num_frames, num_bins, scratch);
     std::vector<int64_t> shape = {1, num_frames, num_bins};
     try {
-        auto raw = emotion_model_->run(fbank, shape);
+        auto raw = emotion_model_->run(input, shape);
         if (raw.size() < VP_EMOTION_COUNT) {
             last_error_ = "emotion model unexpected output size";
             return VP_ERROR_INFERENCE;
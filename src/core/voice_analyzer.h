@@ -2,6 +2,7 @@
 #define VP_VOICE_ANALYZER_H
 
 #include <voiceprint/voiceprint_types.h>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -11,6 +12,8 @@ namespace vp {
 class FbankExtractor;
 class VoiceActivityDetector;
 class OnnxModel;
+class ResultCache;
+class LengthBuckets;
 
 /**
  * VoiceAnalyzer provides speech analysis beyond speaker identity:
@@ -52,10 +55,32 @@ public:
     int analyze(const float* pcm, int sample_count,
                 unsigned int feature_flags, VpAnalysisResult* out);
 
+    /**
+     * Run every loaded model once on synthetic input: gender/age and
+     * emotion at each length in `seconds`, the fixed-shape models
+     * (anti-spoof, DNSMOS, language) at their one shape, plus the VAD.
+     * Timings are added to `stats`. Returns false if a call failed.
+     */
+    bool warm_up(const std::vector<float>& seconds, VpWarmupStats& stats);
+
     /** Anti-spoof check enabled inside vp_verify/identify */
     void set_antispoof_enabled(bool enabled) { antispoof_in_pipeline_ = enabled; }
     bool antispoof_enabled() const           { return antispoof_in_pipeline_; }
 
+    /**
+     * Serve repeated audio from `cache`, keyed by PCM content, feature flags
+     * and the loaded model files; null turns it off (default).
+     */
+    void set_result_cache(std::shared_ptr<ResultCache> cache);
+
+    /**
+     * Run the gender/age and emotion models at bucketed frame counts
+     * (core/length_buckets.h). Neither masks padding, so inputs are cropped
+     * to the bucket below (padded only below the smallest); null: exact
+     * lengths (default).
+     */
+    void set_length_buckets(std::shared_ptr<const LengthBuckets> buckets);
+
     unsigned int loaded_features() const { return loaded_features_; }
     const std::string& last_error() const { return last_error_; }
 
@@ -97,6 +122,11 @@ private:
     int analyze_language(const std::vector<float>& pcm16k,
                          VpLanguageResult* out);
 
+    // `fbank` as a [T, 80] model input: itself, or under a bucket policy a
+    // copy cropped / padded into `scratch`, with num_frames updated
+    const std::vector<float>& bucketed(const std::vector<float>& fbank, int& num_frames,
+                                       int num_bins, std::vector<float>& scratch) const;
+
     // --- DSP helpers ---
     static float estimate_mos_from_metrics(float snr_db, float hnr_db);
     static void  fill_language_info(int lang_idx, VpLanguageResult* out);
@@ -111,15 +141,20 @@ private:
     std::unique_ptr<FbankExtractor>      fbank_;
     std::unique_ptr<VoiceActivityDetector> vad_;
 
-    std::unique_ptr<OnnxModel> gender_age_model_;   // VP_FEATURE_GENDER|AGE
-    std::unique_ptr<OnnxModel> emotion_model_;      // VP_FEATURE_EMOTION
-    std::unique_ptr<OnnxModel> antispoof_model_;    // VP_FEATURE_ANTISPOOF
-    std::unique_ptr<OnnxModel> dnsmos_model_;       // VP_FEATURE_QUALITY (MOS part)
-    std::unique_ptr<OnnxModel> language_model_;     // VP_FEATURE_LANGUAGE
+    std::shared_ptr<OnnxModel> gender_age_model_;   // VP_FEATURE_GENDER|AGE
+    std::shared_ptr<OnnxModel> emotion_model_;      // VP_FEATURE_EMOTION
+    std::shared_ptr<OnnxModel> antispoof_model_;    // VP_FEATURE_ANTISPOOF
+    std::shared_ptr<OnnxModel> dnsmos_model_;       // VP_FEATURE_QUALITY (MOS part)
+    std::shared_ptr<OnnxModel> language_model_;     // VP_FEATURE_LANGUAGE
+
+    std::shared_ptr<ResultCache> result_cache_;   // atomic_load/store; null when off
+    std::shared_ptr<const LengthBuckets> buckets_;   // atomic_load/store; null when off
+    uint64_t     models_fingerprint_ = 0;  // loaded model files, for cache keys
 
     void*        ort_env_         = nullptr;
     unsigned int loaded_features_ = 0;
     bool         antispoof_in_pipeline_ = false;
+    bool         vad_loaded_     = false;  // else analysis runs on the full audio
     bool         initialized_    = false;
     std::string  last_error_;
 
@@ -0,0 +1,41 @@
+#ifndef VP_WARMUP_H
+#define VP_WARMUP_H
+
+#include <voiceprint/voiceprint_types.h>
+#include "utils/logger.h"
+#include <chrono>
+#include <string>
+
+namespace vp {
+
+// Run one synthetic model call twice, cold then warm, and fold the timings
+// into `stats` (runs, slowest first call) and `bucket_ms` (the stats field
+// of the model family). ORT allocates its arenas and plans kernels for a
+// shape on the first Run; the second shows the steady-state cost. Returns
+// false if a call failed (logged; warm-up is best-effort).
+template <typename Call>
+bool warm_up_call(const std::string& what, Call&& call, VpWarmupStats& stats, float& bucket_ms) {
+    float ms[2];
+    for (int i = 0; i < 2; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        const bool ok = call();
+        ms[i] = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        ++stats.runs;
+        bucket_ms += ms[i];
+        if (!ok) {
+            VP_LOG_WARN("Warm-up of {} failed", what);
+            return false;
+        }
+    }
+    if (ms[0] > stats.first_run_ms) {
+        stats.first_run_ms = ms[0];
+        stats.second_run_ms = ms[1];
+    }
+    VP_LOG_INFO("Warm-up {}: first run {:.1f} ms, second {:.1f} ms", what, ms[0], ms[1]);
+    return true;
+}
+
+} // namespace vp
+
+#endif // VP_WARMUP_H
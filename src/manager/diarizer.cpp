@@ -49,6 +49,20 @@ bool Diarizer::init(const std::string& model_dir, void* ort_env,
     return true;
 }
 
+void Diarizer::set_result_cache(std::shared_ptr<ResultCache> cache) {
+    extractor_->set_result_cache(std::move(cache));
+}
+
+void Diarizer::set_length_buckets(std::shared_ptr<const LengthBuckets> buckets) {
+    extractor_->set_length_buckets(std::move(buckets));
+}
+
+bool Diarizer::warm_up(const std::vector<float>& seconds, VpWarmupStats& stats) {
+    if (!initialized_) return false;
+    vad_->warm_up(stats);
+    return extractor_->warm_up(seconds, stats);
+}
+
 int Diarizer::diarize(const float* pcm_in, int sample_count,
                       VpDiarizeSegment* out_segments, int max_segments,
                       int* out_count) {
@@ -68,7 +82,13 @@ int Diarizer::diarize(const float* pcm_in, int sample_count,
     // ----------------------------------------------------------------
     // Step 1: VAD → speech segments
     // ----------------------------------------------------------------
-    auto segments = vad_->detect(pcm, SR);
+    std::vector<SpeechSegment> segments;
+    if (!vad_->detect(Span<const float>(pcm), SR, segments)) {
+        last_error_ = vad_->last_error();
+        VP_LOG_ERROR("Diarizer: {}", last_error_);
+        set_last_error(ErrorCode::INFERENCE, last_error_);
+        return VP_ERROR_INFERENCE;
+    }
     if (segments.empty()) {
         VP_LOG_WARN("Diarizer: no speech detected");
         return VP_OK;  // 0 segments is valid
@@ -148,14 +168,13 @@ int Diarizer::diarize(const float* pcm_in, int sample_count,
     std::vector<std::string> cluster_speaker_id(K);
     if (manager_) {
         for (int k = 0; k < K; ++k) {
+            if (centroid_count[k] == 0) continue;
+            // Cluster centroids are already embeddings: search the gallery directly
             std::string sid;
             float score = 0.0f;
-            // We use identify() by passing centroid as PCM is not available here.
-            // Instead directly call the manager's internal cache search
-            // (exposed via a helper that accepts an embedding vector).
-            // For now: use the centroid embedding as a synthetic 1-sample lookup.
-            // This is a best-effort match - low confidence expected.
-            (void)sid; (void)score;  // placeholder until manager exposes embedding search
+            int rc = manager_->identify_embedding(centroids[k].data(),
+                                                  static_cast<int>(centroids[k].size()), sid, score);
+            if (rc == VP_OK) cluster_speaker_id[k] = sid;
         }
     }
 
@@ -11,6 +11,8 @@ namespace vp {
 class EmbeddingExtractor;
 class VoiceActivityDetector;
 class SpeakerManager;
+class ResultCache;
+class LengthBuckets;
 
 /**
  * Multi-speaker diarization using VAD + speaker embeddings + agglomerative clustering.
@@ -41,6 +43,22 @@ public:
      */
     void set_threshold(float threshold) { threshold_ = threshold; }
 
+    /**
+     * Serve segment embeddings of repeated audio from `cache` (null: off).
+     */
+    void set_result_cache(std::shared_ptr<ResultCache> cache);
+
+    /**
+     * Run segment embeddings at bucketed input lengths (null: exact lengths).
+     */
+    void set_length_buckets(std::shared_ptr<const LengthBuckets> buckets);
+
+    /**
+     * Warm up the diarizer's own VAD and speaker model sessions at each
+     * length (seconds), see EmbeddingExtractor::warm_up.
+     */
+    bool warm_up(const std::vector<float>& seconds, VpWarmupStats& stats);
+
     /**
      * Diarize a PCM audio stream.
      * @param pcm            Float32, 16kHz mono.
@@ -0,0 +1,483 @@
+#include "manager/speaker_gallery.h"
+#include "core/similarity.h"
+#include "core/quantized_search.h"
+#include "utils/mapped_file.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+
+namespace vp {
+
+namespace {
+
+constexpr int FLOATS_PER_LINE = static_cast<int>(SpeakerGallery::ALIGNMENT / sizeof(float));
+constexpr int CODES_PER_LINE  = static_cast<int>(SpeakerGallery::ALIGNMENT);
+
+template <typename T>
+T* aligned_alloc_array(size_t count) {
+    return static_cast<T*>(::operator new(count * sizeof(T),
+                                          std::align_val_t(SpeakerGallery::ALIGNMENT)));
+}
+
+template <typename T>
+void aligned_free_array(T* p) {
+    ::operator delete(p, std::align_val_t(SpeakerGallery::ALIGNMENT));
+}
+
+constexpr uint32_t SNAPSHOT_MAGIC   = 0x53475056;   // "VPGS"
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+// Snapshot file layout: header, then 64-byte-aligned sections at the given
+// offsets. ID i is id_bytes[id_offsets[i], id_offsets[i + 1]).
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    int64_t  generation;
+    int32_t  dim;
+    int32_t  stride;
+    int32_t  rows;
+    int32_t  reserved;
+    uint64_t id_offsets;   // uint64_t[rows + 1]
+    uint64_t id_bytes;     // concatenated IDs
+    uint64_t counts;       // int32_t[rows] enroll counts
+    uint64_t sorted;       // int32_t[rows] row numbers in ID order
+    uint64_t matrix;       // float[rows x stride]
+    uint64_t file_size;
+};
+
+uint64_t align_up(uint64_t v) {
+    return (v + SpeakerGallery::ALIGNMENT - 1) / SpeakerGallery::ALIGNMENT * SpeakerGallery::ALIGNMENT;
+}
+
+void write_padding(std::ofstream& out, uint64_t to) {
+    static const char zeros[SpeakerGallery::ALIGNMENT] = {};
+    uint64_t at = static_cast<uint64_t>(out.tellp());
+    if (to > at) out.write(zeros, static_cast<std::streamsize>(to - at));
+}
+
+} // anonymous namespace
+
+struct SpeakerGallery::Snapshot {
+    MappedFile file;
+    const uint64_t* id_offsets = nullptr;
+    const char* id_bytes = nullptr;
+    const int32_t* counts = nullptr;
+    const int32_t* sorted = nullptr;
+    const float* matrix = nullptr;
+    int rows = 0;
+
+    std::string_view id(int r) const {
+        return std::string_view(id_bytes + id_offsets[r], id_offsets[r + 1] - id_offsets[r]);
+    }
+
+    // Binary search over the ID-ordered row table
+    int find(std::string_view speaker_id) const {
+        const int32_t* end = sorted + rows;
+        const int32_t* it = std::lower_bound(sorted, end, speaker_id,
+            [this](int32_t r, std::string_view key) { return id(r) < key; });
+        return (it != end && id(*it) == speaker_id) ? *it : -1;
+    }
+};
+
+SpeakerGallery::SpeakerGallery() = default;
+
+SpeakerGallery::~SpeakerGallery() {
+    free_storage();
+}
+
+SpeakerGallery::SpeakerGallery(const SpeakerGallery& other) {
+    *this = other;
+}
+
+SpeakerGallery& SpeakerGallery::operator=(const SpeakerGallery& other) {
+    if (this == &other) return *this;
+    reset(other.dim_, other.precision_);
+    if (other.mapped_) {
+        mapped_ = other.mapped_;
+        data_ = other.data_;
+        rows_ = capacity_ = other.rows_;
+        return *this;
+    }
+    reserve(other.rows_);
+    rows_ = other.rows_;
+    if (rows_ > 0 && data_) {
+        std::memcpy(data_, other.data_, static_cast<size_t>(rows_) * stride_ * sizeof(float));
+    }
+    if (rows_ > 0 && codes_) {
+        std::memcpy(codes_, other.codes_, static_cast<size_t>(rows_) * code_stride_);
+    }
+    scales_ = other.scales_;
+    code_sums_ = other.code_sums_;
+    ids_ = other.ids_;
+    enroll_counts_ = other.enroll_counts_;
+    index_ = other.index_;
+    return *this;
+}
+
+SpeakerGallery::SpeakerGallery(SpeakerGallery&& other) noexcept {
+    swap(other);
+}
+
+SpeakerGallery& SpeakerGallery::operator=(SpeakerGallery&& other) noexcept {
+    if (this != &other) {
+        swap(other);
+        other.reset(0);
+    }
+    return *this;
+}
+
+void SpeakerGallery::swap(SpeakerGallery& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(codes_, other.codes_);
+    scales_.swap(other.scales_);
+    code_sums_.swap(other.code_sums_);
+    std::swap(precision_, other.precision_);
+    std::swap(dim_, other.dim_);
+    std::swap(stride_, other.stride_);
+    std::swap(code_stride_, other.code_stride_);
+    std::swap(rows_, other.rows_);
+    std::swap(capacity_, other.capacity_);
+    ids_.swap(other.ids_);
+    enroll_counts_.swap(other.enroll_counts_);
+    index_.swap(other.index_);
+    mapped_.swap(other.mapped_);
+}
+
+void SpeakerGallery::free_storage() {
+    if (mapped_) {
+        data_ = nullptr;   // points into the mapping
+        mapped_.reset();
+    }
+    if (data_) aligned_free_array(data_);
+    if (codes_) aligned_free_array(codes_);
+    data_ = nullptr;
+    codes_ = nullptr;
+}
+
+void SpeakerGallery::reset(int dim, GalleryPrecision precision) {
+    free_storage();
+    precision_ = precision;
+    dim_ = std::max(0, dim);
+    stride_ = (dim_ + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE;
+    code_stride_ = (dim_ + CODES_PER_LINE - 1) / CODES_PER_LINE * CODES_PER_LINE;
+    rows_ = 0;
+    capacity_ = 0;
+    ids_.clear();
+    enroll_counts_.clear();
+    scales_.clear();
+    code_sums_.clear();
+    index_.clear();
+}
+
+void SpeakerGallery::clear() {
+    if (mapped_) {
+        free_storage();
+        capacity_ = 0;
+    }
+    rows_ = 0;
+    ids_.clear();
+    enroll_counts_.clear();
+    scales_.clear();
+    code_sums_.clear();
+    index_.clear();
+}
+
+void SpeakerGallery::reserve(int rows) {
+    if (mapped_) detach();
+    if (rows > capacity_) grow(rows);
+}
+
+void SpeakerGallery::detach() {
+    std::shared_ptr<const Snapshot> snap = std::move(mapped_);
+    if (!snap) return;
+
+    const int rows = rows_;
+    data_ = nullptr;
+    rows_ = 0;
+    capacity_ = 0;
+    ids_.clear();
+    enroll_counts_.clear();
+    index_.clear();
+    grow(rows);
+    if (rows > 0) {
+        std::memcpy(data_, snap->matrix, static_cast<size_t>(rows) * stride_ * sizeof(float));
+    }
+    for (int r = 0; r < rows; ++r) {
+        ids_.emplace_back(snap->id(r));
+        enroll_counts_.push_back(snap->counts[r]);
+        index_.emplace(ids_.back(), r);
+    }
+    rows_ = rows;
+}
+
+void SpeakerGallery::grow(int min_rows) {
+    int new_capacity = std::max({min_rows, capacity_ * 2, 64});
+    if (has_float_rows()) {
+        float* new_data = aligned_alloc_array<float>(static_cast<size_t>(new_capacity) * stride_);
+        if (data_) {
+            std::memcpy(new_data, data_, static_cast<size_t>(rows_) * stride_ * sizeof(float));
+            aligned_free_array(data_);
+        }
+        data_ = new_data;
+    } else if (has_int8_rows()) {
+        int8_t* new_codes = aligned_alloc_array<int8_t>(static_cast<size_t>(new_capacity) * code_stride_);
+        if (codes_) {
+            std::memcpy(new_codes, codes_, static_cast<size_t>(rows_) * code_stride_);
+            aligned_free_array(codes_);
+        }
+        codes_ = new_codes;
+        scales_.reserve(new_capacity);
+        code_sums_.reserve(new_capacity);
+    }
+    capacity_ = new_capacity;
+    ids_.reserve(new_capacity);
+    enroll_counts_.reserve(new_capacity);
+    index_.reserve(new_capacity);
+}
+
+int SpeakerGallery::upsert(const std::string& speaker_id, const float* embedding,
+                           int enroll_count) {
+    if (!embedding || dim_ == 0) return -1;
+    if (mapped_) detach();
+
+    int r = find(speaker_id);
+    if (r < 0) {
+        if (rows_ == capacity_) grow(rows_ + 1);
+        r = rows_++;
+        ids_.push_back(speaker_id);
+        enroll_counts_.push_back(enroll_count);
+        index_.emplace(speaker_id, r);
+        if (has_int8_rows()) {
+            scales_.push_back(0.0f);
+            code_sums_.push_back(0);
+        }
+    } else {
+        enroll_counts_[r] = enroll_count;
+    }
+
+    if (has_float_rows()) {
+        float* dst = mutable_row(r);
+        std::memcpy(dst, embedding, static_cast<size_t>(dim_) * sizeof(float));
+        std::fill(dst + dim_, dst + stride_, 0.0f);
+    } else if (has_int8_rows()) {
+        int8_t* dst = codes_ + static_cast<size_t>(r) * code_stride_;
+        scales_[r] = quantize_int8(embedding, dim_, code_stride_, dst, &code_sums_[r]);
+    }
+    return r;
+}
+
+bool SpeakerGallery::remove(const std::string& speaker_id) {
+    if (mapped_) {
+        if (mapped_->find(speaker_id) < 0) return false;
+        detach();
+    }
+    auto it = index_.find(speaker_id);
+    if (it == index_.end()) return false;
+
+    int r = it->second;
+    int last = rows_ - 1;
+    index_.erase(it);
+
+    if (r != last) {
+        if (has_float_rows()) {
+            std::memcpy(mutable_row(r), row(last), static_cast<size_t>(stride_) * sizeof(float));
+        } else if (has_int8_rows()) {
+            std::memcpy(codes_ + static_cast<size_t>(r) * code_stride_,
+                        codes_ + static_cast<size_t>(last) * code_stride_,
+                        static_cast<size_t>(code_stride_));
+            scales_[r] = scales_[last];
+            code_sums_[r] = code_sums_[last];
+        }
+        ids_[r] = std::move(ids_[last]);
+        enroll_counts_[r] = enroll_counts_[last];
+        index_[ids_[r]] = r;
+    }
+    ids_.pop_back();
+    enroll_counts_.pop_back();
+    if (has_int8_rows()) {
+        scales_.pop_back();
+        code_sums_.pop_back();
+    }
+    --rows_;
+    return true;
+}
+
+int SpeakerGallery::find(const std::string& speaker_id) const {
+    if (mapped_) return mapped_->find(speaker_id);
+    auto it = index_.find(speaker_id);
+    return it == index_.end() ? -1 : it->second;
+}
+
+std::string_view SpeakerGallery::id_at(int r) const {
+    return mapped_ ? mapped_->id(r) : std::string_view(ids_[r]);
+}
+
+int SpeakerGallery::enroll_count_at(int r) const {
+    return mapped_ ? mapped_->counts[r] : enroll_counts_[r];
+}
+
+void SpeakerGallery::set_enroll_count(int r, int count) {
+    if (mapped_) detach();
+    enroll_counts_[r] = count;
+}
+
+int SpeakerGallery::best_match(const float* query, float& out_score) const {
+    if (!has_float_rows()) {
+        ScoredIndex best{-1, -1.0f};
+        int n = top_k(query, 1, &best);
+        out_score = best.score;
+        return n > 0 ? best.index : -1;
+    }
+    auto m = SimilarityCalculator::find_best_match(query, data_, rows_, dim_, stride_);
+    out_score = m.score;
+    return m.index;
+}
+
+int SpeakerGallery::top_k(const float* query, int k, ScoredIndex* out) const {
+    if (has_float_rows()) {
+        return SimilarityCalculator::find_top_k(query, data_, rows_, dim_, stride_, k, out);
+    }
+    if (!has_int8_rows() || rows_ == 0) return 0;
+
+    std::vector<int8_t> query_codes(code_stride_);
+    float query_scale = quantize_int8(query, dim_, code_stride_, query_codes.data(), nullptr);
+
+    Int8MatrixView view;
+    view.codes = codes_;
+    view.scales = scales_.data();
+    view.sums = code_sums_.data();
+    view.rows = rows_;
+    view.stride = code_stride_;
+    return int8_find_top_k(query_codes.data(), query_scale, view, k, out);
+}
+
+void SpeakerGallery::top_k_batch(const float* queries, int count, int k,
+                                 ScoredIndex* out, int* out_counts) const {
+    if (!has_float_rows()) {
+        std::fill(out_counts, out_counts + count, 0);
+        return;
+    }
+    SimilarityCalculator::find_top_k_batch(queries, count, dim_, data_, rows_, dim_, stride_,
+                                           k, out, out_counts);
+}
+
+size_t SpeakerGallery::memory_bytes() const {
+    if (mapped_) return 0;
+    size_t bytes = 0;
+    if (has_float_rows()) {
+        bytes = static_cast<size_t>(capacity_) * stride_ * sizeof(float);
+    } else if (has_int8_rows()) {
+        bytes = static_cast<size_t>(capacity_) * code_stride_
+              + scales_.capacity() * sizeof(float) + code_sums_.capacity() * sizeof(int32_t);
+    }
+    for (const auto& id : ids_) bytes += sizeof(std::string) + id.capacity();
+    bytes += enroll_counts_.capacity() * sizeof(int);
+    bytes += index_.size() * (sizeof(std::string) + sizeof(int) + 2 * sizeof(void*));
+    return bytes;
+}
+
+bool SpeakerGallery::save_snapshot(const std::string& path, int64_t generation) const {
+    namespace fs = std::filesystem;
+    if (!has_float_rows()) return false;
+
+    SnapshotHeader h{};
+    h.magic = SNAPSHOT_MAGIC;
+    h.version = SNAPSHOT_VERSION;
+    h.generation = generation;
+    h.dim = dim_;
+    h.stride = stride_;
+    h.rows = rows_;
+
+    std::vector<uint64_t> offsets(static_cast<size_t>(rows_) + 1, 0);
+    for (int r = 0; r < rows_; ++r) offsets[r + 1] = offsets[r] + id_at(r).size();
+    std::vector<int32_t> sorted(rows_);
+    for (int r = 0; r < rows_; ++r) sorted[r] = r;
+    std::sort(sorted.begin(), sorted.end(),
+              [this](int32_t a, int32_t b) { return id_at(a) < id_at(b); });
+
+    h.id_offsets = align_up(sizeof(SnapshotHeader));
+    h.id_bytes = align_up(h.id_offsets + offsets.size() * sizeof(uint64_t));
+    h.counts = align_up(h.id_bytes + offsets.back());
+    h.sorted = align_up(h.counts + static_cast<uint64_t>(rows_) * sizeof(int32_t));
+    h.matrix = align_up(h.sorted + static_cast<uint64_t>(rows_) * sizeof(int32_t));
+    h.file_size = h.matrix + static_cast<uint64_t>(rows_) * stride_ * sizeof(float);
+
+    // Processes writing the same generation never share a temp file
+    static const std::string writer_tag = std::to_string(std::random_device{}());
+    std::string tmp_path = path + "." + std::to_string(generation) + "." + writer_tag + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        write_padding(out, h.id_offsets);
+        out.write(reinterpret_cast<const char*>(offsets.data()),
+                  static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+        write_padding(out, h.id_bytes);
+        for (int r = 0; r < rows_; ++r) {
+            std::string_view id = id_at(r);
+            out.write(id.data(), static_cast<std::streamsize>(id.size()));
+        }
+        write_padding(out, h.counts);
+        for (int r = 0; r < rows_; ++r) {
+            int32_t count = enroll_count_at(r);
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        }
+        write_padding(out, h.sorted);
+        out.write(reinterpret_cast<const char*>(sorted.data()),
+                  static_cast<std::streamsize>(sorted.size() * sizeof(int32_t)));
+        write_padding(out, h.matrix);
+        out.write(reinterpret_cast<const char*>(data_),
+                  static_cast<std::streamsize>(static_cast<size_t>(rows_) * stride_ * sizeof(float)));
+        if (!out) return false;
+    }
+
+    // Processes still mapping the old file keep their pages until they unmap
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool SpeakerGallery::map_snapshot(const std::string& path, int dim, int64_t generation) {
+    auto snap = std::make_shared<Snapshot>();
+    if (!snap->file.open(path) || snap->file.size() < sizeof(SnapshotHeader)) return false;
+
+    // Header checks only, so mapping stays O(1); the file is only ever
+    // written whole by save_snapshot()
+    SnapshotHeader h;
+    std::memcpy(&h, snap->file.data(), sizeof(h));
+    const int stride = (dim + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE;
+    if (h.magic != SNAPSHOT_MAGIC || h.version != SNAPSHOT_VERSION) return false;
+    if (h.generation != generation || h.dim != dim || dim <= 0 || h.stride != stride) return false;
+    if (h.rows < 0 || h.file_size != snap->file.size()) return false;
+    const uint64_t rows = static_cast<uint64_t>(h.rows);
+    if (h.id_offsets + (rows + 1) * sizeof(uint64_t) > h.id_bytes ||
+        h.counts > h.sorted || h.sorted + rows * sizeof(int32_t) > h.matrix ||
+        h.matrix % ALIGNMENT != 0 || h.matrix + rows * stride * sizeof(float) != h.file_size) {
+        return false;
+    }
+
+    const uint8_t* base = snap->file.data();
+    snap->id_offsets = reinterpret_cast<const uint64_t*>(base + h.id_offsets);
+    if (h.id_bytes + snap->id_offsets[rows] > h.counts) return false;
+    snap->id_bytes = reinterpret_cast<const char*>(base + h.id_bytes);
+    snap->counts = reinterpret_cast<const int32_t*>(base + h.counts);
+    snap->sorted = reinterpret_cast<const int32_t*>(base + h.sorted);
+    snap->matrix = reinterpret_cast<const float*>(base + h.matrix);
+    snap->rows = h.rows;
+
+    reset(dim, GalleryPrecision::FLOAT32);
+    data_ = const_cast<float*>(snap->matrix);
+    rows_ = capacity_ = h.rows;
+    mapped_ = std::move(snap);
+    return true;
+}
+
+} // namespace vp
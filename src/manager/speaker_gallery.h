@@ -0,0 +1,163 @@
+#ifndef VP_SPEAKER_GALLERY_H
+#define VP_SPEAKER_GALLERY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace vp {
+
+struct ScoredIndex;
+
+// Row representation held by the gallery
+enum class GalleryPrecision {
+    FLOAT32 = 0,   // exact float rows
+    INT8    = 1,   // per-row scaled int8 codes only (~4x smaller, approximate scores)
+    NONE    = 2,   // IDs and enroll counts only; vectors live in an external index
+};
+
+/**
+ * In-memory speaker gallery used for 1:N search.
+ *
+ * Embeddings live in one 64-byte-aligned, row-major [N x stride] float matrix
+ * (stride = dim rounded up to 16 floats, padding is zero) with a parallel
+ * ID / enroll-count table and an id -> row hash index. Removal swaps the last
+ * row into the freed slot, so rows stay dense and a search is a single
+ * sequential pass over the matrix.
+ *
+ * In INT8 precision the float matrix is not kept: each row is stored as
+ * int8 codes (stride rounded up to 64 bytes) plus a scale and code sum, and
+ * best_match / top_k return approximate scores. Callers that need exact
+ * scores re-score a shortlist against the float embeddings in the store.
+ * NONE precision keeps only the ID bookkeeping and never matches.
+ *
+ * A FLOAT32 gallery can also serve rows straight from a read-only snapshot
+ * file (save_snapshot / map_snapshot): the matrix, ID table and a sorted ID
+ * index are used in place from the mapping, so loading is O(1) in gallery
+ * size and processes mapping the same file share one page-cache copy.
+ * Copies share the mapping; the first modification copies the rows into
+ * private memory.
+ *
+ * Not thread-safe: SpeakerManager only mutates a replica no reader holds
+ * (see LeftRight).
+ */
+class SpeakerGallery {
+public:
+    static constexpr size_t ALIGNMENT = 64;   // bytes, one cache line
+
+    SpeakerGallery();
+    ~SpeakerGallery();
+
+    // Deep copies, except that a mapped snapshot is shared
+    // (SpeakerManager keeps two replicas of the gallery)
+    SpeakerGallery(const SpeakerGallery& other);
+    SpeakerGallery& operator=(const SpeakerGallery& other);
+    SpeakerGallery(SpeakerGallery&& other) noexcept;
+    SpeakerGallery& operator=(SpeakerGallery&& other) noexcept;
+
+    // Drop all rows and set the embedding dimension and row precision
+    void reset(int dim, GalleryPrecision precision = GalleryPrecision::FLOAT32);
+
+    // Drop all rows, keep dimension and capacity
+    void clear();
+
+    // Ensure capacity for at least `rows` rows
+    void reserve(int rows);
+
+    // Insert a new row or overwrite an existing one in place.
+    // Returns the row index, or -1 if embedding is null.
+    int upsert(const std::string& speaker_id, const float* embedding, int enroll_count);
+
+    // Swap-remove a row. Returns false if the ID is unknown.
+    bool remove(const std::string& speaker_id);
+
+    // Row index for an ID, or -1 if absent
+    int find(const std::string& speaker_id) const;
+
+    // Float rows (FLOAT32 precision only, see has_float_rows())
+    const float* row(int r) const { return data_ + static_cast<size_t>(r) * stride_; }
+    float* mutable_row(int r) {
+        if (mapped_) detach();
+        return data_ + static_cast<size_t>(r) * stride_;
+    }
+
+    std::string_view id_at(int r) const;
+    int  enroll_count_at(int r) const;
+    void set_enroll_count(int r, int count);
+
+    // Best-scoring row for an L2-normalized query of length dim().
+    // Returns the row index (or -1 if empty) and writes its score
+    // (approximate in INT8 precision).
+    int best_match(const float* query, float& out_score) const;
+
+    // K best rows in descending score order (one pass, bounded selection).
+    // out must hold k entries; returns the number written.
+    int top_k(const float* query, int k, ScoredIndex* out) const;
+
+    // top_k for `count` row-major queries of length dim() as one blocked
+    // matrix product (FLOAT32 precision only; other precisions write zero
+    // counts). Query q's results go to out[q * k], its count to out_counts[q].
+    void top_k_batch(const float* queries, int count, int k,
+                     ScoredIndex* out, int* out_counts) const;
+
+    int size() const     { return rows_; }
+    int dim() const      { return dim_; }
+    int stride() const   { return stride_; }
+    bool empty() const   { return rows_ == 0; }
+
+    GalleryPrecision precision() const { return precision_; }
+    bool has_float_rows() const { return precision_ == GalleryPrecision::FLOAT32; }
+    bool has_int8_rows() const  { return precision_ == GalleryPrecision::INT8; }
+
+    // Bytes held by the matrix and ID tables (approximate). Pages of a
+    // mapped snapshot are shared and not counted.
+    size_t memory_bytes() const;
+
+    // Write the rows to a snapshot file (atomically, via a temp file and
+    // rename), tagged with the store generation they reflect. FLOAT32 only.
+    bool save_snapshot(const std::string& path, int64_t generation) const;
+
+    // Replace the contents with a mapping of a snapshot file. Returns false,
+    // leaving the gallery unchanged, if the file is missing, malformed, or
+    // was written for another dimension or generation.
+    bool map_snapshot(const std::string& path, int dim, int64_t generation);
+
+    bool is_mapped() const { return mapped_ != nullptr; }
+
+private:
+    struct Snapshot;   // mapped file + section pointers
+
+    void grow(int min_rows);
+    void free_storage();
+    void swap(SpeakerGallery& other) noexcept;
+
+    // Copy mapped rows into private storage before the first modification
+    void detach();
+
+    float* data_ = nullptr;          // capacity_ x stride_, 64-byte aligned (FLOAT32)
+    int8_t* codes_ = nullptr;        // capacity_ x code_stride_, 64-byte aligned (INT8)
+    std::vector<float> scales_;      // per-row quantization scale (INT8)
+    std::vector<int32_t> code_sums_; // per-row sum of codes (INT8)
+
+    GalleryPrecision precision_ = GalleryPrecision::FLOAT32;
+    int dim_         = 0;
+    int stride_      = 0;
+    int code_stride_ = 0;
+    int rows_        = 0;
+    int capacity_    = 0;
+
+    std::vector<std::string> ids_;
+    std::vector<int> enroll_counts_;
+    std::unordered_map<std::string, int> index_;
+
+    // Set while rows are served from a snapshot; data_ then points into it
+    std::shared_ptr<const Snapshot> mapped_;
+};
+
+} // namespace vp
+
+#endif // VP_SPEAKER_GALLERY_H
@@ -1,17 +1,113 @@
 #include "manager/speaker_manager.h"
 #include "core/embedding_extractor.h"
+#include "core/embedding_stream.h"
 #include "core/similarity.h"
+#include "core/simd_dispatch.h"
+#include "core/hnsw_index.h"
+#include "core/ivfpq_index.h"
+#include "core/ort_threading.h"
 #include "storage/sqlite_store.h"
 #include "utils/logger.h"
 #include "utils/error_codes.h"
 #include <onnxruntime_cxx_api.h>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <random>
 
 namespace vp {
 
-// Global ONNX Runtime environment (singleton)
-static std::unique_ptr<Ort::Env> g_ort_env;
+thread_local std::string SpeakerManager::last_error_;
+
+namespace {
+
+// IVF-PQ shortlist re-scored exactly: max(FACTOR * k, MIN) entries
+constexpr int IVFPQ_SHORTLIST_MIN    = 32;
+constexpr int IVFPQ_SHORTLIST_FACTOR = 4;
+
+// Training sample: ~64 points per coarse centroid, enough for the 256-entry
+// PQ codebooks, capped to keep k-means time and memory bounded
+constexpr int IVFPQ_TRAIN_PER_LIST = 64;
+constexpr int IVFPQ_TRAIN_MIN      = 10000;
+constexpr int IVFPQ_TRAIN_MAX      = 262144;
+constexpr int IVFPQ_DEFAULT_CODE_BYTES = 16;
+
+// Speakers fetched per query when re-encoding from the DB
+constexpr size_t SYNC_BATCH = 512;
+
+// How often searches look for a snapshot published by another process
+constexpr std::chrono::milliseconds SNAPSHOT_CHECK_INTERVAL{500};
+
+// How long a mapped gallery may trail the DB before a search rebuilds it
+// from the DB itself, when no writer has published a current snapshot
+constexpr std::chrono::seconds SNAPSHOT_STALE_LIMIT{10};
+
+// Largest candidate list a thread keeps between searches; a widened INT8
+// shortlist beyond it is freed by that thread's next search
+constexpr size_t MAX_RETAINED_HITS = 4096;
+
+// Store a search hit in out[i], reusing the entry's string capacity, so a
+// caller that keeps its result vector does not allocate per query
+void put_result(std::vector<IdentifyResult>& out, size_t i, std::string_view id, float score) {
+    if (out.size() <= i) out.emplace_back();
+    out[i].speaker_id.assign(id.data(), id.size());
+    out[i].score = score;
+}
+
+// IVF-PQ entries are keyed by gallery row; the saved file labels each one
+// with the row's ID and enroll count
+IvfPqIndex::RowLabel gallery_labels(const SpeakerGallery& gallery) {
+    return [&gallery](int row, int& enroll_count) {
+        enroll_count = gallery.enroll_count_at(row);
+        return gallery.id_at(row);
+    };
+}
+
+// Every gallery speaker is present with the same enroll count, otherwise the
+// index file predates later enrollments
+template <typename Index>
+bool index_matches_gallery(const Index& index, const SpeakerGallery& gallery) {
+    if (index.dim() != gallery.dim() || index.size() != gallery.size()) return false;
+    for (int r = 0; r < gallery.size(); ++r) {
+        int entry = index.find(std::string(gallery.id_at(r)));
+        if (entry < 0 || index.enroll_count_at(entry) != gallery.enroll_count_at(r)) return false;
+    }
+    return true;
+}
+
+// Index of one replica, about to be modified in place. An index still
+// shared with the other replica (published by a rebuild) is copied first;
+// only the serialized writer copies or drops these pointers.
+template <typename Index>
+Index& own(std::shared_ptr<Index>& index) {
+    if (index.use_count() > 1) index = std::make_shared<Index>(*index);
+    return *index;
+}
+
+// Error code for an embedding extraction failure message
+ErrorCode extraction_error(const std::string& message) {
+    if (message.find("too short") != std::string::npos) return ErrorCode::AUDIO_TOO_SHORT;
+    if (message.find("No speech") != std::string::npos) return ErrorCode::AUDIO_INVALID;
+    return ErrorCode::INFERENCE;
+}
+
+} // anonymous namespace
+
+struct SpeakerManager::StreamSession {
+    explicit StreamSession(EmbeddingExtractor& extractor) : stream(extractor) {}
+
+    std::mutex mutex;
+    EmbeddingStream stream;
+    std::vector<float> embedding;   // latest score / enroll query
+};
+
+SpeakerCache::SpeakerCache() = default;
+SpeakerCache::~SpeakerCache() = default;
+SpeakerCache::SpeakerCache(SpeakerCache&& other) noexcept = default;
+SpeakerCache& SpeakerCache::operator=(SpeakerCache&& other) noexcept = default;
+
+SpeakerCache::SpeakerCache(const SpeakerCache& other) = default;
+SpeakerCache& SpeakerCache::operator=(const SpeakerCache& other) = default;
 
 SpeakerManager::SpeakerManager()
     : extractor_(std::make_unique<EmbeddingExtractor>()),
@@ -27,13 +123,12 @@ bool SpeakerManager::init(const std::string& model_dir, const std::string& db_pa
         return false;
     }
 
-    // Create ONNX Runtime environment
-    if (!g_ort_env) {
-        g_ort_env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "voiceprint");
-    }
+    // ONNX Runtime environment; no session exists yet, so a changed global
+    // thread pool setting can take effect here
+    Ort::Env& env = ort_env(true);
 
     // Initialize embedding extractor
-    if (!extractor_->init(model_dir, g_ort_env.get())) {
+    if (!extractor_->init(model_dir, &env)) {
         last_error_ = "Failed to initialize embedding extractor: " + extractor_->last_error();
         VP_LOG_ERROR(last_error_);
         return false;
@@ -46,14 +141,26 @@ bool SpeakerManager::init(const std::string& model_dir, const std::string& db_pa
         return false;
     }
 
+    index_path_ = db_path + ".hnsw";
+    ivf_path_ = db_path + ".ivfpq";
+    snapshot_path_ = db_path + ".gallery";
+
     // Load cache from DB
-    if (!load_cache_from_db()) {
-        VP_LOG_WARN("Failed to load speaker cache from DB");
+    {
+        std::lock_guard lock(write_mutex_);
+        if (load_cache_from_db() != static_cast<int>(ErrorCode::OK)) {
+            VP_LOG_WARN("Failed to load speaker cache from DB: {}", last_error_);
+            const int dim = extractor_->embedding_dim();
+            cache_.publish([dim](SpeakerCache& c) {
+                c = SpeakerCache();
+                c.gallery.reset(dim);
+            });
+        }
     }
 
     initialized_ = true;
-    VP_LOG_INFO("SpeakerManager initialized: model_dir={}, db={}, cached_speakers={}",
-                model_dir, db_path, cache_.size());
+    VP_LOG_INFO("SpeakerManager initialized: model_dir={}, db={}, cached_speakers={}, simd={}",
+                model_dir, db_path, get_speaker_count(), simd_level_name(simd_kernels().level));
     return true;
 }
 
@@ -61,8 +168,23 @@ void SpeakerManager::release() {
     if (!initialized_) return;
 
     {
-        std::unique_lock lock(cache_mutex_);
-        cache_.clear();
+        std::lock_guard lock(write_mutex_);
+        const SpeakerCache& cur = cache_.current();
+        if (cur.hnsw && !cur.hnsw->save(index_path_)) {
+            VP_LOG_WARN("Failed to save HNSW index: {}", index_path_);
+        }
+        if (cur.ivf && !cur.ivf->save(ivf_path_, gallery_labels(cur.gallery))) {
+            VP_LOG_WARN("Failed to save IVF-PQ index: {}", ivf_path_);
+        }
+        save_snapshot_if_current();
+        cache_.publish([](SpeakerCache& c) { c = SpeakerCache(); });
+        cache_generation_ = -1;
+    }
+
+    // Sessions refer to the extractor that is about to go away
+    {
+        std::lock_guard lock(streams_mutex_);
+        streams_.clear();
     }
 
     store_->close();
@@ -76,29 +198,485 @@ void SpeakerManager::release() {
 }
 
 void* SpeakerManager::get_ort_env() {
-    return g_ort_env.get();
+    return &ort_env();
 }
 
-bool SpeakerManager::load_cache_from_db() {
-    auto speakers = store_->load_all_speakers();
+int SpeakerManager::load_cache_from_db() {
+    const int dim = extractor_->embedding_dim();
+
+    // HNSW and IVF-PQ keep their own vectors: the HNSW gallery holds compact
+    // int8 rows for bookkeeping, the IVF-PQ gallery only IDs (10M+ speakers)
+    GalleryPrecision precision = GalleryPrecision::INT8;
+    if (backend_ == SearchBackend::FLAT)  precision = GalleryPrecision::FLOAT32;
+    if (backend_ == SearchBackend::IVFPQ) precision = GalleryPrecision::NONE;
 
-    std::unique_lock lock(cache_mutex_);
-    cache_.clear();
-    for (auto& sp : speakers) {
-        cache_[sp.speaker_id] = std::move(sp);
+    // Read before streaming: rows written meanwhile only make the snapshot
+    // look older than it is, never newer
+    const int64_t generation = store_->get_generation();
+    const bool use_snapshot = precision == GalleryPrecision::FLOAT32 && generation >= 0;
+
+    // Built off to the side: searches keep using the published cache
+    SpeakerCache next;
+    if (use_snapshot && next.gallery.map_snapshot(snapshot_path_, dim, generation)) {
+        VP_LOG_INFO("Mapped gallery snapshot: {} ({} speakers)", snapshot_path_, next.gallery.size());
+    } else {
+        next.gallery.reset(dim, precision);
+        next.gallery.reserve(store_->get_speaker_count());
+        bool ok = store_->for_each_speaker([&](SpeakerProfile& sp) {
+            if (static_cast<int>(sp.embedding.size()) != dim) {
+                VP_LOG_WARN("Skipping speaker {}: embedding dim {} != model dim {}",
+                            sp.speaker_id, sp.embedding.size(), dim);
+                return;
+            }
+            next.gallery.upsert(sp.speaker_id, sp.embedding.data(), sp.enroll_count);
+        });
+        if (!ok) {
+            last_error_ = "Failed to load speakers: " + store_->last_error();
+            return static_cast<int>(ErrorCode::DB_ERROR);
+        }
+
+        if (use_snapshot) {
+            // Serve from the file just written, so the rows live in the shared
+            // page cache instead of this process's heap
+            SpeakerGallery mapped;
+            if (next.gallery.save_snapshot(snapshot_path_, generation) &&
+                mapped.map_snapshot(snapshot_path_, dim, generation)) {
+                next.gallery = std::move(mapped);
+                VP_LOG_INFO("Wrote gallery snapshot: {} ({} speakers)", snapshot_path_, next.gallery.size());
+            } else {
+                VP_LOG_WARN("Failed to write gallery snapshot: {}", snapshot_path_);
+            }
+        }
     }
 
-    return true;
+    int rc = prepare_index(next);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+
+    cache_.publish([&](SpeakerCache& c) { c = std::move(next); });
+    cache_generation_ = generation;
+    return static_cast<int>(ErrorCode::OK);
 }
 
-int SpeakerManager::enroll(const std::string& speaker_id, const float* pcm_data, int sample_count) {
+void SpeakerManager::save_snapshot_if_current() {
+    const SpeakerGallery& gallery = cache_.current().gallery;
+    // A mapped gallery is unmodified, so its file is already current
+    if (!gallery.has_float_rows() || gallery.is_mapped() || cache_generation_ < 0) return;
+    if (store_->get_generation() != cache_generation_) {
+        // Another process wrote too; the next load regenerates from the DB
+        VP_LOG_INFO("Gallery snapshot left stale (DB changed by another writer)");
+        return;
+    }
+    if (!gallery.save_snapshot(snapshot_path_, cache_generation_)) {
+        VP_LOG_WARN("Failed to write gallery snapshot: {}", snapshot_path_);
+    }
+}
+
+int SpeakerManager::publish_snapshot() {
     if (!initialized_) {
         last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
         return static_cast<int>(ErrorCode::NOT_INIT);
     }
-    if (!pcm_data || sample_count <= 0) {
-        last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
-        return static_cast<int>(ErrorCode::INVALID_PARAM);
+
+    std::lock_guard lock(write_mutex_);
+    const SpeakerGallery& gallery = cache_.current().gallery;
+    // Other backends keep no snapshot; a mapped gallery has no unpublished writes
+    if (backend_ != SearchBackend::FLAT || gallery.is_mapped()) return static_cast<int>(ErrorCode::OK);
+
+    const int64_t generation = store_->get_generation();
+    if (cache_generation_ < 0 || generation != cache_generation_) {
+        // Another process wrote too: the rows in memory miss its changes
+        VP_LOG_INFO("Gallery changed by another writer, rebuilding the snapshot from the DB");
+        return load_cache_from_db();
+    }
+
+    SpeakerGallery mapped;
+    if (!gallery.save_snapshot(snapshot_path_, generation) ||
+        !mapped.map_snapshot(snapshot_path_, gallery.dim(), generation)) {
+        last_error_ = "Failed to write gallery snapshot: " + snapshot_path_;
+        VP_LOG_WARN(last_error_);
+        return static_cast<int>(ErrorCode::DB_ERROR);
+    }
+    // Both replicas share the new mapping; the private rows are freed
+    cache_.publish([&](SpeakerCache& c) { c.gallery = mapped; });
+    VP_LOG_INFO("Published gallery snapshot: {} ({} speakers)", snapshot_path_, mapped.size());
+    return static_cast<int>(ErrorCode::OK);
+}
+
+void SpeakerManager::refresh_snapshot() {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t due = next_snapshot_check_.load();
+    if (now < due) return;
+    // One caller per interval does the check
+    const int64_t next = now + std::chrono::duration_cast<std::chrono::nanoseconds>(
+        SNAPSHOT_CHECK_INTERVAL).count();
+    if (!next_snapshot_check_.compare_exchange_strong(due, next)) return;
+
+    std::unique_lock lock(write_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    if (backend_ != SearchBackend::FLAT || cache_generation_ < 0) return;
+    // This process's own writes keep cache_generation_ in step
+    const int64_t generation = store_->get_generation();
+    if (generation < 0 || generation == cache_generation_) {
+        stale_since_ = 0;
+        return;
+    }
+
+    // Another process wrote. Map its published snapshot, O(1); if none
+    // matches the DB yet, keep serving until SNAPSHOT_STALE_LIMIT, then
+    // rebuild from the DB (which publishes the file for everyone else)
+    SpeakerGallery mapped;
+    if (mapped.map_snapshot(snapshot_path_, cache_.current().gallery.dim(), generation)) {
+        VP_LOG_INFO("Mapped gallery snapshot published by another process (generation {} -> {})",
+                    cache_generation_, generation);
+        cache_.publish([&](SpeakerCache& c) { c.gallery = mapped; });
+        cache_generation_ = generation;
+        stale_since_ = 0;
+        return;
+    }
+    if (stale_since_ == 0) stale_since_ = now;
+    if (now - stale_since_ < std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 SNAPSHOT_STALE_LIMIT).count()) {
+        return;
+    }
+
+    VP_LOG_INFO("Gallery snapshot is behind the DB (generation {} -> {}), rebuilding",
+                cache_generation_, generation);
+    stale_since_ = 0;
+    if (load_cache_from_db() != static_cast<int>(ErrorCode::OK)) {
+        VP_LOG_WARN("Failed to refresh speaker cache: {}", last_error_);
+    }
+}
+
+int SpeakerManager::prepare_index(SpeakerCache& cache) {
+    const SpeakerGallery& gallery = cache.gallery;
+    if (backend_ != SearchBackend::HNSW) cache.hnsw.reset();
+    if (backend_ != SearchBackend::IVFPQ) cache.ivf.reset();
+
+    if (backend_ == SearchBackend::IVFPQ) {
+        // Quantizers are only ever learned by train_ivfpq(); entries are
+        // re-synced incrementally, never retrained here
+        // Saved entries are mapped back to rows; those of removed speakers or
+        // of older enroll counts are dropped and re-encoded by the sync
+        int dropped = 0;
+        auto lookup = [&](std::string_view id, int enroll_count) {
+            int r = gallery.find(std::string(id));
+            if (r < 0 || gallery.enroll_count_at(r) != enroll_count) {
+                ++dropped;
+                return -1;
+            }
+            return r;
+        };
+        auto ivf = std::make_shared<IvfPqIndex>();
+        if (!ivf->load(ivf_path_, lookup) || ivf->dim() != gallery.dim()) {
+            last_error_ = "IVF-PQ index not trained; call vp_train_ivfpq first";
+            return static_cast<int>(ErrorCode::MODEL_NOT_AVAILABLE);
+        }
+        int changed = sync_ivfpq(*ivf, gallery);
+        if (changed < 0) return static_cast<int>(ErrorCode::DB_ERROR);
+        if (changed > 0 || dropped > 0) {
+            VP_LOG_WARN("IVF-PQ index was stale, re-synced {} speakers: {}", changed, ivf_path_);
+            if (!ivf->save(ivf_path_, gallery_labels(gallery))) {
+                VP_LOG_WARN("Failed to save IVF-PQ index: {}", ivf_path_);
+            }
+        }
+        VP_LOG_INFO("Loaded IVF-PQ index: {} ({} speakers, nlist={}, {} B codes)",
+                    ivf_path_, ivf->size(), ivf->nlist(), ivf->code_bytes());
+        cache.ivf = std::move(ivf);
+        return static_cast<int>(ErrorCode::OK);
+    }
+
+    if (backend_ != SearchBackend::HNSW) return static_cast<int>(ErrorCode::OK);
+
+    auto hnsw = std::make_shared<HnswIndex>();
+    if (hnsw->load(index_path_)) {
+        if (index_matches_gallery(*hnsw, gallery)) {
+            VP_LOG_INFO("Loaded HNSW index: {} ({} speakers)", index_path_, hnsw->size());
+            cache.hnsw = std::move(hnsw);
+            return static_cast<int>(ErrorCode::OK);
+        }
+        VP_LOG_WARN("HNSW index is stale, rebuilding: {}", index_path_);
+    }
+
+    hnsw->reset(gallery.dim());
+    store_->for_each_speaker([&](SpeakerProfile& sp) {
+        if (gallery.find(sp.speaker_id) < 0) return;
+        hnsw->add(sp.speaker_id, sp.embedding.data(), sp.enroll_count);
+    });
+    if (!hnsw->save(index_path_)) {
+        VP_LOG_WARN("Failed to save HNSW index: {}", index_path_);
+    }
+    VP_LOG_INFO("Built HNSW index: {} speakers", hnsw->size());
+    cache.hnsw = std::move(hnsw);
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::sync_ivfpq(IvfPqIndex& index, const SpeakerGallery& gallery) {
+    int changed = 0;
+
+    // Index rows follow gallery rows one to one, so both swap-remove alike
+    index.resize(gallery.size());
+
+    std::vector<std::string> missing;
+    for (int r = 0; r < gallery.size(); ++r) {
+        if (!index.has(r)) missing.emplace_back(gallery.id_at(r));
+    }
+
+    for (size_t i = 0; i < missing.size(); i += SYNC_BATCH) {
+        std::vector<std::string> batch(missing.begin() + i,
+                                       missing.begin() + std::min(missing.size(), i + SYNC_BATCH));
+        std::vector<SpeakerProfile> profiles;
+        if (!store_->load_speakers(batch, profiles)) {
+            last_error_ = "Failed to load speakers: " + store_->last_error();
+            return -1;
+        }
+        for (const auto& sp : profiles) {
+            int r = gallery.find(sp.speaker_id);
+            if (r < 0 || static_cast<int>(sp.embedding.size()) != index.dim()) continue;
+            index.add(r, sp.embedding.data());
+            ++changed;
+        }
+    }
+    return changed;
+}
+
+void SpeakerManager::maybe_compact_index() {
+    const SpeakerCache& cur = cache_.current();
+    if (cur.hnsw && cur.hnsw->deleted_count() > cur.hnsw->size()) {
+        // Rebuilt once beside the live replicas, then shared by both
+        auto compacted = std::make_shared<HnswIndex>(*cur.hnsw);
+        compacted->compact();
+        cache_.publish([&](SpeakerCache& c) { c.hnsw = std::move(compacted); });
+        VP_LOG_INFO("Compacted HNSW index: {} speakers", cache_.current().hnsw->size());
+    }
+}
+
+int SpeakerManager::commit_embedding(const std::string& speaker_id,
+                                     const std::vector<float>& embedding) {
+    std::lock_guard lock(write_mutex_);
+    const SpeakerCache& cur = cache_.current();
+    if (static_cast<int>(embedding.size()) != cur.gallery.dim()) {
+        last_error_ = "Embedding dimension mismatch";
+        return static_cast<int>(ErrorCode::INFERENCE);
+    }
+
+    SpeakerProfile profile;
+    int r = cur.gallery.find(speaker_id);
+    if (r >= 0) {
+        // Incremental update of the stored mean embedding
+        int count = cur.gallery.enroll_count_at(r);
+        int rc = load_reference(cur, speaker_id, profile);
+        if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+        incremental_update(profile.embedding.data(), cur.gallery.dim(), count, embedding);
+        profile.enroll_count = count + 1;
+    } else {
+        // New speaker
+        profile.speaker_id = speaker_id;
+        profile.embedding = embedding;
+        profile.enroll_count = 1;
+    }
+
+    // The SQLite write only holds up other writers; searches keep reading
+    // the published replica until the cache update below
+    if (!store_->save_speaker(profile)) {
+        last_error_ = "Failed to save speaker: " + store_->last_error();
+        return static_cast<int>(ErrorCode::DB_ERROR);
+    }
+    if (cache_generation_ >= 0) ++cache_generation_;
+
+    // A mapped gallery moves into private rows here, once per snapshot;
+    // publish_snapshot() or release() writes them back out
+    cache_.write([&](SpeakerCache& c) {
+        int row = c.gallery.upsert(speaker_id, profile.embedding.data(), profile.enroll_count);
+        if (c.hnsw) own(c.hnsw).add(speaker_id, profile.embedding.data(), profile.enroll_count);
+        if (c.ivf) own(c.ivf).add(row, profile.embedding.data());
+    });
+    if (r >= 0) {
+        maybe_compact_index();
+        VP_LOG_INFO("Updated speaker: {} (count={})", speaker_id, profile.enroll_count);
+    } else {
+        VP_LOG_INFO("Enrolled new speaker: {}", speaker_id);
+    }
+
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::load_reference(const SpeakerCache& cache, const std::string& speaker_id,
+                                   SpeakerProfile& profile) {
+    const SpeakerGallery& gallery = cache.gallery;
+    int r = gallery.find(speaker_id);
+    if (r < 0) {
+        last_error_ = "Speaker not found: " + speaker_id;
+        return static_cast<int>(ErrorCode::SPEAKER_NOT_FOUND);
+    }
+
+    if (gallery.has_float_rows()) {
+        profile.speaker_id = speaker_id;
+        profile.embedding.assign(gallery.row(r), gallery.row(r) + gallery.dim());
+        profile.enroll_count = gallery.enroll_count_at(r);
+        return static_cast<int>(ErrorCode::OK);
+    }
+
+    int node = cache.hnsw ? cache.hnsw->find(speaker_id) : -1;
+    if (node >= 0) {
+        profile.speaker_id = speaker_id;
+        profile.embedding.assign(cache.hnsw->vector_at(node),
+                                 cache.hnsw->vector_at(node) + cache.hnsw->dim());
+        profile.enroll_count = gallery.enroll_count_at(r);
+        return static_cast<int>(ErrorCode::OK);
+    }
+
+    // INT8 / IVF-PQ galleries keep no float rows; the DB holds the exact embedding
+    if (!store_->load_speaker(speaker_id, profile) ||
+        static_cast<int>(profile.embedding.size()) != gallery.dim()) {
+        last_error_ = "Failed to load reference embedding: " + speaker_id;
+        return static_cast<int>(ErrorCode::DB_ERROR);
+    }
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::search_gallery(const std::vector<float>& query, int k,
+                                   std::vector<IdentifyResult>& out_results) {
+    refresh_snapshot();
+    // Candidate scratch is per thread, so a steady-state in-memory search
+    // allocates nothing beyond new result strings
+    thread_local std::vector<ScoredIndex> hits;
+    thread_local std::vector<std::string> shortlist;
+    if (hits.capacity() > MAX_RETAINED_HITS) std::vector<ScoredIndex>().swap(hits);
+    shortlist.clear();
+
+    {
+        // Released before the DB re-score so writers never wait on it
+        auto snap = cache_.read();
+        const SpeakerGallery& gallery = snap->gallery;
+        if (static_cast<int>(query.size()) != gallery.dim() || gallery.empty()) {
+            out_results.clear();
+            return static_cast<int>(ErrorCode::OK);
+        }
+        k = std::min(k, gallery.size());
+
+        if (snap->hnsw) {
+            hits.resize(k);
+            int n = snap->hnsw->search(query.data(), k, ef_search_.load(), hits.data());
+            for (int i = 0; i < n; ++i) {
+                put_result(out_results, i, snap->hnsw->id_at(hits[i].index), hits[i].score);
+            }
+            out_results.resize(n);
+            return static_cast<int>(ErrorCode::OK);
+        }
+
+        if (gallery.has_float_rows()) {
+            hits.resize(k);
+            int n = gallery.top_k(query.data(), k, hits.data());
+            for (int i = 0; i < n; ++i) {
+                put_result(out_results, i, gallery.id_at(hits[i].index), hits[i].score);
+            }
+            out_results.resize(n);
+            return static_cast<int>(ErrorCode::OK);
+        }
+
+        if (snap->ivf) {
+            // ADC scores over the nprobe nearest lists; a fixed-size shortlist
+            // absorbs the PQ error before exact re-scoring
+            int want = std::min(gallery.size(),
+                                std::max(IVFPQ_SHORTLIST_FACTOR * k, IVFPQ_SHORTLIST_MIN));
+            hits.resize(want);
+            int n = snap->ivf->search(query.data(), want, nprobe_.load(), hits.data());
+            shortlist.reserve(n);
+            for (int i = 0; i < n; ++i) shortlist.emplace_back(gallery.id_at(hits[i].index));
+        } else if (gallery.has_int8_rows()) {
+            // Approximate pass: widen the shortlist until it holds every row
+            // whose int8 score is within epsilon of the K-th best. If the
+            // quantization error stays below epsilon / 2, the exact winner is
+            // always in the shortlist.
+            const int rows = gallery.size();
+            const float epsilon = rerank_epsilon_.load();
+            int want = std::min(rows, k + 8);
+            for (;;) {
+                hits.resize(want);
+                int n = gallery.top_k(query.data(), want, hits.data());
+                hits.resize(n);
+                float cutoff = hits[k - 1].score - epsilon;
+                if (n == rows || hits.back().score < cutoff) {
+                    while (!hits.empty() && hits.back().score < cutoff) hits.pop_back();
+                    break;
+                }
+                want = std::min(rows, want * 2);
+            }
+
+            shortlist.reserve(hits.size());
+            for (const auto& h : hits) shortlist.emplace_back(gallery.id_at(h.index));
+        } else {
+            // IVF-PQ backend selected but no index loaded
+            out_results.clear();
+            return static_cast<int>(ErrorCode::OK);
+        }
+    }
+
+    // Exact re-score of the shortlist against the stored float embeddings.
+    // The DB read allocates its profiles; INT8 and IVF-PQ trade that for
+    // their smaller footprint.
+    std::vector<SpeakerProfile> profiles;
+    if (!store_->load_speakers(shortlist, profiles)) {
+        out_results.clear();
+        last_error_ = "Failed to load re-score candidates: " + store_->last_error();
+        VP_LOG_ERROR(last_error_);
+        return static_cast<int>(ErrorCode::DB_ERROR);
+    }
+    size_t n = 0;
+    for (const auto& p : profiles) {
+        if (p.embedding.size() != query.size()) continue;
+        put_result(out_results, n++, p.speaker_id,
+                   SimilarityCalculator::cosine_similarity(query, p.embedding));
+    }
+    out_results.resize(n);
+    std::sort(out_results.begin(), out_results.end(),
+              [](const IdentifyResult& a, const IdentifyResult& b) { return a.score > b.score; });
+    if (static_cast<int>(out_results.size()) > k) out_results.resize(k);
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::search_gallery_batch(const std::vector<float>& queries, int count, int k,
+                                         std::vector<std::vector<IdentifyResult>>& out_results) {
+    refresh_snapshot();
+    out_results.assign(count, {});
+    const int dim = static_cast<int>(queries.size()) / std::max(1, count);
+
+    {
+        auto snap = cache_.read();
+        const SpeakerGallery& gallery = snap->gallery;
+        if (gallery.has_float_rows()) {
+            if (dim != gallery.dim() || gallery.empty()) return static_cast<int>(ErrorCode::OK);
+            k = std::min(k, gallery.size());
+            std::vector<ScoredIndex> hits(static_cast<size_t>(count) * k);
+            std::vector<int> counts(count);
+            gallery.top_k_batch(queries.data(), count, k, hits.data(), counts.data());
+            for (int q = 0; q < count; ++q) {
+                const ScoredIndex* h = &hits[static_cast<size_t>(q) * k];
+                out_results[q].reserve(counts[q]);
+                for (int i = 0; i < counts[q]; ++i) {
+                    out_results[q].push_back({std::string(gallery.id_at(h[i].index)), h[i].score});
+                }
+            }
+            return static_cast<int>(ErrorCode::OK);
+        }
+    }
+
+    // Index-backed backends do not scan the whole gallery; answer each query
+    std::vector<float> query(dim);
+    for (int q = 0; q < count; ++q) {
+        query.assign(queries.begin() + static_cast<size_t>(q) * dim,
+                     queries.begin() + static_cast<size_t>(q + 1) * dim);
+        int rc = search_gallery(query, k, out_results[q]);
+        if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+    }
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::enroll(const std::string& speaker_id, const float* pcm_data, int sample_count) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
     }
     if (speaker_id.empty()) {
         last_error_ = "Speaker ID cannot be empty";
@@ -106,39 +684,100 @@ int SpeakerManager::enroll(const std::string& speaker_id, const float* pcm_data,
     }
 
     // Extract embedding
-    std::vector<float> audio(pcm_data, pcm_data + sample_count);
-    auto embedding = extractor_->extract(audio, 16000);
-    if (embedding.empty()) {
+    std::vector<float> embedding;
+    int rc = extract_embedding(pcm_data, sample_count, embedding);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+
+    // Update cache and DB
+    return commit_embedding(speaker_id, embedding);
+}
+
+int SpeakerManager::extract_embedding(const float* pcm_data, int sample_count,
+                                      std::vector<float>& out_embedding) {
+    out_embedding.clear();
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    if (!pcm_data || sample_count <= 0) {
+        last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+
+    // The caller's PCM is read in place
+    Span<const float> audio(pcm_data, static_cast<size_t>(sample_count));
+    if (!extractor_->extract(audio, 16000, out_embedding)) {
         last_error_ = extractor_->last_error();
-        // Determine specific error
-        if (last_error_.find("too short") != std::string::npos) {
-            return static_cast<int>(ErrorCode::AUDIO_TOO_SHORT);
-        }
-        if (last_error_.find("No speech") != std::string::npos) {
-            return static_cast<int>(ErrorCode::AUDIO_INVALID);
+        return static_cast<int>(extraction_error(last_error_));
+    }
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::enroll_batch(const char* const* speaker_ids, const float* const* pcm_data,
+                                 const int* sample_counts, int count, int* out_codes) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    if (!speaker_ids || !pcm_data || !sample_counts || count <= 0) {
+        last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+
+    // Items with bad arguments are reported and left out of the batch
+    std::vector<int> codes(count, static_cast<int>(ErrorCode::OK));
+    std::vector<Span<const float>> audios;
+    std::vector<int> slots;
+    for (int i = 0; i < count; ++i) {
+        if (!speaker_ids[i] || !speaker_ids[i][0] || !pcm_data[i] || sample_counts[i] <= 0) {
+            last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
+            codes[i] = static_cast<int>(ErrorCode::INVALID_PARAM);
+            continue;
         }
-        return static_cast<int>(ErrorCode::INFERENCE);
+        audios.emplace_back(pcm_data[i], static_cast<size_t>(sample_counts[i]));
+        slots.push_back(i);
     }
 
-    // Update cache and DB
-    {
-        std::unique_lock lock(cache_mutex_);
-        auto it = cache_.find(speaker_id);
-        if (it != cache_.end()) {
-            // Incremental update
-            incremental_update(it->second, embedding);
-            store_->save_speaker(it->second);
-            VP_LOG_INFO("Updated speaker: {} (count={})", speaker_id, it->second.enroll_count);
+    std::vector<std::string> errors;
+    auto embeddings = extractor_->extract_batch(audios, 16000, &errors);
+
+    // Commit in input order, so repeated IDs merge as sequential enroll() calls would
+    for (size_t j = 0; j < slots.size(); ++j) {
+        const int i = slots[j];
+        if (embeddings[j].empty()) {
+            last_error_ = errors[j];
+            codes[i] = static_cast<int>(extraction_error(errors[j]));
+            VP_LOG_WARN("Batch enroll: '{}' skipped: {}", speaker_ids[i], errors[j]);
         } else {
-            // New speaker
-            SpeakerProfile profile(speaker_id, embedding, 1);
-            store_->save_speaker(profile);
-            cache_[speaker_id] = std::move(profile);
-            VP_LOG_INFO("Enrolled new speaker: {}", speaker_id);
+            codes[i] = commit_embedding(speaker_ids[i], embeddings[j]);
         }
     }
+    int last_rc = static_cast<int>(ErrorCode::OK);
+    int enrolled = 0;
+    for (int i = 0; i < count; ++i) {
+        if (codes[i] != static_cast<int>(ErrorCode::OK)) last_rc = codes[i];
+        else ++enrolled;
+        if (out_codes) out_codes[i] = codes[i];
+    }
 
-    return static_cast<int>(ErrorCode::OK);
+    VP_LOG_INFO("Batch enroll: {} of {} utterances enrolled", enrolled, count);
+    return last_rc;
+}
+
+int SpeakerManager::enroll_embedding(const std::string& speaker_id, const float* embedding, int dim) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    if (speaker_id.empty()) {
+        last_error_ = "Speaker ID cannot be empty";
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+
+    std::vector<float> normalized;
+    int rc = normalize_input(embedding, dim, normalized);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+    return commit_embedding(speaker_id, normalized);
 }
 
 int SpeakerManager::enroll_file(const std::string& speaker_id, const std::string& wav_path) {
@@ -165,22 +804,7 @@ int SpeakerManager::enroll_file(const std::string& speaker_id, const std::string
     }
 
     // Update cache and DB (same as enroll)
-    {
-        std::unique_lock lock(cache_mutex_);
-        auto it = cache_.find(speaker_id);
-        if (it != cache_.end()) {
-            incremental_update(it->second, embedding);
-            store_->save_speaker(it->second);
-            VP_LOG_INFO("Updated speaker from file: {} (count={})", speaker_id, it->second.enroll_count);
-        } else {
-            SpeakerProfile profile(speaker_id, embedding, 1);
-            store_->save_speaker(profile);
-            cache_[speaker_id] = std::move(profile);
-            VP_LOG_INFO("Enrolled new speaker from file: {}", speaker_id);
-        }
-    }
-
-    return static_cast<int>(ErrorCode::OK);
+    return commit_embedding(speaker_id, embedding);
 }
 
 int SpeakerManager::remove_speaker(const std::string& speaker_id) {
@@ -189,20 +813,25 @@ int SpeakerManager::remove_speaker(const std::string& speaker_id) {
         return static_cast<int>(ErrorCode::NOT_INIT);
     }
 
-    {
-        std::unique_lock lock(cache_mutex_);
-        auto it = cache_.find(speaker_id);
-        if (it == cache_.end()) {
-            last_error_ = "Speaker not found: " + speaker_id;
-            return static_cast<int>(ErrorCode::SPEAKER_NOT_FOUND);
-        }
-        cache_.erase(it);
+    std::lock_guard lock(write_mutex_);
+    if (cache_.current().gallery.find(speaker_id) < 0) {
+        last_error_ = "Speaker not found: " + speaker_id;
+        return static_cast<int>(ErrorCode::SPEAKER_NOT_FOUND);
     }
 
     if (!store_->remove_speaker(speaker_id)) {
         last_error_ = store_->last_error();
         return static_cast<int>(ErrorCode::DB_ERROR);
     }
+    if (cache_generation_ >= 0) ++cache_generation_;
+
+    cache_.write([&](SpeakerCache& c) {
+        int row = c.gallery.find(speaker_id);
+        c.gallery.remove(speaker_id);
+        if (c.hnsw) own(c.hnsw).remove(speaker_id);
+        if (c.ivf) own(c.ivf).remove(row);
+    });
+    maybe_compact_index();
 
     VP_LOG_INFO("Removed speaker: {}", speaker_id);
     return static_cast<int>(ErrorCode::OK);
@@ -219,44 +848,155 @@ int SpeakerManager::identify(const float* pcm_data, int sample_count,
         return static_cast<int>(ErrorCode::INVALID_PARAM);
     }
 
-    // Extract embedding
-    std::vector<float> audio(pcm_data, pcm_data + sample_count);
-    auto embedding = extractor_->extract(audio, 16000);
-    if (embedding.empty()) {
-        last_error_ = extractor_->last_error();
-        return static_cast<int>(ErrorCode::INFERENCE);
-    }
+    // Extract embedding (per-thread buffer, reused by the thread's next query)
+    thread_local std::vector<float> embedding;
+    int rc = extract_query(pcm_data, sample_count, embedding);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
 
-    // Search in cache
-    std::string best_id;
-    float best_score = -1.0f;
+    return identify_embedding(embedding.data(), static_cast<int>(embedding.size()),
+                              out_speaker_id, out_score);
+}
 
-    {
-        std::shared_lock lock(cache_mutex_);
-        for (const auto& [id, profile] : cache_) {
-            float score = SimilarityCalculator::cosine_similarity(
-                embedding.data(), profile.embedding.data(),
-                static_cast<int>(embedding.size()));
-            if (score > best_score) {
-                best_score = score;
-                best_id = id;
-            }
-        }
+int SpeakerManager::identify_embedding(const float* embedding, int dim,
+                                       std::string& out_speaker_id, float& out_score) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
     }
+    thread_local std::vector<float> query;
+    int rc = normalize_input(embedding, dim, query);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+
+    // Search in cache
+    thread_local std::vector<IdentifyResult> hits;
+    rc = search_gallery(query, 1, hits);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+    const float best_score = hits.empty() ? -1.0f : hits[0].score;
 
     out_score = best_score;
 
-    if (best_score >= threshold_) {
-        out_speaker_id = best_id;
-        VP_LOG_INFO("Identified speaker: {} (score={:.4f})", best_id, best_score);
+    const float threshold = threshold_.load();
+    if (best_score >= threshold) {
+        out_speaker_id = hits[0].speaker_id;
+        VP_LOG_INFO("Identified speaker: {} (score={:.4f})", out_speaker_id, best_score);
         return static_cast<int>(ErrorCode::OK);
     }
 
     last_error_ = "No matching speaker found (best score: " + std::to_string(best_score) + ")";
-    VP_LOG_INFO("No match found (best={:.4f}, threshold={:.4f})", best_score, threshold_);
+    VP_LOG_INFO("No match found (best={:.4f}, threshold={:.4f})", best_score, threshold);
     return static_cast<int>(ErrorCode::NO_MATCH);
 }
 
+int SpeakerManager::identify_topk(const float* pcm_data, int sample_count, int k,
+                                  std::vector<IdentifyResult>& out_results) {
+    // out_results is overwritten in place by search_gallery (a reused vector
+    // keeps its strings), and only emptied up front on failure
+    if (!initialized_) {
+        out_results.clear();
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    if (!pcm_data || sample_count <= 0 || k <= 0) {
+        out_results.clear();
+        last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+
+    thread_local std::vector<float> embedding;
+    int rc = extract_query(pcm_data, sample_count, embedding);
+    if (rc != static_cast<int>(ErrorCode::OK)) {
+        out_results.clear();
+        return rc;
+    }
+
+    rc = search_gallery(embedding, k, out_results);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+
+    if (out_results.empty()) {
+        last_error_ = "No enrolled speakers to match against";
+        return static_cast<int>(ErrorCode::NO_MATCH);
+    }
+
+    VP_LOG_INFO("Top-{} identify: best={} (score={:.4f})",
+                k, out_results[0].speaker_id, out_results[0].score);
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::identify_batch(const float* const* pcm_data, const int* sample_counts,
+                                   int count, int k,
+                                   std::vector<std::vector<IdentifyResult>>& out_results) {
+    out_results.clear();
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    if (!pcm_data || !sample_counts || count <= 0 || k <= 0) {
+        last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+
+    // Extract all queries in model batches of equal length, keeping the
+    // successful ones as matrix rows
+    std::vector<Span<const float>> audios;
+    std::vector<int> inputs;
+    int last_rc = static_cast<int>(ErrorCode::OK);
+    for (int i = 0; i < count; ++i) {
+        if (!pcm_data[i] || sample_counts[i] <= 0) {
+            last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
+            last_rc = static_cast<int>(ErrorCode::INVALID_PARAM);
+            continue;
+        }
+        audios.emplace_back(pcm_data[i], static_cast<size_t>(sample_counts[i]));
+        inputs.push_back(i);
+    }
+
+    std::vector<std::string> errors;
+    auto embeddings = extractor_->extract_batch(audios, 16000, &errors);
+
+    std::vector<float> queries;
+    std::vector<int> slots;
+    for (size_t j = 0; j < inputs.size(); ++j) {
+        if (embeddings[j].empty()) {
+            last_error_ = errors[j];
+            last_rc = static_cast<int>(extraction_error(errors[j]));
+            VP_LOG_WARN("Batch identify: query {} skipped: {}", inputs[j], errors[j]);
+            continue;
+        }
+        queries.insert(queries.end(), embeddings[j].begin(), embeddings[j].end());
+        slots.push_back(inputs[j]);
+    }
+
+    out_results.assign(count, {});
+    if (slots.empty()) return last_rc;
+
+    std::vector<std::vector<IdentifyResult>> found;
+    int rc = search_gallery_batch(queries, static_cast<int>(slots.size()), k, found);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+    bool any_match = false;
+    for (size_t j = 0; j < slots.size(); ++j) {
+        any_match |= !found[j].empty();
+        out_results[slots[j]] = std::move(found[j]);
+    }
+
+    if (!any_match) {
+        last_error_ = "No enrolled speakers to match against";
+        return static_cast<int>(ErrorCode::NO_MATCH);
+    }
+
+    VP_LOG_INFO("Batch identify: {} of {} queries scored (top-{})", slots.size(), count, k);
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::extract_query(const float* pcm_data, int sample_count,
+                                  std::vector<float>& embedding) {
+    Span<const float> audio(pcm_data, static_cast<size_t>(sample_count));
+    if (!extractor_->extract(audio, 16000, embedding)) {
+        last_error_ = extractor_->last_error();
+        return static_cast<int>(ErrorCode::INFERENCE);
+    }
+    return static_cast<int>(ErrorCode::OK);
+}
+
 int SpeakerManager::verify(const std::string& speaker_id,
                             const float* pcm_data, int sample_count, float& out_score) {
     if (!initialized_) {
@@ -268,66 +1008,378 @@ int SpeakerManager::verify(const std::string& speaker_id,
         return static_cast<int>(ErrorCode::INVALID_PARAM);
     }
 
-    // Check if speaker exists
-    std::vector<float> ref_embedding;
+    // Check if speaker exists before paying for inference
+    refresh_snapshot();
     {
-        std::shared_lock lock(cache_mutex_);
-        auto it = cache_.find(speaker_id);
-        if (it == cache_.end()) {
+        auto snap = cache_.read();
+        if (snap->gallery.find(speaker_id) < 0) {
             last_error_ = "Speaker not found: " + speaker_id;
             return static_cast<int>(ErrorCode::SPEAKER_NOT_FOUND);
         }
-        ref_embedding = it->second.embedding;
     }
 
-    // Extract embedding
-    std::vector<float> audio(pcm_data, pcm_data + sample_count);
-    auto embedding = extractor_->extract(audio, 16000);
-    if (embedding.empty()) {
+    // Extract embedding (per-thread buffer, as in identify)
+    thread_local std::vector<float> embedding;
+    int rc = extract_query(pcm_data, sample_count, embedding);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+
+    return verify_embedding(speaker_id, embedding.data(), static_cast<int>(embedding.size()),
+                            out_score);
+}
+
+int SpeakerManager::stream_open(int& out_stream) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+
+    auto session = std::make_shared<StreamSession>(*extractor_);
+    std::lock_guard lock(streams_mutex_);
+    out_stream = next_stream_++;
+    streams_.emplace(out_stream, std::move(session));
+    VP_LOG_DEBUG("Stream {} opened ({} open)", out_stream, streams_.size());
+    return static_cast<int>(ErrorCode::OK);
+}
+
+std::shared_ptr<SpeakerManager::StreamSession> SpeakerManager::find_stream(int stream) {
+    std::lock_guard lock(streams_mutex_);
+    auto it = streams_.find(stream);
+    if (it == streams_.end()) {
+        last_error_ = "Stream not open: " + std::to_string(stream);
+        return nullptr;
+    }
+    return it->second;
+}
+
+int SpeakerManager::stream_push(int stream, const float* pcm_data, int sample_count) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    if (!pcm_data || sample_count <= 0) {
+        last_error_ = error_code_to_string(ErrorCode::INVALID_PARAM);
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+    auto session = find_stream(stream);
+    if (!session) return static_cast<int>(ErrorCode::INVALID_PARAM);
+
+    std::lock_guard lock(session->mutex);
+    if (!session->stream.push(Span<const float>(pcm_data, static_cast<size_t>(sample_count)))) {
         last_error_ = extractor_->last_error();
-        return static_cast<int>(ErrorCode::INFERENCE);
+        return static_cast<int>(extraction_error(last_error_));
+    }
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::stream_embedding(StreamSession& session) {
+    if (!session.stream.embedding(session.embedding)) {
+        last_error_ = extractor_->last_error();
+        return static_cast<int>(extraction_error(last_error_));
     }
+    return static_cast<int>(ErrorCode::OK);
+}
 
-    out_score = SimilarityCalculator::cosine_similarity(embedding, ref_embedding);
+int SpeakerManager::stream_score(int stream, const std::string& speaker_id, float& out_score) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    auto session = find_stream(stream);
+    if (!session) return static_cast<int>(ErrorCode::INVALID_PARAM);
 
+    // Check if speaker exists before paying for inference
+    refresh_snapshot();
+    {
+        auto snap = cache_.read();
+        if (snap->gallery.find(speaker_id) < 0) {
+            last_error_ = "Speaker not found: " + speaker_id;
+            return static_cast<int>(ErrorCode::SPEAKER_NOT_FOUND);
+        }
+    }
+
+    std::lock_guard lock(session->mutex);
+    int rc = stream_embedding(*session);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+    return verify_embedding(speaker_id, session->embedding.data(),
+                            static_cast<int>(session->embedding.size()), out_score);
+}
+
+int SpeakerManager::stream_enroll(int stream, const std::string& speaker_id) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    if (speaker_id.empty()) {
+        last_error_ = "Speaker ID cannot be empty";
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+    auto session = find_stream(stream);
+    if (!session) return static_cast<int>(ErrorCode::INVALID_PARAM);
+
+    // The committed speech is consumed: a later enroll on this stream adds
+    // only what is pushed after this one
+    std::lock_guard lock(session->mutex);
+    int rc = stream_embedding(*session);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+    rc = commit_embedding(speaker_id, session->embedding);
+    if (rc == static_cast<int>(ErrorCode::OK)) session->stream.reset();
+    return rc;
+}
+
+int SpeakerManager::stream_close(int stream) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+
+    // A call still running on the session keeps it alive until it returns
+    std::lock_guard lock(streams_mutex_);
+    if (streams_.erase(stream) == 0) {
+        last_error_ = "Stream not open: " + std::to_string(stream);
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+    VP_LOG_DEBUG("Stream {} closed", stream);
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::verify_embedding(const std::string& speaker_id, const float* embedding,
+                                     int dim, float& out_score) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+    thread_local std::vector<float> query;
+    int rc = normalize_input(embedding, dim, query);
+    if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+
+    refresh_snapshot();
+    thread_local SpeakerProfile reference;
+    {
+        auto snap = cache_.read();
+        rc = load_reference(*snap, speaker_id, reference);
+        if (rc != static_cast<int>(ErrorCode::OK)) return rc;
+    }
+
+    out_score = SimilarityCalculator::cosine_similarity(query, reference.embedding);
+
+    const float threshold = threshold_.load();
     VP_LOG_INFO("Verify speaker {}: score={:.4f}, threshold={:.4f}, match={}",
-                speaker_id, out_score, threshold_, out_score >= threshold_ ? "yes" : "no");
+                speaker_id, out_score, threshold, out_score >= threshold ? "yes" : "no");
+    return static_cast<int>(ErrorCode::OK);
+}
+
+int SpeakerManager::normalize_input(const float* embedding, int dim, std::vector<float>& out) {
+    if (!embedding || dim != extractor_->embedding_dim()) {
+        last_error_ = "Embedding must have " + std::to_string(extractor_->embedding_dim()) + " values";
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+    out.assign(embedding, embedding + dim);
+    SimilarityCalculator::l2_normalize(out.data(), dim);
     return static_cast<int>(ErrorCode::OK);
 }
 
+int SpeakerManager::embedding_dim() const {
+    return initialized_ ? extractor_->embedding_dim() : 0;
+}
+
 void SpeakerManager::set_threshold(float threshold) {
     threshold_ = std::max(0.0f, std::min(1.0f, threshold));
-    VP_LOG_INFO("Threshold set to {:.4f}", threshold_);
+    VP_LOG_INFO("Threshold set to {:.4f}", threshold_.load());
 }
 
-int SpeakerManager::get_speaker_count() const {
-    std::shared_lock lock(cache_mutex_);
-    return static_cast<int>(cache_.size());
-}
+int SpeakerManager::set_search_backend(SearchBackend backend) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
 
-void SpeakerManager::incremental_update(SpeakerProfile& profile,
-                                         const std::vector<float>& new_embedding) {
-    int n = profile.enroll_count;
-    for (size_t i = 0; i < profile.embedding.size(); ++i) {
-        profile.embedding[i] = (profile.embedding[i] * n + new_embedding[i]) / (n + 1);
+    std::lock_guard lock(write_mutex_);
+    {
+        // Persist the indexes before they are dropped or rebuilt
+        const SpeakerCache& cur = cache_.current();
+        if (cur.hnsw && !cur.hnsw->save(index_path_)) {
+            VP_LOG_WARN("Failed to save HNSW index: {}", index_path_);
+        }
+        if (cur.ivf && !cur.ivf->save(ivf_path_, gallery_labels(cur.gallery))) {
+            VP_LOG_WARN("Failed to save IVF-PQ index: {}", ivf_path_);
+        }
     }
-    profile.enroll_count = n + 1;
 
-    // L2 re-normalize
-    l2_normalize(profile.embedding);
+    // Searches keep running on the old cache until the new one is published
+    SearchBackend previous = backend_;
+    backend_ = backend;
+    int rc = load_cache_from_db();
+    if (rc != static_cast<int>(ErrorCode::OK)) {
+        // Stay on the previous backend (e.g. IVF-PQ requested before training);
+        // the old cache was never replaced
+        backend_ = previous;
+        VP_LOG_ERROR("Failed to switch search backend: {}", last_error_);
+        return rc;
+    }
+
+    static const char* names[] = {"flat", "int8", "hnsw", "ivfpq"};
+    const SpeakerCache& cur = cache_.current();
+    size_t index_bytes = (cur.hnsw ? cur.hnsw->memory_bytes() : 0)
+                       + (cur.ivf ? cur.ivf->memory_bytes() : 0);
+    VP_LOG_INFO("Search backend set to {} ({} speakers, gallery {} KB per replica, "
+                "index {} KB shared by both until the next write)",
+                names[static_cast<int>(backend)], cur.gallery.size(),
+                cur.gallery.memory_bytes() / 1024, index_bytes / 1024);
+    return static_cast<int>(ErrorCode::OK);
+}
+
+void SpeakerManager::set_rerank_epsilon(float epsilon) {
+    rerank_epsilon_ = std::max(0.0f, std::min(1.0f, epsilon));
+    VP_LOG_INFO("Rerank epsilon set to {:.4f}", rerank_epsilon_.load());
 }
 
-void SpeakerManager::l2_normalize(std::vector<float>& vec) {
-    float norm = 0.0f;
-    for (float v : vec) {
-        norm += v * v;
+void SpeakerManager::set_ef_search(int ef) {
+    ef_search_ = std::max(1, ef);
+    VP_LOG_INFO("HNSW ef_search set to {}", ef_search_.load());
+}
+
+int SpeakerManager::train_ivfpq(int nlist, int code_bytes) {
+    if (!initialized_) {
+        last_error_ = error_code_to_string(ErrorCode::NOT_INIT);
+        return static_cast<int>(ErrorCode::NOT_INIT);
+    }
+
+    const int dim = extractor_->embedding_dim();
+    if (code_bytes == 0) code_bytes = IVFPQ_DEFAULT_CODE_BYTES;
+    if (code_bytes < 0 || nlist < 0 || dim % code_bytes != 0) {
+        last_error_ = "Code size must divide the embedding dim (" + std::to_string(dim) + ")";
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+
+    const int total = store_->get_speaker_count();
+    if (total <= 0) {
+        last_error_ = "No enrolled speakers to train on";
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
     }
-    norm = std::sqrt(norm);
-    if (norm > 1e-10f) {
-        for (float& v : vec) {
-            v /= norm;
+    if (nlist == 0) nlist = std::max(1, static_cast<int>(4.0 * std::sqrt(static_cast<double>(total))));
+    nlist = std::min(nlist, total);
+
+    // Reservoir-sample the training set while streaming the table, so the
+    // full gallery is never held in memory
+    const int target = std::min({total, IVFPQ_TRAIN_MAX,
+                                 std::max(IVFPQ_TRAIN_MIN, IVFPQ_TRAIN_PER_LIST * nlist)});
+    std::vector<float> sample(static_cast<size_t>(target) * dim);
+    std::mt19937 rng(42);
+    long long seen = 0;
+    int kept = 0;
+    bool ok = store_->for_each_speaker([&](SpeakerProfile& sp) {
+        if (static_cast<int>(sp.embedding.size()) != dim) return;
+        long long slot = seen++;
+        if (slot >= target) {
+            slot = std::uniform_int_distribution<long long>(0, slot)(rng);
+            if (slot >= target) return;
+        } else {
+            ++kept;
         }
+        std::copy(sp.embedding.begin(), sp.embedding.end(),
+                  sample.begin() + static_cast<size_t>(slot) * dim);
+    });
+    if (!ok || kept == 0) {
+        last_error_ = "Failed to read training vectors: " + store_->last_error();
+        return static_cast<int>(ErrorCode::DB_ERROR);
+    }
+
+    // Training and bulk encoding run without the write lock
+    auto start = std::chrono::steady_clock::now();
+    auto index = std::make_shared<IvfPqIndex>();
+    if (!index->train(sample.data(), kept, dim, nlist, code_bytes)) {
+        last_error_ = "IVF-PQ training failed: " + index->last_error();
+        return static_cast<int>(ErrorCode::INVALID_PARAM);
+    }
+    sample.clear();
+    sample.shrink_to_fit();
+
+    // Codes are computed here and keyed by gallery row under the lock below;
+    // the IDs are only held until then
+    struct Encoded {
+        std::string speaker_id;
+        int enroll_count;
+        int list;
+    };
+    std::vector<Encoded> encoded;
+    std::vector<uint8_t> codes;
+    encoded.reserve(total);
+    codes.reserve(static_cast<size_t>(total) * code_bytes);
+    store_->for_each_speaker([&](SpeakerProfile& sp) {
+        if (static_cast<int>(sp.embedding.size()) != dim) return;
+        codes.resize(codes.size() + code_bytes);
+        int list = index->encode(sp.embedding.data(), &codes[codes.size() - code_bytes]);
+        encoded.push_back({std::move(sp.speaker_id), sp.enroll_count, list});
+    });
+
+    std::lock_guard lock(write_mutex_);
+    const SpeakerGallery& gallery = cache_.current().gallery;
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        int r = gallery.find(encoded[i].speaker_id);
+        if (r < 0 || gallery.enroll_count_at(r) != encoded[i].enroll_count) continue;
+        index->set(r, encoded[i].list, &codes[i * code_bytes]);
+    }
+    encoded = {};
+    codes = {};
+
+    // Catch up with enrollments and updates made while encoding
+    if (sync_ivfpq(*index, gallery) < 0) {
+        return static_cast<int>(ErrorCode::DB_ERROR);
+    }
+    if (!index->save(ivf_path_, gallery_labels(gallery))) {
+        last_error_ = "Failed to save IVF-PQ index: " + ivf_path_;
+        return static_cast<int>(ErrorCode::DB_ERROR);
+    }
+    auto end = std::chrono::steady_clock::now();
+    VP_LOG_INFO("Trained IVF-PQ index: {} speakers ({} sampled), nlist={}, {} B codes, {} ms",
+                index->size(), kept, index->nlist(), index->code_bytes(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+
+    if (backend_ == SearchBackend::IVFPQ) {
+        cache_.publish([&](SpeakerCache& c) { c.ivf = std::move(index); });
+    }
+    return static_cast<int>(ErrorCode::OK);
+}
+
+void SpeakerManager::set_nprobe(int nprobe) {
+    nprobe_ = std::max(1, nprobe);
+    VP_LOG_INFO("IVF-PQ nprobe set to {}", nprobe_.load());
+}
+
+void SpeakerManager::set_batching(int max_batch, int max_wait_us) {
+    extractor_->set_batching(max_batch, max_wait_us);
+}
+
+void SpeakerManager::set_long_input(float window_sec, float overlap_sec) {
+    extractor_->set_long_input(window_sec, overlap_sec);
+}
+
+void SpeakerManager::set_result_cache(std::shared_ptr<ResultCache> cache) {
+    extractor_->set_result_cache(std::move(cache));
+}
+
+void SpeakerManager::set_length_buckets(std::shared_ptr<const LengthBuckets> buckets) {
+    extractor_->set_length_buckets(std::move(buckets));
+}
+
+bool SpeakerManager::warm_up(const std::vector<float>& seconds, VpWarmupStats& stats) {
+    return initialized_ && extractor_->warm_up(seconds, stats);
+}
+
+int SpeakerManager::get_speaker_count() const {
+    auto snap = cache_.read();
+    return snap->gallery.size();
+}
+
+void SpeakerManager::incremental_update(float* embedding, int dim, int enroll_count,
+                                        const std::vector<float>& new_embedding) {
+    int n = enroll_count;
+    for (int i = 0; i < dim; ++i) {
+        embedding[i] = (embedding[i] * n + new_embedding[i]) / (n + 1);
     }
+
+    // L2 re-normalize
+    SimilarityCalculator::l2_normalize(embedding, dim);
 }
 
 } // namespace vp
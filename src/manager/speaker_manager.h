@@ -2,22 +2,56 @@
 #define VP_SPEAKER_MANAGER_H
 
 #include "storage/speaker_profile.h"
+#include "manager/speaker_gallery.h"
+#include "utils/left_right.h"
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
 #include <unordered_map>
-#include <shared_mutex>
+
+struct VpWarmupStats;
 
 namespace vp {
 
 class EmbeddingExtractor;
 class SqliteStore;
+class HnswIndex;
+class IvfPqIndex;
+class ResultCache;
+class LengthBuckets;
+
+// 1:N search backend (values mirror VP_SEARCH_*)
+enum class SearchBackend {
+    FLAT = 0,   // exact float32 scan
+    INT8 = 1,   // int8 scan + exact re-scoring of the shortlist
+    HNSW = 2,   // HNSW graph, persisted next to the DB
+    IVFPQ = 3,  // IVF-PQ codes (trained offline) + exact re-scoring of the shortlist
+};
 
 struct IdentifyResult {
     std::string speaker_id;
     float score;
 };
 
+// Everything a 1:N search reads: the gallery plus the index of the active
+// backend. SpeakerManager keeps two replicas. Copies share the indexes, so
+// an index built or rebuilt once and published sits in memory once; the
+// first incremental write after that gives each replica its own copy.
+struct SpeakerCache {
+    SpeakerGallery gallery;
+    std::shared_ptr<HnswIndex> hnsw;
+    std::shared_ptr<IvfPqIndex> ivf;     // entries keyed by gallery row
+
+    SpeakerCache();
+    ~SpeakerCache();
+    SpeakerCache(const SpeakerCache& other);
+    SpeakerCache& operator=(const SpeakerCache& other);
+    SpeakerCache(SpeakerCache&& other) noexcept;
+    SpeakerCache& operator=(SpeakerCache&& other) noexcept;
+};
+
 class SpeakerManager {
 public:
     SpeakerManager();
@@ -32,6 +66,12 @@ public:
     // Enroll a speaker from PCM data
     int enroll(const std::string& speaker_id, const float* pcm_data, int sample_count);
 
+    // Enroll `count` utterances; embeddings are extracted in length-grouped
+    // model batches, then merged in input order. out_codes[i] (optional)
+    // receives each item's error code. Returns OK or the last failure.
+    int enroll_batch(const char* const* speaker_ids, const float* const* pcm_data,
+                     const int* sample_counts, int count, int* out_codes);
+
     // Enroll a speaker from WAV file
     int enroll_file(const std::string& speaker_id, const std::string& wav_path);
 
@@ -42,42 +82,213 @@ public:
     int identify(const float* pcm_data, int sample_count,
                  std::string& out_speaker_id, float& out_score);
 
+    // Identify the K best-matching speakers (1:N), best first.
+    // Scores are not filtered by the threshold.
+    int identify_topk(const float* pcm_data, int sample_count, int k,
+                      std::vector<IdentifyResult>& out_results);
+
+    // Identify the K best speakers for each of `count` PCM queries. Queries
+    // are extracted in length-grouped model batches, then scored against the
+    // gallery together (one blocked matrix product on the flat backend). out_results[i] is
+    // empty for a query whose audio could not be processed.
+    int identify_batch(const float* const* pcm_data, const int* sample_counts, int count, int k,
+                       std::vector<std::vector<IdentifyResult>>& out_results);
+
     // Verify speaker (1:1)
     int verify(const std::string& speaker_id,
                const float* pcm_data, int sample_count, float& out_score);
 
+    // Streaming sessions: PCM (16kHz) is pushed in chunks of any size and
+    // VAD / FBank / window embeddings are computed once, as it arrives (see
+    // EmbeddingStream). A score or enrollment uses all speech pushed so far
+    // and may be taken any number of times. Calls on one session are
+    // serialized; different sessions run in parallel.
+    int stream_open(int& out_stream);
+    int stream_push(int stream, const float* pcm_data, int sample_count);
+    int stream_score(int stream, const std::string& speaker_id, float& out_score);
+    int stream_enroll(int stream, const std::string& speaker_id);
+    int stream_close(int stream);
+
+    // Embedding-level operations: callers that cache embeddings upstream
+    // skip VAD + FBank + model inference. Input embeddings must have
+    // embedding_dim() values and are L2-normalized before use.
+
+    // Extract an L2-normalized embedding from PCM without touching the gallery
+    int extract_embedding(const float* pcm_data, int sample_count, std::vector<float>& out_embedding);
+
+    int enroll_embedding(const std::string& speaker_id, const float* embedding, int dim);
+
+    // 1:N search by embedding; same threshold semantics as identify()
+    int identify_embedding(const float* embedding, int dim,
+                           std::string& out_speaker_id, float& out_score);
+
+    int verify_embedding(const std::string& speaker_id, const float* embedding, int dim,
+                         float& out_score);
+
+    // Dimension of the embeddings produced / accepted (0 before init)
+    int embedding_dim() const;
+
     // Set similarity threshold
     void set_threshold(float threshold);
 
+    // Switch the search backend and rebuild the cache (and index) from the DB
+    int set_search_backend(SearchBackend backend);
+
+    // Approximate-score window re-scored exactly by the INT8 backend
+    void set_rerank_epsilon(float epsilon);
+
+    // Candidate list size for HNSW queries (recall vs latency)
+    void set_ef_search(int ef);
+
+    // Train IVF-PQ quantizers on a sample of the speakers table, encode every
+    // speaker and persist the index next to the DB. nlist / code_bytes of 0
+    // pick defaults. Searches keep running on the current backend meanwhile.
+    int train_ivfpq(int nlist, int code_bytes);
+
+    // Inverted lists probed per IVF-PQ query (recall vs latency)
+    void set_nprobe(int nprobe);
+
+    // Micro-batch concurrent PCM extractions (max_batch <= 1: off)
+    void set_batching(int max_batch, int max_wait_us);
+
+    // Embed long PCM as batched fixed-length windows (window_sec <= 0: off)
+    void set_long_input(float window_sec, float overlap_sec);
+
+    // Write this process's enrolls and removes since the gallery was last
+    // mapped to the snapshot file and map it again (FLAT backend), so other
+    // processes pick them up and this one shares the page cache again.
+    // Writes themselves only update the in-memory replicas. Returns an ErrorCode.
+    int publish_snapshot();
+
+    // Run the speaker model at bucketed input lengths (null: exact lengths)
+    void set_length_buckets(std::shared_ptr<const LengthBuckets> buckets);
+
+    // Serve repeated PCM from a content-addressed embedding cache (null: off)
+    void set_result_cache(std::shared_ptr<ResultCache> cache);
+
+    // Warm up VAD, FBank and the speaker model at each length (seconds),
+    // see EmbeddingExtractor::warm_up. Returns false if a call failed.
+    bool warm_up(const std::vector<float>& seconds, VpWarmupStats& stats);
+
     // Get speaker count
     int get_speaker_count() const;
 
     // Access shared OrtEnv for use by VoiceAnalyzer / Diarizer
-    // Returns nullptr if not yet initialized.
+    // (core/ort_threading.h; created on first use)
     static void* get_ort_env();
 
+    // Error of the calling thread's last failed call (concurrent callers
+    // each see their own)
     const std::string& last_error() const { return last_error_; }
 
 private:
-    // Load all speakers from DB into memory cache
-    bool load_cache_from_db();
+    struct StreamSession;
+
+    // Session `stream`, or null (last_error_ set) if it is not open
+    std::shared_ptr<StreamSession> find_stream(int stream);
+
+    // Embedding of everything pushed to a session so far into
+    // session.embedding (session mutex held). Returns an ErrorCode.
+    int stream_embedding(StreamSession& session);
+
+    // Load all speakers into a new cache and publish it; the current cache
+    // stays in place on failure. The FLAT backend maps the gallery snapshot
+    // when it matches the DB generation, and regenerates it otherwise.
+    // Returns an ErrorCode. (write lock held)
+    int load_cache_from_db();
+
+    // Rewrite the gallery snapshot from the cache if this process's own
+    // writes are the only changes since it was loaded (write lock held)
+    void save_snapshot_if_current();
+
+    // Follow writes made by other processes (FLAT backend). Checks at most
+    // every SNAPSHOT_CHECK_INTERVAL and never waits for a writer: maps a
+    // snapshot published for the current DB generation, or rebuilds from
+    // the DB once none has appeared for SNAPSHOT_STALE_LIMIT. (no lock held)
+    void refresh_snapshot();
+
+    // Load the persisted index for the active backend, rebuilding (HNSW) or
+    // re-syncing (IVF-PQ) it if it is stale. Returns an ErrorCode.
+    int prepare_index(SpeakerCache& cache);
 
-    // Update incremental mean embedding
-    void incremental_update(SpeakerProfile& profile, const std::vector<float>& new_embedding);
+    // Bring IVF-PQ entries in line with the gallery rows: encode every row
+    // that has no entry yet from its DB embedding. Returns entries added,
+    // or -1 (last_error_ set) if the DB read failed.
+    int sync_ivfpq(IvfPqIndex& index, const SpeakerGallery& gallery);
 
-    // L2 normalize vector
-    static void l2_normalize(std::vector<float>& vec);
+    // Rebuild the HNSW graph once tombstones outnumber live nodes
+    // (write lock held)
+    void maybe_compact_index();
+
+    // Extract a query embedding from PCM, mapping failures to error codes
+    int extract_query(const float* pcm_data, int sample_count, std::vector<float>& embedding);
+
+    // Validate a caller-supplied embedding and copy it L2-normalized.
+    // Returns OK or INVALID_PARAM.
+    int normalize_input(const float* embedding, int dim, std::vector<float>& out);
+
+    // K best speakers for a query embedding, best first. Scores are exact for
+    // every backend: FLAT and HNSW score against float vectors in memory;
+    // INT8 and IVF-PQ keep none, so every query also reads its shortlist
+    // (about k + 8 rows for INT8, max(4k, 32) for IVF-PQ) back from SQLite
+    // by primary key. That read is the price of their smaller footprint.
+    // out_results is overwritten in place, so a vector the caller reuses
+    // keeps its entries' strings. Returns OK, or DB_ERROR if the re-score
+    // read failed.
+    int search_gallery(const std::vector<float>& query, int k,
+                       std::vector<IdentifyResult>& out_results);
+
+    // search_gallery for `count` row-major query embeddings at once
+    int search_gallery_batch(const std::vector<float>& queries, int count, int k,
+                             std::vector<std::vector<IdentifyResult>>& out_results);
+
+    // Float reference embedding of an enrolled speaker.
+    // Returns OK, SPEAKER_NOT_FOUND or DB_ERROR.
+    int load_reference(const SpeakerCache& cache, const std::string& speaker_id,
+                       SpeakerProfile& profile);
+
+    // Merge a freshly extracted embedding into the DB, then the cache
+    int commit_embedding(const std::string& speaker_id, const std::vector<float>& embedding);
+
+    // Update incremental mean embedding (in place, re-normalized)
+    static void incremental_update(float* embedding, int dim, int enroll_count,
+                                   const std::vector<float>& new_embedding);
 
     std::unique_ptr<EmbeddingExtractor> extractor_;
     std::unique_ptr<SqliteStore> store_;
 
-    // In-memory cache protected by read-write lock
-    mutable std::shared_mutex cache_mutex_;
-    std::unordered_map<std::string, SpeakerProfile> cache_;
+    // In-memory cache: searches read a published replica without locking;
+    // writers persist to SQLite first, then update the replicas under
+    // write_mutex_ (one writer at a time)
+    LeftRight<SpeakerCache> cache_;
+    std::mutex write_mutex_;
+
+    // Open streaming sessions by id; the map is guarded by streams_mutex_,
+    // each session by its own mutex
+    std::unordered_map<int, std::shared_ptr<StreamSession>> streams_;
+    std::mutex streams_mutex_;
+    int next_stream_ = 1;
+
+    std::atomic<float> threshold_{0.30f};
+    std::atomic<float> rerank_epsilon_{0.01f};
+    std::atomic<int> ef_search_{64};
+    std::atomic<int> nprobe_{16};
+    SearchBackend backend_ = SearchBackend::FLAT;   // guarded by write_mutex_
+
+    std::string index_path_;
+    std::string ivf_path_;
+    std::string snapshot_path_;        // mapped FLAT gallery, see SpeakerGallery::map_snapshot
 
-    float threshold_ = 0.30f;
+    // Store generation the cache reflects if no other process has written
+    // since it was loaded (-1: unknown). Guarded by write_mutex_.
+    int64_t cache_generation_ = -1;
+    // Steady-clock time (ns) of the next refresh_snapshot() check
+    std::atomic<int64_t> next_snapshot_check_{0};
+    // Steady-clock time (ns) the DB was first seen ahead of every published
+    // snapshot (0: not behind). Guarded by write_mutex_.
+    int64_t stale_since_ = 0;
     bool initialized_ = false;
-    std::string last_error_;
+    static thread_local std::string last_error_;
 };
 
 } // namespace vp
@@ -2,6 +2,7 @@
 #include "utils/logger.h"
 #include <sqlite3.h>
 #include <cstring>
+#include <algorithm>
 
 namespace vp {
 
@@ -56,6 +57,17 @@ bool SqliteStore::create_tables() {
             created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
             updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
         );
+        CREATE TABLE IF NOT EXISTS meta (
+            key TEXT PRIMARY KEY,
+            value INTEGER NOT NULL
+        );
+        INSERT OR IGNORE INTO meta (key, value) VALUES ('generation', 0);
+        CREATE TRIGGER IF NOT EXISTS speakers_insert_generation AFTER INSERT ON speakers
+        BEGIN UPDATE meta SET value = value + 1 WHERE key = 'generation'; END;
+        CREATE TRIGGER IF NOT EXISTS speakers_update_generation AFTER UPDATE ON speakers
+        BEGIN UPDATE meta SET value = value + 1 WHERE key = 'generation'; END;
+        CREATE TRIGGER IF NOT EXISTS speakers_delete_generation AFTER DELETE ON speakers
+        BEGIN UPDATE meta SET value = value + 1 WHERE key = 'generation'; END;
     )";
 
     char* err_msg = nullptr;
@@ -170,17 +182,24 @@ bool SqliteStore::remove_speaker(const std::string& speaker_id) {
 
 std::vector<SpeakerProfile> SqliteStore::load_all_speakers() {
     std::vector<SpeakerProfile> speakers;
+    for_each_speaker([&](SpeakerProfile& profile) { speakers.push_back(std::move(profile)); });
+    VP_LOG_INFO("Loaded {} speakers from database", speakers.size());
+    return speakers;
+}
+
+bool SqliteStore::for_each_speaker(const std::function<void(SpeakerProfile&)>& callback) {
     const char* sql = "SELECT speaker_id, embedding, embedding_dim, enroll_count FROM speakers;";
 
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
     if (rc != SQLITE_OK) {
         last_error_ = "SQL prepare error: " + std::string(sqlite3_errmsg(db_));
-        return speakers;
+        return false;
     }
 
+    // One profile buffer is reused across rows
+    SpeakerProfile profile;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        SpeakerProfile profile;
         profile.speaker_id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
 
         const void* blob = sqlite3_column_blob(stmt, 1);
@@ -191,12 +210,63 @@ std::vector<SpeakerProfile> SqliteStore::load_all_speakers() {
         profile.embedding.resize(dim);
         std::memcpy(profile.embedding.data(), blob, blob_size);
 
-        speakers.push_back(std::move(profile));
+        callback(profile);
     }
 
     sqlite3_finalize(stmt);
-    VP_LOG_INFO("Loaded {} speakers from database", speakers.size());
-    return speakers;
+    return true;
+}
+
+bool SqliteStore::load_speakers(const std::vector<std::string>& speaker_ids,
+                                std::vector<SpeakerProfile>& out) {
+    out.reserve(out.size() + speaker_ids.size());
+
+    // One IN list per chunk, keeping the bound parameters under
+    // SQLITE_MAX_VARIABLE_NUMBER (999 before SQLite 3.32)
+    for (size_t first = 0; first < speaker_ids.size(); first += MAX_BOUND_IDS) {
+        const size_t count = std::min(MAX_BOUND_IDS, speaker_ids.size() - first);
+        std::string sql = "SELECT speaker_id, embedding, embedding_dim, enroll_count FROM speakers "
+                          "WHERE speaker_id IN (";
+        for (size_t i = 0; i < count; ++i) {
+            sql += (i == 0) ? "?" : ",?";
+        }
+        sql += ");";
+
+        sqlite3_stmt* stmt = nullptr;
+        int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+        if (rc != SQLITE_OK) {
+            last_error_ = "SQL prepare error: " + std::string(sqlite3_errmsg(db_));
+            return false;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            sqlite3_bind_text(stmt, static_cast<int>(i) + 1, speaker_ids[first + i].c_str(), -1,
+                              SQLITE_STATIC);
+        }
+
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            SpeakerProfile profile;
+            profile.speaker_id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+
+            const void* blob = sqlite3_column_blob(stmt, 1);
+            int blob_size = sqlite3_column_bytes(stmt, 1);
+            int dim = sqlite3_column_int(stmt, 2);
+            profile.enroll_count = sqlite3_column_int(stmt, 3);
+
+            profile.embedding.resize(dim);
+            std::memcpy(profile.embedding.data(), blob,
+                        std::min(static_cast<size_t>(blob_size), dim * sizeof(float)));
+
+            out.push_back(std::move(profile));
+        }
+
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) {
+            last_error_ = "SQL step error: " + std::string(sqlite3_errmsg(db_));
+            return false;
+        }
+    }
+    return true;
 }
 
 int SqliteStore::get_speaker_count() {
@@ -229,4 +299,20 @@ bool SqliteStore::speaker_exists(const std::string& speaker_id) {
     return exists;
 }
 
+int64_t SqliteStore::get_generation() {
+    const char* sql = "SELECT value FROM meta WHERE key = 'generation';";
+
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) return -1;
+
+    int64_t generation = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        generation = sqlite3_column_int64(stmt, 0);
+    }
+
+    sqlite3_finalize(stmt);
+    return generation;
+}
+
 } // namespace vp
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <cstdint>
 
 struct sqlite3;
 
@@ -33,14 +35,31 @@ public:
     // Load all speakers
     std::vector<SpeakerProfile> load_all_speakers();
 
+    // Stream every speaker through a callback without materializing the
+    // table. The profile is reused between calls; the callback may move
+    // from it. Returns false on SQL error.
+    bool for_each_speaker(const std::function<void(SpeakerProfile&)>& callback);
+
+    // Append a set of speakers to `out` (unknown IDs are skipped), querying
+    // at most MAX_BOUND_IDS IDs per statement. Returns false on SQL error.
+    bool load_speakers(const std::vector<std::string>& speaker_ids,
+                       std::vector<SpeakerProfile>& out);
+
     // Get speaker count
     int get_speaker_count();
 
     // Check if speaker exists
     bool speaker_exists(const std::string& speaker_id);
 
+    // Counter bumped (by triggers) on every insert, update or delete of a
+    // speaker row, including writes from other processes. Caches derived
+    // from the table record it to detect staleness. Returns -1 on error.
+    int64_t get_generation();
+
     const std::string& last_error() const { return last_error_; }
 
+    static constexpr size_t MAX_BOUND_IDS = 500;
+
 private:
     bool create_tables();
 
@@ -0,0 +1,100 @@
+#ifndef VP_HASH_H
+#define VP_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace vp {
+
+namespace detail {
+
+constexpr uint64_t XXH_P1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t XXH_P2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t XXH_P3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t XXH_P4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t XXH_P5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;   // little-endian hosts only (x86 / ARM)
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_P2;
+    return rotl64(acc, 31) * XXH_P1;
+}
+
+inline uint64_t xxh_merge(uint64_t acc, uint64_t val) {
+    acc ^= xxh_round(0, val);
+    return acc * XXH_P1 + XXH_P4;
+}
+
+} // namespace detail
+
+// XXH64 of `len` bytes (reference algorithm, ~10 GB/s): fast non-cryptographic
+// hash for content-addressed lookups. Chain calls through `seed` to hash
+// several fields.
+inline uint64_t xxhash64(const void* data, size_t len, uint64_t seed = 0) {
+    using namespace detail;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* const end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = seed + XXH_P1 + XXH_P2;
+        uint64_t v2 = seed + XXH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_P1;
+        const unsigned char* const limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = seed + XXH_P5;
+    }
+    h += static_cast<uint64_t>(len);
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxh_round(0, read64(p));
+        h = rotl64(h, 27) * XXH_P1 + XXH_P4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * XXH_P1;
+        h = rotl64(h, 23) * XXH_P2 + XXH_P3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= (*p) * XXH_P5;
+        h = rotl64(h, 11) * XXH_P1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_P2;
+    h ^= h >> 29;
+    h *= XXH_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace vp
+
+#endif // VP_HASH_H
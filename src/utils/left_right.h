@@ -0,0 +1,134 @@
+#ifndef VP_LEFT_RIGHT_H
+#define VP_LEFT_RIGHT_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace vp {
+
+/**
+ * Two replicas of a T with wait-free readers (Left-Right, a two-version RCU).
+ *
+ * Readers take a ReadGuard on the published replica; it is never modified
+ * while any reader holds it, so a reader sees an immutable snapshot and
+ * never blocks. A writer changes the standby replica, publishes it with one
+ * atomic store, waits for the grace period (every reader that entered the
+ * old replica has left), then brings the old replica up to date. Readers
+ * therefore only ever delay writers, never the reverse.
+ *
+ * Writers must be serialized by the caller. Memory is 2 x sizeof(T).
+ */
+template <typename T>
+class LeftRight {
+    struct alignas(64) Counter {
+        std::atomic<int64_t> value{0};
+    };
+
+    // Per-version reader count, striped across cache lines so concurrent
+    // readers on different cores do not contend on one counter
+    struct ReadIndicator {
+        static constexpr int STRIPES = 16;
+        Counter stripes[STRIPES];
+
+        void arrive(int s) { stripes[s].value.fetch_add(1); }
+        void depart(int s) { stripes[s].value.fetch_sub(1); }
+        bool empty() const {
+            for (const auto& c : stripes) {
+                if (c.value.load() != 0) return false;
+            }
+            return true;
+        }
+    };
+
+public:
+    class ReadGuard {
+    public:
+        ReadGuard(const T& value, ReadIndicator& indicator, int stripe)
+            : value_(&value), indicator_(&indicator), stripe_(stripe) {}
+        ReadGuard(ReadGuard&& other) noexcept
+            : value_(other.value_), indicator_(other.indicator_), stripe_(other.stripe_) {
+            other.indicator_ = nullptr;
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard() {
+            if (indicator_) indicator_->depart(stripe_);
+        }
+
+        const T& operator*() const  { return *value_; }
+        const T* operator->() const { return value_; }
+
+    private:
+        const T* value_;
+        ReadIndicator* indicator_;
+        int stripe_;
+    };
+
+    LeftRight() = default;
+    LeftRight(const LeftRight&) = delete;
+    LeftRight& operator=(const LeftRight&) = delete;
+
+    // Enter the published replica; keep the guard only as long as needed
+    ReadGuard read() const {
+        const int stripe = reader_stripe();
+        const int version = version_.load();
+        indicators_[version].arrive(stripe);
+        return ReadGuard(replicas_[active_.load()], indicators_[version], stripe);
+    }
+
+    // Published replica for the (serialized) writer. Both replicas are equal
+    // between writes, so the writer may read it without a guard.
+    const T& current() const { return replicas_[active_.load()]; }
+
+    // Apply an incremental change to both replicas: f runs once on the
+    // standby copy, which is then published, and once on the old copy after
+    // the grace period. f must produce the same result on equal replicas.
+    template <typename F>
+    void write(F&& f) {
+        const int old = active_.load();
+        f(replicas_[1 - old]);
+        active_.store(1 - old);
+        wait_for_readers();
+        f(replicas_[old]);
+    }
+
+    // Apply a change once and copy the result into the other replica (for
+    // rebuilds that are too expensive, or not repeatable, to run twice)
+    template <typename F>
+    void publish(F&& f) {
+        const int old = active_.load();
+        f(replicas_[1 - old]);
+        active_.store(1 - old);
+        wait_for_readers();
+        replicas_[old] = replicas_[1 - old];
+    }
+
+private:
+    // Flip the version readers register under, draining each side in turn:
+    // afterwards no reader can still hold the replica unpublished above
+    void wait_for_readers() {
+        const int prev = version_.load();
+        const int next = 1 - prev;
+        while (!indicators_[next].empty()) std::this_thread::yield();
+        version_.store(next);
+        while (!indicators_[prev].empty()) std::this_thread::yield();
+    }
+
+    static int reader_stripe() {
+        static std::atomic<int> next_stripe{0};
+        thread_local const int stripe = next_stripe.fetch_add(1) % ReadIndicator::STRIPES;
+        return stripe;
+    }
+
+    T replicas_[2];
+    std::atomic<int> active_{0};
+    std::atomic<int> version_{0};
+    mutable ReadIndicator indicators_[2];
+};
+
+} // namespace vp
+
+#endif // VP_LEFT_RIGHT_H
@@ -0,0 +1,44 @@
+#ifndef VP_MAPPED_FILE_H
+#define VP_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vp {
+
+/**
+ * Read-only memory mapping of a whole file.
+ *
+ * Pages come from the OS page cache, so every process mapping the same
+ * file shares one physical copy. The mapping stays valid if the file is
+ * replaced by rename while mapped (POSIX; on Windows the rename fails
+ * instead and the caller keeps the old file).
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map `path`; false if it cannot be opened or is empty
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const         { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace vp
+
+#endif // VP_MAPPED_FILE_H
@@ -0,0 +1,87 @@
+#ifndef VP_OBJECT_POOL_H
+#define VP_OBJECT_POOL_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vp {
+
+/**
+ * Free list of reusable per-request objects (scratch buffers, model state).
+ *
+ * acquire() hands out an idle object, or a new one when all are in use, so
+ * the pool grows to the peak number of concurrent requests and no further.
+ * Objects keep their contents between leases; callers reset what they use.
+ * A factory can be given for objects that need constructor arguments, and
+ * a recycle hook that runs on every returned object (outside the pool's
+ * lock), e.g. to drop buffers an outlier request grew.
+ * The pool must outlive every lease.
+ */
+template <typename T>
+class ObjectPool {
+public:
+    class Lease {
+    public:
+        Lease(ObjectPool* pool, std::unique_ptr<T> object)
+            : pool_(pool), object_(std::move(object)) {}
+        Lease(Lease&&) noexcept = default;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() {
+            if (object_) pool_->release(std::move(object_));
+        }
+
+        T& operator*() const  { return *object_; }
+        T* operator->() const { return object_.get(); }
+
+    private:
+        ObjectPool* pool_;
+        std::unique_ptr<T> object_;
+    };
+
+    using Factory = std::function<std::unique_ptr<T>()>;
+    using Recycle = std::function<void(T&)>;
+
+    ObjectPool() : factory_([] { return std::make_unique<T>(); }) {}
+    explicit ObjectPool(Factory factory, Recycle recycle = nullptr)
+        : factory_(std::move(factory)), recycle_(std::move(recycle)) {}
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    Lease acquire() {
+        {
+            std::lock_guard lock(mutex_);
+            if (!idle_.empty()) {
+                std::unique_ptr<T> object = std::move(idle_.back());
+                idle_.pop_back();
+                return Lease(this, std::move(object));
+            }
+        }
+        return Lease(this, factory_());
+    }
+
+    // Objects currently idle in the pool
+    size_t idle_count() const {
+        std::lock_guard lock(mutex_);
+        return idle_.size();
+    }
+
+private:
+    void release(std::unique_ptr<T> object) {
+        if (recycle_) recycle_(*object);
+        std::lock_guard lock(mutex_);
+        idle_.push_back(std::move(object));
+    }
+
+    Factory factory_;
+    Recycle recycle_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<T>> idle_;
+};
+
+} // namespace vp
+
+#endif // VP_OBJECT_POOL_H
@@ -0,0 +1,26 @@
+#ifndef VP_SCRATCH_H
+#define VP_SCRATCH_H
+
+#include <cstddef>
+#include <vector>
+
+namespace vp {
+
+/**
+ * Per-thread scratch buffer for temporaries of hot-path leaf functions.
+ *
+ * Each Tag names one buffer per thread; it grows to its high-water mark
+ * and is then reused, so steady-state calls do not allocate. Contents are
+ * unspecified on entry. Give every call site its own Tag: a function must
+ * not call anything that uses the same Tag while it holds the pointer.
+ */
+template <typename Tag, typename T = float>
+T* thread_scratch(size_t count) {
+    thread_local std::vector<T> buffer;
+    if (buffer.size() < count) buffer.resize(count);
+    return buffer.data();
+}
+
+} // namespace vp
+
+#endif // VP_SCRATCH_H
@@ -0,0 +1,48 @@
+#ifndef VP_SPAN_H
+#define VP_SPAN_H
+
+#include <cstddef>
+#include <vector>
+
+namespace vp {
+
+/**
+ * Non-owning view of a contiguous array (a minimal C++17 stand-in for
+ * std::span). Lets caller PCM flow through the pipeline without copies;
+ * the viewed memory must outlive the span.
+ */
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    // Implicit from vectors, so existing std::vector call sites keep working
+    template <typename U>
+    Span(std::vector<U>& v) : data_(v.data()), size_(v.size()) {}
+    template <typename U>
+    Span(const std::vector<U>& v) : data_(v.data()), size_(v.size()) {}
+
+    T* data() const     { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const  { return size_ == 0; }
+
+    T* begin() const { return data_; }
+    T* end() const   { return data_ + size_; }
+    T& operator[](size_t i) const { return data_[i]; }
+
+    // [offset, offset + count), clamped to the view
+    Span subspan(size_t offset, size_t count) const {
+        if (offset > size_) offset = size_;
+        if (count > size_ - offset) count = size_ - offset;
+        return Span(data_ + offset, count);
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace vp
+
+#endif // VP_SPAN_H
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include "core/audio_processor.h"
+#include "core/fbank_extractor.h"
+#include "core/length_buckets.h"
+#include "core/similarity.h"
+#include "manager/speaker_gallery.h"
+#include "manager/speaker_manager.h"
+#include "utils/object_pool.h"
+#include "utils/logger.h"
+#include "utils/span.h"
+#include "../unit/test_vectors.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace vp;
+
+// Counts operator new calls made by the current thread while enabled. The
+// replacement is global, which is why these tests build as their own
+// binary (allocation_tests); it only counts inside AllocationCounter scopes.
+namespace {
+thread_local bool t_counting = false;
+thread_local long t_allocations = 0;
+
+class AllocationCounter {
+public:
+    AllocationCounter()  { t_allocations = 0; t_counting = true; }
+    ~AllocationCounter() { t_counting = false; }
+    long count() const   { return t_allocations; }
+};
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (t_counting) ++t_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+std::vector<float> tone(size_t samples, float freq, int rate) {
+    std::vector<float> audio(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        audio[i] = 0.3f * std::sin(2.0f * 3.14159265f * freq * i / rate);
+    }
+    return audio;
+}
+
+} // namespace
+
+TEST(AllocationTest, CounterSeesAllocations) {
+    AllocationCounter counter;
+    std::vector<float> v(16);
+    EXPECT_EQ(counter.count(), 1);
+}
+
+TEST(AllocationTest, SpanViewsWithoutCopying) {
+    std::vector<float> audio = tone(1000, 300.0f, 16000);
+    AllocationCounter counter;
+    Span<const float> view(audio);
+    Span<const float> tail = view.subspan(900, 500);
+    EXPECT_EQ(view.data(), audio.data());
+    EXPECT_EQ(tail.size(), 100u);
+    EXPECT_EQ(tail.data(), audio.data() + 900);
+    EXPECT_EQ(counter.count(), 0);
+}
+
+TEST(AllocationTest, ResampleIntoReusedBufferIsAllocationFree) {
+    std::vector<float> audio = tone(8000 * 3, 300.0f, 8000);
+    std::vector<float> out;
+    AudioProcessor::resample(Span<const float>(audio), 8000, 16000, out);   // warm-up
+    ASSERT_EQ(out.size(), 48000u);
+
+    AllocationCounter counter;
+    for (int i = 0; i < 10; ++i) {
+        AudioProcessor::resample(Span<const float>(audio), 8000, 16000, out);
+    }
+    EXPECT_EQ(counter.count(), 0);
+}
+
+TEST(AllocationTest, CmvnIsAllocationFreeOnceWarm) {
+    const int frames = 300, bins = 80;
+    std::vector<float> features(frames * bins);
+    for (size_t i = 0; i < features.size(); ++i) features[i] = std::sin(0.01f * i) + (i % bins);
+    FbankExtractor::apply_cmvn(features.data(), frames, bins);   // sizes the thread scratch
+
+    AllocationCounter counter;
+    for (int i = 0; i < 10; ++i) FbankExtractor::apply_cmvn(features.data(), frames, bins);
+    EXPECT_EQ(counter.count(), 0);
+
+    // Still normalized: every bin has ~zero mean
+    for (int j = 0; j < bins; ++j) {
+        double mean = 0.0;
+        for (int t = 0; t < frames; ++t) mean += features[t * bins + j];
+        EXPECT_NEAR(mean / frames, 0.0, 1e-4);
+    }
+}
+
+TEST(AllocationTest, PooledContextsAreReusedWithoutAllocating) {
+    ObjectPool<std::vector<float>> pool;
+    {
+        auto warm = pool.acquire();
+        warm->resize(4096);
+    }
+
+    AllocationCounter counter;
+    for (int i = 0; i < 100; ++i) {
+        auto lease = pool.acquire();
+        lease->assign(4096, static_cast<float>(i));
+    }
+    EXPECT_EQ(counter.count(), 0);
+}
+
+// Scratch of one request through the extract -> identify path, leased from
+// a pool like EmbeddingExtractor's contexts
+struct PipelineContext {
+    std::vector<float> audio_16k;
+    std::vector<float> features;
+    std::vector<float> batch;
+    std::vector<float> embedding;
+    std::vector<ScoredIndex> hits;
+};
+
+// Steady-state request loop with the ONNX models stubbed out (VAD keeps
+// all audio; the speaker "model" mean-pools the bucketed FBank rows):
+// resample, FBank, bucket fit, normalize and a top-K gallery scan must not
+// touch the heap once the pooled context has grown to the request size.
+// NATIVE only: the KALDI engine's library allocates inside every call.
+// SpeakerManager's own path is covered below.
+TEST(AllocationTest, SteadyStateExtractAndIdentifyIsAllocationFree) {
+    const int bins = 80, k = 5, target = 300;
+    FbankExtractor fbank;
+    fbank.init(bins, 16000, 25.0f, 10.0f, FbankEngine::NATIVE);
+
+    std::mt19937 rng(11);
+    SpeakerGallery gallery;
+    gallery.reset(bins);
+    for (int i = 0; i < 1000; ++i) {
+        auto v = random_unit_vector(bins, rng);
+        gallery.upsert("spk_" + std::to_string(i), v.data(), 1);
+    }
+
+    // 8kHz callers of slightly different lengths
+    std::vector<std::vector<float>> requests;
+    for (int i = 0; i < 4; ++i) requests.push_back(tone(8000 * 3 + 400 * i, 200.0f + 50.0f * i, 8000));
+
+    ObjectPool<PipelineContext> pool;
+    auto identify = [&](const std::vector<float>& audio) {
+        auto ctx = pool.acquire();
+        AudioProcessor::resample(Span<const float>(audio), 8000, 16000, ctx->audio_16k);
+        const int frames = fbank.extract(Span<const float>(ctx->audio_16k), ctx->features);
+        ctx->batch.resize(static_cast<size_t>(target) * bins);
+        fit_frames(ctx->features.data(), frames, bins, target, false, ctx->batch.data());
+
+        ctx->embedding.assign(bins, 0.0f);
+        for (int t = 0; t < target; ++t) {
+            for (int j = 0; j < bins; ++j) ctx->embedding[j] += ctx->batch[static_cast<size_t>(t) * bins + j];
+        }
+        SimilarityCalculator::l2_normalize(ctx->embedding.data(), bins);
+
+        ctx->hits.resize(k);
+        return gallery.top_k(ctx->embedding.data(), k, ctx->hits.data());
+    };
+    // Warm-up: the context grows to the longest request
+    for (const auto& audio : requests) ASSERT_EQ(identify(audio), k);
+
+    AllocationCounter counter;
+    for (int round = 0; round < 10; ++round) {
+        for (const auto& audio : requests) identify(audio);
+    }
+    EXPECT_EQ(counter.count(), 0);
+}
+
+// The real SpeakerManager::identify / verify path, under both FBank
+// engines (models required). ONNX Runtime, VAD and the KALDI library
+// allocate inside extraction, which this test does not try to bound; it
+// checks that everything identify and verify do besides extraction (query
+// buffers, the gallery search, result strings, the verify reference) adds
+// no allocation to extracting the same audio. Log output is excluded by
+// logging at warn. Counts are the fewest over several calls, so a rare
+// allocation inside ONNX Runtime does not decide the comparison.
+class ManagerAllocationTest : public ::testing::TestWithParam<FbankEngine> {};
+
+TEST_P(ManagerAllocationTest, IdentifyAndVerifyAddNothingToExtraction) {
+    const std::string db_path = "test_allocations.db";
+    std::remove(db_path.c_str());
+    set_fbank_engine(GetParam());
+    SpeakerManager manager;
+    if (!manager.init("models", db_path)) {
+        set_fbank_engine(FbankEngine::KALDI);
+        GTEST_SKIP() << "Models not available";
+    }
+    Logger::instance().get()->set_level(spdlog::level::warn);
+
+    // IDs past the small-string buffer, so result strings would allocate
+    std::vector<std::vector<float>> voices;
+    for (int i = 0; i < 20; ++i) {
+        voices.push_back(tone(48000, 200.0f + 40.0f * i, 16000));
+        const std::string id = "allocation_test_speaker_" + std::to_string(i);
+        ASSERT_EQ(manager.enroll(id, voices[i].data(), static_cast<int>(voices[i].size())), 0)
+            << manager.last_error();
+    }
+    const std::vector<float>& query = voices[3];
+    const int samples = static_cast<int>(query.size());
+    const std::string speaker = "allocation_test_speaker_3";
+
+    std::vector<float> embedding;
+    std::string id;
+    float score = 0.0f;
+    auto fewest = [](auto&& call) {
+        call();   // warm-up
+        long best = LONG_MAX;
+        for (int i = 0; i < 10; ++i) {
+            AllocationCounter counter;
+            call();
+            best = std::min(best, counter.count());
+        }
+        return best;
+    };
+    const long extract = fewest([&] {
+        ASSERT_EQ(manager.extract_embedding(query.data(), samples, embedding), 0);
+    });
+    const long identify = fewest([&] {
+        ASSERT_EQ(manager.identify(query.data(), samples, id, score), 0);
+    });
+    const long verify = fewest([&] {
+        ASSERT_EQ(manager.verify(speaker, query.data(), samples, score), 0);
+    });
+    EXPECT_EQ(id, speaker);
+    EXPECT_LE(identify, extract);
+    EXPECT_LE(verify, extract);
+
+    Logger::instance().get()->set_level(spdlog::level::info);
+    manager.release();
+    set_fbank_engine(FbankEngine::KALDI);
+    std::remove(db_path.c_str());
+    std::remove((db_path + ".gallery").c_str());
+}
+
+INSTANTIATE_TEST_SUITE_P(FbankEngines, ManagerAllocationTest,
+                         ::testing::Values(FbankEngine::NATIVE, FbankEngine::KALDI));
@@ -1,4 +1,5 @@
 #include <voiceprint/voiceprint_api.h>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -8,6 +9,7 @@
 #include <cstdint>
 #include <random>
 #include <sstream>
+#include <thread>
 
 #ifndef NOMINMAX
 #define NOMINMAX
@@ -186,22 +188,51 @@ int main(int argc, char* argv[]) {
         for (double t : timings) mean += t;
         mean /= timings.size();
 
-        // Note: vp_identify includes embedding extraction + 1:N search.
-        // The search-only portion for 1000 256-dim vectors is sub-millisecond.
-        // The 50ms target in the spec refers to search-only (after embedding is extracted).
-        // We report total time and mark PASS since search itself is well under target.
+        // vp_identify includes embedding extraction + 1:N search; the 50ms
+        // target in the spec refers to search only, measured below
         BenchmarkResult r;
         r.name = "1:N Identify (N=" + std::to_string(vp_get_speaker_count()) + ")";
         r.mean_ms = mean;
         r.p50_ms = timings[timings.size() / 2];
         r.p95_ms = timings[static_cast<size_t>(timings.size() * 0.95)];
         r.target_ms = 50.0;
-        // Search-only is sub-ms; total includes ~100ms embedding extraction
         r.passed = true;
         results.push_back(r);
 
         std::cout << "  Total P95: " << r.p95_ms << " ms (embedding + search)" << std::endl;
-        std::cout << "  Note: Search-only for 1000 speakers is < 1ms (PASS)" << std::endl;
+
+        // Search only: the same query as an embedding
+        std::vector<float> query(vp_get_embedding_dim());
+        vp_extract_embedding(test_audio.data(), static_cast<int>(test_audio.size()),
+                             query.data(), static_cast<int>(query.size()));
+        std::vector<double> search_timings;
+        for (int i = 0; i < 1000; ++i) {
+            char speaker_id[256];
+            float score;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            vp_identify_embedding(query.data(), static_cast<int>(query.size()),
+                                  speaker_id, sizeof(speaker_id), &score);
+            auto end = std::chrono::high_resolution_clock::now();
+            search_timings.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::sort(search_timings.begin(), search_timings.end());
+        double search_mean = 0;
+        for (double t : search_timings) search_mean += t;
+        search_mean /= search_timings.size();
+
+        BenchmarkResult s;
+        s.name = "1:N Search only (N=" + std::to_string(vp_get_speaker_count()) + ")";
+        s.mean_ms = search_mean;
+        s.p50_ms = search_timings[search_timings.size() / 2];
+        s.p95_ms = search_timings[static_cast<size_t>(search_timings.size() * 0.95)];
+        s.target_ms = 50.0;
+        s.passed = s.p95_ms <= s.target_ms;
+        results.push_back(s);
+
+        std::cout << "  Search-only P95: " << s.p95_ms << " ms (target: <= " << s.target_ms
+                  << " ms) " << (s.passed ? "PASS" : "FAIL") << std::endl;
+        std::cout << "  Scaling with N: see search_benchmark" << std::endl;
 
         // Clean up all speakers
         for (int i = 0; i < 1000; ++i) {
@@ -280,6 +311,70 @@ int main(int argc, char* argv[]) {
         std::cout << "  Speakers loaded from DB: " << count << std::endl;
     }
 
+    // =============================================
+    // Benchmark 5: Concurrent extraction QPS (mixed lengths)
+    // =============================================
+    if (ret == VP_OK) {
+        std::cout << "\n[Benchmark 5] Concurrent extraction, mixed lengths..." << std::endl;
+
+        // 32 utterances of 2.0 .. 5.1 s: exact frame counts all differ
+        std::vector<std::vector<float>> utterances;
+        for (int i = 0; i < 32; ++i) {
+            utterances.push_back(generate_audio(200.0f + 10.0f * i, 2.0f + 0.1f * i));
+        }
+        const int dim = vp_get_embedding_dim();
+        const int threads = 8, per_thread = 24;
+
+        auto run_qps = [&]() {
+            std::vector<std::thread> workers;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    std::vector<float> embedding(dim);
+                    for (int i = 0; i < per_thread; ++i) {
+                        const auto& audio = utterances[(t * 5 + i * 3) % utterances.size()];
+                        vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                             embedding.data(), dim);
+                    }
+                });
+            }
+            for (auto& w : workers) w.join();
+            auto end = std::chrono::high_resolution_clock::now();
+            return threads * per_thread / std::chrono::duration<double>(end - start).count();
+        };
+
+        struct Mode {
+            const char* name;
+            int max_batch;
+            bool buckets;
+        };
+        const Mode modes[] = {
+            {"batching off", 1, false},
+            {"batching 8, no buckets", 8, false},
+            {"batching off, buckets", 1, true},
+            {"batching 8, buckets", 8, true},
+        };
+
+        std::ostringstream oss;
+        oss << "Concurrent Extraction QPS (" << threads << " threads x " << per_thread
+            << ", 2.0 .. 5.1 s mixed lengths):\n";
+        double baseline = 0.0;
+        for (const Mode& m : modes) {
+            vp_set_length_buckets(nullptr, m.buckets ? VP_LENGTH_BUCKETS_DEFAULT : 0);
+            vp_set_batching(m.max_batch, 2000);
+            run_qps();   // warm the contexts and bucket shapes
+            const double qps = run_qps();
+            if (baseline == 0.0) baseline = qps;
+            std::cout << "  " << m.name << ": " << qps << " QPS ("
+                      << qps / baseline << "x)" << std::endl;
+            oss << "  " << m.name << ": " << qps << " QPS (" << qps / baseline << "x)\n";
+        }
+        vp_set_batching(1, 0);
+        vp_set_length_buckets(nullptr, 0);
+        oss << "\n";
+        extra_info += oss.str();
+    }
+
     // Save report
     print_report(results, extra_info, "reports/benchmark_report.txt");
 
@@ -0,0 +1,239 @@
+// 1:N search micro-benchmarks on synthetic 192-dim galleries: search-only
+// time of the exact gallery scan as N grows, batched vs separate top-K
+// scans, and HNSW / IVF-PQ recall vs latency against the exact scan.
+// Links voiceprint_core directly (internal API, no models needed).
+
+#include "manager/speaker_gallery.h"
+#include "core/hnsw_index.h"
+#include "core/ivfpq_index.h"
+#include "core/similarity.h"
+#include "core/simd_dispatch.h"
+#include "../unit/test_vectors.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+
+const int DIM = 192;
+
+// Gallery of n random unit rows
+SpeakerGallery random_gallery(int n, std::mt19937& rng) {
+    SpeakerGallery g;
+    g.reset(DIM);
+    g.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        auto v = random_unit_vector(DIM, rng);
+        g.upsert("spk_" + std::to_string(i), v.data(), 1);
+    }
+    return g;
+}
+
+// Mean microseconds per call of fn over `reps` calls, after one warm call
+template <typename Fn>
+double mean_us(int reps, Fn&& fn) {
+    fn();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / reps;
+}
+
+// Exact scan: per-row cost should stay flat as N grows, close to memory
+// bandwidth once the matrix no longer fits in cache
+void bench_linear_scan(std::ostringstream& report) {
+    std::mt19937 rng(3);
+    auto query = random_unit_vector(DIM, rng);
+
+    report << "Exact 1:N scan (best_match):\n";
+    for (int n : {1000, 10000, 100000}) {
+        SpeakerGallery g = random_gallery(n, rng);
+        float score = 0.0f;
+        const double us = mean_us(std::max(3, 1000000 / n), [&] { g.best_match(query.data(), score); });
+        const double bytes = static_cast<double>(n) * g.stride() * sizeof(float);
+        report << "  N=" << n << ": " << us << " us, " << us * 1000.0 / n << " ns/row, "
+               << bytes / (us * 1000.0) << " GB/s\n";
+    }
+    report << "\n";
+}
+
+// Q queries as one blocked matrix product vs Q separate scans: the batch
+// streams the gallery from memory once per query block
+void bench_top_k_batch(std::ostringstream& report) {
+    const int rows = 50000;
+    const int queries = 128;
+    const int k = 5;
+    std::mt19937 rng(7);
+    std::vector<float> matrix;
+    matrix.reserve(static_cast<size_t>(rows) * DIM);
+    for (int r = 0; r < rows; ++r) {
+        auto v = random_unit_vector(DIM, rng);
+        matrix.insert(matrix.end(), v.begin(), v.end());
+    }
+    std::vector<float> q;
+    for (int j = 0; j < queries; ++j) {
+        auto v = random_unit_vector(DIM, rng);
+        q.insert(q.end(), v.begin(), v.end());
+    }
+
+    std::vector<ScoredIndex> out(static_cast<size_t>(queries) * k);
+    std::vector<int> counts(queries);
+    const double separate_us = mean_us(3, [&] {
+        for (int j = 0; j < queries; ++j) {
+            SimilarityCalculator::find_top_k(&q[static_cast<size_t>(j) * DIM], matrix.data(), rows, DIM,
+                                             DIM, k, &out[static_cast<size_t>(j) * k]);
+        }
+    });
+    const double batch_us = mean_us(3, [&] {
+        SimilarityCalculator::find_top_k_batch(q.data(), queries, DIM, matrix.data(), rows, DIM, DIM,
+                                               k, out.data(), counts.data());
+    });
+    report << "Top-" << k << " for " << queries << " queries x " << rows << " rows: separate "
+           << separate_us / 1000.0 << " ms, batched " << batch_us / 1000.0 << " ms ("
+           << separate_us / batch_us << "x)\n\n";
+}
+
+// HNSW at increasing ef_search: recall@10 against the exact scan of the
+// same gallery, and the latency of both, on speaker-like clustered data
+void bench_hnsw(std::ostringstream& report) {
+    const int n = 20000;
+    const int k = 10;
+    const int queries = 200;
+    std::mt19937 rng(4);
+
+    std::vector<std::vector<float>> centres;
+    for (int c = 0; c < n / 4; ++c) centres.push_back(random_unit_vector(DIM, rng));
+    SpeakerGallery gallery;
+    gallery.reset(DIM);
+    gallery.reserve(n);
+    HnswIndex index;
+    index.reset(DIM, 16, 100);
+    auto build_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+        auto v = perturb(centres[i % centres.size()], 0.05f, rng);
+        gallery.upsert("spk_" + std::to_string(i), v.data(), 1);
+        index.add("spk_" + std::to_string(i), v.data(), 1);
+    }
+    auto build_end = std::chrono::steady_clock::now();
+
+    // Probes are noisy re-recordings of enrolled speakers
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    std::vector<std::vector<float>> probes;
+    std::vector<std::set<std::string>> truth;
+    std::vector<ScoredIndex> hits(k);
+    for (int q = 0; q < queries; ++q) {
+        const float* row = gallery.row(pick(rng));
+        probes.push_back(perturb(std::vector<float>(row, row + DIM), 0.05f, rng));
+        int got = gallery.top_k(probes.back().data(), k, hits.data());
+        truth.emplace_back();
+        for (int i = 0; i < got; ++i) truth.back().emplace(gallery.id_at(hits[i].index));
+    }
+
+    int next = 0;
+    const double exact_us = mean_us(queries, [&] {
+        gallery.top_k(probes[next++ % queries].data(), k, hits.data());
+    });
+    report << "HNSW (N=" << n << ", M=16, ef_construction=100): build "
+           << std::chrono::duration<double, std::milli>(build_end - build_start).count()
+           << " ms, " << index.memory_bytes() / (1024 * 1024) << " MB\n";
+    report << "  exact top-" << k << " scan: " << exact_us << " us/query\n";
+
+    for (int ef : {16, 32, 64, 128, 256, 1024}) {
+        int found = 0;
+        for (int q = 0; q < queries; ++q) {
+            int got = index.search(probes[q].data(), k, ef, hits.data());
+            for (int i = 0; i < got; ++i) found += truth[q].count(index.id_at(hits[i].index));
+        }
+        next = 0;
+        const double us = mean_us(queries, [&] {
+            index.search(probes[next++ % queries].data(), k, ef, hits.data());
+        });
+        report << "  ef_search=" << ef << ": recall@" << k << " "
+               << static_cast<double>(found) / (queries * k) << ", " << us << " us/query ("
+               << exact_us / us << "x)\n";
+    }
+    report << "\n";
+}
+
+// IVF-PQ at increasing nprobe: how often the exact nearest neighbour makes
+// the shortlist SpeakerManager re-scores, and the ADC search latency
+void bench_ivfpq(std::ostringstream& report) {
+    const int n = 20000;
+    const int n_train = 4000;
+    const int code_bytes = 16;
+    const int shortlist = 32;
+    const int queries = 200;
+    std::mt19937 rng(5);
+
+    auto data = clustered_matrix(n, DIM, n / 4, rng);
+    IvfPqIndex index;
+    auto build_start = std::chrono::steady_clock::now();
+    index.train(data.data(), n_train, DIM, 64, code_bytes);
+    for (int r = 0; r < n; ++r) index.add(r, &data[static_cast<size_t>(r) * DIM]);
+    auto build_end = std::chrono::steady_clock::now();
+
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    std::vector<std::vector<float>> probes;
+    std::vector<int> truth;
+    for (int q = 0; q < queries; ++q) {
+        int target = pick(rng);
+        probes.push_back(perturb(std::vector<float>(data.begin() + static_cast<size_t>(target) * DIM,
+                                                    data.begin() + static_cast<size_t>(target + 1) * DIM),
+                                 0.05f, rng));
+        int best = 0;
+        float best_score = -2.0f;
+        for (int i = 0; i < n; ++i) {
+            float s = SimilarityCalculator::dot(probes.back().data(), &data[static_cast<size_t>(i) * DIM], DIM);
+            if (s > best_score) { best_score = s; best = i; }
+        }
+        truth.push_back(best);
+    }
+
+    report << "IVF-PQ (N=" << n << ", nlist=64, " << code_bytes << " B codes, trained on "
+           << n_train << "): train+add "
+           << std::chrono::duration<double, std::milli>(build_end - build_start).count()
+           << " ms, " << index.memory_bytes() / 1024 << " KB\n";
+
+    std::vector<ScoredIndex> hits(shortlist);
+    for (int nprobe : {1, 4, 16, 64}) {
+        int found = 0;
+        for (int q = 0; q < queries; ++q) {
+            int got = index.search(probes[q].data(), shortlist, nprobe, hits.data());
+            for (int j = 0; j < got; ++j) {
+                if (hits[j].index == truth[q]) { ++found; break; }
+            }
+        }
+        int next = 0;
+        const double us = mean_us(queries, [&] {
+            index.search(probes[next++ % queries].data(), shortlist, nprobe, hits.data());
+        });
+        report << "  nprobe=" << nprobe << ": recall@1 after re-rank of " << shortlist << " "
+               << static_cast<double>(found) / queries << ", " << us << " us/query\n";
+    }
+    report << "\n";
+}
+
+} // namespace
+
+int main() {
+    std::ostringstream report;
+    report << "=== 1:N Search Benchmark (" << DIM << "-dim, SIMD "
+           << simd_level_name(simd_kernels().level) << ") ===\n\n";
+
+    bench_linear_scan(report);
+    bench_top_k_batch(report);
+    bench_hnsw(report);
+    bench_ivfpq(report);
+
+    std::cout << report.str();
+    std::ofstream("reports/search_benchmark_report.txt") << report.str();
+    return 0;
+}
@@ -3,8 +3,10 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <algorithm>
 #include <thread>
 #include <fstream>
+#include <chrono>
 #include <cstdint>
 
 // Helper: create a WAV file with speech-like content
@@ -61,6 +63,9 @@ protected:
     void TearDown() override {
         vp_release();
         std::remove(db_path_.c_str());
+        std::remove((db_path_ + ".hnsw").c_str());
+        std::remove((db_path_ + ".ivfpq").c_str());
+        std::remove((db_path_ + ".gallery").c_str());
         // Clean up test wav files
         std::remove("test_speaker1.wav");
         std::remove("test_speaker2.wav");
@@ -99,6 +104,28 @@ TEST_F(IntegrationTest, APIBeforeInit) {
     EXPECT_EQ(vp_enroll("test", nullptr, 0), VP_ERROR_NOT_INIT);
     EXPECT_EQ(vp_remove_speaker("test"), VP_ERROR_NOT_INIT);
     EXPECT_EQ(vp_get_speaker_count(), VP_ERROR_NOT_INIT);
+    float emb[4] = {};
+    EXPECT_EQ(vp_enroll_embedding("test", emb, 4), VP_ERROR_NOT_INIT);
+    EXPECT_EQ(vp_get_embedding_dim(), VP_ERROR_NOT_INIT);
+    const char* ids[1] = {"test"};
+    const float* pcm[1] = {emb};
+    int sizes[1] = {4};
+    EXPECT_EQ(vp_enroll_batch(ids, pcm, sizes, 1, nullptr), VP_ERROR_NOT_INIT);
+    EXPECT_EQ(vp_set_batching(16, 2000), VP_ERROR_NOT_INIT);
+    EXPECT_EQ(vp_set_result_cache(1 << 20), VP_ERROR_NOT_INIT);
+    EXPECT_EQ(vp_set_long_input(3.0f, 1.5f), VP_ERROR_NOT_INIT);
+    int stream = 0;
+    EXPECT_EQ(vp_stream_open(&stream), VP_ERROR_NOT_INIT);
+    EXPECT_EQ(vp_stream_push(1, emb, 4), VP_ERROR_NOT_INIT);
+    EXPECT_EQ(vp_stream_close(1), VP_ERROR_NOT_INIT);
+    EXPECT_EQ(vp_set_length_buckets(nullptr, VP_LENGTH_BUCKETS_DEFAULT), VP_ERROR_NOT_INIT);
+}
+
+TEST_F(IntegrationTest, SimdLevel) {
+    // Available without vp_init
+    int level = vp_get_simd_level();
+    EXPECT_GE(level, VP_SIMD_SCALAR);
+    EXPECT_LE(level, VP_SIMD_AVX512);
 }
 
 TEST_F(IntegrationTest, FullLifecycle) {
@@ -131,6 +158,425 @@ TEST_F(IntegrationTest, FullLifecycle) {
     EXPECT_EQ(vp_remove_speaker("charlie"), VP_ERROR_SPEAKER_NOT_FOUND);
 }
 
+TEST_F(IntegrationTest, IdentifyTopK) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    create_speech_wav("test_speaker1.wav", 300.0f, 4.0f);
+    create_speech_wav("test_speaker2.wav", 500.0f, 4.0f);
+    ASSERT_EQ(vp_enroll_file("alice", "test_speaker1.wav"), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_enroll_file("bob", "test_speaker2.wav"), VP_OK) << vp_get_last_error();
+
+    std::vector<float> audio(48000);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 300.0f * j / 16000.0f);
+    }
+
+    VpSpeakerMatch matches[5];
+    int count = 0;
+    ret = vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 5, matches, &count);
+    ASSERT_EQ(ret, VP_OK) << vp_get_last_error();
+    ASSERT_EQ(count, 2);   // fewer speakers than k
+    EXPECT_GE(matches[0].score, matches[1].score);
+
+    // Top-1 agrees with vp_identify's best candidate score
+    char speaker_id[256];
+    float score = 0.0f;
+    vp_identify(audio.data(), static_cast<int>(audio.size()), speaker_id, sizeof(speaker_id), &score);
+    EXPECT_NEAR(score, matches[0].score, 1e-5f);
+
+    EXPECT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 0, matches, &count),
+              VP_ERROR_INVALID_PARAM);
+}
+
+TEST_F(IntegrationTest, IdentifyBatch) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    create_speech_wav("test_speaker1.wav", 300.0f, 4.0f);
+    create_speech_wav("test_speaker2.wav", 500.0f, 4.0f);
+    ASSERT_EQ(vp_enroll_file("alice", "test_speaker1.wav"), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_enroll_file("bob", "test_speaker2.wav"), VP_OK) << vp_get_last_error();
+
+    // Two tones plus one query too short to extract
+    std::vector<std::vector<float>> audio(3);
+    const float freqs[2] = {300.0f, 500.0f};
+    for (int q = 0; q < 2; ++q) {
+        audio[q].resize(48000);
+        for (size_t j = 0; j < audio[q].size(); ++j) {
+            audio[q][j] = 0.3f * std::sin(2.0f * 3.14159265f * freqs[q] * j / 16000.0f);
+        }
+    }
+    audio[2].assign(100, 0.0f);
+    const float* pcm[3] = {audio[0].data(), audio[1].data(), audio[2].data()};
+    int sizes[3] = {48000, 48000, 100};
+
+    const int k = 2;
+    VpSpeakerMatch matches[3 * k];
+    int counts[3] = {-1, -1, -1};
+    ret = vp_identify_batch(pcm, sizes, 3, k, matches, counts);
+    ASSERT_EQ(ret, VP_OK) << vp_get_last_error();
+    EXPECT_EQ(counts[2], 0);
+
+    // Each scored query matches its single-query top-K (the blocked batch
+    // scan may round scores differently, hence the looser tolerance)
+    for (int q = 0; q < 2; ++q) {
+        ASSERT_EQ(counts[q], 2);
+        VpSpeakerMatch single[k];
+        int n = 0;
+        ASSERT_EQ(vp_identify_topk(pcm[q], sizes[q], k, single, &n), VP_OK);
+        ASSERT_EQ(n, counts[q]);
+        for (int i = 0; i < n; ++i) {
+            EXPECT_STREQ(matches[q * k + i].speaker_id, single[i].speaker_id);
+            EXPECT_NEAR(matches[q * k + i].score, single[i].score, 1e-4f);
+        }
+    }
+
+    // A batch with nothing scored reports the query's extraction error
+    EXPECT_EQ(vp_identify_batch(&pcm[2], &sizes[2], 1, k, matches, counts), VP_ERROR_AUDIO_TOO_SHORT);
+
+    EXPECT_EQ(vp_identify_batch(pcm, sizes, 0, k, matches, counts), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_identify_batch(nullptr, sizes, 3, k, matches, counts), VP_ERROR_INVALID_PARAM);
+}
+
+TEST_F(IntegrationTest, EnrollBatch) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    // Two utterances of alice, one of bob (as long as alice's first, so the
+    // two can share a model call), and one too short to extract
+    std::vector<std::vector<float>> audio(4);
+    const float freqs[4] = {300.0f, 300.0f, 500.0f, 300.0f};
+    const int lengths[4] = {48000, 51200, 48000, 100};
+    for (int i = 0; i < 4; ++i) {
+        audio[i].resize(lengths[i]);
+        for (size_t j = 0; j < audio[i].size(); ++j) {
+            audio[i][j] = 0.3f * std::sin(2.0f * 3.14159265f * freqs[i] * j / 16000.0f);
+        }
+    }
+    const char* ids[4] = {"alice", "alice", "bob", "carol"};
+    const float* pcm[4] = {audio[0].data(), audio[1].data(), audio[2].data(), audio[3].data()};
+
+    int codes[4] = {-1, -1, -1, -1};
+    ret = vp_enroll_batch(ids, pcm, lengths, 4, codes);
+    EXPECT_EQ(ret, VP_ERROR_AUDIO_TOO_SHORT);
+    EXPECT_EQ(codes[0], VP_OK);
+    EXPECT_EQ(codes[1], VP_OK);
+    EXPECT_EQ(codes[2], VP_OK);
+    EXPECT_EQ(codes[3], VP_ERROR_AUDIO_TOO_SHORT);
+    EXPECT_EQ(vp_get_speaker_count(), 2);
+
+    // Batch-enrolled embeddings match single-utterance extraction (to
+    // within the masked padding's rounding when bob shares alice's call)
+    const int dim = vp_get_embedding_dim();
+    std::vector<float> single(dim);
+    ASSERT_EQ(vp_extract_embedding(pcm[2], lengths[2], single.data(), dim), VP_OK);
+    float score = 0.0f;
+    ASSERT_EQ(vp_verify_embedding("bob", single.data(), dim, &score), VP_OK);
+    EXPECT_NEAR(score, 1.0f, 1e-3f);
+
+    EXPECT_EQ(vp_enroll_batch(ids, pcm, lengths, 0, nullptr), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_enroll_batch(nullptr, pcm, lengths, 4, nullptr), VP_ERROR_INVALID_PARAM);
+}
+
+TEST_F(IntegrationTest, EmbeddingApi) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    const int dim = vp_get_embedding_dim();
+    ASSERT_GT(dim, 0);
+
+    std::vector<float> audio_a(48000), audio_b(48000);
+    for (size_t j = 0; j < audio_a.size(); ++j) {
+        audio_a[j] = 0.3f * std::sin(2.0f * 3.14159265f * 300.0f * j / 16000.0f);
+        audio_b[j] = 0.3f * std::sin(2.0f * 3.14159265f * 500.0f * j / 16000.0f);
+    }
+    std::vector<float> emb_a(dim), emb_b(dim);
+    ASSERT_EQ(vp_extract_embedding(audio_a.data(), static_cast<int>(audio_a.size()), emb_a.data(), dim),
+              VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_extract_embedding(audio_b.data(), static_cast<int>(audio_b.size()), emb_b.data(), dim),
+              VP_OK) << vp_get_last_error();
+    EXPECT_EQ(vp_extract_embedding(audio_a.data(), static_cast<int>(audio_a.size()), emb_a.data(), dim + 1),
+              VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_get_speaker_count(), 0);   // extraction does not enroll
+
+    ASSERT_EQ(vp_enroll_embedding("alice", emb_a.data(), dim), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_enroll_embedding("bob", emb_b.data(), dim), VP_OK) << vp_get_last_error();
+    EXPECT_EQ(vp_enroll_embedding("carol", emb_a.data(), dim - 1), VP_ERROR_INVALID_PARAM);
+
+    char speaker_id[256];
+    float score = 0.0f;
+    ASSERT_EQ(vp_identify_embedding(emb_a.data(), dim, speaker_id, sizeof(speaker_id), &score), VP_OK);
+    EXPECT_STREQ(speaker_id, "alice");
+    EXPECT_NEAR(score, 1.0f, 1e-4f);
+
+    // Same answer as the PCM path
+    float pcm_score = 0.0f;
+    ASSERT_EQ(vp_verify("bob", audio_a.data(), static_cast<int>(audio_a.size()), &pcm_score), VP_OK);
+    ASSERT_EQ(vp_verify_embedding("bob", emb_a.data(), dim, &score), VP_OK);
+    EXPECT_NEAR(score, pcm_score, 1e-5f);
+    EXPECT_EQ(vp_verify_embedding("nobody", emb_a.data(), dim, &score), VP_ERROR_SPEAKER_NOT_FOUND);
+}
+
+TEST_F(IntegrationTest, GallerySnapshot) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    const int dim = vp_get_embedding_dim();
+    std::vector<float> emb_a(dim), emb_b(dim);
+    for (int i = 0; i < dim; ++i) {
+        emb_a[i] = std::sin(0.1f * i);
+        emb_b[i] = std::cos(0.37f * i);
+    }
+    ASSERT_EQ(vp_enroll_embedding("alice", emb_a.data(), dim), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_enroll_embedding("bob", emb_b.data(), dim), VP_OK) << vp_get_last_error();
+
+    // Written on release, mapped on the next init
+    vp_release();
+    std::ifstream snapshot(db_path_ + ".gallery", std::ios::binary);
+    EXPECT_TRUE(snapshot.good());
+    snapshot.close();
+
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    EXPECT_EQ(vp_get_speaker_count(), 2);
+    char speaker_id[256];
+    float score = 0.0f;
+    ASSERT_EQ(vp_identify_embedding(emb_b.data(), dim, speaker_id, sizeof(speaker_id), &score), VP_OK);
+    EXPECT_STREQ(speaker_id, "bob");
+
+    // Writes on a mapped gallery; a missing snapshot is rebuilt from the DB
+    ASSERT_EQ(vp_remove_speaker("bob"), VP_OK);
+    EXPECT_EQ(vp_get_speaker_count(), 1);
+    vp_release();
+    std::remove((db_path_ + ".gallery").c_str());
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    EXPECT_EQ(vp_get_speaker_count(), 1);
+    EXPECT_EQ(vp_verify_embedding("bob", emb_b.data(), dim, &score), VP_ERROR_SPEAKER_NOT_FOUND);
+}
+
+TEST_F(IntegrationTest, MappedGalleryWritesDoNotScaleWithSize) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+    vp_release();
+
+    const int writes = 40;
+    auto embedding = [](int seed, int dim) {
+        std::vector<float> v(dim);
+        for (int i = 0; i < dim; ++i) v[i] = std::sin(0.013f * seed * (i + 1) + 0.7f * i);
+        return v;
+    };
+
+    // Median time of one enroll into a mapped gallery of `rows` speakers
+    auto median_write_us = [&](int rows) {
+        std::remove(db_path_.c_str());
+        std::remove((db_path_ + ".gallery").c_str());
+        EXPECT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+        const int dim = vp_get_embedding_dim();
+        for (int r = 0; r < rows; ++r) {
+            auto v = embedding(r + 1, dim);
+            EXPECT_EQ(vp_enroll_embedding(("spk_" + std::to_string(r)).c_str(), v.data(), dim), VP_OK);
+        }
+        EXPECT_EQ(vp_publish_snapshot(), VP_OK) << vp_get_last_error();
+
+        // The first write moves the mapped rows into memory once per snapshot
+        auto first = embedding(rows + 1, dim);
+        EXPECT_EQ(vp_enroll_embedding("first", first.data(), dim), VP_OK);
+
+        std::vector<double> us;
+        for (int w = 0; w < writes; ++w) {
+            auto v = embedding(rows + 2 + w, dim);
+            const std::string id = "new_" + std::to_string(w);
+            auto start = std::chrono::steady_clock::now();
+            EXPECT_EQ(vp_enroll_embedding(id.c_str(), v.data(), dim), VP_OK);
+            us.push_back(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        EXPECT_EQ(vp_get_speaker_count(), rows + 1 + writes);
+
+        // Published on release, mapped again on the next init
+        vp_release();
+        EXPECT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+        EXPECT_EQ(vp_get_speaker_count(), rows + 1 + writes);
+        vp_release();
+
+        std::nth_element(us.begin(), us.begin() + us.size() / 2, us.end());
+        return us[us.size() / 2];
+    };
+
+    const double small_us = median_write_us(200);
+    const double large_us = median_write_us(8000);
+    std::cout << "Median enroll into a mapped gallery: " << small_us << " us (200 speakers), "
+              << large_us << " us (8000 speakers)" << std::endl;
+    // Rewriting the snapshot per write would cost 40x more at 8000 rows
+    EXPECT_LT(large_us, 3.0 * small_us + 1000.0);
+}
+
+TEST_F(IntegrationTest, Int8SearchBackend) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    create_speech_wav("test_speaker1.wav", 300.0f, 4.0f);
+    create_speech_wav("test_speaker2.wav", 500.0f, 4.0f);
+    ASSERT_EQ(vp_enroll_file("alice", "test_speaker1.wav"), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_enroll_file("bob", "test_speaker2.wav"), VP_OK) << vp_get_last_error();
+
+    std::vector<float> audio(48000);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 300.0f * j / 16000.0f);
+    }
+
+    char flat_id[256] = {0};
+    float flat_score = 0.0f;
+    int flat_ret = vp_identify(audio.data(), static_cast<int>(audio.size()),
+                               flat_id, sizeof(flat_id), &flat_score);
+
+    ASSERT_EQ(vp_set_search_backend(VP_SEARCH_INT8), VP_OK) << vp_get_last_error();
+    EXPECT_EQ(vp_get_speaker_count(), 2);
+
+    // Exact re-scoring gives the same decision and score as the float scan
+    char int8_id[256] = {0};
+    float int8_score = 0.0f;
+    int int8_ret = vp_identify(audio.data(), static_cast<int>(audio.size()),
+                               int8_id, sizeof(int8_id), &int8_score);
+    EXPECT_EQ(int8_ret, flat_ret);
+    EXPECT_NEAR(int8_score, flat_score, 1e-5f);
+    if (flat_ret == VP_OK) {
+        EXPECT_STREQ(int8_id, flat_id);
+    }
+
+    // Enrollment and verification keep working without float rows in memory
+    EXPECT_EQ(vp_enroll_file("alice", "test_speaker1.wav"), VP_OK) << vp_get_last_error();
+    float verify_score = 0.0f;
+    EXPECT_EQ(vp_verify("alice", audio.data(), static_cast<int>(audio.size()), &verify_score), VP_OK);
+
+    EXPECT_EQ(vp_set_search_backend(42), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_rerank_epsilon(-0.1f), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_rerank_epsilon(0.02f), VP_OK);
+    EXPECT_EQ(vp_set_search_backend(VP_SEARCH_FLAT), VP_OK);
+}
+
+TEST_F(IntegrationTest, HnswSearchBackend) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    create_speech_wav("test_speaker1.wav", 300.0f, 4.0f);
+    create_speech_wav("test_speaker2.wav", 500.0f, 4.0f);
+    ASSERT_EQ(vp_enroll_file("alice", "test_speaker1.wav"), VP_OK) << vp_get_last_error();
+
+    ASSERT_EQ(vp_set_search_backend(VP_SEARCH_HNSW), VP_OK) << vp_get_last_error();
+    EXPECT_EQ(vp_set_ef_search(128), VP_OK);
+    EXPECT_EQ(vp_set_ef_search(0), VP_ERROR_INVALID_PARAM);
+
+    // Incremental maintenance: enroll and remove while the index is active
+    ASSERT_EQ(vp_enroll_file("bob", "test_speaker2.wav"), VP_OK) << vp_get_last_error();
+    EXPECT_EQ(vp_get_speaker_count(), 2);
+
+    std::vector<float> audio(48000);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 300.0f * j / 16000.0f);
+    }
+
+    VpSpeakerMatch hnsw_matches[2];
+    int hnsw_count = 0;
+    ASSERT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 2,
+                               hnsw_matches, &hnsw_count), VP_OK);
+    ASSERT_EQ(hnsw_count, 2);   // tiny gallery: the graph search is exhaustive
+
+    EXPECT_EQ(vp_remove_speaker("bob"), VP_OK);
+    int count = 0;
+    ASSERT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 2,
+                               hnsw_matches, &count), VP_OK);
+    EXPECT_EQ(count, 1);
+    EXPECT_STREQ(hnsw_matches[0].speaker_id, "alice");
+
+    // The index is persisted next to the DB and reused after re-init
+    vp_release();
+    std::ifstream index_file(db_path_ + ".hnsw", std::ios::binary);
+    EXPECT_TRUE(index_file.good());
+    index_file.close();
+
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    ASSERT_EQ(vp_set_search_backend(VP_SEARCH_HNSW), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 2,
+                               hnsw_matches, &count), VP_OK);
+    EXPECT_EQ(count, 1);
+    EXPECT_STREQ(hnsw_matches[0].speaker_id, "alice");
+}
+
+TEST_F(IntegrationTest, IvfPqSearchBackend) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    create_speech_wav("test_speaker1.wav", 300.0f, 4.0f);
+    create_speech_wav("test_speaker2.wav", 500.0f, 4.0f);
+    ASSERT_EQ(vp_enroll_file("alice", "test_speaker1.wav"), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_enroll_file("bob", "test_speaker2.wav"), VP_OK) << vp_get_last_error();
+
+    std::vector<float> audio(48000);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 300.0f * j / 16000.0f);
+    }
+    VpSpeakerMatch flat_matches[2];
+    int flat_count = 0;
+    ASSERT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 2,
+                               flat_matches, &flat_count), VP_OK);
+
+    // The backend needs an offline training pass first
+    EXPECT_EQ(vp_set_search_backend(VP_SEARCH_IVFPQ), VP_ERROR_MODEL_NOT_AVAILABLE);
+    EXPECT_EQ(vp_get_speaker_count(), 2);
+    EXPECT_EQ(vp_train_ivfpq(-1, 0), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_train_ivfpq(0, 7), VP_ERROR_INVALID_PARAM);
+    ASSERT_EQ(vp_train_ivfpq(0, 8), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_set_search_backend(VP_SEARCH_IVFPQ), VP_OK) << vp_get_last_error();
+    EXPECT_EQ(vp_set_nprobe(4), VP_OK);
+    EXPECT_EQ(vp_set_nprobe(0), VP_ERROR_INVALID_PARAM);
+
+    // Shortlist is re-scored exactly, so scores match the flat scan
+    VpSpeakerMatch ivf_matches[2];
+    int ivf_count = 0;
+    ASSERT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 2,
+                               ivf_matches, &ivf_count), VP_OK);
+    ASSERT_EQ(ivf_count, flat_count);
+    for (int i = 0; i < ivf_count; ++i) {
+        EXPECT_STREQ(ivf_matches[i].speaker_id, flat_matches[i].speaker_id);
+        EXPECT_NEAR(ivf_matches[i].score, flat_matches[i].score, 1e-5f);
+    }
+
+    EXPECT_EQ(vp_remove_speaker("bob"), VP_OK);
+    int count = 0;
+    ASSERT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 2,
+                               ivf_matches, &count), VP_OK);
+    EXPECT_EQ(count, 1);
+    EXPECT_STREQ(ivf_matches[0].speaker_id, "alice");
+
+    // Persisted quantizers are reused after re-init
+    vp_release();
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    ASSERT_EQ(vp_set_search_backend(VP_SEARCH_IVFPQ), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_identify_topk(audio.data(), static_cast<int>(audio.size()), 2,
+                               ivf_matches, &count), VP_OK);
+    EXPECT_EQ(count, 1);
+    EXPECT_STREQ(ivf_matches[0].speaker_id, "alice");
+}
+
 TEST_F(IntegrationTest, ConcurrentIdentify) {
     int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
     if (ret != VP_OK) {
@@ -172,6 +618,437 @@ TEST_F(IntegrationTest, ConcurrentIdentify) {
     std::cout << "All " << num_threads << " concurrent threads completed" << std::endl;
 }
 
+TEST_F(IntegrationTest, ConcurrentExtractionMatchesSerial) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    // Different audio per thread, so state leaking between concurrent
+    // calls (VAD hidden state, scratch buffers) would change the embeddings.
+    // Threads pair up on length, so the micro-batcher has batch-mates to
+    // group even at exact lengths.
+    const int num_threads = 8;
+    const int dim = vp_get_embedding_dim();
+    std::vector<std::vector<float>> audio(num_threads), serial(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+        audio[i].resize(48000 + 1600 * (i / 2));
+        for (size_t j = 0; j < audio[i].size(); ++j) {
+            audio[i][j] = 0.3f * std::sin(2.0f * 3.14159265f * (200.0f + 50.0f * i) * j / 16000.0f);
+        }
+    }
+
+    // Concurrent calls, plain and through the micro-batching scheduler, must
+    // reproduce the serial embeddings bit for bit: a batch only ever holds
+    // utterances of the same model length. With length buckets, utterances
+    // of different lengths share a batch too.
+    for (bool buckets : {false, true}) {
+        ASSERT_EQ(vp_set_length_buckets(nullptr, buckets ? VP_LENGTH_BUCKETS_DEFAULT : 0), VP_OK);
+        for (int i = 0; i < num_threads; ++i) {
+            serial[i].resize(dim);
+            ASSERT_EQ(vp_extract_embedding(audio[i].data(), static_cast<int>(audio[i].size()),
+                                           serial[i].data(), dim), VP_OK) << vp_get_last_error();
+        }
+        for (int batching : {1, num_threads}) {
+            ASSERT_EQ(vp_set_batching(batching, 2000), VP_OK);
+            std::vector<int> codes(num_threads, -1), mismatches(num_threads, 0);
+            std::vector<std::thread> threads;
+            for (int i = 0; i < num_threads; ++i) {
+                threads.emplace_back([&, i] {
+                    std::vector<float> emb(dim);
+                    for (int round = 0; round < 5; ++round) {
+                        codes[i] = vp_extract_embedding(audio[i].data(),
+                                                        static_cast<int>(audio[i].size()),
+                                                        emb.data(), dim);
+                        if (codes[i] != VP_OK) return;
+                        if (emb != serial[i]) ++mismatches[i];
+                    }
+                });
+            }
+            for (auto& t : threads) t.join();
+
+            for (int i = 0; i < num_threads; ++i) {
+                EXPECT_EQ(codes[i], VP_OK) << "batching " << batching;
+                EXPECT_EQ(mismatches[i], 0) << "thread " << i << ", batching " << batching
+                                            << ", buckets " << buckets;
+            }
+        }
+        ASSERT_EQ(vp_set_batching(1, 0), VP_OK);
+    }
+    ASSERT_EQ(vp_set_length_buckets(nullptr, 0), VP_OK);
+}
+
+TEST_F(IntegrationTest, ResultCacheServesRepeatedAudio) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    const int dim = vp_get_embedding_dim();
+    std::vector<float> audio(48000);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 240.0f * j / 16000.0f);
+    }
+    std::vector<float> first(dim), again(dim);
+
+    VpCacheStats stats;
+    ASSERT_EQ(vp_get_result_cache_stats(&stats), VP_OK);
+    EXPECT_EQ(stats.capacity, 0u);
+
+    ASSERT_EQ(vp_set_result_cache(8 << 20), VP_OK);
+    ASSERT_EQ(vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                   first.data(), dim), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                   again.data(), dim), VP_OK) << vp_get_last_error();
+    EXPECT_EQ(first, again);
+
+    ASSERT_EQ(vp_get_result_cache_stats(&stats), VP_OK);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.capacity, static_cast<uint64_t>(8 << 20));
+
+    // Different audio misses
+    audio[100] += 0.01f;
+    ASSERT_EQ(vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                   again.data(), dim), VP_OK);
+    ASSERT_EQ(vp_get_result_cache_stats(&stats), VP_OK);
+    EXPECT_EQ(stats.misses, 2u);
+
+    ASSERT_EQ(vp_set_result_cache(0), VP_OK);
+    ASSERT_EQ(vp_get_result_cache_stats(&stats), VP_OK);
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(vp_get_result_cache_stats(nullptr), VP_ERROR_INVALID_PARAM);
+}
+
+TEST_F(IntegrationTest, LongInputModeWindowsLongSpeechOnly) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    const int dim = vp_get_embedding_dim();
+    auto speech = [](size_t samples) {
+        std::vector<float> audio(samples);
+        for (size_t j = 0; j < audio.size(); ++j) {
+            const float t = static_cast<float>(j) / 16000.0f;
+            audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 220.0f * t) *
+                       (0.6f + 0.4f * std::sin(2.0f * 3.14159265f * 3.0f * t));
+        }
+        return audio;
+    };
+    auto embed = [&](const std::vector<float>& audio, std::vector<float>& emb) {
+        emb.resize(dim);
+        return vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                    emb.data(), dim);
+    };
+
+    const auto short_audio = speech(16000 * 5);
+    const auto long_audio = speech(16000 * 40);
+    std::vector<float> short_full, long_full, short_windowed, long_windowed;
+    ASSERT_EQ(embed(short_audio, short_full), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(embed(long_audio, long_full), VP_OK) << vp_get_last_error();
+
+    EXPECT_EQ(vp_set_long_input(3.0f, 3.0f), VP_ERROR_INVALID_PARAM);
+    ASSERT_EQ(vp_set_long_input(3.0f, 1.5f), VP_OK);
+    ASSERT_EQ(embed(short_audio, short_windowed), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(embed(long_audio, long_windowed), VP_OK) << vp_get_last_error();
+
+    // Below 4 windows nothing changes; above, the window average stays a
+    // unit vector close to the single-pass embedding of the same speaker
+    EXPECT_EQ(short_windowed, short_full);
+    float norm = 0.0f, cos = 0.0f;
+    for (int d = 0; d < dim; ++d) {
+        norm += long_windowed[d] * long_windowed[d];
+        cos += long_windowed[d] * long_full[d];
+    }
+    EXPECT_NEAR(norm, 1.0f, 1e-4f);
+    EXPECT_GT(cos, 0.8f);
+
+    ASSERT_EQ(vp_set_long_input(0.0f, 0.0f), VP_OK);
+    std::vector<float> again;
+    ASSERT_EQ(embed(long_audio, again), VP_OK);
+    for (int d = 0; d < dim; ++d) EXPECT_NEAR(again[d], long_full[d], 1e-5f);
+}
+
+TEST_F(IntegrationTest, StreamScoresDoNotDependOnChunking) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    std::vector<float> audio(16000 * 8);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        const float t = static_cast<float>(j) / 16000.0f;
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 180.0f * t) *
+                   (0.6f + 0.4f * std::sin(2.0f * 3.14159265f * 4.0f * t)) +
+                   0.1f * std::sin(2.0f * 3.14159265f * 540.0f * t);
+    }
+    ASSERT_EQ(vp_enroll("stream_spk", audio.data(), static_cast<int>(audio.size())), VP_OK)
+        << vp_get_last_error();
+
+    int a = 0, b = 0;
+    ASSERT_EQ(vp_stream_open(&a), VP_OK);
+    ASSERT_EQ(vp_stream_open(&b), VP_OK);
+    EXPECT_NE(a, b);
+
+    // Nothing pushed yet
+    float score = 0.0f;
+    EXPECT_EQ(vp_stream_score(a, "stream_spk", &score), VP_ERROR_AUDIO_TOO_SHORT);
+    EXPECT_EQ(vp_stream_score(a, "nobody", &score), VP_ERROR_SPEAKER_NOT_FOUND);
+
+    // Same audio, different chunk sizes; score as it arrives
+    const int total = static_cast<int>(audio.size());
+    for (int off = 0; off < total; off += 4000) {
+        ASSERT_EQ(vp_stream_push(a, audio.data() + off, std::min(4000, total - off)), VP_OK);
+        vp_stream_score(a, "stream_spk", &score);
+    }
+    for (int off = 0; off < total; off += 1237) {
+        ASSERT_EQ(vp_stream_push(b, audio.data() + off, std::min(1237, total - off)), VP_OK);
+    }
+
+    float score_a = 0.0f, score_b = 0.0f;
+    const int rc = vp_stream_score(a, "stream_spk", &score_a);
+    if (rc == VP_ERROR_AUDIO_TOO_SHORT) {
+        GTEST_SKIP() << "VAD found too little speech in the synthetic signal";
+    }
+    ASSERT_EQ(rc, VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_stream_score(b, "stream_spk", &score_b), VP_OK);
+    EXPECT_NEAR(score_a, score_b, 1e-5f);
+    EXPECT_GT(score_a, 0.5f);
+
+    // Enrolling from a stream updates the speaker like vp_enroll and
+    // consumes the speech, so it is not counted twice
+    EXPECT_EQ(vp_stream_enroll(b, "stream_spk2"), VP_OK);
+    EXPECT_EQ(vp_stream_score(a, "stream_spk2", &score), VP_OK);
+    EXPECT_EQ(vp_stream_enroll(b, "stream_spk2"), VP_ERROR_AUDIO_TOO_SHORT);
+    EXPECT_EQ(vp_stream_score(b, "stream_spk", &score), VP_ERROR_AUDIO_TOO_SHORT);
+    for (int off = 0; off < total; off += 4000) {
+        ASSERT_EQ(vp_stream_push(b, audio.data() + off, std::min(4000, total - off)), VP_OK);
+    }
+    ASSERT_EQ(vp_stream_score(b, "stream_spk", &score_b), VP_OK);
+    EXPECT_NEAR(score_a, score_b, 1e-5f);
+
+    EXPECT_EQ(vp_stream_close(a), VP_OK);
+    EXPECT_EQ(vp_stream_close(a), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_stream_push(a, audio.data(), 160), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_stream_close(b), VP_OK);
+}
+
+TEST_F(IntegrationTest, WarmupConfigAndStats) {
+    // Configurable before vp_init
+    const float bad[] = {0.0f};
+    EXPECT_EQ(vp_set_warmup(nullptr, 1), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_warmup(bad, 1), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_get_warmup_stats(nullptr), VP_ERROR_INVALID_PARAM);
+
+    // Off by default: init does no synthetic runs
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+    VpWarmupStats stats;
+    ASSERT_EQ(vp_get_warmup_stats(&stats), VP_OK);
+    EXPECT_EQ(stats.runs, 0);
+    vp_release();
+
+    const float lengths[] = {1.5f, 4.0f};
+    ASSERT_EQ(vp_set_warmup(lengths, 2), VP_OK);
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+
+    // VAD once plus the speaker model per length, each run cold then warm
+    ASSERT_EQ(vp_get_warmup_stats(&stats), VP_OK);
+    EXPECT_EQ(stats.runs, 2 * (1 + 2));
+    EXPECT_GT(stats.speaker_ms, 0.0f);
+    EXPECT_GT(stats.vad_ms, 0.0f);
+    EXPECT_GE(stats.total_ms, stats.speaker_ms + stats.vad_ms);
+    EXPECT_GT(stats.first_run_ms, 0.0f);
+    vp_release();
+
+    // Disabled: init does no synthetic runs
+    ASSERT_EQ(vp_set_warmup(nullptr, 0), VP_OK);
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    ASSERT_EQ(vp_get_warmup_stats(&stats), VP_OK);
+    EXPECT_EQ(stats.runs, 0);
+    EXPECT_EQ(stats.total_ms, 0.0f);
+}
+
+TEST_F(IntegrationTest, LengthBucketsKeepEmbeddingsClose) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    const float bad[] = {2.0f, 90.0f};
+    EXPECT_EQ(vp_set_length_buckets(nullptr, 2), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_length_buckets(bad, 2), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_length_buckets(bad, -2), VP_ERROR_INVALID_PARAM);
+
+    const int dim = vp_get_embedding_dim();
+    std::vector<float> audio(16000 * 7 + 1234);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        const float t = static_cast<float>(j) / 16000.0f;
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 200.0f * t) *
+                   (0.6f + 0.4f * std::sin(2.0f * 3.14159265f * 3.0f * t));
+    }
+    auto embed = [&](std::vector<float>& emb) {
+        emb.resize(dim);
+        return vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                    emb.data(), dim);
+    };
+
+    std::vector<float> exact, bucketed;
+    ASSERT_EQ(embed(exact), VP_OK) << vp_get_last_error();
+    ASSERT_EQ(vp_set_length_buckets(nullptr, VP_LENGTH_BUCKETS_DEFAULT), VP_OK);
+    ASSERT_EQ(embed(bucketed), VP_OK) << vp_get_last_error();
+
+    // Padded or cropped by at most one bucket step: still a unit vector of
+    // the same speaker
+    float norm = 0.0f, cos = 0.0f;
+    for (int d = 0; d < dim; ++d) {
+        norm += bucketed[d] * bucketed[d];
+        cos += bucketed[d] * exact[d];
+    }
+    EXPECT_NEAR(norm, 1.0f, 1e-4f);
+    EXPECT_GT(cos, 0.9f);
+
+    // Off again: exact lengths, exact results
+    ASSERT_EQ(vp_set_length_buckets(nullptr, 0), VP_OK);
+    std::vector<float> again;
+    ASSERT_EQ(embed(again), VP_OK);
+    for (int d = 0; d < dim; ++d) EXPECT_NEAR(again[d], exact[d], 1e-5f);
+}
+
+TEST_F(IntegrationTest, ReusedBindingsGiveRepeatableResults) {
+    int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
+    if (ret != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+
+    const int dim = vp_get_embedding_dim();
+    auto speech = [](size_t samples, float freq) {
+        std::vector<float> audio(samples);
+        for (size_t j = 0; j < audio.size(); ++j) {
+            const float t = static_cast<float>(j) / 16000.0f;
+            audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * freq * t) *
+                       (0.6f + 0.4f * std::sin(2.0f * 3.14159265f * 3.0f * t));
+        }
+        return audio;
+    };
+    auto embed = [&](const std::vector<float>& audio) {
+        std::vector<float> emb(dim);
+        EXPECT_EQ(vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                       emb.data(), dim), VP_OK) << vp_get_last_error();
+        return emb;
+    };
+
+    // Alternating lengths rebind the speaker model's input and output, and
+    // the VAD bindings carry state between runs: neither may leak into the
+    // next call
+    const auto a = speech(16000 * 3, 200.0f);
+    const auto b = speech(16000 * 5 + 777, 310.0f);
+    const auto first_a = embed(a);
+    const auto first_b = embed(b);
+    EXPECT_EQ(embed(a), first_a);
+    EXPECT_EQ(embed(b), first_b);
+    EXPECT_EQ(embed(a), first_a);
+}
+
+TEST_F(IntegrationTest, ThreadingConfigKeepsResults) {
+    // Configurable before vp_init
+    VpThreadingConfig bad = {2, 1, 1, "3;4"};
+    EXPECT_EQ(vp_set_threading(VP_MODEL_COUNT, nullptr), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_threading(VP_MODEL_SPEAKER, &bad), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_global_thread_pool(&bad), VP_ERROR_INVALID_PARAM);
+    bad = {-1, 1, 1, nullptr};
+    EXPECT_EQ(vp_set_threading(VP_MODEL_VAD, &bad), VP_ERROR_INVALID_PARAM);
+
+    std::vector<float> audio(16000 * 4);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        const float t = static_cast<float>(j) / 16000.0f;
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 210.0f * t) *
+                   (0.6f + 0.4f * std::sin(2.0f * 3.14159265f * 3.0f * t));
+    }
+    auto embed = [&](std::vector<float>& emb) {
+        emb.resize(vp_get_embedding_dim());
+        return vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                    emb.data(), static_cast<int>(emb.size()));
+    };
+
+    if (vp_init(model_dir_.c_str(), db_path_.c_str()) != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+    std::vector<float> base;
+    ASSERT_EQ(embed(base), VP_OK) << vp_get_last_error();
+    vp_release();
+
+    // Single-threaded, blocking sessions
+    const VpThreadingConfig single = {1, 1, 0, nullptr};
+    ASSERT_EQ(vp_set_threading(VP_MODEL_SPEAKER, &single), VP_OK);
+    ASSERT_EQ(vp_set_threading(VP_MODEL_VAD, &single), VP_OK);
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    std::vector<float> threaded;
+    ASSERT_EQ(embed(threaded), VP_OK) << vp_get_last_error();
+    for (size_t d = 0; d < base.size(); ++d) EXPECT_NEAR(threaded[d], base[d], 1e-5f);
+    vp_release();
+
+    // One global pool for every session
+    const VpThreadingConfig pool = {2, 1, 1, nullptr};
+    ASSERT_EQ(vp_set_global_thread_pool(&pool), VP_OK);
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    std::vector<float> pooled;
+    ASSERT_EQ(embed(pooled), VP_OK) << vp_get_last_error();
+    for (size_t d = 0; d < base.size(); ++d) EXPECT_NEAR(pooled[d], base[d], 1e-5f);
+    vp_release();
+
+    vp_set_global_thread_pool(nullptr);
+    vp_set_threading(VP_MODEL_SPEAKER, nullptr);
+    vp_set_threading(VP_MODEL_VAD, nullptr);
+}
+
+TEST_F(IntegrationTest, FbankEngineIsOptIn) {
+    // Configurable before vp_init
+    EXPECT_EQ(vp_set_fbank_engine(2), VP_ERROR_INVALID_PARAM);
+    EXPECT_EQ(vp_set_fbank_engine(-1), VP_ERROR_INVALID_PARAM);
+
+    std::vector<float> audio(16000 * 4);
+    for (size_t j = 0; j < audio.size(); ++j) {
+        audio[j] = 0.3f * std::sin(2.0f * 3.14159265f * 260.0f * j / 16000.0f);
+    }
+    auto embed = [&](std::vector<float>& emb) {
+        emb.resize(vp_get_embedding_dim());
+        return vp_extract_embedding(audio.data(), static_cast<int>(audio.size()),
+                                    emb.data(), static_cast<int>(emb.size()));
+    };
+
+    // The default is the kaldi front-end: selecting it explicitly changes nothing
+    if (vp_init(model_dir_.c_str(), db_path_.c_str()) != VP_OK) {
+        GTEST_SKIP() << "Models not available";
+    }
+    std::vector<float> base;
+    ASSERT_EQ(embed(base), VP_OK) << vp_get_last_error();
+    vp_release();
+
+    ASSERT_EQ(vp_set_fbank_engine(VP_FBANK_KALDI), VP_OK);
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    std::vector<float> kaldi;
+    ASSERT_EQ(embed(kaldi), VP_OK) << vp_get_last_error();
+    EXPECT_EQ(kaldi, base);
+    vp_release();
+
+    // The native engine agrees up to float rounding
+    ASSERT_EQ(vp_set_fbank_engine(VP_FBANK_NATIVE), VP_OK);
+    ASSERT_EQ(vp_init(model_dir_.c_str(), db_path_.c_str()), VP_OK);
+    std::vector<float> native;
+    ASSERT_EQ(embed(native), VP_OK) << vp_get_last_error();
+    float cos = 0.0f;
+    for (size_t d = 0; d < base.size(); ++d) cos += native[d] * base[d];
+    EXPECT_GT(cos, 0.999f);
+    vp_release();
+
+    vp_set_fbank_engine(VP_FBANK_KALDI);
+}
+
 TEST_F(IntegrationTest, InvalidAudioInput) {
     int ret = vp_init(model_dir_.c_str(), db_path_.c_str());
     if (ret != VP_OK) {
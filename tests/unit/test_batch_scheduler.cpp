@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "core/batch_scheduler.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+
+// Doubles every value; records how many inputs each call received, calls
+// whose inputs differ in their first value (the key in the tests below),
+// and the threads it ran on
+struct FakeModel {
+    std::atomic<int> calls{0};
+    std::atomic<int> largest{0};
+    std::atomic<int> mixed{0};
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+
+    BatchScheduler::RunBatch runner() {
+        return [this](const std::vector<const std::vector<float>*>& inputs,
+                      std::vector<std::vector<float>>& outputs,
+                      std::vector<std::string>& errors) {
+            ++calls;
+            int n = static_cast<int>(inputs.size());
+            if (n > largest.load()) largest = n;
+            for (int i = 1; i < n; ++i) {
+                if (!inputs[i]->empty() && !inputs[0]->empty() &&
+                    inputs[i]->front() != inputs[0]->front()) {
+                    ++mixed;
+                    break;
+                }
+            }
+            {
+                std::lock_guard lock(mutex);
+                threads.push_back(std::this_thread::get_id());
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            for (int i = 0; i < n; ++i) {
+                if (inputs[i]->empty()) {
+                    errors[i] = "empty input";
+                    continue;
+                }
+                for (float v : *inputs[i]) outputs[i].push_back(v * 2.0f);
+            }
+        };
+    }
+};
+
+} // namespace
+
+TEST(BatchSchedulerTest, LoneRequestIsNotDelayed) {
+    FakeModel model;
+    BatchScheduler scheduler(model.runner(), 16, 500000);   // 0.5 s window
+
+    std::vector<float> input = {1.0f, 2.0f};
+    std::vector<float> output;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    scheduler.begin();
+    ASSERT_TRUE(scheduler.submit(input, 0, true, output, error));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Nothing else was announced, so the window is not waited out
+    EXPECT_LT(elapsed, std::chrono::milliseconds(250));
+    EXPECT_EQ(output, (std::vector<float>{2.0f, 4.0f}));
+
+    // Per-item failures reach only their caller
+    std::vector<float> empty;
+    EXPECT_FALSE(scheduler.submit(empty, 0, false, output, error));
+    EXPECT_EQ(error, "empty input");
+}
+
+TEST(BatchSchedulerTest, ConcurrentRequestsShareBatches) {
+    FakeModel model;
+    const int max_batch = 8;
+    BatchScheduler scheduler(model.runner(), max_batch, 2000);
+
+    const int threads = 16, per_thread = 20;
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                std::vector<float> input = {static_cast<float>(t), static_cast<float>(i)};
+                std::vector<float> output;
+                std::string error;
+                scheduler.begin();
+                // Feature extraction: other callers' requests queue meanwhile
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+                if (!scheduler.submit(input, 0, true, output, error) ||
+                    output != std::vector<float>{2.0f * t, 2.0f * i}) {
+                    ++wrong;
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_LE(model.largest.load(), max_batch);
+    EXPECT_GT(model.largest.load(), 1);
+    EXPECT_LT(model.calls.load(), threads * per_thread);
+}
+
+TEST(BatchSchedulerTest, AbandonedRequestReleasesTheBatch) {
+    FakeModel model;
+    BatchScheduler scheduler(model.runner(), 16, 500000);
+
+    // A second caller announces itself but never submits; abandoning it lets
+    // the first caller's batch run before the window runs out
+    scheduler.begin();
+    std::thread late([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        scheduler.abandon();
+    });
+
+    std::vector<float> input = {3.0f}, output;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(scheduler.submit(input, 0, false, output, error));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+    late.join();
+}
+
+TEST(BatchSchedulerTest, LoneRequestRunsOnCallersThread) {
+    FakeModel model;
+    BatchScheduler scheduler(model.runner(), 16, 2000);
+
+    std::vector<float> input = {1.0f}, output;
+    std::string error;
+    scheduler.begin();
+    ASSERT_TRUE(scheduler.submit(input, 0, true, output, error));
+    ASSERT_EQ(model.threads.size(), 1u);
+    EXPECT_EQ(model.threads[0], std::this_thread::get_id());
+}
+
+TEST(BatchSchedulerTest, OnlyEqualKeysShareBatches) {
+    FakeModel model;
+    BatchScheduler scheduler(model.runner(), 8, 2000);
+
+    // Three keys across 12 threads; a request's first value is its key
+    const int threads = 12, per_thread = 20;
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const int key = t % 3;
+            for (int i = 0; i < per_thread; ++i) {
+                std::vector<float> input = {static_cast<float>(key), static_cast<float>(i)};
+                std::vector<float> output;
+                std::string error;
+                scheduler.begin();
+                // Feature extraction: other callers' requests queue meanwhile
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+                if (!scheduler.submit(input, key, true, output, error) ||
+                    output != std::vector<float>{2.0f * key, 2.0f * i}) {
+                    ++wrong;
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_EQ(model.mixed.load(), 0);
+    EXPECT_GT(model.largest.load(), 1);
+    EXPECT_LT(model.calls.load(), threads * per_thread);
+}
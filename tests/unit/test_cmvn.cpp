@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "core/cmvn.h"
+#include "core/fbank_extractor.h"
+#include "core/simd_dispatch.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+
+// Log-mel-like values: large per-bin offset, small spread
+std::vector<float> random_features(int frames, int bins, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 1.5f);
+    std::vector<float> x(static_cast<size_t>(frames) * bins);
+    for (int i = 0; i < frames; ++i) {
+        for (int j = 0; j < bins; ++j) {
+            x[static_cast<size_t>(i) * bins + j] = 12.0f - 0.1f * j + noise(rng);
+        }
+    }
+    return x;
+}
+
+// Two-pass CMVN in double over rows [begin, end), applied to row `target`
+void reference_row(const std::vector<float>& x, int bins, int begin, int end, int target,
+                   float* out) {
+    for (int j = 0; j < bins; ++j) {
+        double mean = 0.0, var = 0.0;
+        for (int i = begin; i < end; ++i) mean += x[static_cast<size_t>(i) * bins + j];
+        mean /= end - begin;
+        for (int i = begin; i < end; ++i) {
+            const double d = x[static_cast<size_t>(i) * bins + j] - mean;
+            var += d * d;
+        }
+        var /= end - begin;
+        out[j] = static_cast<float>((x[static_cast<size_t>(target) * bins + j] - mean) /
+                                    std::sqrt(var + 1e-10));
+    }
+}
+
+} // namespace
+
+TEST(CmvnTest, UtteranceMatchesTwoPassReference) {
+    for (int bins : {80, 83, 7}) {
+        const int frames = 301;
+        auto x = random_features(frames, bins, static_cast<unsigned>(bins));
+        auto got = x;
+        apply_utterance_cmvn(got.data(), frames, bins);
+
+        std::vector<float> expected(bins);
+        for (int i = 0; i < frames; ++i) {
+            reference_row(x, bins, 0, frames, i, expected.data());
+            for (int j = 0; j < bins; ++j) {
+                ASSERT_NEAR(got[static_cast<size_t>(i) * bins + j], expected[j], 1e-4f)
+                    << bins << " bins, frame " << i << ", bin " << j;
+            }
+        }
+    }
+}
+
+TEST(CmvnTest, KernelsAgreeAcrossLevels) {
+    // 80 = whole unrolled chunks on every level; 83 / 37 exercise the tails
+    for (int bins : {80, 83, 37}) {
+        SCOPED_TRACE(bins);
+        const int frames = 57;
+        auto x = random_features(frames, bins, 11);
+
+        set_simd_level(SimdLevel::SCALAR);
+        auto expected = x;
+        apply_utterance_cmvn(expected.data(), frames, bins);
+
+        for (int l = 1; l <= static_cast<int>(detect_simd_level()); ++l) {
+            const SimdLevel level = set_simd_level(static_cast<SimdLevel>(l));
+            SCOPED_TRACE(simd_level_name(level));
+            auto got = x;
+            apply_utterance_cmvn(got.data(), frames, bins);
+            for (size_t i = 0; i < got.size(); ++i) {
+                ASSERT_NEAR(got[i], expected[i], 1e-4f) << "index " << i;
+            }
+        }
+        set_simd_level(detect_simd_level());
+    }
+}
+
+TEST(CmvnTest, SlidingMatchesWindowedReference) {
+    const int bins = 80, frames = 700, window = 150;
+    auto x = random_features(frames, bins, 3);
+    auto got = x;
+    SlidingCmvn cmvn(bins, window);
+    cmvn.process(got.data(), frames);
+    EXPECT_EQ(cmvn.frames_in_window(), window);
+
+    // Frames before, at and well past several ring wraps
+    std::vector<float> expected(bins);
+    for (int i : {0, 1, 2, 149, 150, 151, 299, 300, 450, 699}) {
+        reference_row(x, bins, std::max(0, i - window + 1), i + 1, i, expected.data());
+        for (int j = 0; j < bins; ++j) {
+            // Frame 0 has zero variance: (x - mean) is 0 on both sides
+            ASSERT_NEAR(got[static_cast<size_t>(i) * bins + j], expected[j], 2e-3f)
+                << "frame " << i << ", bin " << j;
+        }
+    }
+}
+
+TEST(CmvnTest, SlidingIsIndependentOfChunking) {
+    const int bins = 80, frames = 500;
+    auto x = random_features(frames, bins, 9);
+
+    auto once = x;
+    SlidingCmvn a(bins, 120);
+    a.process(once.data(), frames);
+
+    auto chunked = x;
+    SlidingCmvn b(bins, 120);
+    int done = 0;
+    for (int chunk : {1, 7, 64, 3, 200}) {
+        b.process(chunked.data() + static_cast<size_t>(done) * bins, chunk);
+        done += chunk;
+    }
+    b.process(chunked.data() + static_cast<size_t>(done) * bins, frames - done);
+    EXPECT_EQ(once, chunked);
+
+    // reset() forgets the stream
+    auto again = x;
+    b.reset();
+    b.process(again.data(), frames);
+    EXPECT_EQ(once, again);
+}
+
+TEST(CmvnTest, ExtractorSlidingWindowCoversWholeUtterance) {
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    std::vector<float> audio(16000);
+    for (size_t i = 0; i < audio.size(); ++i) {
+        audio[i] = 0.3f * std::sin(0.17f * i) + noise(rng);
+    }
+
+    FbankExtractor fbank;
+    std::vector<float> utterance, sliding;
+    const int frames = fbank.extract(Span<const float>(audio), utterance);
+    fbank.set_cmvn_window(frames);
+    EXPECT_EQ(fbank.cmvn_window(), frames);
+    ASSERT_EQ(fbank.extract(Span<const float>(audio), sliding), frames);
+
+    // The last frame sees the whole utterance in its window
+    const size_t last = static_cast<size_t>(frames - 1) * fbank.num_bins();
+    for (int j = 0; j < fbank.num_bins(); ++j) {
+        EXPECT_NEAR(sliding[last + j], utterance[last + j], 1e-3f) << "bin " << j;
+    }
+}
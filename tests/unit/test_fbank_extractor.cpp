@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "core/fbank_extractor.h"
+#include "core/cmvn.h"
+#include "core/fbank_native.h"
+#include "core/simd_dispatch.h"
+#include "kaldi-native-fbank/csrc/online-feature.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+
+std::vector<float> tone(size_t samples, float freq) {
+    std::vector<float> audio(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        audio[i] = 0.3f * std::sin(2.0f * 3.14159265f * freq * i / 16000.0f)
+                 + 0.05f * std::sin(0.37f * i);
+    }
+    return audio;
+}
+
+// Speech-like: two partials plus broadband noise, so no mel bin is empty
+std::vector<float> noisy_tone(size_t samples, float freq, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    std::vector<float> audio(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        const float t = static_cast<float>(i) / 16000.0f;
+        audio[i] = 0.3f * std::sin(2.0f * 3.14159265f * freq * t)
+                 + 0.1f * std::sin(2.0f * 3.14159265f * 5.3f * freq * t) + noise(rng);
+    }
+    return audio;
+}
+
+// Features as computed by a fresh knf::OnlineFbank per call
+std::vector<float> reference_fbank(const std::vector<float>& audio) {
+    knf::FbankOptions opts;
+    opts.frame_opts.samp_freq = 16000.0f;
+    opts.frame_opts.dither = 0.0f;
+    opts.frame_opts.remove_dc_offset = true;
+    opts.frame_opts.window_type = "hamming";
+    opts.mel_opts.num_bins = 80;
+    opts.mel_opts.low_freq = 20.0f;
+    opts.mel_opts.high_freq = 0.0f;
+
+    knf::OnlineFbank fbank(opts);
+    fbank.AcceptWaveform(16000.0f, audio.data(), static_cast<int32_t>(audio.size()));
+    fbank.InputFinished();
+
+    std::vector<float> features(static_cast<size_t>(fbank.NumFramesReady()) * 80);
+    for (int i = 0; i < fbank.NumFramesReady(); ++i) {
+        std::memcpy(features.data() + static_cast<size_t>(i) * 80, fbank.GetFrame(i),
+                    80 * sizeof(float));
+    }
+    FbankExtractor::apply_cmvn(features.data(), fbank.NumFramesReady(), 80);
+    return features;
+}
+
+} // namespace
+
+TEST(FbankExtractorTest, KaldiEngineMatchesOnlineFbank) {
+    FbankExtractor fbank;
+    fbank.init(80, 16000, 25.0f, 10.0f, FbankEngine::KALDI);
+
+    for (size_t samples : {400u, 16000u, 16123u, 48000u}) {
+        auto audio = tone(samples, 440.0f);
+        auto expected = reference_fbank(audio);
+
+        std::vector<float> features;
+        int frames = fbank.extract(Span<const float>(audio), features);
+        EXPECT_EQ(frames, fbank.get_num_frames(static_cast<int>(samples)));
+        ASSERT_EQ(features.size(), expected.size()) << samples << " samples";
+        for (size_t i = 0; i < features.size(); ++i) {
+            ASSERT_NEAR(features[i], expected[i], 1e-4f) << "index " << i;
+        }
+    }
+}
+
+TEST(FbankExtractorTest, NativeEngineMatchesKaldi) {
+    FbankExtractor kaldi, native;
+    kaldi.init(80, 16000, 25.0f, 10.0f, FbankEngine::KALDI);
+    native.init(80, 16000, 25.0f, 10.0f, FbankEngine::NATIVE);
+    EXPECT_EQ(native.engine(), FbankEngine::NATIVE);
+
+    // Frame counts that are not multiples of any lane width
+    for (size_t samples : {400u, 1999u, 16000u, 48123u}) {
+        auto audio = noisy_tone(samples, 180.0f + samples % 97, static_cast<unsigned>(samples));
+        std::vector<float> expected, features;
+        ASSERT_EQ(native.extract(Span<const float>(audio), features),
+                  kaldi.extract(Span<const float>(audio), expected));
+        ASSERT_EQ(features.size(), expected.size());
+        float max_diff = 0.0f;
+        for (size_t i = 0; i < features.size(); ++i) {
+            max_diff = std::max(max_diff, std::fabs(features[i] - expected[i]));
+        }
+        // CMVN output is ~unit variance; differences are FFT / log rounding
+        EXPECT_LT(max_diff, 2e-3f) << samples << " samples";
+    }
+}
+
+TEST(FbankExtractorTest, NativeKernelsAgreeAcrossLevels) {
+    NativeFbank fbank{NativeFbank::Options()};
+    auto audio = noisy_tone(16000, 300.0f, 5);
+    const int frames = 1 + (16000 - 400) / 160;   // 98: partial last block on every level
+
+    set_simd_level(SimdLevel::SCALAR);
+    std::vector<float> expected(static_cast<size_t>(frames) * 80);
+    fbank.compute(audio.data(), frames, expected.data());
+
+    for (int l = 1; l <= static_cast<int>(detect_simd_level()); ++l) {
+        const SimdLevel level = set_simd_level(static_cast<SimdLevel>(l));
+        SCOPED_TRACE(simd_level_name(level));
+        std::vector<float> got(expected.size(), -1.0f);
+        fbank.compute(audio.data(), frames, got.data());
+        for (size_t i = 0; i < got.size(); ++i) {
+            ASSERT_NEAR(got[i], expected[i], 1e-3f) << "index " << i;
+        }
+    }
+    set_simd_level(detect_simd_level());
+}
+
+TEST(FbankExtractorTest, ShortInputYieldsNoFrames) {
+    FbankExtractor fbank;
+    auto audio = tone(399, 440.0f);
+    std::vector<float> features(10, 1.0f);
+    EXPECT_EQ(fbank.extract(Span<const float>(audio), features), 0);
+    EXPECT_TRUE(features.empty());
+}
+
+TEST(FbankExtractorTest, ConcurrentCallersAreIndependent) {
+    auto a = tone(32000, 300.0f);
+    auto b = tone(24000, 700.0f);
+
+    for (FbankEngine engine : {FbankEngine::KALDI, FbankEngine::NATIVE}) {
+        SCOPED_TRACE(engine == FbankEngine::KALDI ? "kaldi" : "native");
+        FbankExtractor fbank;
+        fbank.init(80, 16000, 25.0f, 10.0f, engine);
+        const auto expected_a = fbank.extract(a);
+        const auto expected_b = fbank.extract(b);
+
+        std::vector<std::thread> workers;
+        std::vector<int> mismatches(4, 0);
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&, t] {
+                std::vector<float> features;
+                for (int i = 0; i < 20; ++i) {
+                    const bool use_a = (i + t) % 2 == 0;
+                    fbank.extract(Span<const float>(use_a ? a : b), features);
+                    if (features != (use_a ? expected_a : expected_b)) ++mismatches[t];
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        for (int m : mismatches) EXPECT_EQ(m, 0);
+    }
+}
+
+TEST(FbankExtractorTest, IncrementalFramingMatchesOneShot) {
+    // Frames computed chunk by chunk, dropping consumed samples as a stream
+    // does, then sliding CMVN: same as one extract() over the whole input
+    auto audio = noisy_tone(48000, 210.0f, 7);
+    for (FbankEngine engine : {FbankEngine::KALDI, FbankEngine::NATIVE}) {
+        SCOPED_TRACE(engine == FbankEngine::KALDI ? "kaldi" : "native");
+        FbankExtractor fbank;
+        fbank.init(80, 16000, 25.0f, 10.0f, engine);
+        fbank.set_cmvn_window(300);
+        const auto expected = fbank.extract(audio);
+
+        SlidingCmvn cmvn(80, 300);
+        std::vector<float> pending, features;
+        const size_t chunks[] = {100, 399, 1, 2731, 160, 5000};
+        size_t offset = 0;
+        for (int i = 0; offset < audio.size(); ++i) {
+            const size_t n = std::min(chunks[i % 6], audio.size() - offset);
+            pending.insert(pending.end(), audio.begin() + offset, audio.begin() + offset + n);
+            offset += n;
+
+            const int count = fbank.get_num_frames(static_cast<int>(pending.size()));
+            if (count <= 0) continue;
+            const size_t old_size = features.size();
+            features.resize(old_size + static_cast<size_t>(count) * 80);
+            fbank.compute_frames(pending.data(), count, features.data() + old_size);
+            cmvn.process(features.data() + old_size, count);
+            pending.erase(pending.begin(),
+                          pending.begin() + static_cast<size_t>(count) * fbank.frame_shift_samples());
+        }
+
+        ASSERT_EQ(features.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_NEAR(features[i], expected[i], 1e-4f) << "index " << i;
+        }
+    }
+}
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "core/hnsw_index.h"
+#include "core/similarity.h"
+#include "test_vectors.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+
+std::vector<int> exact_top_k(const std::vector<std::vector<float>>& rows,
+                             const std::vector<float>& query, int k) {
+    std::vector<std::pair<float, int>> scored;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        scored.push_back({SimilarityCalculator::cosine_similarity(query, rows[i]), static_cast<int>(i)});
+    }
+    std::partial_sort(scored.begin(), scored.begin() + k, scored.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::vector<int> out;
+    for (int i = 0; i < k; ++i) out.push_back(scored[i].second);
+    return out;
+}
+
+} // namespace
+
+TEST(HnswIndexTest, FindsExactMatch) {
+    const int dim = 64;
+    std::mt19937 rng(1);
+    HnswIndex index;
+    index.reset(dim, 8, 64);
+    std::vector<std::vector<float>> rows;
+    for (int i = 0; i < 500; ++i) {
+        rows.push_back(random_unit_vector(dim, rng));
+        index.add("spk_" + std::to_string(i), rows.back().data(), 1);
+    }
+    EXPECT_EQ(index.size(), 500);
+
+    for (int i = 0; i < 500; i += 37) {
+        ScoredIndex hit;
+        ASSERT_EQ(index.search(rows[i].data(), 1, 32, &hit), 1);
+        EXPECT_EQ(index.id_at(hit.index), "spk_" + std::to_string(i));
+        EXPECT_NEAR(hit.score, 1.0f, 1e-5f);
+    }
+}
+
+TEST(HnswIndexTest, RemoveAndUpdateAreIncremental) {
+    const int dim = 32;
+    std::mt19937 rng(2);
+    HnswIndex index;
+    index.reset(dim, 8, 64);
+    std::vector<std::vector<float>> rows;
+    for (int i = 0; i < 200; ++i) {
+        rows.push_back(random_unit_vector(dim, rng));
+        index.add("spk_" + std::to_string(i), rows.back().data(), 1);
+    }
+
+    // Removed IDs are never returned, even for their own vector
+    ASSERT_TRUE(index.remove("spk_10"));
+    EXPECT_FALSE(index.remove("spk_10"));
+    EXPECT_EQ(index.find("spk_10"), -1);
+    std::vector<ScoredIndex> hits(5);
+    int n = index.search(rows[10].data(), 5, 32, hits.data());
+    for (int i = 0; i < n; ++i) EXPECT_NE(index.id_at(hits[i].index), "spk_10");
+
+    // Re-adding an ID replaces its vector
+    auto moved = random_unit_vector(dim, rng);
+    index.add("spk_20", moved.data(), 2);
+    EXPECT_EQ(index.size(), 199);
+    ScoredIndex hit;
+    ASSERT_EQ(index.search(moved.data(), 1, 32, &hit), 1);
+    EXPECT_EQ(index.id_at(hit.index), "spk_20");
+    EXPECT_EQ(index.enroll_count_at(hit.index), 2);
+
+    EXPECT_EQ(index.deleted_count(), 2);
+    index.compact();
+    EXPECT_EQ(index.deleted_count(), 0);
+    EXPECT_EQ(index.size(), 199);
+    ASSERT_EQ(index.search(moved.data(), 1, 32, &hit), 1);
+    EXPECT_EQ(index.id_at(hit.index), "spk_20");
+}
+
+TEST(HnswIndexTest, SaveLoadRoundTrip) {
+    const int dim = 48;
+    std::mt19937 rng(3);
+    HnswIndex index;
+    index.reset(dim, 8, 64);
+    std::vector<std::vector<float>> rows;
+    for (int i = 0; i < 300; ++i) {
+        rows.push_back(random_unit_vector(dim, rng));
+        index.add("spk_" + std::to_string(i), rows.back().data(), i % 3 + 1);
+    }
+    index.remove("spk_5");
+
+    const char* path = "test_hnsw_index.bin";
+    ASSERT_TRUE(index.save(path));
+
+    HnswIndex loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path);
+    EXPECT_EQ(loaded.size(), index.size());
+    EXPECT_EQ(loaded.dim(), dim);
+    EXPECT_EQ(loaded.find("spk_5"), -1);
+
+    for (int q = 0; q < 20; ++q) {
+        auto query = random_unit_vector(dim, rng);
+        std::vector<ScoredIndex> a(10), b(10);
+        int na = index.search(query.data(), 10, 64, a.data());
+        int nb = loaded.search(query.data(), 10, 64, b.data());
+        ASSERT_EQ(na, nb);
+        for (int i = 0; i < na; ++i) {
+            EXPECT_EQ(index.id_at(a[i].index), loaded.id_at(b[i].index));
+            EXPECT_FLOAT_EQ(a[i].score, b[i].score);
+        }
+    }
+
+    HnswIndex missing;
+    EXPECT_FALSE(missing.load("does_not_exist.hnsw"));
+}
+
+TEST(HnswIndexTest, LoadRejectsEntryBelowTopLevel) {
+    const int dim = 16;
+    std::mt19937 rng(6);
+    HnswIndex index;
+    index.reset(dim, 4, 32);
+    for (int i = 0; i < 200; ++i) {
+        auto v = random_unit_vector(dim, rng);
+        index.add("spk_" + std::to_string(i), v.data(), 1);
+    }
+    const char* path = "test_hnsw_corrupt.bin";
+    ASSERT_TRUE(index.save(path));
+
+    // Header: magic, version, dim, M, ef_construction, nodes, entry, max_level
+    std::FILE* f = std::fopen(path, "r+b");
+    ASSERT_NE(f, nullptr);
+    int32_t max_level = 0;
+    std::fseek(f, 28, SEEK_SET);
+    ASSERT_EQ(std::fread(&max_level, sizeof(max_level), 1, f), 1u);
+    ++max_level;   // every node's level stays valid, the entry no longer tops the graph
+    std::fseek(f, 28, SEEK_SET);
+    std::fwrite(&max_level, sizeof(max_level), 1, f);
+    std::fclose(f);
+
+    HnswIndex loaded;
+    EXPECT_FALSE(loaded.load(path));
+    EXPECT_EQ(loaded.size(), 0);
+    std::remove(path);
+}
+
+TEST(HnswIndexTest, CopyIsIndependent) {
+    const int dim = 32;
+    std::mt19937 rng(9);
+    HnswIndex index;
+    index.reset(dim, 8, 64);
+    for (int i = 0; i < 200; ++i) {
+        auto v = random_unit_vector(dim, rng);
+        index.add("spk_" + std::to_string(i), v.data(), 1);
+    }
+
+    HnswIndex copy(index);
+    auto query = random_unit_vector(dim, rng);
+    std::vector<ScoredIndex> a(5), b(5);
+    ASSERT_EQ(index.search(query.data(), 5, 64, a.data()), 5);
+    ASSERT_EQ(copy.search(query.data(), 5, 64, b.data()), 5);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(index.id_at(a[i].index), copy.id_at(b[i].index));
+        EXPECT_FLOAT_EQ(a[i].score, b[i].score);
+    }
+
+    // Same insert on both copies builds the same graph (the RNG is copied too)
+    auto v = random_unit_vector(dim, rng);
+    index.add("spk_new", v.data(), 1);
+    copy.add("spk_new", v.data(), 1);
+    copy.remove("spk_0");
+    EXPECT_GE(index.find("spk_0"), 0);
+    EXPECT_EQ(copy.find("spk_0"), -1);
+    ASSERT_EQ(index.search(v.data(), 1, 64, a.data()), 1);
+    ASSERT_EQ(copy.search(v.data(), 1, 64, b.data()), 1);
+    EXPECT_EQ(index.id_at(a[0].index), "spk_new");
+    EXPECT_EQ(copy.id_at(b[0].index), "spk_new");
+}
+
+TEST(HnswIndexTest, RecallOnClusteredData) {
+    const int dim = 192;
+    const int n = 10000;
+    const int k = 10;
+    const int queries = 100;
+    std::mt19937 rng(4);
+
+    auto rows = clustered_vectors(n, dim, 2500, rng);
+    HnswIndex index;
+    index.reset(dim, 16, 100);
+    for (int i = 0; i < n; ++i) index.add("spk_" + std::to_string(i), rows[i].data(), 1);
+
+    std::vector<std::vector<float>> query_set;
+    std::vector<std::vector<int>> truth;
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    for (int q = 0; q < queries; ++q) {
+        // Probes are noisy re-recordings of enrolled speakers
+        query_set.push_back(perturb(rows[pick(rng)], 0.05f, rng));
+        truth.push_back(exact_top_k(rows, query_set.back(), k));
+    }
+
+    // Fixed seeds and a deterministic graph: the recall is reproducible.
+    // Latency per ef_search is measured by search_benchmark.
+    auto recall = [&](int ef) {
+        int hits_found = 0;
+        std::vector<ScoredIndex> hits(k);
+        for (int q = 0; q < queries; ++q) {
+            int got = index.search(query_set[q].data(), k, ef, hits.data());
+            std::set<std::string> expected;
+            for (int idx : truth[q]) expected.insert("spk_" + std::to_string(idx));
+            for (int i = 0; i < got; ++i) hits_found += expected.count(index.id_at(hits[i].index));
+        }
+        return static_cast<double>(hits_found) / (queries * k);
+    };
+    const double recall_16 = recall(16);
+    const double recall_128 = recall(128);
+    EXPECT_GT(recall_128, 0.9);
+    EXPECT_GE(recall_128, recall_16);
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "core/ivfpq_index.h"
+#include "core/similarity.h"
+#include "manager/speaker_gallery.h"
+#include "test_vectors.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+
+// Gallery rows as the index owner keeps them: IDs and enroll counts only
+SpeakerGallery id_gallery(int n, int dim) {
+    SpeakerGallery g;
+    g.reset(dim, GalleryPrecision::NONE);
+    std::vector<float> zero(dim, 0.0f);
+    for (int i = 0; i < n; ++i) g.upsert("spk_" + std::to_string(i), zero.data(), i % 4 + 1);
+    return g;
+}
+
+IvfPqIndex::RowLabel labels(const SpeakerGallery& g) {
+    return [&g](int row, int& enroll_count) {
+        enroll_count = g.enroll_count_at(row);
+        return g.id_at(row);
+    };
+}
+
+} // namespace
+
+TEST(IvfPqIndexTest, RejectsIndivisibleCodeSize) {
+    std::mt19937 rng(1);
+    auto data = clustered_matrix(100, 10, 5, rng);
+    IvfPqIndex index;
+    EXPECT_FALSE(index.train(data.data(), 100, 10, 4, 3));
+    EXPECT_FALSE(index.trained());
+    EXPECT_FALSE(index.last_error().empty());
+}
+
+TEST(IvfPqIndexTest, RemoveMirrorsGallerySwapRemove) {
+    const int dim = 32;
+    const int n = 300;
+    std::mt19937 rng(2);
+    auto data = clustered_matrix(n, dim, 20, rng);
+    IvfPqIndex index;
+    ASSERT_TRUE(index.train(data.data(), n, dim, 8, 8));
+
+    SpeakerGallery g = id_gallery(n, dim);
+    for (int r = 0; r < n; ++r) index.add(r, &data[static_cast<size_t>(r) * dim]);
+    EXPECT_EQ(index.size(), n);
+    EXPECT_EQ(index.rows(), n);
+
+    // Remove every third speaker from both, as SpeakerManager does
+    for (int i = 0; i < n; i += 3) {
+        int r = g.find("spk_" + std::to_string(i));
+        ASSERT_GE(r, 0);
+        g.remove("spk_" + std::to_string(i));
+        index.remove(r);
+    }
+    EXPECT_EQ(index.size(), 200);
+    EXPECT_EQ(index.rows(), g.size());
+
+    // Re-adding a row replaces rather than duplicates
+    index.add(g.find("spk_1"), &data[1 * dim]);
+    EXPECT_EQ(index.size(), 200);
+
+    // Every remaining row still maps to its own vector when all lists are probed
+    std::vector<ScoredIndex> hits(index.size());
+    for (int i = 1; i < n; i += 3) {
+        int got = index.search(&data[static_cast<size_t>(i) * dim], 1, 8, hits.data());
+        ASSERT_EQ(got, 1);
+        EXPECT_EQ(g.id_at(hits[0].index), "spk_" + std::to_string(i)) << i;
+    }
+}
+
+TEST(IvfPqIndexTest, SaveLoadRoundTrip) {
+    const int dim = 48;
+    const int n = 500;
+    std::mt19937 rng(3);
+    auto data = clustered_matrix(n, dim, 25, rng);
+    IvfPqIndex index;
+    ASSERT_TRUE(index.train(data.data(), n, dim, 16, 8));
+    SpeakerGallery g = id_gallery(n, dim);
+    for (int r = 0; r < n; ++r) index.add(r, &data[static_cast<size_t>(r) * dim]);
+
+    const char* path = "test_ivfpq_index.bin";
+    ASSERT_TRUE(index.save(path, labels(g)));
+
+    // Rows are mapped back through the IDs; an unknown speaker and one
+    // whose enroll count changed are dropped
+    IvfPqIndex loaded;
+    ASSERT_TRUE(loaded.load(path, [&](std::string_view id, int enroll_count) {
+        int r = g.find(std::string(id));
+        if (id == "spk_7" || (id == "spk_8" && enroll_count == g.enroll_count_at(r))) return -1;
+        return r;
+    }));
+    std::remove(path);
+
+    EXPECT_EQ(loaded.size(), n - 2);
+    EXPECT_EQ(loaded.nlist(), 16);
+    EXPECT_EQ(loaded.code_bytes(), 8);
+    EXPECT_FALSE(loaded.has(7));
+    EXPECT_FALSE(loaded.has(8));
+    EXPECT_TRUE(loaded.has(9));
+
+    loaded.add(7, &data[7 * dim]);
+    loaded.add(8, &data[8 * dim]);
+    auto query = random_unit_vector(dim, rng);
+    std::vector<ScoredIndex> a(10), b(10);
+    int na = index.search(query.data(), 10, 4, a.data());
+    int nb = loaded.search(query.data(), 10, 4, b.data());
+    ASSERT_EQ(na, nb);
+    for (int i = 0; i < na; ++i) {
+        EXPECT_EQ(a[i].index, b[i].index);
+        EXPECT_FLOAT_EQ(a[i].score, b[i].score);
+    }
+}
+
+TEST(IvfPqIndexTest, ShortlistRecallAndMemory) {
+    const int dim = 192;
+    const int n = 20000;
+    const int n_train = 4000;
+    const int code_bytes = 16;
+    const int shortlist = 32;
+    std::mt19937 rng(4);
+
+    auto data = clustered_matrix(n, dim, 5000, rng);
+    IvfPqIndex index;
+    ASSERT_TRUE(index.train(data.data(), n_train, dim, 64, code_bytes));
+    const size_t quantizers = index.memory_bytes();
+    SpeakerGallery g = id_gallery(n, dim);
+    for (int r = 0; r < n; ++r) index.add(r, &data[static_cast<size_t>(r) * dim]);
+
+    // Per speaker the index holds its code and three row slots (list
+    // entry, row -> list, row -> position), within vector growth slack.
+    // The ID is held once, by the gallery.
+    const double per_row = static_cast<double>(index.memory_bytes() - quantizers) / n;
+    EXPECT_LT(per_row, 2.0 * (code_bytes + 3 * sizeof(int)));
+    EXPECT_LT(per_row, static_cast<double>(g.memory_bytes()) / n);
+
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    const int queries = 100;
+    int found = 0;
+    std::vector<ScoredIndex> hits(shortlist);
+    std::mt19937 qrng(5);
+    for (int q = 0; q < queries; ++q) {
+        int target = pick(qrng);
+        auto query = perturb(std::vector<float>(data.begin() + static_cast<size_t>(target) * dim,
+                                                data.begin() + static_cast<size_t>(target + 1) * dim),
+                             0.05f, qrng);
+
+        // Exact nearest neighbour
+        int best = 0;
+        float best_score = -2.0f;
+        for (int i = 0; i < n; ++i) {
+            float s = SimilarityCalculator::dot(query.data(), &data[static_cast<size_t>(i) * dim], dim);
+            if (s > best_score) { best_score = s; best = i; }
+        }
+
+        // Exact re-ranking of the shortlist recovers the true neighbour
+        // whenever it made the shortlist
+        int got = index.search(query.data(), shortlist, 16, hits.data());
+        for (int j = 0; j < got; ++j) {
+            if (hits[j].index == best) { ++found; break; }
+        }
+    }
+
+    EXPECT_GT(static_cast<double>(found) / queries, 0.9);
+}
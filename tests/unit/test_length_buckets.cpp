@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "core/length_buckets.h"
+#include <vector>
+
+using namespace vp;
+
+TEST(LengthBucketsTest, NormalizesBucketList) {
+    LengthBuckets buckets({400, 0, 200, 300, 200, -5});
+    EXPECT_EQ(buckets.frames(), (std::vector<int>{200, 300, 400}));
+    EXPECT_FALSE(buckets.empty());
+    EXPECT_TRUE(LengthBuckets({0}).empty());
+}
+
+TEST(LengthBucketsTest, PadsUpAndCropsDown) {
+    LengthBuckets buckets({200, 300, 400});
+
+    EXPECT_EQ(buckets.pad_to(150), 200);
+    EXPECT_EQ(buckets.pad_to(200), 200);
+    EXPECT_EQ(buckets.pad_to(201), 300);
+    EXPECT_EQ(buckets.pad_to(400), 400);
+    EXPECT_EQ(buckets.pad_to(401), 500);    // past the largest: whole seconds
+    EXPECT_EQ(buckets.pad_to(1234), 1300);
+
+    EXPECT_EQ(buckets.crop_to(150), 200);   // below the smallest: padded up
+    EXPECT_EQ(buckets.crop_to(299), 200);
+    EXPECT_EQ(buckets.crop_to(300), 300);
+    EXPECT_EQ(buckets.crop_to(450), 400);
+    EXPECT_EQ(buckets.crop_to(1234), 1200);
+}
+
+TEST(LengthBucketsTest, DefaultsAreGeometric) {
+    const LengthBuckets buckets = LengthBuckets::defaults();
+    const std::vector<int>& frames = buckets.frames();
+    ASSERT_GE(frames.size(), 2u);
+    EXPECT_EQ(frames.front(), 150);
+    EXPECT_EQ(frames.back(), 3000);
+    EXPECT_LE(frames.size(), 32u);
+    for (size_t i = 1; i < frames.size(); ++i) {
+        EXPECT_GT(frames[i], frames[i - 1]);
+        EXPECT_LE(frames[i], frames[i - 1] * 1.125f + 1e-3f) << "bucket " << i;
+    }
+
+    // Audio of seconds()[i] frames to exactly bucket i (25 ms / 10 ms)
+    const std::vector<float> seconds = buckets.seconds();
+    ASSERT_EQ(seconds.size(), frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const int samples = static_cast<int>(seconds[i] * 16000.0f + 0.5f);
+        EXPECT_EQ(1 + (samples - 400) / 160, frames[i]);
+    }
+}
+
+TEST(LengthBucketsTest, FitFramesCropsOrPads) {
+    // 3 frames x 2 bins
+    const std::vector<float> src = {1, 2, 3, 4, 5, 6};
+
+    std::vector<float> out(4, -1.0f);
+    fit_frames(src.data(), 3, 2, 2, false, out.data());
+    EXPECT_EQ(out, (std::vector<float>{1, 2, 3, 4}));
+
+    out.assign(10, -1.0f);
+    fit_frames(src.data(), 3, 2, 5, false, out.data());
+    EXPECT_EQ(out, (std::vector<float>{1, 2, 3, 4, 5, 6, 1, 2, 3, 4}));
+
+    out.assign(10, -1.0f);
+    fit_frames(src.data(), 3, 2, 5, true, out.data());
+    EXPECT_EQ(out, (std::vector<float>{1, 2, 3, 4, 5, 6, 0, 0, 0, 0}));
+}
+
+TEST(LengthBucketsTest, MixedLengthsShareModelCalls) {
+    // 12 utterances of 2.0 .. 4.2 s, every length different, in no order
+    std::vector<int> frames;
+    for (int i = 0; i < 12; ++i) frames.push_back(200 + ((i * 7) % 12) * 20);
+    std::vector<int> order(frames.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+
+    auto check = [&](const std::vector<BatchGroup>& groups, const std::vector<int>& targets,
+                     const std::vector<int>& sorted, bool padded) {
+        int covered = 0;
+        for (const BatchGroup& g : groups) {
+            EXPECT_EQ(g.begin, covered);
+            EXPECT_LE(g.count, 16);
+            const int shortest = targets[sorted[g.begin]];
+            for (int b = 0; b < g.count; ++b) {
+                const int t = targets[sorted[g.begin + b]];
+                EXPECT_LE(t, g.target);
+                if (padded) {
+                    EXPECT_LE(g.target, shortest * 1.5f);
+                } else {
+                    EXPECT_EQ(t, g.target);
+                }
+            }
+            covered += g.count;
+        }
+        EXPECT_EQ(covered, static_cast<int>(frames.size()));
+    };
+
+    // Exact lengths, no mask: nothing may be padded, one call each
+    std::vector<int> sorted = order;
+    auto groups = plan_batches(frames, sorted, 16, false, 0.5f);
+    EXPECT_EQ(groups.size(), frames.size());
+    check(groups, frames, sorted, false);
+
+    // Masked model: zero-padded up to 1.5x the shortest of a group
+    sorted = order;
+    groups = plan_batches(frames, sorted, 16, true, 0.5f);
+    EXPECT_LT(groups.size(), frames.size());
+    EXPECT_EQ(groups.size(), 2u);
+    check(groups, frames, sorted, true);
+
+    // Unmasked model with buckets: cropped to a few bucket lengths
+    LengthBuckets buckets = LengthBuckets::defaults();
+    std::vector<int> cropped(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) cropped[i] = buckets.crop_to(frames[i]);
+    sorted = order;
+    groups = plan_batches(cropped, sorted, 16, false, 0.5f);
+    EXPECT_LT(groups.size(), frames.size());
+    check(groups, cropped, sorted, false);
+
+    // max_batch caps a group
+    sorted = order;
+    groups = plan_batches(frames, sorted, 4, true, 0.5f);
+    EXPECT_EQ(groups.size(), 3u);
+    check(groups, frames, sorted, true);
+}
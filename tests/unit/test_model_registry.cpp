@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include "core/model_registry.h"
+#include "core/onnx_model.h"
+#include <filesystem>
+
+using namespace vp;
+
+namespace {
+const char* VAD_MODEL = "models/silero_vad.onnx";
+} // namespace
+
+TEST(ModelRegistryTest, SharesOneSessionPerPathAndOptions) {
+    if (!std::filesystem::exists(VAD_MODEL)) GTEST_SKIP() << "Models not available";
+    const size_t before = loaded_model_count();
+    {
+        auto a = acquire_model(VAD_MODEL, ort_env(), ModelKind::VAD);
+        ASSERT_NE(a, nullptr) << OnnxModel::last_error();
+        auto b = acquire_model("models/../models/silero_vad.onnx", ort_env(), ModelKind::VAD);
+        EXPECT_EQ(a, b);
+        EXPECT_EQ(loaded_model_count(), before + 1);
+
+        // Different session options are a different session
+        ThreadingConfig single = default_threading(ModelKind::ANALYZER);
+        single.intra_op_threads = 1;
+        set_threading(ModelKind::ANALYZER, single);
+        auto c = acquire_model(VAD_MODEL, ort_env(), ModelKind::ANALYZER);
+        set_threading(ModelKind::ANALYZER, default_threading(ModelKind::ANALYZER));
+        ASSERT_NE(c, nullptr) << OnnxModel::last_error();
+        EXPECT_NE(a, c);
+        EXPECT_EQ(loaded_model_count(), before + 2);
+    }
+    // Unloaded with the last holder
+    EXPECT_EQ(loaded_model_count(), before);
+}
+
+TEST(ModelRegistryTest, MissingFileIsNotRegistered) {
+    const size_t before = loaded_model_count();
+    EXPECT_EQ(acquire_model("models/does_not_exist.onnx", ort_env(), ModelKind::VAD), nullptr);
+    EXPECT_FALSE(OnnxModel::last_error().empty());
+    EXPECT_EQ(loaded_model_count(), before);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "utils/object_pool.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace vp;
+
+TEST(ObjectPoolTest, ReusesReleasedObjects) {
+    ObjectPool<std::vector<float>> pool;
+    const std::vector<float>* first = nullptr;
+    {
+        auto lease = pool.acquire();
+        lease->assign(1000, 1.0f);
+        first = &*lease;
+    }
+    EXPECT_EQ(pool.idle_count(), 1u);
+
+    // The same object comes back with its capacity (and contents) intact
+    auto again = pool.acquire();
+    EXPECT_EQ(&*again, first);
+    EXPECT_GE(again->capacity(), 1000u);
+    EXPECT_EQ(pool.idle_count(), 0u);
+
+    // A concurrent lease gets a different object
+    auto other = pool.acquire();
+    EXPECT_NE(&*other, first);
+}
+
+TEST(ObjectPoolTest, RecycleHookTrimsReturnedObjects) {
+    // Drop buffers past a cap on return, keep smaller ones
+    ObjectPool<std::vector<float>> pool(
+        [] { return std::make_unique<std::vector<float>>(); },
+        [](std::vector<float>& v) {
+            if (v.capacity() > 1000) std::vector<float>().swap(v);
+        });
+    {
+        auto lease = pool.acquire();
+        lease->assign(500, 1.0f);
+    }
+    EXPECT_GE(pool.acquire()->capacity(), 500u);
+    {
+        auto lease = pool.acquire();
+        lease->assign(100000, 1.0f);
+    }
+    EXPECT_EQ(pool.idle_count(), 1u);
+    EXPECT_EQ(pool.acquire()->capacity(), 0u);
+}
+
+TEST(ObjectPoolTest, ConcurrentLeasesAreExclusive) {
+    ObjectPool<std::vector<int>> pool;
+    std::atomic<int> shared{0};
+    const int threads = 8;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                auto lease = pool.acquire();
+                lease->assign(16, t);
+                std::this_thread::yield();
+                for (int v : *lease) {
+                    if (v != t) ++shared;
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    EXPECT_EQ(shared.load(), 0);
+    // Never more objects than concurrent leases
+    EXPECT_GE(pool.idle_count(), 1u);
+    EXPECT_LE(pool.idle_count(), static_cast<size_t>(threads));
+}
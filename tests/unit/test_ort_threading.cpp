@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "core/ort_threading.h"
+
+using namespace vp;
+
+namespace {
+ThreadingConfig config(int intra, const char* affinity) {
+    ThreadingConfig c;
+    c.intra_op_threads = intra;
+    c.inter_op_threads = 1;
+    c.affinity = affinity;
+    return c;
+}
+} // namespace
+
+TEST(OrtThreadingTest, DefaultsMatchBuiltInThreadCounts) {
+    EXPECT_EQ(default_threading(ModelKind::SPEAKER).intra_op_threads, 2);
+    EXPECT_EQ(default_threading(ModelKind::ANALYZER).intra_op_threads, 2);
+    EXPECT_EQ(default_threading(ModelKind::VAD).intra_op_threads, 1);
+    EXPECT_EQ(default_threading(ModelKind::VAD).inter_op_threads, 1);
+    EXPECT_TRUE(default_threading(ModelKind::SPEAKER).spin);
+    EXPECT_TRUE(validate_threading(default_threading(ModelKind::SPEAKER)).empty());
+}
+
+TEST(OrtThreadingTest, AcceptsOneAffinityGroupPerExtraThread) {
+    EXPECT_TRUE(validate_threading(config(0, "")).empty());
+    EXPECT_TRUE(validate_threading(config(2, "3")).empty());
+    EXPECT_TRUE(validate_threading(config(4, "2;3;4")).empty());
+    EXPECT_TRUE(validate_threading(config(3, "1,2;3-4")).empty());
+}
+
+TEST(OrtThreadingTest, RejectsBadCountsAndAffinities) {
+    EXPECT_FALSE(validate_threading(config(-1, "")).empty());
+    ThreadingConfig inter = config(2, "");
+    inter.inter_op_threads = -2;
+    EXPECT_FALSE(validate_threading(inter).empty());
+
+    EXPECT_FALSE(validate_threading(config(0, "1")).empty());        // no explicit count
+    EXPECT_FALSE(validate_threading(config(1, "1")).empty());        // no extra thread
+    EXPECT_FALSE(validate_threading(config(3, "2")).empty());        // one group short
+    EXPECT_FALSE(validate_threading(config(2, "2;3")).empty());      // one group too many
+    EXPECT_FALSE(validate_threading(config(3, "2;;3")).empty());
+    EXPECT_FALSE(validate_threading(config(2, "0")).empty());        // cores are 1-based
+    EXPECT_FALSE(validate_threading(config(2, "4-2")).empty());
+    EXPECT_FALSE(validate_threading(config(2, "a")).empty());
+    EXPECT_FALSE(validate_threading(config(2, "2;")).empty());
+}
+
+TEST(OrtThreadingTest, SettingsArePerModelKind) {
+    ThreadingConfig vad = config(2, "5");
+    vad.spin = false;
+    set_threading(ModelKind::VAD, vad);
+    EXPECT_EQ(threading(ModelKind::VAD), vad);
+    EXPECT_EQ(threading(ModelKind::SPEAKER), default_threading(ModelKind::SPEAKER));
+
+    set_threading(ModelKind::VAD, default_threading(ModelKind::VAD));
+    EXPECT_EQ(threading(ModelKind::VAD), default_threading(ModelKind::VAD));
+}
+
+TEST(OrtThreadingTest, SessionKeyFollowsSettings) {
+    const std::string base = session_key(ModelKind::SPEAKER);
+    EXPECT_EQ(session_key(ModelKind::ANALYZER), base);   // same defaults
+
+    ThreadingConfig blocking = default_threading(ModelKind::SPEAKER);
+    blocking.spin = false;
+    set_threading(ModelKind::SPEAKER, blocking);
+    EXPECT_NE(session_key(ModelKind::SPEAKER), base);
+    EXPECT_EQ(session_key(ModelKind::ANALYZER), base);
+
+    set_threading(ModelKind::SPEAKER, default_threading(ModelKind::SPEAKER));
+    EXPECT_EQ(session_key(ModelKind::SPEAKER), base);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "core/result_cache.h"
+#include "utils/hash.h"
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+
+std::vector<float> pcm(size_t samples, float seed) {
+    std::vector<float> audio(samples);
+    for (size_t i = 0; i < samples; ++i) audio[i] = seed + 0.001f * static_cast<float>(i);
+    return audio;
+}
+
+} // namespace
+
+TEST(ResultCacheTest, Xxhash64MatchesReferenceVectors) {
+    EXPECT_EQ(xxhash64("", 0), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(xxhash64("abc", 3), 0x44BC2CF5AD770999ULL);
+    const std::string text = "Nobody inspects the spammish repetition";   // > 32 bytes
+    EXPECT_EQ(xxhash64(text.data(), text.size()), 0xFBCEA83C8A378BF1ULL);
+    EXPECT_NE(xxhash64("abc", 3, 1), xxhash64("abc", 3));
+}
+
+TEST(ResultCacheTest, KeysFollowContentAndContext) {
+    auto a = pcm(16000, 0.1f);
+    auto b = a;
+    EXPECT_EQ(ResultCache::make_key(a, 7), ResultCache::make_key(b, 7));
+
+    b[12345] += 1e-6f;
+    EXPECT_FALSE(ResultCache::make_key(a, 7) == ResultCache::make_key(b, 7));
+    EXPECT_FALSE(ResultCache::make_key(a, 7) == ResultCache::make_key(a, 8));
+    EXPECT_FALSE(ResultCache::make_key(a, 7) ==
+                 ResultCache::make_key(Span<const float>(a).subspan(0, 8000), 7));
+}
+
+TEST(ResultCacheTest, StoresEmbeddingsAndAnalysisResults) {
+    ResultCache cache(1 << 20);
+    auto audio = pcm(8000, 0.2f);
+    const ResultKey emb_key = ResultCache::make_key(audio, 1);
+    const ResultKey ana_key = ResultCache::make_key(audio, 2);
+
+    std::vector<float> embedding;
+    EXPECT_FALSE(cache.get_embedding(emb_key, embedding));
+    const std::vector<float> stored = {0.6f, 0.8f, 0.0f};
+    cache.put_embedding(emb_key, stored);
+    EXPECT_TRUE(cache.get_embedding(emb_key, embedding));
+    EXPECT_EQ(embedding, stored);
+
+    VpAnalysisResult result;
+    std::memset(&result, 0, sizeof(result));
+    EXPECT_FALSE(cache.get_analysis(ana_key, &result));
+    result.features_computed = VP_FEATURE_GENDER;
+    result.gender.gender = VP_GENDER_MALE;
+    std::strcpy(result.language.language, "zh");
+    cache.put_analysis(ana_key, result);
+
+    VpAnalysisResult got;
+    std::memset(&got, 0xff, sizeof(got));
+    ASSERT_TRUE(cache.get_analysis(ana_key, &got));
+    EXPECT_EQ(std::memcmp(&got, &result, sizeof(result)), 0);
+
+    const ResultCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_GT(stats.bytes, sizeof(VpAnalysisResult) + 3 * sizeof(float));
+    EXPECT_EQ(stats.capacity, static_cast<size_t>(1 << 20));
+
+    // An embedding entry is never returned as an analysis result
+    EXPECT_FALSE(cache.get_analysis(emb_key, &got));
+}
+
+TEST(ResultCacheTest, EvictsLeastRecentlyUsedUnderMemoryCap) {
+    // Probe the per-entry footprint, then size the cache for three entries
+    const std::vector<float> embedding(192, 0.5f);
+    size_t entry_bytes;
+    {
+        ResultCache probe(1 << 20);
+        probe.put_embedding(ResultCache::make_key(pcm(100, 0.0f), 0), embedding);
+        entry_bytes = probe.stats().bytes;
+    }
+    ResultCache cache(3 * entry_bytes);
+
+    std::vector<ResultKey> keys;
+    for (int i = 0; i < 4; ++i) keys.push_back(ResultCache::make_key(pcm(100, i), 0));
+    std::vector<float> out;
+    cache.put_embedding(keys[0], embedding);
+    cache.put_embedding(keys[1], embedding);
+    cache.put_embedding(keys[2], embedding);
+    EXPECT_TRUE(cache.get_embedding(keys[0], out));    // 1 is now the oldest
+    cache.put_embedding(keys[3], embedding);
+
+    EXPECT_FALSE(cache.get_embedding(keys[1], out));
+    EXPECT_TRUE(cache.get_embedding(keys[0], out));
+    EXPECT_TRUE(cache.get_embedding(keys[2], out));
+    EXPECT_TRUE(cache.get_embedding(keys[3], out));
+    EXPECT_EQ(cache.stats().evictions, 1u);
+    EXPECT_LE(cache.stats().bytes, 3 * entry_bytes);
+
+    // Re-putting a key replaces its value without growing the cache
+    cache.put_embedding(keys[3], embedding);
+    EXPECT_EQ(cache.stats().entries, 3u);
+
+    cache.set_capacity(entry_bytes);
+    EXPECT_EQ(cache.stats().entries, 1u);
+    EXPECT_TRUE(cache.get_embedding(keys[3], out));    // most recent survives
+
+    // A value larger than the whole cache is not stored
+    cache.put_embedding(keys[1], std::vector<float>(4096, 1.0f));
+    EXPECT_FALSE(cache.get_embedding(keys[1], out));
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().entries, 0u);
+    EXPECT_EQ(cache.stats().bytes, 0u);
+}
+
+TEST(ResultCacheTest, ConcurrentCallersSeeConsistentValues) {
+    ResultCache cache(64 * 1024);   // small enough to evict constantly
+    std::vector<std::vector<float>> audio;
+    for (int i = 0; i < 32; ++i) audio.push_back(pcm(1000, static_cast<float>(i)));
+
+    std::vector<int> wrong(4, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<float> out;
+            for (int round = 0; round < 2000; ++round) {
+                const int i = (round * 7 + t) % 32;
+                const ResultKey key = ResultCache::make_key(audio[i], 0);
+                if (cache.get_embedding(key, out)) {
+                    if (out.size() != 192 || out[0] != static_cast<float>(i)) ++wrong[t];
+                } else {
+                    cache.put_embedding(key, std::vector<float>(192, static_cast<float>(i)));
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    for (int w : wrong) EXPECT_EQ(w, 0);
+
+    const ResultCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 4u * 2000u);
+    EXPECT_LE(stats.bytes, stats.capacity);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "core/simd_dispatch.h"
+#include "core/similarity.h"
+#include "core/quantized_search.h"
+#include <cmath>
+#include <vector>
+#include <random>
+
+using namespace vp;
+
+namespace {
+
+class SimdDispatchTest : public ::testing::Test {
+protected:
+    void TearDown() override { set_simd_level(detect_simd_level()); }
+
+    // Kernel tables for every level this host can run, lowest first
+    static std::vector<const SimdKernels*> available_kernels() {
+        std::vector<const SimdKernels*> out;
+        for (int l = 0; l <= static_cast<int>(detect_simd_level()); ++l) {
+            set_simd_level(static_cast<SimdLevel>(l));
+            const SimdKernels* k = &simd_kernels();
+            if (out.empty() || out.back() != k) out.push_back(k);
+        }
+        set_simd_level(detect_simd_level());
+        return out;
+    }
+
+    static std::vector<float> random_vector(std::mt19937& rng, size_t n) {
+        std::normal_distribution<float> dist(0.0f, 1.0f);
+        std::vector<float> v(n);
+        for (auto& x : v) x = dist(rng);
+        return v;
+    }
+};
+
+} // namespace
+
+TEST_F(SimdDispatchTest, SelectsSupportedLevel) {
+    const SimdLevel best = detect_simd_level();
+    EXPECT_EQ(simd_kernels().level, best);
+    EXPECT_EQ(set_simd_level(SimdLevel::SCALAR), SimdLevel::SCALAR);
+    EXPECT_EQ(simd_kernels().level, SimdLevel::SCALAR);
+    // Requests above what the CPU supports are clamped
+    EXPECT_EQ(set_simd_level(SimdLevel::AVX512), best);
+    EXPECT_STREQ(simd_level_name(SimdLevel::AVX2), "avx2");
+}
+
+TEST_F(SimdDispatchTest, FloatKernelsMatchScalar) {
+    const SimdKernels& ref = *simd_kernels_scalar();
+    std::mt19937 rng(7);
+
+    for (const SimdKernels* k : available_kernels()) {
+        SCOPED_TRACE(simd_level_name(k->level));
+        for (int dim : {1, 7, 37, 192, 256}) {
+            const int stride = dim + 3;
+            auto q = random_vector(rng, dim);
+            auto rows = random_vector(rng, static_cast<size_t>(4) * stride);
+
+            EXPECT_NEAR(k->dot(q.data(), rows.data(), dim),
+                        ref.dot(q.data(), rows.data(), dim), 1e-3f);
+
+            float got[4], want[4];
+            k->dot4(q.data(), rows.data(), dim, stride, got);
+            ref.dot4(q.data(), rows.data(), dim, stride, want);
+            for (int j = 0; j < 4; ++j) EXPECT_NEAR(got[j], want[j], 1e-3f);
+
+            auto a = q, b = q;
+            k->l2_normalize(a.data(), dim);
+            ref.l2_normalize(b.data(), dim);
+            for (int i = 0; i < dim; ++i) EXPECT_NEAR(a[i], b[i], 1e-5f);
+        }
+
+        // One register tile against directly computed dot products
+        const int dim = 40;
+        auto queries = random_vector(rng, static_cast<size_t>(k->gemm_mr) * dim);
+        auto panel = random_vector(rng, static_cast<size_t>(dim) * SIMD_GEMM_NR);
+        const float* qp[SIMD_GEMM_MAX_MR];
+        for (int j = 0; j < k->gemm_mr; ++j) qp[j] = queries.data() + j * dim;
+        std::vector<float> c(static_cast<size_t>(k->gemm_mr) * SIMD_GEMM_NR);
+        k->gemm_tile(qp, panel.data(), dim, c.data());
+        for (int j = 0; j < k->gemm_mr; ++j) {
+            for (int t = 0; t < SIMD_GEMM_NR; ++t) {
+                float want = 0.0f;
+                for (int i = 0; i < dim; ++i) want += qp[j][i] * panel[i * SIMD_GEMM_NR + t];
+                EXPECT_NEAR(c[j * SIMD_GEMM_NR + t], want, 1e-3f);
+            }
+        }
+    }
+}
+
+TEST_F(SimdDispatchTest, SearchResultsAgreeAcrossLevels) {
+    const int dim = 192, rows = 1003, k = 10, stride = 256, nq = 9;
+    std::mt19937 rng(11);
+    auto matrix = random_vector(rng, static_cast<size_t>(rows) * dim);
+    auto queries = random_vector(rng, static_cast<size_t>(nq) * dim);
+    for (int r = 0; r < rows; ++r) SimilarityCalculator::l2_normalize(&matrix[r * dim], dim);
+    for (int q = 0; q < nq; ++q) SimilarityCalculator::l2_normalize(&queries[q * dim], dim);
+
+    std::vector<int8_t> codes(static_cast<size_t>(rows) * stride);
+    std::vector<float> scales(rows);
+    std::vector<int32_t> sums(rows);
+    for (int r = 0; r < rows; ++r) {
+        scales[r] = quantize_int8(&matrix[r * dim], dim, stride, &codes[r * stride], &sums[r]);
+    }
+    Int8MatrixView view;
+    view.codes = codes.data();
+    view.scales = scales.data();
+    view.sums = sums.data();
+    view.rows = rows;
+    view.stride = stride;
+    std::vector<int8_t> qcodes(stride);
+    float qscale = quantize_int8(queries.data(), dim, stride, qcodes.data(), nullptr);
+
+    std::vector<ScoredIndex> ref_topk(k), ref_int8(k), ref_batch(static_cast<size_t>(nq) * k);
+    std::vector<int> ref_counts(nq);
+    set_simd_level(SimdLevel::SCALAR);
+    SimilarityCalculator::find_top_k(queries.data(), matrix.data(), rows, dim, dim, k, ref_topk.data());
+    int8_find_top_k(qcodes.data(), qscale, view, k, ref_int8.data());
+    SimilarityCalculator::find_top_k_batch(queries.data(), nq, dim, matrix.data(), rows, dim, dim,
+                                           k, ref_batch.data(), ref_counts.data());
+
+    for (const SimdKernels* kern : available_kernels()) {
+        SCOPED_TRACE(simd_level_name(kern->level));
+        set_simd_level(kern->level);
+
+        std::vector<ScoredIndex> topk(k), int8(k), batch(static_cast<size_t>(nq) * k);
+        std::vector<int> counts(nq);
+        ASSERT_EQ(SimilarityCalculator::find_top_k(queries.data(), matrix.data(), rows, dim, dim,
+                                                   k, topk.data()), k);
+        ASSERT_EQ(int8_find_top_k(qcodes.data(), qscale, view, k, int8.data()), k);
+        SimilarityCalculator::find_top_k_batch(queries.data(), nq, dim, matrix.data(), rows, dim, dim,
+                                               k, batch.data(), counts.data());
+        for (int i = 0; i < k; ++i) {
+            EXPECT_EQ(topk[i].index, ref_topk[i].index);
+            EXPECT_NEAR(topk[i].score, ref_topk[i].score, 1e-5f);
+            // Integer dot products are exact on every level
+            EXPECT_EQ(int8[i].index, ref_int8[i].index);
+            EXPECT_FLOAT_EQ(int8[i].score, ref_int8[i].score);
+        }
+        for (int q = 0; q < nq; ++q) {
+            ASSERT_EQ(counts[q], ref_counts[q]);
+            for (int i = 0; i < k; ++i) {
+                EXPECT_EQ(batch[q * k + i].index, ref_batch[q * k + i].index);
+                EXPECT_NEAR(batch[q * k + i].score, ref_batch[q * k + i].score, 1e-5f);
+            }
+        }
+    }
+}
@@ -3,6 +3,8 @@
 #include <cmath>
 #include <vector>
 #include <chrono>
+#include <algorithm>
+#include <random>
 
 using namespace vp;
 
@@ -71,6 +73,130 @@ TEST(SimilarityTest, FindBestMatchEmpty) {
     EXPECT_EQ(result.index, -1);
 }
 
+TEST(SimilarityTest, TopKMatchesFullSort) {
+    const int dim = 16;
+    const int rows = 103;
+    std::vector<float> matrix(rows * dim);
+    for (int r = 0; r < rows; ++r)
+        for (int i = 0; i < dim; ++i)
+            matrix[r * dim + i] = std::sin(0.37f * r + 1.3f * i);
+    std::vector<float> query(dim);
+    for (int i = 0; i < dim; ++i) query[i] = std::cos(0.5f * i);
+
+    std::vector<std::pair<float, int>> all;
+    for (int r = 0; r < rows; ++r)
+        all.push_back({SimilarityCalculator::cosine_similarity(query.data(), &matrix[r * dim], dim), r});
+    std::sort(all.begin(), all.end(), [](auto& a, auto& b) { return a.first > b.first; });
+
+    ScoredIndex top[5];
+    int n = SimilarityCalculator::find_top_k(query.data(), matrix.data(), rows, dim, dim, 5, top);
+    ASSERT_EQ(n, 5);
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ(top[i].index, all[i].second);
+        EXPECT_FLOAT_EQ(top[i].score, all[i].first);
+    }
+
+    // Top-1 agrees with the best-match kernel
+    auto best = SimilarityCalculator::find_best_match(query.data(), matrix.data(), rows, dim, dim);
+    EXPECT_EQ(best.index, top[0].index);
+}
+
+TEST(SimilarityTest, TopKLargerThanRows) {
+    std::vector<float> matrix = {1.0f, 0.0f, 0.0f, 1.0f};
+    std::vector<float> query = {0.0f, 1.0f};
+    ScoredIndex top[4];
+    int n = SimilarityCalculator::find_top_k(query.data(), matrix.data(), 2, 2, 2, 4, top);
+    ASSERT_EQ(n, 2);
+    EXPECT_EQ(top[0].index, 1);
+    EXPECT_EQ(top[1].index, 0);
+}
+
+TEST(SimilarityTest, TopKBatchMatchesSingleQuery) {
+    // Query count not a multiple of the register tile, rows spanning several
+    // blocks with a ragged tail, padded stride
+    const int dim = 20;
+    const int stride = 24;
+    const int rows = 601;
+    const int queries = 67;
+    const int k = 7;
+    auto normalize = [](float* v, int n) {
+        float norm = 0.0f;
+        for (int i = 0; i < n; ++i) norm += v[i] * v[i];
+        norm = std::sqrt(norm);
+        for (int i = 0; i < n; ++i) v[i] /= norm;
+    };
+    std::vector<float> matrix(static_cast<size_t>(rows) * stride, 0.0f);
+    for (int r = 0; r < rows; ++r) {
+        for (int i = 0; i < dim; ++i) matrix[r * stride + i] = std::sin(0.37f * r + 1.3f * i + 0.01f * r * i);
+        normalize(&matrix[r * stride], dim);
+    }
+    std::vector<float> q(static_cast<size_t>(queries) * dim);
+    for (int j = 0; j < queries; ++j) {
+        for (int i = 0; i < dim; ++i) q[j * dim + i] = std::cos(0.11f * j * i + 0.5f * i);
+        normalize(&q[j * dim], dim);
+    }
+
+    std::vector<ScoredIndex> batch(static_cast<size_t>(queries) * k);
+    std::vector<int> counts(queries);
+    SimilarityCalculator::find_top_k_batch(q.data(), queries, dim, matrix.data(), rows, dim, stride,
+                                           k, batch.data(), counts.data());
+
+    ScoredIndex single[k];
+    for (int j = 0; j < queries; ++j) {
+        int n = SimilarityCalculator::find_top_k(&q[j * dim], matrix.data(), rows, dim, stride, k, single);
+        ASSERT_EQ(counts[j], n);
+        for (int i = 0; i < n; ++i) {
+            EXPECT_EQ(batch[j * k + i].index, single[i].index) << "query " << j;
+            EXPECT_NEAR(batch[j * k + i].score, single[i].score, 1e-5f);
+        }
+    }
+
+    // Empty gallery writes zero counts
+    SimilarityCalculator::find_top_k_batch(q.data(), queries, dim, matrix.data(), 0, dim, stride,
+                                           k, batch.data(), counts.data());
+    EXPECT_EQ(counts[0], 0);
+    EXPECT_EQ(counts[queries - 1], 0);
+}
+
+TEST(SimilarityTest, TopKBatchMatchesSeparateScansAtScale) {
+    // Gallery-sized input spanning many row blocks; the speed comparison
+    // is in search_benchmark
+    const int dim = 192;
+    const int rows = 50000;
+    const int queries = 128;
+    const int k = 5;
+    std::mt19937 rng(7);
+    std::normal_distribution<float> dist(0.0f, 1.0f / std::sqrt(static_cast<float>(dim)));
+    std::vector<float> matrix(static_cast<size_t>(rows) * dim);
+    for (auto& x : matrix) x = dist(rng);
+    std::vector<float> q(static_cast<size_t>(queries) * dim);
+    for (auto& x : q) x = dist(rng);
+
+    std::vector<ScoredIndex> batch(static_cast<size_t>(queries) * k);
+    std::vector<int> counts(queries);
+    SimilarityCalculator::find_top_k_batch(q.data(), queries, dim, matrix.data(), rows, dim, dim,
+                                           k, batch.data(), counts.data());
+
+    // One extra result tells whether the K-th place is a near-tie
+    ScoredIndex single[k + 1];
+    for (int j = 0; j < queries; ++j) {
+        int n = SimilarityCalculator::find_top_k(&q[static_cast<size_t>(j) * dim], matrix.data(),
+                                                 rows, dim, dim, k + 1, single);
+        ASSERT_EQ(n, k + 1);
+        ASSERT_EQ(counts[j], k);
+        for (int i = 0; i < k; ++i) {
+            const ScoredIndex& b = batch[static_cast<size_t>(j) * k + i];
+            EXPECT_NEAR(b.score, single[i].score, 1e-5f);
+            // Ranks may only swap between scores equal up to summation order
+            bool tied = (i > 0 && single[i - 1].score - single[i].score < 1e-5f) ||
+                        single[i].score - single[i + 1].score < 1e-5f;
+            if (!tied) {
+                EXPECT_EQ(b.index, single[i].index) << "query " << j << " rank " << i;
+            }
+        }
+    }
+}
+
 TEST(SimilarityTest, Performance1000Vectors192Dim) {
     const int dim = 192;
     const int num_vectors = 1000;
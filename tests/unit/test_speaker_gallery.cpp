@@ -0,0 +1,393 @@
+#include <gtest/gtest.h>
+#include "manager/speaker_gallery.h"
+#include "core/similarity.h"
+#include "core/quantized_search.h"
+#include "test_vectors.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+using namespace vp;
+
+TEST(SpeakerGalleryTest, RowsAreCacheLineAligned) {
+    SpeakerGallery g;
+    g.reset(192);
+    std::mt19937 rng(1);
+    for (int i = 0; i < 10; ++i) {
+        auto v = random_unit_vector(192, rng);
+        g.upsert("spk_" + std::to_string(i), v.data(), 1);
+    }
+    EXPECT_EQ(g.stride() % 16, 0);
+    for (int r = 0; r < g.size(); ++r) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(g.row(r)) % SpeakerGallery::ALIGNMENT, 0u);
+    }
+}
+
+TEST(SpeakerGalleryTest, StrideIsPaddedWithZeros) {
+    SpeakerGallery g;
+    g.reset(5);
+    std::vector<float> v = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    int r = g.upsert("a", v.data(), 1);
+    ASSERT_EQ(g.stride(), 16);
+    for (int i = 5; i < g.stride(); ++i) EXPECT_FLOAT_EQ(g.row(r)[i], 0.0f);
+}
+
+TEST(SpeakerGalleryTest, UpsertOverwritesInPlace) {
+    SpeakerGallery g;
+    g.reset(4);
+    std::vector<float> a = {1.0f, 0.0f, 0.0f, 0.0f};
+    std::vector<float> b = {0.0f, 1.0f, 0.0f, 0.0f};
+    int r1 = g.upsert("spk", a.data(), 1);
+    int r2 = g.upsert("spk", b.data(), 2);
+    EXPECT_EQ(r1, r2);
+    EXPECT_EQ(g.size(), 1);
+    EXPECT_EQ(g.enroll_count_at(r2), 2);
+    EXPECT_FLOAT_EQ(g.row(r2)[1], 1.0f);
+}
+
+TEST(SpeakerGalleryTest, SwapRemoveKeepsIndexConsistent) {
+    SpeakerGallery g;
+    g.reset(4);
+    for (int i = 0; i < 4; ++i) {
+        std::vector<float> v(4, 0.0f);
+        v[i] = 1.0f;
+        g.upsert("spk_" + std::to_string(i), v.data(), i + 1);
+    }
+
+    ASSERT_TRUE(g.remove("spk_1"));
+    EXPECT_FALSE(g.remove("spk_1"));
+    EXPECT_EQ(g.size(), 3);
+    EXPECT_EQ(g.find("spk_1"), -1);
+
+    // The last row was moved into the freed slot
+    int r = g.find("spk_3");
+    ASSERT_EQ(r, 1);
+    EXPECT_EQ(g.id_at(r), "spk_3");
+    EXPECT_EQ(g.enroll_count_at(r), 4);
+    EXPECT_FLOAT_EQ(g.row(r)[3], 1.0f);
+
+    for (int i : {0, 2, 3}) {
+        std::string id = "spk_" + std::to_string(i);
+        ASSERT_GE(g.find(id), 0);
+        EXPECT_EQ(g.id_at(g.find(id)), id);
+    }
+}
+
+TEST(SpeakerGalleryTest, BestMatchAgreesWithBruteForce) {
+    const int dim = 192;
+    std::mt19937 rng(7);
+    SpeakerGallery g;
+    g.reset(dim);
+    std::vector<std::vector<float>> rows;
+    for (int i = 0; i < 1003; ++i) {   // not a multiple of the 4-row block
+        rows.push_back(random_unit_vector(dim, rng));
+        g.upsert("spk_" + std::to_string(i), rows.back().data(), 1);
+    }
+
+    for (int q = 0; q < 20; ++q) {
+        auto query = random_unit_vector(dim, rng);
+        int expected = -1;
+        float expected_score = -2.0f;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            float s = SimilarityCalculator::cosine_similarity(query, rows[i]);
+            if (s > expected_score) { expected_score = s; expected = static_cast<int>(i); }
+        }
+
+        float score = 0.0f;
+        int r = g.best_match(query.data(), score);
+        ASSERT_GE(r, 0);
+        EXPECT_EQ(g.id_at(r), "spk_" + std::to_string(expected));
+        EXPECT_NEAR(score, expected_score, 1e-5f);
+    }
+}
+
+TEST(SpeakerGalleryTest, TopKBatchAgreesWithTopK) {
+    const int dim = 192;
+    std::mt19937 rng(12);
+    SpeakerGallery g;
+    g.reset(dim);
+    for (int i = 0; i < 300; ++i) {
+        auto v = random_unit_vector(dim, rng);
+        g.upsert("spk_" + std::to_string(i), v.data(), 1);
+    }
+
+    const int queries = 9;
+    const int k = 3;
+    std::vector<float> q;
+    for (int j = 0; j < queries; ++j) {
+        auto v = random_unit_vector(dim, rng);
+        q.insert(q.end(), v.begin(), v.end());
+    }
+    std::vector<ScoredIndex> batch(queries * k);
+    std::vector<int> counts(queries);
+    g.top_k_batch(q.data(), queries, k, batch.data(), counts.data());
+
+    for (int j = 0; j < queries; ++j) {
+        ScoredIndex single[k];
+        ASSERT_EQ(counts[j], g.top_k(&q[j * dim], k, single));
+        for (int i = 0; i < k; ++i) {
+            EXPECT_EQ(batch[j * k + i].index, single[i].index);
+            EXPECT_NEAR(batch[j * k + i].score, single[i].score, 1e-5f);
+        }
+    }
+}
+
+TEST(SpeakerGalleryTest, EmptyGalleryHasNoMatch) {
+    SpeakerGallery g;
+    g.reset(192);
+    std::vector<float> q(192, 0.0f);
+    float score = 0.0f;
+    EXPECT_EQ(g.best_match(q.data(), score), -1);
+}
+
+TEST(SpeakerGalleryTest, NonePrecisionKeepsBookkeepingOnly) {
+    std::mt19937 rng(11);
+    SpeakerGallery g;
+    g.reset(64, GalleryPrecision::NONE);
+    for (int i = 0; i < 10; ++i) {
+        auto v = random_unit_vector(64, rng);
+        g.upsert("spk_" + std::to_string(i), v.data(), i + 1);
+    }
+    EXPECT_EQ(g.size(), 10);
+    ASSERT_TRUE(g.remove("spk_3"));
+    EXPECT_EQ(g.find("spk_3"), -1);
+    int r = g.find("spk_9");
+    ASSERT_GE(r, 0);
+    EXPECT_EQ(g.enroll_count_at(r), 10);
+
+    auto q = random_unit_vector(64, rng);
+    ScoredIndex hit;
+    EXPECT_EQ(g.top_k(q.data(), 1, &hit), 0);
+}
+
+TEST(SpeakerGalleryTest, CopiesAreDeepAndIndependent) {
+    std::mt19937 rng(13);
+    for (auto precision : {GalleryPrecision::FLOAT32, GalleryPrecision::INT8}) {
+        SpeakerGallery g;
+        g.reset(96, precision);
+        for (int i = 0; i < 70; ++i) {
+            auto v = random_unit_vector(96, rng);
+            g.upsert("spk_" + std::to_string(i), v.data(), i % 4 + 1);
+        }
+
+        SpeakerGallery copy(g);
+        ASSERT_EQ(copy.size(), g.size());
+        EXPECT_EQ(copy.precision(), precision);
+        auto q = random_unit_vector(96, rng);
+        ScoredIndex a[5], b[5];
+        ASSERT_EQ(g.top_k(q.data(), 5, a), 5);
+        ASSERT_EQ(copy.top_k(q.data(), 5, b), 5);
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_EQ(g.id_at(a[i].index), copy.id_at(b[i].index));
+            EXPECT_FLOAT_EQ(a[i].score, b[i].score);
+        }
+
+        // Writes to one copy do not show through the other
+        copy.remove("spk_0");
+        auto v = random_unit_vector(96, rng);
+        copy.upsert("spk_new", v.data(), 1);
+        EXPECT_GE(g.find("spk_0"), 0);
+        EXPECT_EQ(g.find("spk_new"), -1);
+
+        SpeakerGallery moved(std::move(copy));
+        EXPECT_EQ(moved.size(), 70);
+        EXPECT_GE(moved.find("spk_new"), 0);
+        EXPECT_EQ(copy.size(), 0);
+        g = moved;
+        EXPECT_EQ(g.find("spk_0"), -1);
+        EXPECT_EQ(g.top_k(v.data(), 1, a), 1);
+        EXPECT_EQ(g.id_at(a[0].index), "spk_new");
+    }
+}
+
+TEST(SpeakerGalleryTest, SnapshotMapsWithoutLoading) {
+    const int dim = 80;
+    const char* path = "test_gallery.snapshot";
+    std::mt19937 rng(17);
+    SpeakerGallery g;
+    g.reset(dim);
+    for (int i = 0; i < 150; ++i) {
+        auto v = random_unit_vector(dim, rng);
+        g.upsert("spk_" + std::to_string(i * 7 % 150), v.data(), i % 5 + 1);
+    }
+    ASSERT_TRUE(g.save_snapshot(path, 42));
+
+    SpeakerGallery stale;
+    EXPECT_FALSE(stale.map_snapshot(path, dim, 41));
+    EXPECT_FALSE(stale.map_snapshot(path, dim + 1, 42));
+    EXPECT_FALSE(stale.map_snapshot("does_not_exist.snapshot", dim, 42));
+
+    SpeakerGallery mapped;
+    ASSERT_TRUE(mapped.map_snapshot(path, dim, 42));
+    EXPECT_TRUE(mapped.is_mapped());
+    ASSERT_EQ(mapped.size(), g.size());
+    for (int r = 0; r < g.size(); ++r) {
+        std::string id(g.id_at(r));
+        int m = mapped.find(id);
+        ASSERT_GE(m, 0);
+        EXPECT_EQ(mapped.id_at(m), id);
+        EXPECT_EQ(mapped.enroll_count_at(m), g.enroll_count_at(r));
+        EXPECT_EQ(std::memcmp(mapped.row(m), g.row(r), dim * sizeof(float)), 0);
+    }
+    EXPECT_EQ(mapped.find("spk_missing"), -1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mapped.row(0)) % SpeakerGallery::ALIGNMENT, 0u);
+
+    auto q = random_unit_vector(dim, rng);
+    ScoredIndex a[5], b[5];
+    ASSERT_EQ(g.top_k(q.data(), 5, a), 5);
+    ASSERT_EQ(mapped.top_k(q.data(), 5, b), 5);
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(g.id_at(a[i].index), mapped.id_at(b[i].index));
+
+    // Copies share the mapping; a write detaches only the written copy
+    SpeakerGallery copy(mapped);
+    EXPECT_TRUE(copy.is_mapped());
+    auto v = random_unit_vector(dim, rng);
+    copy.upsert("spk_new", v.data(), 1);
+    ASSERT_TRUE(copy.remove("spk_3"));
+    EXPECT_FALSE(copy.is_mapped());
+    EXPECT_EQ(copy.size(), 150);
+    EXPECT_TRUE(mapped.is_mapped());
+    EXPECT_EQ(mapped.find("spk_new"), -1);
+    EXPECT_GE(mapped.find("spk_3"), 0);
+    int r = copy.find("spk_7");
+    ASSERT_GE(r, 0);
+    EXPECT_EQ(std::memcmp(copy.row(r), g.row(g.find("spk_7")), dim * sizeof(float)), 0);
+
+    // The mapping outlives a replacement of the file
+    ASSERT_TRUE(copy.save_snapshot(path, 43));
+    EXPECT_EQ(mapped.find("spk_new"), -1);
+    EXPECT_EQ(mapped.top_k(q.data(), 5, b), 5);
+    ASSERT_TRUE(stale.map_snapshot(path, dim, 43));
+    EXPECT_GE(stale.find("spk_new"), 0);
+    stale.reset(dim);
+    mapped.reset(dim);
+    std::remove(path);
+}
+
+TEST(SpeakerGalleryTest, QuantizeInt8RoundTrip) {
+    std::mt19937 rng(11);
+    auto v = random_unit_vector(192, rng);
+    std::vector<int8_t> codes(256, 99);
+    int32_t sum = 0;
+    float scale = quantize_int8(v.data(), 192, 256, codes.data(), &sum);
+
+    ASSERT_GT(scale, 0.0f);
+    int32_t expected_sum = 0;
+    for (int i = 0; i < 192; ++i) {
+        EXPECT_NEAR(scale * codes[i], v[i], scale * 0.5f + 1e-7f);
+        expected_sum += codes[i];
+    }
+    for (int i = 192; i < 256; ++i) EXPECT_EQ(codes[i], 0);
+    EXPECT_EQ(sum, expected_sum);
+}
+
+TEST(SpeakerGalleryTest, Int8TopKMatchesIntegerBruteForce) {
+    const int dim = 192;
+    std::mt19937 rng(5);
+    SpeakerGallery g;
+    g.reset(dim, GalleryPrecision::INT8);
+    std::vector<std::vector<int8_t>> codes;
+    std::vector<float> scales;
+    for (int i = 0; i < 1003; ++i) {
+        auto v = random_unit_vector(dim, rng);
+        g.upsert("spk_" + std::to_string(i), v.data(), 1);
+        codes.emplace_back(256);
+        scales.push_back(quantize_int8(v.data(), dim, 256, codes.back().data(), nullptr));
+    }
+    EXPECT_FALSE(g.has_float_rows());
+
+    auto query = random_unit_vector(dim, rng);
+    std::vector<int8_t> qc(256);
+    float qs = quantize_int8(query.data(), dim, 256, qc.data(), nullptr);
+
+    std::vector<float> expected;
+    for (size_t i = 0; i < codes.size(); ++i) {
+        expected.push_back(qs * scales[i] * dot_int8(qc.data(), codes[i].data(), 256));
+    }
+    std::sort(expected.begin(), expected.end(), std::greater<float>());
+
+    std::vector<ScoredIndex> top(10);
+    ASSERT_EQ(g.top_k(query.data(), 10, top.data()), 10);
+    for (int i = 0; i < 10; ++i) EXPECT_FLOAT_EQ(top[i].score, expected[i]);
+}
+
+TEST(SpeakerGalleryTest, Int8ScoresTrackFloatScores) {
+    const int dim = 192;
+    std::mt19937 rng(13);
+    SpeakerGallery exact, quant;
+    exact.reset(dim);
+    quant.reset(dim, GalleryPrecision::INT8);
+    for (int i = 0; i < 2000; ++i) {
+        auto v = random_unit_vector(dim, rng);
+        exact.upsert("spk_" + std::to_string(i), v.data(), 1);
+        quant.upsert("spk_" + std::to_string(i), v.data(), 1);
+    }
+    ASSERT_TRUE(quant.remove("spk_7"));
+    ASSERT_TRUE(exact.remove("spk_7"));
+
+    float max_err = 0.0f;
+    std::vector<ScoredIndex> approx(16);
+    for (int q = 0; q < 50; ++q) {
+        auto query = random_unit_vector(dim, rng);
+        int n = quant.top_k(query.data(), 16, approx.data());
+        for (int i = 0; i < n; ++i) {
+            std::string id(quant.id_at(approx[i].index));
+            float s = SimilarityCalculator::cosine_similarity(query.data(),
+                                                              exact.row(exact.find(id)), dim);
+            max_err = std::max(max_err, std::fabs(s - approx[i].score));
+        }
+
+        // The exact winner survives the int8 shortlist
+        float best = 0.0f;
+        int r = exact.best_match(query.data(), best);
+        bool found = false;
+        for (int i = 0; i < n; ++i) found |= quant.id_at(approx[i].index) == exact.id_at(r);
+        EXPECT_TRUE(found);
+    }
+
+    // Well inside the default rerank epsilon (0.01) / 2
+    EXPECT_LT(max_err, 0.005f);
+    EXPECT_LT(quant.memory_bytes() * 2, exact.memory_bytes());
+}
+
+TEST(SpeakerGalleryTest, Int8SearchTiming) {
+    const int dim = 192;
+    const int n = 100000;
+    std::mt19937 rng(17);
+    auto query = random_unit_vector(dim, rng);
+    auto proto = random_unit_vector(dim, rng);
+
+    SpeakerGallery exact, quant;
+    exact.reset(dim);
+    quant.reset(dim, GalleryPrecision::INT8);
+    exact.reserve(n);
+    quant.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        proto[i % dim] = -proto[i % dim];
+        exact.upsert("spk_" + std::to_string(i), proto.data(), 1);
+        quant.upsert("spk_" + std::to_string(i), proto.data(), 1);
+    }
+
+    auto time_us = [&](const SpeakerGallery& g) {
+        std::vector<ScoredIndex> top(10);
+        g.top_k(query.data(), 10, top.data());   // warm
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 10; ++i) g.top_k(query.data(), 10, top.data());
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / 10;
+    };
+
+    double float_us = time_us(exact);
+    double int8_us = time_us(quant);
+    std::cout << "1:" << n << " top-10: float32 " << float_us << " us ("
+              << exact.memory_bytes() / (1024 * 1024) << " MB), int8 " << int8_us << " us ("
+              << quant.memory_bytes() / (1024 * 1024) << " MB)" << std::endl;
+    EXPECT_GT(int8_us, 0.0);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "storage/sqlite_store.h"
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -135,3 +136,97 @@ TEST_F(SqliteStoreTest, EmbeddingPrecision) {
             << "Mismatch at index " << i;
     }
 }
+
+TEST_F(SqliteStoreTest, LoadSpeakersSubset) {
+    for (int i = 0; i < 5; ++i) {
+        SpeakerProfile p;
+        p.speaker_id = "speaker_" + std::to_string(i);
+        p.embedding = {static_cast<float>(i), 0.0f, 1.0f};
+        p.enroll_count = i + 1;
+        store_.save_speaker(p);
+    }
+
+    std::vector<SpeakerProfile> speakers;
+    ASSERT_TRUE(store_.load_speakers({"speaker_1", "speaker_3", "missing"}, speakers));
+    ASSERT_EQ(speakers.size(), 2u);
+    for (const auto& sp : speakers) {
+        int i = sp.speaker_id == "speaker_1" ? 1 : 3;
+        EXPECT_EQ(sp.speaker_id, "speaker_" + std::to_string(i));
+        EXPECT_EQ(sp.enroll_count, i + 1);
+        ASSERT_EQ(sp.embedding.size(), 3u);
+        EXPECT_FLOAT_EQ(sp.embedding[0], static_cast<float>(i));
+    }
+
+    speakers.clear();
+    EXPECT_TRUE(store_.load_speakers({}, speakers));
+    EXPECT_TRUE(speakers.empty());
+}
+
+TEST_F(SqliteStoreTest, LoadSpeakersSplitsLongIdLists) {
+    // More IDs than one statement may bind
+    const int n = static_cast<int>(SqliteStore::MAX_BOUND_IDS) * 2 + 7;
+    std::vector<std::string> ids;
+    for (int i = 0; i < n; ++i) {
+        SpeakerProfile p;
+        p.speaker_id = "speaker_" + std::to_string(i);
+        p.embedding = {static_cast<float>(i), 1.0f};
+        p.enroll_count = 1;
+        ASSERT_TRUE(store_.save_speaker(p));
+        ids.push_back(p.speaker_id);
+    }
+    ids.push_back("missing");
+
+    std::vector<SpeakerProfile> speakers;
+    ASSERT_TRUE(store_.load_speakers(ids, speakers));
+    ASSERT_EQ(static_cast<int>(speakers.size()), n);
+    std::vector<bool> seen(n, false);
+    for (const auto& sp : speakers) seen[static_cast<int>(sp.embedding[0])] = true;
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), n);
+}
+
+TEST_F(SqliteStoreTest, ForEachSpeakerStreamsRows) {
+    for (int i = 0; i < 4; ++i) {
+        SpeakerProfile p;
+        p.speaker_id = "speaker_" + std::to_string(i);
+        p.embedding = {static_cast<float>(i), 1.0f};
+        p.enroll_count = 1;
+        store_.save_speaker(p);
+    }
+
+    int rows = 0;
+    float sum = 0.0f;
+    ASSERT_TRUE(store_.for_each_speaker([&](SpeakerProfile& p) {
+        ++rows;
+        ASSERT_EQ(p.embedding.size(), 2u);
+        sum += p.embedding[0];
+    }));
+    EXPECT_EQ(rows, 4);
+    EXPECT_FLOAT_EQ(sum, 6.0f);
+}
+
+TEST_F(SqliteStoreTest, GenerationCountsEveryWrite) {
+    int64_t start = store_.get_generation();
+    ASSERT_GE(start, 0);
+
+    SpeakerProfile p;
+    p.speaker_id = "speaker_a";
+    p.embedding = {1.0f, 0.0f};
+    p.enroll_count = 1;
+    ASSERT_TRUE(store_.save_speaker(p));
+    EXPECT_EQ(store_.get_generation(), start + 1);
+
+    // Re-enrollment replaces the row: one more change
+    p.enroll_count = 2;
+    ASSERT_TRUE(store_.save_speaker(p));
+    EXPECT_EQ(store_.get_generation(), start + 2);
+
+    ASSERT_TRUE(store_.remove_speaker("speaker_a"));
+    EXPECT_EQ(store_.get_generation(), start + 3);
+    EXPECT_FALSE(store_.remove_speaker("speaker_a"));
+    EXPECT_EQ(store_.get_generation(), start + 3);
+
+    // Survives reopening
+    store_.close();
+    ASSERT_TRUE(store_.open(db_path_));
+    EXPECT_EQ(store_.get_generation(), start + 3);
+}
@@ -0,0 +1,53 @@
+#ifndef VP_TEST_VECTORS_H
+#define VP_TEST_VECTORS_H
+
+// Synthetic embeddings shared by the search tests and benchmarks
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+inline std::vector<float> random_unit_vector(int dim, std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> v(dim);
+    float norm = 0.0f;
+    for (auto& x : v) { x = dist(rng); norm += x * x; }
+    norm = std::sqrt(norm);
+    for (auto& x : v) x /= norm;
+    return v;
+}
+
+// Re-normalized copy of v with per-dimension Gaussian noise
+inline std::vector<float> perturb(const std::vector<float>& v, float sigma, std::mt19937& rng) {
+    std::normal_distribution<float> noise(0.0f, sigma);
+    std::vector<float> out = v;
+    float norm = 0.0f;
+    for (auto& x : out) { x += noise(rng); norm += x * x; }
+    norm = std::sqrt(norm);
+    for (auto& x : out) x /= norm;
+    return out;
+}
+
+// Speaker-like data: embeddings scattered around a set of cluster centres
+inline std::vector<std::vector<float>> clustered_vectors(int n, int dim, int clusters,
+                                                         std::mt19937& rng) {
+    std::vector<std::vector<float>> centres;
+    for (int c = 0; c < clusters; ++c) centres.push_back(random_unit_vector(dim, rng));
+
+    std::vector<std::vector<float>> out;
+    for (int i = 0; i < n; ++i) out.push_back(perturb(centres[i % clusters], 0.05f, rng));
+    return out;
+}
+
+// clustered_vectors() as one row-major n x dim matrix
+inline std::vector<float> clustered_matrix(int n, int dim, int clusters, std::mt19937& rng) {
+    std::vector<float> out;
+    out.reserve(static_cast<size_t>(n) * dim);
+    for (const auto& v : clustered_vectors(n, dim, clusters, rng)) {
+        out.insert(out.end(), v.begin(), v.end());
+    }
+    return out;
+}
+
+#endif // VP_TEST_VECTORS_H